@@ -0,0 +1,349 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/aligned_combine.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/framework/version.h"
+#include "paddle/fluid/memory/allocation/allocator.h"
+#ifndef _WIN32
+#include "paddle/fluid/memory/allocation/mmap_allocator.h"
+#endif
+
+namespace paddle {
+namespace framework {
+
+namespace {
+
+constexpr char kAlignedCombineMagic[8] = "PDALIGN";
+constexpr uint32_t kAlignedCombineVersion = 0;
+
+struct AlignedCombineEntry {
+  LoD lod;
+  proto::VarType::TensorDesc desc;
+  uint64_t offset;
+
+  size_t DataSize() const {
+    int64_t numel = 1;
+    for (auto dim : desc.dims()) {
+      numel *= dim;
+    }
+    return static_cast<size_t>(numel) * SizeOfType(desc.data_type());
+  }
+};
+
+template <typename T>
+void WritePod(std::ostream& os, const T& value) {
+  os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void ReadPod(std::istream& is, T* value) {
+  is.read(reinterpret_cast<char*>(value), sizeof(T));
+}
+
+void WriteHeader(std::ostream& os,
+                 const std::vector<AlignedCombineEntry>& entries,
+                 uint32_t alignment) {
+  os.write(kAlignedCombineMagic, sizeof(kAlignedCombineMagic));
+  WritePod(os, kAlignedCombineVersion);
+  WritePod(os, alignment);
+  WritePod(os, static_cast<uint64_t>(entries.size()));
+  for (auto& entry : entries) {
+    WritePod(os, kCurTensorVersion);
+    WritePod(os, static_cast<uint64_t>(entry.lod.size()));
+    for (auto& level : entry.lod) {
+      uint64_t size = level.size() * sizeof(LoD::value_type::value_type);
+      WritePod(os, size);
+      os.write(reinterpret_cast<const char*>(level.data()),
+               static_cast<std::streamsize>(size));
+    }
+    constexpr uint32_t tensor_version = 0;
+    WritePod(os, tensor_version);
+    auto desc = entry.desc.SerializeAsString();
+    WritePod(os, static_cast<int32_t>(desc.size()));
+    os.write(desc.data(), static_cast<std::streamsize>(desc.size()));
+    WritePod(os, entry.offset);
+  }
+}
+
+// Reads the header and returns its size in bytes.
+size_t ReadHeader(std::istream& is, std::vector<AlignedCombineEntry>* entries) {
+  char magic[sizeof(kAlignedCombineMagic)];
+  is.read(magic, sizeof(magic));
+  PADDLE_ENFORCE_EQ(
+      std::memcmp(magic, kAlignedCombineMagic, sizeof(magic)), 0,
+      platform::errors::InvalidArgument(
+          "The stream is not in the aligned combined format."));
+  uint32_t version;
+  ReadPod(is, &version);
+  PADDLE_ENFORCE_EQ(version, kAlignedCombineVersion,
+                    platform::errors::InvalidArgument(
+                        "The aligned combined format version %u is not "
+                        "supported, only version %u is supported.",
+                        version, kAlignedCombineVersion));
+  uint32_t alignment;
+  ReadPod(is, &alignment);
+  uint64_t num;
+  ReadPod(is, &num);
+  size_t header_size = sizeof(magic) + sizeof(version) + sizeof(alignment) +
+                       sizeof(num);
+
+  entries->resize(num);
+  for (auto& entry : *entries) {
+    uint32_t lod_tensor_version;
+    ReadPod(is, &lod_tensor_version);
+    PADDLE_ENFORCE_EQ(IsTensorVersionSupported(lod_tensor_version), true,
+                      platform::errors::InvalidArgument(
+                          "tensor version %u is not supported.",
+                          lod_tensor_version));
+    uint64_t lod_level;
+    ReadPod(is, &lod_level);
+    header_size += sizeof(lod_tensor_version) + sizeof(lod_level);
+    entry.lod.resize(lod_level);
+    for (auto& level : entry.lod) {
+      uint64_t size;
+      ReadPod(is, &size);
+      level.resize(size / sizeof(LoD::value_type::value_type));
+      is.read(reinterpret_cast<char*>(level.data()),
+              static_cast<std::streamsize>(size));
+      header_size += sizeof(size) + size;
+    }
+    uint32_t tensor_version;
+    ReadPod(is, &tensor_version);
+    PADDLE_ENFORCE_EQ(
+        tensor_version, 0U,
+        platform::errors::InvalidArgument(
+            "tensor version %u is not supported, Only version 0 is supported",
+            tensor_version));
+    int32_t desc_size;
+    ReadPod(is, &desc_size);
+    std::unique_ptr<char[]> buf(new char[desc_size]);
+    is.read(buf.get(), desc_size);
+    PADDLE_ENFORCE_EQ(
+        entry.desc.ParseFromArray(buf.get(), desc_size), true,
+        platform::errors::InvalidArgument("Cannot parse tensor desc"));
+    ReadPod(is, &entry.offset);
+    header_size += sizeof(tensor_version) + sizeof(desc_size) + desc_size +
+                   sizeof(entry.offset);
+  }
+  PADDLE_ENFORCE_EQ(static_cast<bool>(is), true,
+                    platform::errors::InvalidArgument(
+                        "The header of the aligned combined stream is "
+                        "incomplete or damaged."));
+  return header_size;
+}
+
+void CheckTensorNumber(const std::vector<AlignedCombineEntry>& entries,
+                       size_t expected) {
+  PADDLE_ENFORCE_EQ(
+      entries.size(), expected,
+      platform::errors::InvalidArgument(
+          "The aligned combined file holds %d tensors, but %d are requested. "
+          "Partial loading is not supported.",
+          entries.size(), expected));
+}
+
+void ResizeTensor(const AlignedCombineEntry& entry, LoDTensor* tensor) {
+  std::vector<int64_t> dims;
+  dims.reserve(static_cast<size_t>(entry.desc.dims().size()));
+  std::copy(entry.desc.dims().begin(), entry.desc.dims().end(),
+            std::back_inserter(dims));
+  tensor->Resize(make_ddim(dims));
+  tensor->set_lod(entry.lod);
+}
+
+}  // namespace
+
+bool IsAlignedCombineStream(std::istream& is) {
+  auto pos = is.tellg();
+  char magic[sizeof(kAlignedCombineMagic)];
+  is.read(magic, sizeof(magic));
+  bool matched = static_cast<bool>(is) &&
+                 std::memcmp(magic, kAlignedCombineMagic, sizeof(magic)) == 0;
+  is.clear();
+  is.seekg(pos);
+  return matched;
+}
+
+void SerializeToAlignedCombineStream(
+    std::ostream& os, const std::vector<const LoDTensor*>& tensors,
+    const platform::DeviceContext& dev_ctx, size_t alignment) {
+  PADDLE_ENFORCE_EQ(alignment > 0 && (alignment & (alignment - 1)) == 0, true,
+                    platform::errors::InvalidArgument(
+                        "The alignment must be a power of 2, but got %d.",
+                        alignment));
+  std::vector<AlignedCombineEntry> entries(tensors.size());
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    auto& entry = entries[i];
+    entry.lod = tensors[i]->lod();
+    entry.desc.set_data_type(tensors[i]->type());
+    auto dims = vectorize(tensors[i]->dims());
+    auto* pb_dims = entry.desc.mutable_dims();
+    pb_dims->Resize(static_cast<int>(dims.size()), 0);
+    std::copy(dims.begin(), dims.end(), pb_dims->begin());
+    entry.offset = 0;
+  }
+
+  // The header size does not depend on the offsets, so write it once to
+  // compute where the data starts, then lay out the data.
+  std::ostringstream header;
+  WriteHeader(header, entries, static_cast<uint32_t>(alignment));
+  size_t offset = header.str().size();
+  for (auto& entry : entries) {
+    offset = memory::allocation::AlignedSize(offset, alignment);
+    entry.offset = offset;
+    offset += entry.DataSize();
+  }
+  header.str("");
+  WriteHeader(header, entries, static_cast<uint32_t>(alignment));
+  auto header_str = header.str();
+  os.write(header_str.data(), static_cast<std::streamsize>(header_str.size()));
+
+  size_t pos = header_str.size();
+  std::vector<char> padding(alignment, 0);
+  for (size_t i = 0; i < tensors.size(); ++i) {
+    os.write(padding.data(),
+             static_cast<std::streamsize>(entries[i].offset - pos));
+    size_t size = entries[i].DataSize();
+    if (size > 0) {
+      if (platform::is_cpu_place(tensors[i]->place())) {
+        os.write(static_cast<const char*>(tensors[i]->data<void>()),
+                 static_cast<std::streamsize>(size));
+      } else {
+        Tensor cpu_tensor;
+        TensorCopy(*tensors[i], platform::CPUPlace(), dev_ctx, &cpu_tensor);
+        dev_ctx.Wait();
+        os.write(static_cast<const char*>(cpu_tensor.data<void>()),
+                 static_cast<std::streamsize>(size));
+      }
+    }
+    pos = entries[i].offset + size;
+  }
+}
+
+void DeserializeFromAlignedCombineStream(
+    std::istream& is, const std::vector<LoDTensor*>& tensors,
+    const platform::DeviceContext& dev_ctx) {
+  std::vector<AlignedCombineEntry> entries;
+  size_t pos = ReadHeader(is, &entries);
+  CheckTensorNumber(entries, tensors.size());
+
+  auto place = dev_ctx.GetPlace();
+  for (size_t i = 0; i < entries.size(); ++i) {
+    auto& entry = entries[i];
+    PADDLE_ENFORCE_GE(entry.offset, pos,
+                      platform::errors::InvalidArgument(
+                          "The data of tensor %d overlaps the previous one.",
+                          i));
+    is.ignore(static_cast<std::streamsize>(entry.offset - pos));
+
+    auto* tensor = tensors[i];
+    ResizeTensor(entry, tensor);
+    size_t size = entry.DataSize();
+    if (platform::is_cpu_place(place)) {
+      void* buf = tensor->mutable_data(place, entry.desc.data_type());
+      is.read(static_cast<char*>(buf), static_cast<std::streamsize>(size));
+    } else {
+      Tensor cpu_tensor;
+      cpu_tensor.Resize(tensor->dims());
+      void* buf = cpu_tensor.mutable_data(platform::CPUPlace(),
+                                          entry.desc.data_type());
+      is.read(static_cast<char*>(buf), static_cast<std::streamsize>(size));
+      TensorCopySync(cpu_tensor, place, tensor);
+    }
+    pos = entry.offset + size;
+  }
+  PADDLE_ENFORCE_EQ(static_cast<bool>(is), true,
+                    platform::errors::InvalidArgument(
+                        "The aligned combined stream is incomplete or "
+                        "damaged."));
+}
+
+void LoadAlignedCombineFileByMemoryMap(const std::string& file_path,
+                                       const std::vector<LoDTensor*>& tensors) {
+#ifndef _WIN32
+  std::vector<AlignedCombineEntry> entries;
+  {
+    std::ifstream fin(file_path, std::ios::binary);
+    PADDLE_ENFORCE_EQ(static_cast<bool>(fin), true,
+                      platform::errors::NotFound("Cannot open file %s.",
+                                                 file_path));
+    ReadHeader(fin, &entries);
+  }
+  CheckTensorNumber(entries, tensors.size());
+
+  auto file = memory::allocation::MapFileToMemory(file_path);
+  for (size_t i = 0; i < entries.size(); ++i) {
+    auto& entry = entries[i];
+    auto* tensor = tensors[i];
+    tensor->clear();
+    ResizeTensor(entry, tensor);
+    std::shared_ptr<memory::Allocation> region =
+        std::make_shared<memory::allocation::MemoryMapFileRegionAllocation>(
+            file, entry.offset, entry.DataSize());
+    tensor->ResetHolderWithType(region, entry.desc.data_type());
+  }
+  VLOG(3) << "Mapped " << entries.size() << " tensors from " << file_path;
+#else
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "Loading parameters by memory map is not supported on Windows."));
+#endif
+}
+
+size_t ConvertToAlignedCombineFile(const std::string& src_path,
+                                   const std::string& dst_path,
+                                   size_t alignment) {
+  std::ifstream fin(src_path, std::ios::binary);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fin), true,
+                    platform::errors::NotFound("Cannot open file %s.",
+                                               src_path));
+  PADDLE_ENFORCE_EQ(IsAlignedCombineStream(fin), false,
+                    platform::errors::InvalidArgument(
+                        "File %s is already in the aligned combined format.",
+                        src_path));
+
+  platform::CPUDeviceContext dev_ctx;
+  std::vector<std::unique_ptr<LoDTensor>> tensors;
+  while (fin.peek() != EOF) {
+    tensors.emplace_back(new LoDTensor());
+    DeserializeFromStream(fin, tensors.back().get(), dev_ctx);
+    PADDLE_ENFORCE_EQ(static_cast<bool>(fin), true,
+                      platform::errors::InvalidArgument(
+                          "File %s is incomplete or damaged.", src_path));
+  }
+
+  std::vector<const LoDTensor*> tensor_ptrs;
+  tensor_ptrs.reserve(tensors.size());
+  for (auto& tensor : tensors) {
+    tensor_ptrs.push_back(tensor.get());
+  }
+  std::ofstream fout(dst_path, std::ios::binary);
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                    platform::errors::Unavailable("Cannot open %s to write.",
+                                                  dst_path));
+  SerializeToAlignedCombineStream(fout, tensor_ptrs, dev_ctx, alignment);
+  return tensors.size();
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,73 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace framework {
+
+/*
+ * The aligned combined format stores several LoDTensors in one file, like
+ * the output of save_combine_op, but places the data of every tensor at an
+ * aligned offset, so the file can be memory mapped and the tensors can point
+ * directly into the mapping.
+ *
+ *   char[8]   magic "PDALIGN"
+ *   uint32_t  format version
+ *   uint32_t  alignment in bytes
+ *   uint64_t  number of tensors
+ *   for each tensor:
+ *     uint32_t  LoDTensor version
+ *     uint64_t  lod_level, then for each level: uint64_t size, size_t[] data
+ *     uint32_t  Tensor version
+ *     int32_t   TensorDesc size, TensorDesc protobuf message
+ *     uint64_t  absolute offset of the tensor data in the file
+ *   padding, then the data of each tensor, each one starting at its offset.
+ */
+constexpr size_t kAlignedCombineDefaultAlignment = 4096;
+
+// Returns true if the stream starts with an aligned combined header. The
+// stream position is not changed.
+bool IsAlignedCombineStream(std::istream& is);
+
+void SerializeToAlignedCombineStream(
+    std::ostream& os, const std::vector<const LoDTensor*>& tensors,
+    const platform::DeviceContext& dev_ctx,
+    size_t alignment = kAlignedCombineDefaultAlignment);
+
+// Reads every tensor into newly allocated memory of dev_ctx's place.
+void DeserializeFromAlignedCombineStream(
+    std::istream& is, const std::vector<LoDTensor*>& tensors,
+    const platform::DeviceContext& dev_ctx);
+
+// Maps the file into memory and makes every tensor share a region of the
+// mapping as its CPU buffer, without copying the data.
+void LoadAlignedCombineFileByMemoryMap(const std::string& file_path,
+                                       const std::vector<LoDTensor*>& tensors);
+
+// Converts a file written by save_combine_op into the aligned combined
+// format. Returns the number of converted tensors.
+size_t ConvertToAlignedCombineFile(
+    const std::string& src_path, const std::string& dst_path,
+    size_t alignment = kAlignedCombineDefaultAlignment);
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,119 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/aligned_combine.h"
+
+namespace paddle {
+namespace framework {
+
+static void InitTensors(std::vector<LoDTensor>* tensors) {
+  platform::CPUPlace place;
+  tensors->resize(3);
+  auto& t0 = (*tensors)[0];
+  t0.Resize({10, 7});
+  t0.set_lod({{0, 3, 10}});
+  float* d0 = t0.mutable_data<float>(place);
+  for (int64_t i = 0; i < t0.numel(); ++i) d0[i] = i * 0.5f;
+
+  auto& t1 = (*tensors)[1];
+  t1.Resize({33});
+  int64_t* d1 = t1.mutable_data<int64_t>(place);
+  for (int64_t i = 0; i < t1.numel(); ++i) d1[i] = i * 3;
+
+  auto& t2 = (*tensors)[2];
+  t2.Resize({0, 4});
+  t2.mutable_data<int>(place);
+}
+
+static void CheckTensors(const std::vector<LoDTensor>& expect,
+                         const std::vector<LoDTensor>& actual) {
+  ASSERT_EQ(expect.size(), actual.size());
+  for (size_t i = 0; i < expect.size(); ++i) {
+    EXPECT_EQ(expect[i].dims(), actual[i].dims());
+    EXPECT_EQ(expect[i].type(), actual[i].type());
+    EXPECT_EQ(expect[i].lod(), actual[i].lod());
+    size_t size = expect[i].numel() * SizeOfType(expect[i].type());
+    if (size > 0) {
+      EXPECT_EQ(std::memcmp(expect[i].data<void>(), actual[i].data<void>(),
+                            size),
+                0);
+    }
+  }
+}
+
+static std::vector<LoDTensor*> Pointers(std::vector<LoDTensor>* tensors) {
+  std::vector<LoDTensor*> ptrs;
+  for (auto& t : *tensors) ptrs.push_back(&t);
+  return ptrs;
+}
+
+TEST(AlignedCombine, stream) {
+  std::vector<LoDTensor> src;
+  InitTensors(&src);
+  platform::CPUDeviceContext dev_ctx;
+
+  std::stringstream ss;
+  SerializeToAlignedCombineStream(ss, {&src[0], &src[1], &src[2]}, dev_ctx,
+                                  64);
+  EXPECT_TRUE(IsAlignedCombineStream(ss));
+
+  std::vector<LoDTensor> dst(src.size());
+  DeserializeFromAlignedCombineStream(ss, Pointers(&dst), dev_ctx);
+  CheckTensors(src, dst);
+
+  std::stringstream plain;
+  SerializeToStream(plain, src[0], dev_ctx);
+  EXPECT_FALSE(IsAlignedCombineStream(plain));
+}
+
+#ifndef _WIN32
+TEST(AlignedCombine, convert_and_mmap) {
+  std::vector<LoDTensor> src;
+  InitTensors(&src);
+  platform::CPUDeviceContext dev_ctx;
+  {
+    std::ofstream fout("aligned_combine_test.plain", std::ios::binary);
+    for (auto& t : src) SerializeToStream(fout, t, dev_ctx);
+  }
+  EXPECT_EQ(ConvertToAlignedCombineFile("aligned_combine_test.plain",
+                                        "aligned_combine_test.aligned"),
+            src.size());
+
+  std::vector<LoDTensor> dst(src.size());
+  LoadAlignedCombineFileByMemoryMap("aligned_combine_test.aligned",
+                                    Pointers(&dst));
+  CheckTensors(src, dst);
+  for (auto& t : dst) {
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(t.data<void>()) %
+                  kAlignedCombineDefaultAlignment,
+              0UL);
+  }
+
+  // Writing to a mapped tensor must not change the file.
+  dst[0].data<float>()[0] = -1.0f;
+  std::vector<LoDTensor> reload(src.size());
+  LoadAlignedCombineFileByMemoryMap("aligned_combine_test.aligned",
+                                    Pointers(&reload));
+  CheckTensors(src, reload);
+}
+#endif
+
+}  // namespace framework
+}  // namespace paddle
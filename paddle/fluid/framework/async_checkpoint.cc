@@ -0,0 +1,215 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/async_checkpoint.h"
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <fstream>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/tensor_util.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/platform/port.h"
+
+DEFINE_int64(async_checkpoint_max_staging_mb, 4096,
+             "The maximum host memory in MB used to stage the variables of "
+             "the checkpoints being written in the background.");
+
+namespace paddle {
+namespace framework {
+
+bool AsyncCheckpointHandle::Done() const {
+  if (!future_.valid()) return true;
+  return future_.wait_for(std::chrono::seconds(0)) ==
+         std::future_status::ready;
+}
+
+void AsyncCheckpointHandle::Wait() const {
+  if (!future_.valid()) return;
+  auto& error = future_.get();
+  if (error != nullptr) {
+    throw *error;
+  }
+}
+
+AsyncCheckpointer::AsyncCheckpointer(size_t max_staging_bytes)
+    : max_staging_bytes_(max_staging_bytes) {}
+
+AsyncCheckpointer::~AsyncCheckpointer() {
+  try {
+    WaitAll();
+  } catch (platform::EnforceNotMet& ex) {
+    LOG(ERROR) << "Async checkpoint failed: " << ex.what();
+  }
+}
+
+AsyncCheckpointer* AsyncCheckpointer::GetInstance() {
+  static AsyncCheckpointer checkpointer(
+      static_cast<size_t>(FLAGS_async_checkpoint_max_staging_mb) << 20);
+  return &checkpointer;
+}
+
+void AsyncCheckpointer::AcquireStaging(size_t bytes) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  cv_.wait(lock, [&] {
+    return staging_bytes_ == 0 || staging_bytes_ + bytes <= max_staging_bytes_;
+  });
+  staging_bytes_ += bytes;
+}
+
+void AsyncCheckpointer::ReleaseStaging(size_t bytes) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    staging_bytes_ -= bytes;
+  }
+  cv_.notify_all();
+}
+
+size_t AsyncCheckpointer::staging_bytes() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return staging_bytes_;
+}
+
+AsyncCheckpointHandle AsyncCheckpointer::Save(
+    const Scope& scope, const std::vector<std::string>& var_names,
+    const std::string& file_path) {
+  std::vector<const LoDTensor*> tensors;
+  tensors.reserve(var_names.size());
+  size_t bytes = 0;
+  for (auto& name : var_names) {
+    auto* var = scope.FindVar(name);
+    PADDLE_ENFORCE_NOT_NULL(
+        var, platform::errors::NotFound(
+                 "Variable [%s] to checkpoint is not found in scope.", name));
+    PADDLE_ENFORCE_EQ(var->IsType<LoDTensor>(), true,
+                      platform::errors::InvalidArgument(
+                          "Only LoDTensor can be checkpointed, but variable "
+                          "[%s] has another type.",
+                          name));
+    auto& tensor = var->Get<LoDTensor>();
+    PADDLE_ENFORCE_EQ(tensor.IsInitialized(), true,
+                      platform::errors::PreconditionNotMet(
+                          "Variable [%s] to checkpoint is not initialized.",
+                          name));
+    tensors.push_back(&tensor);
+    bytes += tensor.numel() * SizeOfType(tensor.type());
+  }
+
+  // Snapshot synchronously, the caller can modify the variables as soon as
+  // Save returns.
+  AcquireStaging(bytes);
+  auto staged = std::make_shared<std::vector<LoDTensor>>(tensors.size());
+  try {
+    for (size_t i = 0; i < tensors.size(); ++i) {
+      auto& dst = (*staged)[i];
+      dst.set_lod(tensors[i]->lod());
+      TensorCopySync(*tensors[i], platform::CPUPlace(), &dst);
+    }
+  } catch (...) {
+    ReleaseStaging(bytes);
+    throw;
+  }
+  VLOG(3) << "Staged " << tensors.size() << " variables (" << bytes
+          << " bytes) for checkpoint " << file_path;
+
+  auto future = ThreadPoolIO::GetInstanceIO()->RunAndGetException(
+      [this, staged, bytes, file_path] {
+        struct StagingReleaser {
+          ~StagingReleaser() {
+            staged->clear();
+            checkpointer->ReleaseStaging(bytes);
+          }
+          AsyncCheckpointer* checkpointer;
+          std::shared_ptr<std::vector<LoDTensor>> staged;
+          size_t bytes;
+        } releaser{this, staged, bytes};
+
+        MkDirRecursively(DirName(file_path).c_str());
+        std::string tmp_path = file_path + ".tmp";
+        {
+          std::ofstream fout(tmp_path, std::ios::binary);
+          PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                            platform::errors::Unavailable(
+                                "Cannot open %s to write.", tmp_path));
+          platform::CPUDeviceContext dev_ctx;
+          for (auto& tensor : *staged) {
+            SerializeToStream(fout, tensor, dev_ctx);
+          }
+          PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                            platform::errors::Unavailable(
+                                "Failed to write checkpoint %s.", tmp_path));
+        }
+        PADDLE_ENFORCE_EQ(
+            std::rename(tmp_path.c_str(), file_path.c_str()), 0,
+            platform::errors::Unavailable("Failed to rename %s to %s.",
+                                          tmp_path, file_path));
+        VLOG(3) << "Checkpoint " << file_path << " is written";
+      });
+
+  AsyncCheckpointHandle handle(future.share());
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Drop the finished checkpoints, so pending_ does not grow over a long
+    // run. The first error among them is kept for WaitAll.
+    auto finished = std::remove_if(
+        pending_.begin(), pending_.end(),
+        [this](const AsyncCheckpointHandle& pending) {
+          if (!pending.Done()) return false;
+          try {
+            pending.Wait();
+          } catch (platform::EnforceNotMet& ex) {
+            if (first_error_ == nullptr) {
+              first_error_.reset(new platform::EnforceNotMet(ex));
+            }
+          }
+          return true;
+        });
+    pending_.erase(finished, pending_.end());
+    pending_.push_back(handle);
+  }
+  return handle;
+}
+
+size_t AsyncCheckpointer::num_pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return pending_.size();
+}
+
+void AsyncCheckpointer::WaitAll() {
+  std::vector<AsyncCheckpointHandle> pending;
+  std::unique_ptr<platform::EnforceNotMet> first_error;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    pending.swap(pending_);
+    first_error = std::move(first_error_);
+  }
+  for (auto& handle : pending) {
+    try {
+      handle.Wait();
+    } catch (platform::EnforceNotMet& ex) {
+      if (first_error == nullptr) {
+        first_error.reset(new platform::EnforceNotMet(ex));
+      }
+    }
+  }
+  if (first_error != nullptr) {
+    throw *first_error;
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
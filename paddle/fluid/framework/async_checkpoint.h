@@ -0,0 +1,102 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <future>              // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/enforce.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace framework {
+
+// The completion handle of a checkpoint saved by AsyncCheckpointer.
+class AsyncCheckpointHandle {
+ public:
+  AsyncCheckpointHandle() = default;
+  explicit AsyncCheckpointHandle(
+      std::shared_future<std::unique_ptr<platform::EnforceNotMet>> future)
+      : future_(std::move(future)) {}
+
+  // Returns true if the checkpoint has been written or has failed.
+  bool Done() const;
+
+  // Blocks until the checkpoint is written, and rethrows the error raised
+  // while writing it, if any.
+  void Wait() const;
+
+ private:
+  std::shared_future<std::unique_ptr<platform::EnforceNotMet>> future_;
+};
+
+// AsyncCheckpointer saves persistable variables without blocking training
+// for the serialization: Save() copies the variables into staging memory,
+// then the staged copy is written on the IO thread pool in the format of
+// save_combine_op, so it can be loaded by load_combine_op.
+//
+// The staging memory is bounded. Save() blocks while the staged data of
+// previous checkpoints and the new one would exceed the limit, unless nothing
+// else is staged.
+//
+// NOTE: the copy is not synchronized with the threads updating the
+// variables, so the caller should snapshot at a step boundary, or accept the
+// same inconsistency as the hogwild training it runs with.
+class AsyncCheckpointer {
+ public:
+  explicit AsyncCheckpointer(size_t max_staging_bytes);
+
+  ~AsyncCheckpointer();
+
+  // The global checkpointer, the staging memory of which is limited by
+  // FLAGS_async_checkpoint_max_staging_mb.
+  static AsyncCheckpointer* GetInstance();
+
+  AsyncCheckpointHandle Save(const Scope& scope,
+                             const std::vector<std::string>& var_names,
+                             const std::string& file_path);
+
+  // Waits for all the pending checkpoints, and rethrows the first error.
+  void WaitAll();
+
+  size_t staging_bytes() const;
+
+  // The number of the checkpoints not known to be finished.
+  size_t num_pending() const;
+
+ private:
+  void AcquireStaging(size_t bytes);
+
+  void ReleaseStaging(size_t bytes);
+
+  size_t max_staging_bytes_;
+  size_t staging_bytes_{0};
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::vector<AsyncCheckpointHandle> pending_;
+  // The first error of the finished checkpoints dropped from pending_.
+  std::unique_ptr<platform::EnforceNotMet> first_error_;
+
+  DISABLE_COPY_AND_ASSIGN(AsyncCheckpointer);
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,107 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/async_checkpoint.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+
+static LoDTensor* CreateTensor(Scope* scope, const std::string& name,
+                               int64_t numel, float value) {
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  tensor->Resize({numel});
+  float* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < numel; ++i) data[i] = value + i;
+  return tensor;
+}
+
+static void CheckFile(const std::string& path,
+                      const std::vector<float>& values, int64_t numel) {
+  std::ifstream fin(path, std::ios::binary);
+  ASSERT_TRUE(static_cast<bool>(fin));
+  platform::CPUDeviceContext dev_ctx;
+  for (float value : values) {
+    LoDTensor tensor;
+    DeserializeFromStream(fin, &tensor, dev_ctx);
+    ASSERT_EQ(tensor.numel(), numel);
+    for (int64_t i = 0; i < numel; ++i) {
+      EXPECT_EQ(tensor.data<float>()[i], value + i);
+    }
+  }
+}
+
+TEST(AsyncCheckpointer, snapshot) {
+  Scope scope;
+  auto* a = CreateTensor(&scope, "a", 1000, 1.0f);
+  auto* b = CreateTensor(&scope, "b", 1000, 2.0f);
+
+  AsyncCheckpointer checkpointer(1UL << 20);
+  auto handle = checkpointer.Save(scope, {"a", "b"},
+                                  "async_checkpoint_test/snapshot");
+  // The checkpoint must keep the values at the time of Save.
+  a->data<float>()[0] = -1.0f;
+  b->data<float>()[0] = -1.0f;
+  handle.Wait();
+  EXPECT_TRUE(handle.Done());
+  CheckFile("async_checkpoint_test/snapshot", {1.0f, 2.0f}, 1000);
+
+  EXPECT_THROW(checkpointer.Save(scope, {"c"}, "async_checkpoint_test/c"),
+               platform::EnforceNotMet);
+}
+
+TEST(AsyncCheckpointer, bounded_staging) {
+  Scope scope;
+  CreateTensor(&scope, "a", 1000, 3.0f);
+
+  // Each checkpoint takes the whole staging memory, so they are serialized.
+  AsyncCheckpointer checkpointer(1000 * sizeof(float));
+  std::vector<AsyncCheckpointHandle> handles;
+  for (int i = 0; i < 4; ++i) {
+    handles.push_back(checkpointer.Save(
+        scope, {"a"}, "async_checkpoint_test/bounded_" + std::to_string(i)));
+    EXPECT_LE(checkpointer.staging_bytes(), 1000 * sizeof(float));
+  }
+  checkpointer.WaitAll();
+  EXPECT_EQ(checkpointer.staging_bytes(), 0UL);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(handles[i].Done());
+    CheckFile("async_checkpoint_test/bounded_" + std::to_string(i), {3.0f},
+              1000);
+  }
+}
+
+TEST(AsyncCheckpointer, drop_finished) {
+  Scope scope;
+  CreateTensor(&scope, "a", 100, 4.0f);
+
+  // The finished checkpoints are dropped by the next Save.
+  AsyncCheckpointer checkpointer(1UL << 20);
+  for (int i = 0; i < 8; ++i) {
+    checkpointer
+        .Save(scope, {"a"}, "async_checkpoint_test/drop_" + std::to_string(i))
+        .Wait();
+    EXPECT_EQ(checkpointer.num_pending(), 1UL);
+  }
+  checkpointer.WaitAll();
+  EXPECT_EQ(checkpointer.num_pending(), 0UL);
+}
+
+}  // namespace framework
+}  // namespace paddle
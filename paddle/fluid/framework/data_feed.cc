@@ -235,6 +235,8 @@ InMemoryDataFeed<T>::InMemoryDataFeed() {
   this->input_channel_ = nullptr;
   this->output_channel_ = nullptr;
   this->consume_channel_ = nullptr;
+  this->max_batch_feasigns_ = 0;
+  this->length_bucket_size_ = 0;
 }
 
 template <typename T>
@@ -261,17 +263,25 @@ int InMemoryDataFeed<T>::Next() {
           << ", consume_channel_ size=" << consume_channel_->Size()
           << ", thread_id=" << thread_id_;
   int index = 0;
-  T instance;
+  size_t feasign_num = 0;
   std::vector<T> ins_vec;
   ins_vec.reserve(this->default_batch_size_);
   while (index < this->default_batch_size_) {
-    if (output_channel_->Size() == 0) {
+    if (pending_ins_.empty() && !TakeBucket()) {
       break;
     }
-    output_channel_->Get(instance);
+    T& instance = pending_ins_.front();
+    size_t num = InstanceFeasignNum(instance);
+    // an instance of more feasigns than max_batch_feasigns_ is batched alone
+    if (max_batch_feasigns_ > 0 && index > 0 &&
+        feasign_num + num > static_cast<size_t>(max_batch_feasigns_)) {
+      break;
+    }
+    feasign_num += num;
     ins_vec.push_back(instance);
     ++index;
     consume_channel_->Put(std::move(instance));
+    pending_ins_.pop_front();
   }
   this->batch_size_ = index;
   VLOG(3) << "batch_size_=" << this->batch_size_
@@ -290,6 +300,23 @@ int InMemoryDataFeed<T>::Next() {
 #endif
 }
 
+template <typename T>
+bool InMemoryDataFeed<T>::TakeBucket() {
+  size_t bucket_size = std::max(length_bucket_size_, 1);
+  T instance;
+  while (pending_ins_.size() < bucket_size && output_channel_->Size() != 0) {
+    output_channel_->Get(instance);
+    pending_ins_.push_back(std::move(instance));
+  }
+  if (pending_ins_.size() > 1) {
+    std::stable_sort(pending_ins_.begin(), pending_ins_.end(),
+                     [this](const T& a, const T& b) {
+                       return InstanceFeasignNum(a) < InstanceFeasignNum(b);
+                     });
+  }
+  return !pending_ins_.empty();
+}
+
 template <typename T>
 void InMemoryDataFeed<T>::SetInputChannel(void* channel) {
   input_channel_ = static_cast<paddle::framework::ChannelObject<T>*>(channel);
@@ -716,6 +743,8 @@ void MultiSlotInMemoryDataFeed::Init(
   paddle::framework::MultiSlotDesc multi_slot_desc =
       data_feed_desc.multi_slot_desc();
   SetBatchSize(data_feed_desc.batch_size());
+  max_batch_feasigns_ = data_feed_desc.max_batch_feasigns();
+  length_bucket_size_ = data_feed_desc.length_bucket_size();
   size_t all_slot_num = multi_slot_desc.slots_size();
   all_slots_.resize(all_slot_num);
   all_slots_type_.resize(all_slot_num);
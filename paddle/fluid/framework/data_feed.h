@@ -19,6 +19,8 @@ limitations under the License. */
 #define _LINUX
 #endif
 
+#include <algorithm>
+#include <deque>
 #include <fstream>
 #include <future>  // NOLINT
 #include <memory>
@@ -239,6 +241,11 @@ class InMemoryDataFeed : public DataFeed {
   virtual bool ParseOneInstance(T* instance) = 0;
   virtual bool ParseOneInstanceFromPipe(T* instance) = 0;
   virtual void PutToFeedVec(const std::vector<T>& ins_vec) = 0;
+  // the num of feasigns of an instance counted by max_batch_feasigns_
+  virtual size_t InstanceFeasignNum(const T& instance) { return 1; }
+  // take a bucket of instances from output_channel_ into pending_ins_,
+  // return false if there is none
+  bool TakeBucket();
 
   int thread_id_;
   int thread_num_;
@@ -249,6 +256,10 @@ class InMemoryDataFeed : public DataFeed {
   paddle::framework::ChannelObject<T>* input_channel_;
   paddle::framework::ChannelObject<T>* output_channel_;
   paddle::framework::ChannelObject<T>* consume_channel_;
+  int max_batch_feasigns_;
+  int length_bucket_size_;
+  // instances taken from output_channel_ but not batched yet
+  std::deque<T> pending_ins_;
 };
 
 // This class define the data type of instance(ins_vec) in MultiSlotDataFeed
@@ -557,6 +568,9 @@ class MultiSlotInMemoryDataFeed : public InMemoryDataFeed<Record> {
   virtual bool ParseOneInstance(Record* instance);
   virtual bool ParseOneInstanceFromPipe(Record* instance);
   virtual void PutToFeedVec(const std::vector<Record>& ins_vec);
+  virtual size_t InstanceFeasignNum(const Record& instance) {
+    return instance.uint64_feasigns_.size() + instance.float_feasigns_.size();
+  }
 };
 
 #if defined(PADDLE_WITH_CUDA) && !defined(_WIN32)
@@ -14,6 +14,7 @@
 
 #include "paddle/fluid/framework/data_set.h"
 #include <algorithm>
+#include <deque>
 #include <random>
 #include <unordered_map>
 #include <unordered_set>
@@ -34,6 +35,10 @@
 namespace paddle {
 namespace framework {
 
+// the max num of messages in flight from a send thread of streaming global
+// shuffle to a trainer
+static const size_t kMaxShuffleMsgInFlight = 8;
+
 // constructor
 template <typename T>
 DatasetImpl<T>::DatasetImpl() {
@@ -51,6 +56,7 @@ DatasetImpl<T>::DatasetImpl() {
   parse_content_ = false;
   preload_thread_num_ = 0;
   global_index_ = 0;
+  msg_transport_ = std::make_shared<FleetMsgTransport>();
 }
 
 // set filelist, file_idx_ will reset to zero.
@@ -179,9 +185,11 @@ void DatasetImpl<T>::CreateChannel() {
 // if sent message between workers, should first call this function
 template <typename T>
 void DatasetImpl<T>::RegisterClientToClientMsgHandler() {
-  auto fleet_ptr = FleetWrapper::GetInstance();
   VLOG(3) << "RegisterClientToClientMsgHandler";
-  fleet_ptr->RegisterClientToClientMsgHandler(
+  if (streaming_global_shuffle_) {
+    StartStreamingShuffleRecv();
+  }
+  msg_transport_->RegisterHandler(
       0, [this](int msg_type, int client_id, const std::string& msg) -> int {
         return this->ReceiveFromClient(msg_type, client_id, msg);
       });
@@ -195,6 +203,9 @@ void DatasetImpl<T>::LoadIntoMemory() {
   VLOG(3) << "DatasetImpl<T>::LoadIntoMemory() begin";
   platform::Timer timeline;
   timeline.Start();
+  if (streaming_global_shuffle_) {
+    StartStreamingShuffleSend();
+  }
   std::vector<std::thread> load_threads;
   for (int64_t i = 0; i < thread_num_; ++i) {
     load_threads.push_back(std::thread(
@@ -204,6 +215,9 @@ void DatasetImpl<T>::LoadIntoMemory() {
     t.join();
   }
   input_channel_->Close();
+  if (streaming_global_shuffle_) {
+    FinishStreamingShuffleSend();
+  }
   int64_t in_chan_size = input_channel_->Size();
   input_channel_->SetBlockSize(in_chan_size / thread_num_ + 1);
   timeline.Pause();
@@ -215,6 +229,9 @@ void DatasetImpl<T>::LoadIntoMemory() {
 template <typename T>
 void DatasetImpl<T>::PreLoadIntoMemory() {
   VLOG(3) << "DatasetImpl<T>::PreLoadIntoMemory() begin";
+  if (streaming_global_shuffle_) {
+    StartStreamingShuffleSend();
+  }
   if (preload_thread_num_ != 0) {
     CHECK(static_cast<size_t>(preload_thread_num_) == preload_readers_.size());
     preload_threads_.clear();
@@ -241,6 +258,9 @@ void DatasetImpl<T>::WaitPreLoadDone() {
     t.join();
   }
   input_channel_->Close();
+  if (streaming_global_shuffle_) {
+    FinishStreamingShuffleSend();
+  }
   int64_t in_chan_size = input_channel_->Size();
   input_channel_->SetBlockSize(in_chan_size / thread_num_ + 1);
   VLOG(3) << "DatasetImpl<T>::WaitPreLoadDone() end";
@@ -303,6 +323,13 @@ void DatasetImpl<T>::LocalShuffle() {
 
 template <typename T>
 void DatasetImpl<T>::GlobalShuffle(int thread_num) {
+  if (streaming_global_shuffle_) {
+    // the records have been sent while loading, and all trainers have done
+    // sending when this is called, so only waits for the received ones
+    VLOG(3) << "DatasetImpl<T>::GlobalShuffle() wait streaming shuffle";
+    FinishStreamingShuffleRecv();
+    return;
+  }
 #ifdef PADDLE_WITH_PSLIB
   VLOG(3) << "DatasetImpl<T>::GlobalShuffle() begin";
   platform::Timer timeline;
@@ -330,12 +357,7 @@ void DatasetImpl<T>::GlobalShuffle(int thread_num) {
           << input_channel_->Size();
 
   auto get_client_id = [this, fleet_ptr](const T& data) -> size_t {
-    if (!this->merge_by_insid_) {
-      return fleet_ptr->LocalRandomEngine()() % this->trainer_num_;
-    } else {
-      return XXH64(data.ins_id_.data(), data.ins_id_.length(), 0) %
-             this->trainer_num_;
-    }
+    return this->GetShuffleClientId(data, &fleet_ptr->LocalRandomEngine());
   };
 
   auto global_shuffle_func = [this, get_client_id]() {
@@ -360,7 +382,7 @@ void DatasetImpl<T>::GlobalShuffle(int thread_num) {
           continue;
         }
         std::string msg(ars[i].Buffer(), ars[i].Length());
-        auto ret = fleet_ptr->SendClientToClientMsg(0, i, msg);
+        auto ret = this->msg_transport_->Send(0, i, msg);
         total_status.push_back(std::move(ret));
       }
       for (auto& t : total_status) {
@@ -501,6 +523,22 @@ void DatasetImpl<T>::SetFleetSendSleepSeconds(int seconds) {
   fleet_send_sleep_seconds_ = seconds;
 }
 
+// if streaming, the records are sent to other trainers by thread_num
+// threads as they are loaded, so call RegisterClientToClientMsgHandler
+// after this and before loading
+template <typename T>
+void DatasetImpl<T>::SetStreamingGlobalShuffle(bool streaming,
+                                               int thread_num) {
+  streaming_global_shuffle_ = streaming;
+  streaming_shuffle_thread_num_ = thread_num;
+}
+
+template <typename T>
+void DatasetImpl<T>::SetMsgTransport(
+    std::shared_ptr<ClientMsgTransport> transport) {
+  msg_transport_ = transport;
+}
+
 template <typename T>
 void DatasetImpl<T>::CreateReaders() {
   VLOG(3) << "Calling CreateReaders()";
@@ -602,6 +640,10 @@ void DatasetImpl<T>::DestroyPreLoadReaders() {
 
 template <typename T>
 int64_t DatasetImpl<T>::GetMemoryDataSize() {
+  if (streaming_global_shuffle_) {
+    // the loaded records have left input_channel_ for the other trainers
+    return streaming_loaded_size_;
+  }
   return input_channel_->Size();
 }
 
@@ -615,30 +657,38 @@ int64_t DatasetImpl<T>::GetShuffleDataSize() {
 }
 
 template <typename T>
-int DatasetImpl<T>::ReceiveFromClient(int msg_type, int client_id,
-                                      const std::string& msg) {
-#ifdef _LINUX
-  VLOG(3) << "ReceiveFromClient msg_type=" << msg_type
-          << ", client_id=" << client_id << ", msg length=" << msg.length();
+size_t DatasetImpl<T>::GetShuffleClientId(const T& t,
+                                          std::default_random_engine* engine) {
+  if (!merge_by_insid_) {
+    return (*engine)() % trainer_num_;
+  } else {
+    return XXH64(t.ins_id_.data(), t.ins_id_.length(), 0) % trainer_num_;
+  }
+}
+
+template <typename T>
+void DatasetImpl<T>::DecodeShuffleMsg(const std::string& msg,
+                                      std::vector<T>* data) {
+  data->clear();
   if (msg.length() == 0) {
-    return 0;
+    return;
   }
   paddle::framework::BinaryArchive ar;
   ar.SetReadBuffer(const_cast<char*>(msg.c_str()), msg.length(), nullptr);
-  if (ar.Cursor() == ar.Finish()) {
-    return 0;
-  }
-  std::vector<T> data;
   while (ar.Cursor() < ar.Finish()) {
-    data.push_back(ar.Get<T>());
+    data->push_back(ar.Get<T>());
   }
   CHECK(ar.Cursor() == ar.Finish());
+}
 
-  auto fleet_ptr = FleetWrapper::GetInstance();
+template <typename T>
+void DatasetImpl<T>::WriteToOutputChannel(std::vector<T>* data) {
+  if (data->empty()) {
+    return;
+  }
   // not use random because it doesn't perform well here.
   // to make sure each channel get data equally, we just put data to
   // channel one by one.
-  // int64_t index = fleet_ptr->LocalRandomEngine()() % channel_num_;
   int64_t index = 0;
   {
     std::unique_lock<std::mutex> lk(global_index_mutex_);
@@ -646,10 +696,167 @@ int DatasetImpl<T>::ReceiveFromClient(int msg_type, int client_id,
   }
   index = index % channel_num_;
   VLOG(3) << "ramdom index=" << index;
-  multi_output_channel_[index]->Write(std::move(data));
+  multi_output_channel_[index]->Write(std::move(*data));
+  data->clear();
+}
 
-  data.clear();
-  data.shrink_to_fit();
+template <typename T>
+paddle::framework::Channel<std::string> DatasetImpl<T>::ShuffleRecvChannel() {
+  std::lock_guard<std::mutex> lock(shuffle_recv_mutex_);
+  return shuffle_recv_channel_;
+}
+
+template <typename T>
+void DatasetImpl<T>::StartStreamingShuffleSend() {
+  PADDLE_ENFORCE_NOT_NULL(
+      ShuffleRecvChannel(),
+      platform::errors::PreconditionNotMet(
+          "Please call RegisterClientToClientMsgHandler before loading data "
+          "with streaming global shuffle."));
+  streaming_loaded_size_ = 0;
+  int thread_num = streaming_shuffle_thread_num_ > 0
+                       ? streaming_shuffle_thread_num_
+                       : thread_num_;
+  VLOG(3) << "start streaming shuffle send threads, num = " << thread_num;
+  // the send threads read the records as soon as a batch is loaded
+  input_channel_->SetBlockSize(fleet_send_batch_size_);
+  auto& engine = FleetWrapper::GetInstance()->LocalRandomEngine();
+  for (int i = 0; i < thread_num; ++i) {
+    shuffle_send_threads_.emplace_back(
+        &DatasetImpl<T>::StreamingShuffleSendFunc, this, engine());
+  }
+}
+
+// should be called after input_channel_ is closed
+template <typename T>
+void DatasetImpl<T>::FinishStreamingShuffleSend() {
+  for (auto& t : shuffle_send_threads_) {
+    t.join();
+  }
+  shuffle_send_threads_.clear();
+  input_channel_->Clear();
+  VLOG(3) << "streaming shuffle send done";
+}
+
+template <typename T>
+void DatasetImpl<T>::StreamingShuffleSendFunc(uint64_t seed) {
+  std::default_random_engine engine(seed);
+  std::vector<paddle::framework::BinaryArchive> ars(trainer_num_);
+  std::vector<int64_t> ar_sizes(trainer_num_, 0);
+  // the receiver gives back the free slots of its recv channel. up to
+  // window[i] messages are in flight to trainer i, the window grows by one
+  // for a reply with free slots, and falls back to one if the receiver is
+  // full, so the sending keeps pace with the receiver instead of sleeping.
+  std::vector<std::deque<std::future<int32_t>>> in_flight(trainer_num_);
+  std::vector<size_t> window(trainer_num_, 1);
+  auto wait_one = [&](int i) {
+    int32_t free_slots = in_flight[i].front().get();
+    in_flight[i].pop_front();
+    window[i] = free_slots > 0
+                    ? std::min(window[i] + 1, kMaxShuffleMsgInFlight)
+                    : 1;
+  };
+  auto send = [&](int i) {
+    while (in_flight[i].size() >= window[i]) {
+      wait_one(i);
+    }
+    std::string msg(ars[i].Buffer(), ars[i].Length());
+    in_flight[i].push_back(msg_transport_->Send(0, i, msg));
+    ars[i].Clear();
+    ar_sizes[i] = 0;
+  };
+
+  std::vector<T> data;
+  while (input_channel_->Read(data)) {
+    streaming_loaded_size_ += data.size();
+    if (trainer_num_ == 1) {
+      WriteToOutputChannel(&data);
+      continue;
+    }
+    for (auto& t : data) {
+      size_t i = GetShuffleClientId(t, &engine);
+      ars[i] << t;
+      if (++ar_sizes[i] >= fleet_send_batch_size_) {
+        send(i);
+      }
+    }
+  }
+  for (int i = 0; i < trainer_num_; ++i) {
+    if (ar_sizes[i] > 0) {
+      send(i);
+    }
+  }
+  for (int i = 0; i < trainer_num_; ++i) {
+    while (!in_flight[i].empty()) {
+      wait_one(i);
+    }
+  }
+}
+
+template <typename T>
+void DatasetImpl<T>::StartStreamingShuffleRecv() {
+  if (ShuffleRecvChannel()) {
+    return;
+  }
+  // a message blocks the sender when the recv threads fall behind
+  auto recv_channel = paddle::framework::MakeChannel<std::string>(
+      std::max(2 * trainer_num_, channel_num_));
+  VLOG(3) << "start streaming shuffle recv threads, num = " << channel_num_;
+  for (int i = 0; i < channel_num_; ++i) {
+    shuffle_recv_threads_.emplace_back([this, recv_channel] {
+      std::string msg;
+      std::vector<T> data;
+      while (recv_channel->Get(msg)) {
+        DecodeShuffleMsg(msg, &data);
+        WriteToOutputChannel(&data);
+      }
+    });
+  }
+  std::lock_guard<std::mutex> lock(shuffle_recv_mutex_);
+  shuffle_recv_channel_ = recv_channel;
+}
+
+template <typename T>
+void DatasetImpl<T>::FinishStreamingShuffleRecv() {
+  auto recv_channel = ShuffleRecvChannel();
+  if (!recv_channel) {
+    return;
+  }
+  // the messages coming after closing are dropped by ReceiveFromClient
+  recv_channel->Close();
+  for (auto& t : shuffle_recv_threads_) {
+    t.join();
+  }
+  shuffle_recv_threads_.clear();
+  {
+    std::lock_guard<std::mutex> lock(shuffle_recv_mutex_);
+    shuffle_recv_channel_ = nullptr;
+  }
+  VLOG(3) << "streaming shuffle recv done";
+}
+
+template <typename T>
+int DatasetImpl<T>::ReceiveFromClient(int msg_type, int client_id,
+                                      const std::string& msg) {
+#ifdef _LINUX
+  VLOG(3) << "ReceiveFromClient msg_type=" << msg_type
+          << ", client_id=" << client_id << ", msg length=" << msg.length();
+  auto recv_channel = ShuffleRecvChannel();
+  if (recv_channel) {
+    // decoded by the recv threads, gives back the free slots so that the
+    // sender can adjust the num of messages in flight
+    if (!recv_channel->Put(msg)) {
+      LOG(WARNING) << "streaming shuffle drops a message from client "
+                   << client_id << " after GlobalShuffle";
+      return -1;
+    }
+    size_t size = recv_channel->Size();
+    size_t capacity = recv_channel->Capacity();
+    return size < capacity ? static_cast<int>(capacity - size) : 0;
+  }
+  std::vector<T> data;
+  DecodeShuffleMsg(msg, &data);
+  WriteToOutputChannel(&data);
 #endif
   return 0;
 }
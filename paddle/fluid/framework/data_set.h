@@ -15,9 +15,11 @@
 #pragma once
 
 #include <ThreadPool.h>
+#include <atomic>
 #include <fstream>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <random>
 #include <set>
 #include <string>
 #include <thread>  // NOLINT
@@ -26,6 +28,7 @@
 #include <vector>
 
 #include "paddle/fluid/framework/data_feed.h"
+#include "paddle/fluid/framework/fleet/msg_transport.h"
 
 namespace paddle {
 namespace framework {
@@ -113,7 +116,8 @@ class Dataset {
   virtual void CreateReaders() = 0;
   // destroy readers
   virtual void DestroyReaders() = 0;
-  // get memory data size
+  // get memory data size, which is the num of records loaded by this
+  // trainer with streaming global shuffle, though they have been sent
   virtual int64_t GetMemoryDataSize() = 0;
   // get shuffle data size
   virtual int64_t GetShuffleDataSize() = 0;
@@ -136,6 +140,13 @@ class Dataset {
   virtual void DynamicAdjustReadersNum(int thread_num) = 0;
   // set fleet send sleep seconds
   virtual void SetFleetSendSleepSeconds(int seconds) = 0;
+  // send the records to other trainers while loading them, instead of
+  // after loading in GlobalShuffle, thread_num is the num of send threads
+  virtual void SetStreamingGlobalShuffle(bool streaming,
+                                         int thread_num = -1) = 0;
+  // set the transport of messages between trainers, fleet by default
+  virtual void SetMsgTransport(
+      std::shared_ptr<ClientMsgTransport> transport) = 0;
 
  protected:
   virtual int ReceiveFromClient(int msg_type, int client_id,
@@ -206,10 +217,26 @@ class DatasetImpl : public Dataset {
                                        bool discard_remaining_ins = false);
   virtual void DynamicAdjustReadersNum(int thread_num);
   virtual void SetFleetSendSleepSeconds(int seconds);
+  virtual void SetStreamingGlobalShuffle(bool streaming, int thread_num = -1);
+  virtual void SetMsgTransport(std::shared_ptr<ClientMsgTransport> transport);
 
  protected:
   virtual int ReceiveFromClient(int msg_type, int client_id,
                                 const std::string& msg);
+  size_t GetShuffleClientId(const T& t, std::default_random_engine* engine);
+  void DecodeShuffleMsg(const std::string& msg, std::vector<T>* data);
+  void WriteToOutputChannel(std::vector<T>* data);
+  // streaming global shuffle sends the records in input_channel_ by
+  // send threads as they are loaded, and the received messages are queued
+  // in shuffle_recv_channel_ to be decoded by recv threads
+  void StartStreamingShuffleSend();
+  void FinishStreamingShuffleSend();
+  void StartStreamingShuffleRecv();
+  void FinishStreamingShuffleRecv();
+  void StreamingShuffleSendFunc(uint64_t seed);
+  // shuffle_recv_channel_ is set and reset by the caller of the dataset
+  // while the transport threads read it in ReceiveFromClient
+  paddle::framework::Channel<std::string> ShuffleRecvChannel();
   std::vector<std::shared_ptr<paddle::framework::DataFeed>> readers_;
   std::vector<std::shared_ptr<paddle::framework::DataFeed>> preload_readers_;
   paddle::framework::Channel<T> input_channel_;
@@ -245,6 +272,15 @@ class DatasetImpl : public Dataset {
   std::mutex global_index_mutex_;
   int64_t global_index_ = 0;
   std::vector<std::shared_ptr<ThreadPool>> consume_task_pool_;
+  std::shared_ptr<ClientMsgTransport> msg_transport_;
+  bool streaming_global_shuffle_ = false;
+  int streaming_shuffle_thread_num_ = -1;
+  std::vector<std::thread> shuffle_send_threads_;
+  std::vector<std::thread> shuffle_recv_threads_;
+  paddle::framework::Channel<std::string> shuffle_recv_channel_;
+  std::mutex shuffle_recv_mutex_;
+  // the num of records loaded by this trainer with streaming global shuffle
+  std::atomic<int64_t> streaming_loaded_size_{0};
 };
 
 // use std::vector<MultiSlotType> or Record as data type
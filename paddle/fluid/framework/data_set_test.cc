@@ -0,0 +1,241 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/data_set.h"
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/fleet/msg_transport.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/platform/timer.h"
+#include "xxhash.h"  // NOLINT
+
+#if defined _WIN32 || defined __APPLE__
+#else
+#define _LINUX
+#endif
+
+namespace paddle {
+namespace framework {
+
+// Gives the records in the output channels after global shuffle.
+class TestDataset : public MultiSlotDataset {
+ public:
+  std::vector<Record> OutputRecords() {
+    std::vector<Record> records;
+    for (auto& channel : multi_output_channel_) {
+      std::vector<Record> data;
+      channel->Close();
+      channel->ReadAll(data);
+      records.insert(records.end(), data.begin(), data.end());
+    }
+    return records;
+  }
+};
+
+static const char* kDataFeedDesc =
+    "name: \"MultiSlotInMemoryDataFeed\"\nbatch_size: 2\n"
+    "multi_slot_desc {\nslots {\nname: \"id\"\ntype: \"uint64\"\n"
+    "is_dense: false\nis_used: true\n}\n}\n";
+
+// Writes file_num files of line_num records for a trainer into dir, the
+// record k of the file f of trainer r has the ins id "r_f_k".
+static std::vector<std::string> GenerateFiles(const std::string& dir, int rank,
+                                              int file_num, int line_num) {
+  std::vector<std::string> filelist;
+  for (int f = 0; f < file_num; ++f) {
+    std::string filename = dir + "/data_set_test." + std::to_string(rank) +
+                           "." + std::to_string(f) + ".txt";
+    std::ofstream fout(filename);
+    for (int k = 0; k < line_num; ++k) {
+      fout << "1 " << rank << "_" << f << "_" << k << " 1 " << k + 1 << "\n";
+    }
+    filelist.push_back(filename);
+  }
+  return filelist;
+}
+
+TEST(DatasetImpl, StreamingGlobalShuffle) {
+#ifdef _LINUX
+  const int trainer_num = 4;
+  const int file_num = 3;
+  const int line_num = 2000;
+  // Few threads for delivering, so that the flow control takes effect.
+  LoopbackMsgHub hub(trainer_num, 2);
+  char dir_template[] = "/tmp/data_set_test.XXXXXX";
+  ASSERT_NE(mkdtemp(dir_template), nullptr);
+  const std::string dir(dir_template);
+  std::vector<std::string> all_files;
+  std::vector<std::shared_ptr<TestDataset>> datasets;
+  for (int rank = 0; rank < trainer_num; ++rank) {
+    auto dataset = std::make_shared<TestDataset>();
+    auto filelist = GenerateFiles(dir, rank, file_num, line_num);
+    all_files.insert(all_files.end(), filelist.begin(), filelist.end());
+    dataset->SetFileList(filelist);
+    dataset->SetThreadNum(2);
+    dataset->SetChannelNum(2);
+    dataset->SetTrainerNum(trainer_num);
+    dataset->SetFleetSendBatchSize(64);
+    // The records are sent to the trainer of the hash of ins id.
+    dataset->SetMergeByInsId(2);
+    dataset->SetDataFeedDesc(kDataFeedDesc);
+    dataset->CreateChannel();
+    dataset->CreateReaders();
+    dataset->SetMsgTransport(hub.Client(rank));
+    dataset->SetStreamingGlobalShuffle(true, 2);
+    dataset->RegisterClientToClientMsgHandler();
+    datasets.push_back(dataset);
+  }
+
+  // Every trainer loads and sends in its own thread, like the trainers in
+  // their processes.
+  platform::Timer timeline;
+  timeline.Start();
+  std::vector<std::thread> trainers;
+  for (auto& dataset : datasets) {
+    trainers.emplace_back([dataset] { dataset->LoadIntoMemory(); });
+  }
+  for (auto& t : trainers) {
+    t.join();
+  }
+  for (auto& dataset : datasets) {
+    dataset->GlobalShuffle();
+  }
+  timeline.Pause();
+  LOG(INFO) << "streaming global shuffle of "
+            << trainer_num * file_num * line_num << " records costs "
+            << timeline.ElapsedSec() << " seconds";
+
+  for (auto& filename : all_files) {
+    std::remove(filename.c_str());
+  }
+  rmdir(dir.c_str());
+
+  // The loaded records are counted though they are sent away.
+  int64_t memory_data_size = 0;
+  for (auto& dataset : datasets) {
+    memory_data_size += dataset->GetMemoryDataSize();
+  }
+  EXPECT_EQ(memory_data_size, trainer_num * file_num * line_num);
+
+  std::set<std::string> ins_ids;
+  for (int rank = 0; rank < trainer_num; ++rank) {
+    for (auto& record : datasets[rank]->OutputRecords()) {
+      const auto& ins_id = record.ins_id_;
+      EXPECT_EQ(XXH64(ins_id.data(), ins_id.length(), 0) % trainer_num,
+                static_cast<uint64_t>(rank));
+      ASSERT_EQ(record.uint64_feasigns_.size(), 1UL);
+      auto k = ins_id.substr(ins_id.rfind('_') + 1);
+      EXPECT_EQ(record.uint64_feasigns_[0].sign().uint64_feasign_,
+                std::stoull(k) + 1);
+      EXPECT_TRUE(ins_ids.insert(ins_id).second);
+    }
+  }
+  EXPECT_EQ(ins_ids.size(),
+            static_cast<size_t>(trainer_num * file_num * line_num));
+#endif
+}
+
+// The instance k has Length(k) feasigns of the value k + 1, some of them
+// have more feasigns than the budget.
+static int Length(int k) { return k % 50 == 0 ? 30 : k % 7 + 1; }
+
+TEST(MultiSlotInMemoryDataFeed, MaxBatchFeasigns) {
+#ifdef _LINUX
+  const int ins_num = 500;
+  const int batch_size = 8;
+  const int max_batch_feasigns = 24;
+  char dir_template[] = "/tmp/data_feed_test.XXXXXX";
+  ASSERT_NE(mkdtemp(dir_template), nullptr);
+  const std::string dir(dir_template);
+  const std::string filename = dir + "/data_feed_test.txt";
+  {
+    std::ofstream fout(filename);
+    for (int k = 0; k < ins_num; ++k) {
+      fout << Length(k);
+      for (int i = 0; i < Length(k); ++i) {
+        fout << " " << k + 1;
+      }
+      fout << "\n";
+    }
+  }
+
+  for (int length_bucket_size : {0, 64}) {
+    MultiSlotDataset dataset;
+    dataset.SetFileList({filename});
+    dataset.SetThreadNum(1);
+    dataset.SetChannelNum(1);
+    dataset.SetTrainerNum(1);
+    dataset.SetDataFeedDesc(
+        "name: \"MultiSlotInMemoryDataFeed\"\nbatch_size: " +
+        std::to_string(batch_size) + "\nmax_batch_feasigns: " +
+        std::to_string(max_batch_feasigns) + "\nlength_bucket_size: " +
+        std::to_string(length_bucket_size) +
+        "\nmulti_slot_desc {\nslots {\nname: \"id\"\ntype: \"uint64\"\n"
+        "is_dense: false\nis_used: true\n}\n}\n");
+    dataset.CreateChannel();
+    dataset.CreateReaders();
+    dataset.LoadIntoMemory();
+
+    Scope scope;
+    scope.Var("id");
+    auto* reader = dataset.GetReaders()[0];
+    reader->SetPlace(platform::CPUPlace());
+    reader->AssignFeedVar(scope);
+    reader->Start();
+    std::vector<int> emitted(ins_num, 0);
+    int batch_num = 0;
+    while (reader->Next() > 0) {
+      const auto& tensor = scope.FindVar("id")->Get<LoDTensor>();
+      const auto& offsets = tensor.lod()[0];
+      const int cur_batch_size = reader->GetCurBatchSize();
+      ASSERT_EQ(offsets.size(), static_cast<size_t>(cur_batch_size + 1));
+      EXPECT_LE(cur_batch_size, batch_size);
+      // Only an instance over the budget is batched alone beyond it.
+      if (cur_batch_size > 1) {
+        EXPECT_LE(offsets.back(), static_cast<size_t>(max_batch_feasigns));
+      }
+      const int64_t* data = tensor.data<int64_t>();
+      for (int i = 0; i < cur_batch_size; ++i) {
+        const int k = static_cast<int>(data[offsets[i]]) - 1;
+        ASSERT_GE(k, 0);
+        ASSERT_LT(k, ins_num);
+        EXPECT_EQ(offsets[i + 1] - offsets[i], static_cast<size_t>(Length(k)));
+        ++emitted[k];
+      }
+      ++batch_num;
+    }
+    for (int k = 0; k < ins_num; ++k) {
+      EXPECT_EQ(emitted[k], 1) << "instance " << k;
+    }
+    LOG(INFO) << ins_num << " instances in " << batch_num
+              << " batches with length_bucket_size " << length_bucket_size;
+  }
+
+  std::remove(filename.c_str());
+  rmdir(dir.c_str());
+#endif
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -141,22 +141,19 @@ void AllReduceOpHandle::AllReduceFunc(
                      ->FindVar(out_var_names[0])
                      ->GetMutable<LoDTensor>();
 
-    // Reduce All Tensor to trg in CPU
-    ReduceBufferData func(lod_tensor_data, trg.data<void>(), numel);
-    VisitDataType(trg.type(), func);
-
+    // Reduce All Tensor to trg in CPU, and copy trg to the other places.
+    std::vector<void *> dst_data;
+    dst_data.reserve(local_exec_scopes_.size());
+    dst_data.emplace_back(trg.data<void>());
     for (size_t i = 1; i < local_exec_scopes_.size(); ++i) {
-      auto &scope = local_exec_scopes_[i];
-      auto &p = places[i];
-      auto *var = scope->FindVar(out_var_names[i]);
-
-      size_t size = numel * SizeOfType(trg.type());
-      RunAndRecordEvent(p, [&trg, var, p, size] {
-        auto dst_ptr = var->GetMutable<framework::LoDTensor>()->data<void>();
-        platform::CPUPlace cpu_place;
-        memory::Copy(cpu_place, dst_ptr, cpu_place, trg.data<void>(), size);
-      });
+      auto *var = local_exec_scopes_[i]->FindVar(out_var_names[i]);
+      dst_data.emplace_back(
+          var->GetMutable<framework::LoDTensor>()->data<void>());
     }
+    this->RunAndRecordEvent([&] {
+      AllReduceBufferData func(lod_tensor_data, dst_data, numel);
+      VisitDataType(trg.type(), func);
+    });
   }
   VLOG(10) << Name() << " size:" << numel * SizeOfType(dtype);
 }
@@ -0,0 +1,102 @@
+//   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/reduce_and_gather.h"
+#include <algorithm>
+#include <exception>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include "gflags/gflags.h"
+#include "paddle/fluid/framework/threadpool.h"
+
+DEFINE_int32(cpu_reduce_threads, 0,
+             "The number of threads reducing the CPU gradients of "
+             "ParallelExecutor, 0 means the number of CPU cores.");
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+static int CPUReduceThreadNum() {
+  static int num_threads = [] {
+    int num = FLAGS_cpu_reduce_threads;
+    if (num <= 0) {
+      num = static_cast<int>(std::thread::hardware_concurrency());
+    }
+    return std::max(num, 1);
+  }();
+  return num_threads;
+}
+
+// The calling thread reduces a slice too, so the pool has one thread less.
+static ThreadPool *CPUReduceThreadPool() {
+  static std::once_flag init_flag;
+  static std::unique_ptr<ThreadPool> pool;
+  std::call_once(init_flag, [] {
+    if (CPUReduceThreadNum() > 1) {
+      pool.reset(new ThreadPool(CPUReduceThreadNum() - 1));
+    }
+  });
+  return pool.get();
+}
+
+void ParallelForBlocks(int64_t numel, int64_t block, int64_t bytes,
+                       const std::function<void(int64_t, int64_t)> &fn) {
+  if (numel <= 0) {
+    return;
+  }
+  int64_t num_blocks = (numel + block - 1) / block;
+  int64_t num_slices = 1;
+  if (bytes >= kParallelReduceMinBytes) {
+    num_slices = std::min<int64_t>(num_blocks, CPUReduceThreadNum());
+  }
+  if (num_slices == 1) {
+    fn(0, numel);
+    return;
+  }
+
+  int64_t blocks_per_slice = (num_blocks + num_slices - 1) / num_slices;
+  int64_t slice = blocks_per_slice * block;
+  auto *pool = CPUReduceThreadPool();
+  std::vector<std::future<void>> futures;
+  futures.reserve(num_slices - 1);
+  for (int64_t begin = slice; begin < numel; begin += slice) {
+    int64_t end = std::min(begin + slice, numel);
+    futures.emplace_back(pool->Run([&fn, begin, end] { fn(begin, end); }));
+  }
+  // The tasks refer to fn, all of them are waited before an exception is
+  // rethrown.
+  std::exception_ptr exception;
+  try {
+    fn(0, std::min(slice, numel));
+  } catch (...) {
+    exception = std::current_exception();
+  }
+  for (auto &future : futures) {
+    try {
+      future.get();
+    } catch (...) {
+      if (!exception) exception = std::current_exception();
+    }
+  }
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
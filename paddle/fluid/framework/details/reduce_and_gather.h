@@ -14,6 +14,7 @@
 
 #pragma once
 #include <algorithm>
+#include <functional>
 #include <map>
 #include <vector>
 #include "paddle/fluid/framework/details/reduce_and_gather.h"
@@ -23,6 +24,51 @@ namespace paddle {
 namespace framework {
 namespace details {
 
+// The CPU buffers are reduced block by block, a block of the destination
+// stays in cache while the same block of every source is added to it.
+constexpr int64_t kReduceBlockBytes = 16 * 1024;
+
+// Buffers of fewer bytes, the sources included, are reduced by the calling
+// thread.
+constexpr int64_t kParallelReduceMinBytes = 1024 * 1024;
+
+// Runs fn(begin, end) on slices of [0, numel) by the threads of the CPU
+// reduction, set by FLAGS_cpu_reduce_threads. Each slice is a multiple of
+// block elements except the last one. A single slice is run by the calling
+// thread when bytes are less than kParallelReduceMinBytes.
+void ParallelForBlocks(int64_t numel, int64_t block, int64_t bytes,
+                       const std::function<void(int64_t, int64_t)> &fn);
+
+// Adds srcs to dst in [begin, end). The sources are added in their order to
+// each element, the same order as adding them one after another, so the
+// result does not depend on the slicing.
+template <typename T>
+void ReduceBlocks(const std::vector<const T *> &srcs, T *dst, int64_t begin,
+                  int64_t end) {
+  const int64_t block = kReduceBlockBytes / sizeof(T);
+  for (int64_t block_begin = begin; block_begin < end; block_begin += block) {
+    int64_t block_end = std::min(block_begin + block, end);
+    for (auto *src : srcs) {
+      if (src == dst) {
+        continue;
+      }
+      for (int64_t i = block_begin; i < block_end; ++i) {
+        dst[i] += src[i];
+      }
+    }
+  }
+}
+
+template <typename T>
+void ParallelReduce(const std::vector<const T *> &srcs, T *dst,
+                    int64_t numel) {
+  ParallelForBlocks(numel, kReduceBlockBytes / sizeof(T),
+                    numel * sizeof(T) * srcs.size(),
+                    [&](int64_t begin, int64_t end) {
+                      ReduceBlocks(srcs, dst, begin, end);
+                    });
+}
+
 struct ReduceLoDTensor {
   const std::vector<const LoDTensor *> &src_tensors_;
   LoDTensor &dst_tensor_;
@@ -39,6 +85,8 @@ struct ReduceLoDTensor {
     dst_tensor_.Resize(t0.dims());
     T *dst = dst_tensor_.mutable_data<T>(platform::CPUPlace());
 
+    std::vector<const T *> srcs;
+    srcs.reserve(src_tensors_.size());
     for (size_t i = 0; i < src_tensors_.size(); ++i) {
       auto &t = *src_tensors_[i];
       if (dst == t.data<T>()) {
@@ -47,9 +95,9 @@ struct ReduceLoDTensor {
 
       PADDLE_ENFORCE_EQ(t.dims(), t0.dims());
       PADDLE_ENFORCE_EQ(t.type(), t0.type());
-      std::transform(t.data<T>(), t.data<T>() + t.numel(), dst, dst,
-                     [](T a, T b) -> T { return a + b; });
+      srcs.emplace_back(t.data<T>());
     }
+    ParallelReduce(srcs, dst, t0.numel());
   }
 };
 
@@ -65,16 +113,61 @@ struct ReduceBufferData {
   template <typename T>
   void apply() const {
     T *dst_data = reinterpret_cast<T *>(dst_data_);
+    std::vector<const T *> srcs;
+    srcs.reserve(src_data_.size());
     for (size_t i = 0; i < src_data_.size(); ++i) {
       auto srd_data = reinterpret_cast<const T *>(src_data_[i]);
       VLOG(10) << "dst: " << dst_data_ << ", " << srd_data;
       if (srd_data == dst_data_) {
         continue;
       }
+      srcs.emplace_back(srd_data);
+    }
+    ParallelReduce(srcs, dst_data, numel_);
+  }
+};
+
+// Reduces src_data to dst_data[0] and copies the result to the other
+// dst_data. A thread copies its slice right after reducing it, while the
+// slice is still in cache.
+struct AllReduceBufferData {
+  const std::vector<const void *> &src_data_;
+  const std::vector<void *> &dst_data_;
+  int64_t numel_;
 
-      std::transform(srd_data, srd_data + numel_, dst_data, dst_data,
-                     [](T a, T b) -> T { return a + b; });
+  AllReduceBufferData(const std::vector<const void *> &src,
+                      const std::vector<void *> &dst, int64_t numel)
+      : src_data_(src), dst_data_(dst), numel_(numel) {}
+
+  template <typename T>
+  void apply() const {
+    PADDLE_ENFORCE_EQ(dst_data_.empty(), false,
+                      platform::errors::InvalidArgument(
+                          "The destinations of allreduce cannot be empty"));
+    T *trg = reinterpret_cast<T *>(dst_data_[0]);
+    std::vector<const T *> srcs;
+    srcs.reserve(src_data_.size());
+    for (auto *src : src_data_) {
+      if (src != trg) {
+        srcs.emplace_back(reinterpret_cast<const T *>(src));
+      }
     }
+    std::vector<T *> others;
+    others.reserve(dst_data_.size());
+    for (size_t i = 1; i < dst_data_.size(); ++i) {
+      if (dst_data_[i] != trg) {
+        others.emplace_back(reinterpret_cast<T *>(dst_data_[i]));
+      }
+    }
+
+    int64_t bytes = numel_ * sizeof(T) * (srcs.size() + others.size());
+    ParallelForBlocks(numel_, kReduceBlockBytes / sizeof(T), bytes,
+                      [&](int64_t begin, int64_t end) {
+                        ReduceBlocks(srcs, trg, begin, end);
+                        for (auto *dst : others) {
+                          std::copy(trg + begin, trg + end, dst + begin);
+                        }
+                      });
   }
 };
 
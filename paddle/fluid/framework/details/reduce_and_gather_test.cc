@@ -0,0 +1,131 @@
+//   Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/details/reduce_and_gather.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace framework {
+namespace details {
+
+// The reduction and the copies of AllReduceOpHandle before they were
+// parallel.
+static void SerialAllReduce(const std::vector<float*>& buffers,
+                            int64_t numel) {
+  for (size_t i = 1; i < buffers.size(); ++i) {
+    std::transform(buffers[i], buffers[i] + numel, buffers[0], buffers[0],
+                   [](float a, float b) -> float { return a + b; });
+  }
+  for (size_t i = 1; i < buffers.size(); ++i) {
+    std::memcpy(buffers[i], buffers[0], numel * sizeof(float));
+  }
+}
+
+static std::vector<std::vector<float>> CreateBuffers(size_t num,
+                                                     int64_t numel) {
+  std::vector<std::vector<float>> buffers(num);
+  for (size_t i = 0; i < num; ++i) {
+    buffers[i].resize(numel);
+    for (int64_t j = 0; j < numel; ++j) {
+      buffers[i][j] = static_cast<float>((i * 31 + j * 17) % 97) / 7.0f;
+    }
+  }
+  return buffers;
+}
+
+template <typename Callback>
+static double TimeMs(Callback callback) {
+  auto start = std::chrono::steady_clock::now();
+  callback();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// All-reduces the buffers of num_places places in parallel, checks the
+// results against the serial reduction and logs the time of both.
+static void CheckAllReduce(size_t num_places, int64_t numel) {
+  auto expected = CreateBuffers(num_places, numel);
+  std::vector<float*> expected_ptrs;
+  for (auto& buffer : expected) {
+    expected_ptrs.emplace_back(buffer.data());
+  }
+  double serial_ms = TimeMs([&] { SerialAllReduce(expected_ptrs, numel); });
+
+  auto buffers = CreateBuffers(num_places, numel);
+  std::vector<const void*> src_data;
+  std::vector<void*> dst_data;
+  for (auto& buffer : buffers) {
+    src_data.emplace_back(buffer.data());
+    dst_data.emplace_back(buffer.data());
+  }
+  double parallel_ms = TimeMs([&] {
+    AllReduceBufferData func(src_data, dst_data, numel);
+    func.apply<float>();
+  });
+  LOG(INFO) << num_places << " places, serial: " << serial_ms
+            << " ms, parallel: " << parallel_ms << " ms";
+
+  // The sources are added in the same order, the results are equal.
+  for (size_t i = 0; i < num_places; ++i) {
+    ASSERT_EQ(std::memcmp(buffers[i].data(), expected[0].data(),
+                          numel * sizeof(float)),
+              0);
+  }
+}
+
+TEST(AllReduceBufferData, cpu_places) {
+  // Just over the bytes reduced in parallel, with a partial last block.
+  const int64_t numel = (1 << 18) + 3;
+  for (size_t num_places : {2, 3, 4}) {
+    CheckAllReduce(num_places, numel);
+  }
+}
+
+// The scaling with the places of a fused gradient buffer of 4MB, which is
+// run with --gtest_also_run_disabled_tests.
+TEST(AllReduceBufferData, DISABLED_scale_cpu_places) {
+  const int64_t numel = 1 << 20;
+  for (size_t num_places : {2, 4, 8, 16, 32}) {
+    CheckAllReduce(num_places, numel);
+  }
+}
+
+TEST(ReduceBufferData, small_buffer) {
+  const int64_t numel = 100;
+  auto buffers = CreateBuffers(3, numel);
+  std::vector<float> expected(buffers[0]);
+  for (size_t i = 1; i < buffers.size(); ++i) {
+    for (int64_t j = 0; j < numel; ++j) {
+      expected[j] += buffers[i][j];
+    }
+  }
+
+  std::vector<const void*> src_data;
+  for (auto& buffer : buffers) {
+    src_data.emplace_back(buffer.data());
+  }
+  ReduceBufferData func(src_data, buffers[0].data(), numel);
+  func.apply<float>();
+  for (int64_t j = 0; j < numel; ++j) {
+    ASSERT_EQ(buffers[0][j], expected[j]);
+  }
+}
+
+}  // namespace details
+}  // namespace framework
+}  // namespace paddle
@@ -44,6 +44,8 @@ void DistMultiTrainer::Initialize(const TrainerDesc &trainer_desc,
   mpi_rank_ = trainer_desc.mpi_rank();
   mpi_size_ = trainer_desc.mpi_size();
   dump_file_num_ = trainer_desc.dump_file_num();
+  checkpoint_config_ = trainer_desc.async_checkpoint_config();
+  checkpoint_stopped_ = false;
   const std::vector<paddle::framework::DataFeed *> readers =
       dataset->GetReaders();
 
@@ -130,6 +132,7 @@ void DistMultiTrainer::InitOtherEnv(const ProgramDesc &main_program) {
   }
   pull_dense_worker_->SetRootScope(root_scope_);
   pull_dense_worker_->Start();
+  InitCheckpointEnv();
   VLOG(3) << "init other env done.";
 }
 
@@ -187,6 +190,7 @@ void DistMultiTrainer::Finalize() {
   if (need_dump_field_) {
     FinalizeDumpEnv();
   }
+  FinalizeCheckpointEnv();
   pull_dense_worker_->Stop();
   root_scope_->DropKids();
 
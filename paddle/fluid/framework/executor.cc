@@ -44,6 +44,10 @@ limitations under the License. */
 DECLARE_bool(benchmark);
 DEFINE_bool(use_mkldnn, false, "Use MKLDNN to run");
 DEFINE_bool(use_ngraph, false, "Use NGRAPH to run");
+DEFINE_bool(cache_sub_block_context, true,
+            "Cache the prepared sub-block of control flow operators, e.g. "
+            "while and recurrent, between their runs instead of creating "
+            "the operators of the sub-block on every run");
 
 namespace paddle {
 namespace framework {
@@ -412,6 +416,63 @@ std::vector<std::shared_ptr<ExecutorPrepareContext>> Executor::Prepare(
   return result;
 }
 
+bool ExecutorPrepareContextCache::IsValid(
+    const ProgramDesc& program, int block_id,
+    const std::vector<std::string>& skip_ref_cnt_vars,
+    bool force_disable_gc) const {
+  if (ctx_ == nullptr || &ctx_->prog_ != &program ||
+      ctx_->block_id_ != static_cast<size_t>(block_id) ||
+      force_disable_gc_ != force_disable_gc ||
+      gc_enabled_ != (GetEagerDeletionThreshold() >= 0) ||
+      skip_ref_cnt_vars_ != skip_ref_cnt_vars) {
+    return false;
+  }
+  auto& block = program.Block(block_id);
+  if (block.OpSize() != op_descs_.size()) return false;
+  // An op changed in place, or created at the address of a removed op, has
+  // another version.
+  for (size_t i = 0; i < op_descs_.size(); ++i) {
+    auto* op_desc = block.Op(static_cast<int>(i));
+    if (op_desc != op_descs_[i] || op_desc->Version() != op_versions_[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ExecutorPrepareContextCache::ContextPtr ExecutorPrepareContextCache::Get(
+    const ProgramDesc& program, int block_id,
+    const std::vector<std::string>& skip_ref_cnt_vars, bool force_disable_gc) {
+  if (FLAGS_cache_sub_block_context) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!in_use_) {
+      if (!IsValid(program, block_id, skip_ref_cnt_vars, force_disable_gc)) {
+        VLOG(3) << "Prepare block " << block_id << " for the context cache";
+        ctx_ = Executor::Prepare(program, block_id, skip_ref_cnt_vars,
+                                 force_disable_gc);
+        auto ops = program.Block(block_id).AllOps();
+        op_descs_.assign(ops.begin(), ops.end());
+        op_versions_.clear();
+        for (auto* op_desc : ops) {
+          op_versions_.push_back(op_desc->Version());
+        }
+        skip_ref_cnt_vars_ = skip_ref_cnt_vars;
+        force_disable_gc_ = force_disable_gc;
+        gc_enabled_ = GetEagerDeletionThreshold() >= 0;
+      }
+      in_use_ = true;
+      return ContextPtr(ctx_.get(), [this](ExecutorPrepareContext*) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        in_use_ = false;
+      });
+    }
+  }
+  return ContextPtr(Executor::Prepare(program, block_id, skip_ref_cnt_vars,
+                                      force_disable_gc)
+                        .release(),
+                    std::default_delete<ExecutorPrepareContext>());
+}
+
 void Executor::RunPreparedContext(ExecutorPrepareContext* ctx, Scope* scope,
                                   bool create_local_scope, bool create_vars,
                                   bool keep_kids) {
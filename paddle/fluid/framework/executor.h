@@ -14,8 +14,10 @@ limitations under the License. */
 
 #pragma once
 
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -50,6 +52,45 @@ struct ExecutorPrepareContext {
   bool force_disable_gc_{false};
 };
 
+// ExecutorPrepareContextCache keeps the prepared context of a sub-block for
+// operators that run the block on every invocation, such as while, recurrent
+// and conditional_block. Preparing a block creates all of its operators, so
+// doing it once per invocation dominates the cost of short loop bodies.
+//
+// The cached context is rebuilt when the ops of the block or their
+// versions, the skipped vars or the garbage collection setting change. It is
+// lent to one run at a time, a concurrent run of the same operator prepares
+// a private context instead.
+class ExecutorPrepareContextCache {
+ public:
+  using ContextPtr =
+      std::unique_ptr<ExecutorPrepareContext,
+                      std::function<void(ExecutorPrepareContext*)>>;
+
+  ExecutorPrepareContextCache() = default;
+
+  ContextPtr Get(const ProgramDesc& program, int block_id,
+                 const std::vector<std::string>& skip_ref_cnt_vars =
+                     std::vector<std::string>(),
+                 bool force_disable_gc = false);
+
+ private:
+  bool IsValid(const ProgramDesc& program, int block_id,
+               const std::vector<std::string>& skip_ref_cnt_vars,
+               bool force_disable_gc) const;
+
+  std::mutex mutex_;
+  std::unique_ptr<ExecutorPrepareContext> ctx_;
+  std::vector<const OpDesc*> op_descs_;
+  std::vector<uint64_t> op_versions_;
+  std::vector<std::string> skip_ref_cnt_vars_;
+  bool force_disable_gc_{false};
+  bool gc_enabled_{false};
+  bool in_use_{false};
+
+  DISABLE_COPY_AND_ASSIGN(ExecutorPrepareContextCache);
+};
+
 class Executor {
  public:
   // TODO(dzhwinter) : Do not rely on this function, it will be removed
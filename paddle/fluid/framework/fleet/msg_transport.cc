@@ -0,0 +1,93 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/framework/fleet/msg_transport.h"
+#include <utility>
+#include "paddle/fluid/framework/fleet/fleet_wrapper.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace framework {
+
+int FleetMsgTransport::RegisterHandler(int msg_type, MsgHandlerFunc handler) {
+  return FleetWrapper::GetInstance()->RegisterClientToClientMsgHandler(
+      msg_type, std::move(handler));
+}
+
+std::future<int32_t> FleetMsgTransport::Send(int msg_type, int to_client_id,
+                                             const std::string& msg) {
+  auto ret = FleetWrapper::GetInstance()->SendClientToClientMsg(
+      msg_type, to_client_id, msg);
+  if (!ret.valid()) {
+    std::promise<int32_t> dropped;
+    dropped.set_value(-1);
+    return dropped.get_future();
+  }
+  return ret;
+}
+
+class LoopbackMsgHub::LoopbackClient : public ClientMsgTransport {
+ public:
+  LoopbackClient(LoopbackMsgHub* hub, int client_id)
+      : hub_(hub), client_id_(client_id) {}
+
+  int RegisterHandler(int msg_type, MsgHandlerFunc handler) override {
+    std::lock_guard<std::mutex> lock(hub_->mutex_);
+    hub_->handlers_[client_id_][msg_type] = std::move(handler);
+    return 0;
+  }
+
+  std::future<int32_t> Send(int msg_type, int to_client_id,
+                            const std::string& msg) override {
+    PADDLE_ENFORCE_LT(to_client_id, static_cast<int>(hub_->handlers_.size()),
+                      platform::errors::InvalidArgument(
+                          "The client id %d is out of range [0, %d)",
+                          to_client_id, hub_->handlers_.size()));
+    LoopbackMsgHub* hub = hub_;
+    int from_client_id = client_id_;
+    return hub_->pool_->enqueue([=] {
+      return hub->Deliver(msg_type, from_client_id, to_client_id, msg);
+    });
+  }
+
+ private:
+  LoopbackMsgHub* hub_;
+  int client_id_;
+};
+
+LoopbackMsgHub::LoopbackMsgHub(int client_num, int thread_num)
+    : handlers_(client_num), pool_(new ::ThreadPool(thread_num)) {}
+
+std::shared_ptr<ClientMsgTransport> LoopbackMsgHub::Client(int client_id) {
+  return std::make_shared<LoopbackClient>(this, client_id);
+}
+
+int32_t LoopbackMsgHub::Deliver(int msg_type, int from_client_id,
+                                int to_client_id, const std::string& msg) {
+  ClientMsgTransport::MsgHandlerFunc handler;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = handlers_[to_client_id].find(msg_type);
+    if (it == handlers_[to_client_id].end()) {
+      VLOG(3) << "no handler of msg_type " << msg_type << " for client "
+              << to_client_id;
+      return -1;
+    }
+    handler = it->second;
+  }
+  return handler(msg_type, from_client_id, msg);
+}
+
+}  // namespace framework
+}  // namespace paddle
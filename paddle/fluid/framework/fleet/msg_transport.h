@@ -0,0 +1,79 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <ThreadPool.h>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace paddle {
+namespace framework {
+
+// ClientMsgTransport sends messages between the trainers, e.g. the records
+// of global shuffle. The handler registered for a msg_type is called with
+// (msg_type, from_client_id, msg) when a message arrives, and its return
+// value is given back to the sender by the future of Send.
+class ClientMsgTransport {
+ public:
+  typedef std::function<int32_t(int, int, const std::string&)> MsgHandlerFunc;
+
+  virtual ~ClientMsgTransport() {}
+
+  virtual int RegisterHandler(int msg_type, MsgHandlerFunc handler) = 0;
+
+  virtual std::future<int32_t> Send(int msg_type, int to_client_id,
+                                    const std::string& msg) = 0;
+};
+
+// FleetMsgTransport sends messages by the client-to-client message service
+// of fleet. Without pslib, the messages are dropped and Send gives -1.
+class FleetMsgTransport : public ClientMsgTransport {
+ public:
+  int RegisterHandler(int msg_type, MsgHandlerFunc handler) override;
+
+  std::future<int32_t> Send(int msg_type, int to_client_id,
+                            const std::string& msg) override;
+};
+
+// LoopbackMsgHub connects the trainers in one process, so that the message
+// passing between trainers can be tested without a parameter server. Each
+// trainer gets its transport by Client(client_id), and the handlers are
+// called asynchronously by the thread pool of the hub. The hub should
+// outlive the transports of its clients.
+class LoopbackMsgHub {
+ public:
+  LoopbackMsgHub(int client_num, int thread_num);
+
+  std::shared_ptr<ClientMsgTransport> Client(int client_id);
+
+ private:
+  class LoopbackClient;
+
+  int32_t Deliver(int msg_type, int from_client_id, int to_client_id,
+                  const std::string& msg);
+
+  std::vector<std::unordered_map<int, ClientMsgTransport::MsgHandlerFunc>>
+      handlers_;
+  std::mutex mutex_;
+  std::unique_ptr<::ThreadPool> pool_;
+};
+
+}  // namespace framework
+}  // namespace paddle
@@ -201,6 +201,44 @@ std::shared_ptr<Graph> Graph::Clone() {
   return cloned_graph;
 }
 
+const std::unordered_set<ir::Node *> &Graph::OpNodesOfType(
+    const std::string &type) const {
+  static const std::unordered_set<ir::Node *> kEmpty;
+  auto it = op_type_index_.find(type);
+  return it == op_type_index_.end() ? kEmpty : it->second;
+}
+
+void Graph::SyncOpTypeIndex() const {
+  std::vector<ir::Node *> changed;
+  for (auto &item : indexed_op_types_) {
+    if (item.first->Op()->Type() != item.second) {
+      changed.push_back(item.first);
+    }
+  }
+  for (auto *node : changed) {
+    VLOG(4) << "reindex op " << indexed_op_types_[node] << " as "
+            << node->Op()->Type();
+    UnindexOpNode(node);
+    IndexOpNode(node, node->Op()->Type());
+  }
+}
+
+void Graph::IndexOpNode(ir::Node *node, const std::string &type) const {
+  op_type_index_[type].insert(node);
+  indexed_op_types_[node] = type;
+}
+
+void Graph::UnindexOpNode(ir::Node *node) const {
+  auto it = indexed_op_types_.find(node);
+  if (it == indexed_op_types_.end()) return;
+  auto index_it = op_type_index_.find(it->second);
+  index_it->second.erase(node);
+  if (index_it->second.empty()) {
+    op_type_index_.erase(index_it);
+  }
+  indexed_op_types_.erase(it);
+}
+
 bool IsControlDepVar(const ir::Node &var) {
   return var.Name().find(ir::Node::kControlDepVarName) != std::string::npos;
 }
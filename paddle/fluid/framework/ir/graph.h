@@ -17,6 +17,7 @@ limitations under the License. */
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -188,6 +189,8 @@ class Graph {
     }
     nodes_.clear();
     node_set_.clear();
+    op_type_index_.clear();
+    indexed_op_types_.clear();
     return ret;
   }
 
@@ -197,6 +200,7 @@ class Graph {
     ret.reset(nodes_.at(node).release());
     nodes_.erase(node);
     node_set_.erase(node);
+    UnindexOpNode(node);
     return ret;
   }
 
@@ -221,9 +225,22 @@ class Graph {
     PADDLE_ENFORCE_EQ(node_set_.find(node) == node_set_.end(), true);
     nodes_[node].reset(node);
     node_set_.insert(node);
+    if (node && node->IsOp() && node->Op()) {
+      IndexOpNode(node, node->Op()->Type());
+    }
     return node;
   }
 
+  // Returns the op nodes of the type. The index is updated as the nodes are
+  // added and removed, call SyncOpTypeIndex first to also find the ops whose
+  // types were changed in place by OpDesc::SetType.
+  const std::unordered_set<ir::Node *> &OpNodesOfType(
+      const std::string &type) const;
+
+  // Moves the ops whose types were changed in place to the right entries of
+  // the index. It only compares the type of each op node.
+  void SyncOpTypeIndex() const;
+
   void ResolveHazard(
       const std::map<std::string, std::vector<ir::Node *>> &var_nodes);
 
@@ -235,6 +252,9 @@ class Graph {
   std::map<std::string, std::vector<ir::Node *>> InitFromProgram(
       const ProgramDesc &program);
 
+  void IndexOpNode(ir::Node *node, const std::string &type) const;
+  void UnindexOpNode(ir::Node *node) const;
+
   // NOTE: program_ shouldn't be exposed to user.
   const ProgramDesc program_;
   std::map<std::string, boost::any> attrs_;
@@ -242,6 +262,10 @@ class Graph {
   std::map<ir::Node *, std::unique_ptr<ir::Node>> nodes_;
   std::unordered_set<ir::Node *> node_set_;
   size_t num_node_created_{0};  // help to generate a unique node id.
+  // The index of the op nodes by type, and the type each op is indexed by.
+  mutable std::unordered_map<std::string, std::unordered_set<ir::Node *>>
+      op_type_index_;
+  mutable std::unordered_map<ir::Node *, std::string> indexed_op_types_;
 };
 
 bool IsControlDepVar(const ir::Node &var);
@@ -108,21 +108,51 @@ void GraphPatternDetector::operator()(Graph *graph,
 
 bool GraphPatternDetector::MarkPDNodesInGraph(const ir::Graph &graph) {
   VLOG(3) << "mark pdnodes in graph";
+  pdnodes2nodes_.clear();
   if (graph.Nodes().empty()) return false;
+  graph.SyncOpTypeIndex();
+
+  // Only the PDNodes linked by the edges are matched in DetectPatterns, if
+  // one of them can't find matched Node, the pattern can't be detected.
+  std::unordered_set<const PDNode *> required;
+  for (auto &edge : pattern_.edges()) {
+    required.insert(edge.first);
+    required.insert(edge.second);
+  }
+  if (required.empty() && !pattern_.nodes().empty()) {
+    required.insert(pattern_.nodes().front().get());
+  }
 
-  for (auto &node : GraphTraits::DFS(graph)) {
-    for (const auto &pdnode : pattern_.nodes()) {
-      if (pdnode->Tell(&node)) {
-        VLOG(4) << "Node " << node.Name() << " marked as " << pdnode->name();
-        pdnodes2nodes_[pdnode.get()].insert(&node);
+  // Mark the PDNodes with the candidates from the op type index first, the
+  // others need to tell all the Nodes.
+  std::vector<const PDNode *> unhinted;
+  std::vector<Node *> candidates;
+  for (const auto &pdnode : pattern_.nodes()) {
+    candidates.clear();
+    if (!CollectCandidates(graph, *pdnode, &candidates)) {
+      unhinted.push_back(pdnode.get());
+      continue;
+    }
+    for (auto *node : candidates) {
+      if (pdnode->Tell(node)) {
+        VLOG(4) << "Node " << node->Name() << " marked as " << pdnode->name();
+        pdnodes2nodes_[pdnode.get()].insert(node);
       }
     }
-  }
-  // Check to early stop if some PDNode can't find matched Node.
-  for (auto &pdnode : pattern_.nodes()) {
-    if (!pdnodes2nodes_.count(pdnode.get())) {
+    if (required.count(pdnode.get()) && !pdnodes2nodes_.count(pdnode.get())) {
       VLOG(4) << pdnode->name() << " can't find matched Node, early stop";
-      // return false;
+      return false;
+    }
+  }
+  if (!unhinted.empty()) {
+    for (auto *node : graph.Nodes()) {
+      for (auto *pdnode : unhinted) {
+        if (pdnode->Tell(node)) {
+          VLOG(4) << "Node " << node->Name() << " marked as "
+                  << pdnode->name();
+          pdnodes2nodes_[pdnode].insert(node);
+        }
+      }
     }
   }
   VLOG(3) << pdnodes2nodes_.size() << " nodes marked";
@@ -130,6 +160,45 @@ bool GraphPatternDetector::MarkPDNodesInGraph(const ir::Graph &graph) {
   return !pdnodes2nodes_.empty();
 }
 
+bool GraphPatternDetector::CollectCandidates(
+    const ir::Graph &graph, const PDNode &pdnode,
+    std::vector<Node *> *candidates) const {
+  // The asserts are ignored if the PDNode has a teller.
+  if (pdnode.teller_ || pdnode.hints_.empty()) return false;
+
+  // Use the hint with the fewest ops.
+  const PDNode::CandidateHint *best = nullptr;
+  size_t best_num_ops = 0;
+  for (auto &hint : pdnode.hints_) {
+    size_t num_ops = 0;
+    for (auto &type : hint.op_types) {
+      num_ops += graph.OpNodesOfType(type).size();
+    }
+    if (best == nullptr || num_ops < best_num_ops) {
+      best = &hint;
+      best_num_ops = num_ops;
+    }
+  }
+
+  using Kind = PDNode::CandidateHint::Kind;
+  std::unordered_set<Node *> visited;
+  for (auto &type : best->op_types) {
+    for (auto *op : graph.OpNodesOfType(type)) {
+      if (best->kind == Kind::kOp) {
+        candidates->push_back(op);
+        continue;
+      }
+      auto &vars = best->kind == Kind::kOpInput ? op->inputs : op->outputs;
+      for (auto *var : vars) {
+        if (visited.insert(var).second) {
+          candidates->push_back(var);
+        }
+      }
+    }
+  }
+  return true;
+}
+
 // The intermediate Nodes can only link to the nodes inside the pattern, or this
 // subgraph will be dropped.
 void GraphPatternDetector::ValidateByNodeRole(
@@ -184,6 +253,11 @@ struct HitGroup {
     nodes_.insert(node);
   }
 
+  Node *RoleOf(PDNode *pat) const {
+    auto it = roles.find(pat);
+    return it == roles.end() ? nullptr : it->second;
+  }
+
  private:
   std::unordered_set<Node *> nodes_;
 };
@@ -198,18 +272,57 @@ bool IsNodesLink(Node *a, Node *b) {
   return false;
 }
 
+// Order the edges to extend the subgraphs from the first PDNode, each edge
+// links to a PDNode matched by the previous edges if possible.
+static std::vector<PDPattern::edge_t> OrderEdges(
+    const std::vector<PDPattern::edge_t> &edges, PDNode *first_pnode) {
+  std::vector<PDPattern::edge_t> result;
+  std::vector<bool> used(edges.size(), false);
+  std::unordered_set<PDNode *> reached({first_pnode});
+  while (result.size() < edges.size()) {
+    size_t next = edges.size();
+    for (size_t i = 0; i < edges.size(); ++i) {
+      if (used[i]) continue;
+      if (next == edges.size()) next = i;
+      if (reached.count(edges[i].first) || reached.count(edges[i].second)) {
+        next = i;
+        break;
+      }
+    }
+    used[next] = true;
+    reached.insert(edges[next].first);
+    reached.insert(edges[next].second);
+    result.push_back(edges[next]);
+  }
+  return result;
+}
+
 std::vector<GraphPatternDetector::subgraph_t>
 GraphPatternDetector::DetectPatterns() {
   // Init empty subgraphs.
   std::vector<GraphPatternDetector::subgraph_t> result;
   std::vector<HitGroup> init_groups;
   std::array<std::vector<HitGroup>, 2> bi_records;
-  auto *first_pnode = pattern_.edges().empty() ? pattern().nodes().front().get()
-                                               : pattern_.edges().front().first;
+  // Start from the PDNode with the fewest marked Nodes.
+  PDNode *first_pnode = nullptr;
+  if (pattern_.edges().empty()) {
+    first_pnode = pattern().nodes().front().get();
+  } else {
+    for (auto &edge : pattern_.edges()) {
+      for (auto *pnode : {edge.first, edge.second}) {
+        auto it = pdnodes2nodes_.find(pnode);
+        if (it == pdnodes2nodes_.end()) return result;
+        if (first_pnode == nullptr ||
+            it->second.size() < pdnodes2nodes_[first_pnode].size()) {
+          first_pnode = pnode;
+        }
+      }
+    }
+  }
   if (!pdnodes2nodes_.count(first_pnode)) return result;
   for (auto *node : pdnodes2nodes_[first_pnode]) {
     HitGroup group;
-    group.roles[first_pnode] = node;
+    group.Register(node, first_pnode);
     init_groups.emplace_back(group);
   }
 
@@ -217,31 +330,48 @@ GraphPatternDetector::DetectPatterns() {
   bi_records[0] = std::move(init_groups);
 
   // Extend a PDNode to subgraphs by deducing the connection relations defined
-  // in edges of PDNodes.
-  for (const auto &edge : pattern_.edges()) {
+  // in edges of PDNodes. If one end of an edge is matched in a subgraph, only
+  // the Nodes linked to it are checked.
+  for (const auto &edge : OrderEdges(pattern_.edges(), first_pnode)) {
     VLOG(4) << "check " << edge.first->name() << " -> " << edge.second->name();
-    // TODO(Superjomn) Fix bug here, the groups might be duplicate here.
-    // Each role has two PDNodes, which indicates two roles.
-    // Detect two Nodes that can match these two roles and they are connected.
     auto &pre_groups = bi_records[step % 2];
     auto &cur_groups = bi_records[1 - (step++ % 2)];
     cur_groups.clear();
     if (pre_groups.empty()) break;
-    // source -> target
-    for (Node *source : pdnodes2nodes_[edge.first]) {
-      for (Node *target : pdnodes2nodes_[edge.second]) {
-        VLOG(8) << "check " << source->id() << " -- " << target->id();
-        // TODO(Superjomn) add some prune strategies.
-        for (const auto &group : pre_groups) {
-          if (IsNodesLink(source, target)) {
-            HitGroup new_group = group;
-            bool flag = new_group.Match(source, edge.first) &&
-                        new_group.Match(target, edge.second);
-            if (flag) {
-              new_group.Register(source, edge.first);
-              new_group.Register(target, edge.second);
-              cur_groups.push_back(new_group);
-              // TODO(Superjomn) need to unique
+    const auto &sources = pdnodes2nodes_[edge.first];
+    const auto &targets = pdnodes2nodes_[edge.second];
+    auto extend = [&](const HitGroup &group, Node *source, Node *target) {
+      HitGroup new_group = group;
+      if (new_group.Match(source, edge.first) &&
+          new_group.Match(target, edge.second)) {
+        new_group.Register(source, edge.first);
+        new_group.Register(target, edge.second);
+        cur_groups.push_back(std::move(new_group));
+      }
+    };
+    for (const auto &group : pre_groups) {
+      // A Node might be linked more than once, e.g. the same var for two
+      // inputs of an op.
+      std::unordered_set<Node *> visited;
+      if (Node *source = group.RoleOf(edge.first)) {
+        for (auto *target : source->outputs) {
+          if (targets.count(target) && visited.insert(target).second) {
+            extend(group, source, target);
+          }
+        }
+      } else if (Node *target = group.RoleOf(edge.second)) {
+        for (auto *source : target->inputs) {
+          if (sources.count(source) && visited.insert(source).second) {
+            extend(group, source, target);
+          }
+        }
+      } else {
+        // The edge is not connected to the matched PDNodes.
+        for (Node *source : sources) {
+          for (Node *target : targets) {
+            VLOG(8) << "check " << source->id() << " -- " << target->id();
+            if (IsNodesLink(source, target)) {
+              extend(group, source, target);
             }
           }
         }
@@ -372,6 +502,7 @@ PDNode *PDNode::assert_is_op() {
 }
 
 PDNode *PDNode::assert_is_op(const std::string &op_type) {
+  AddCandidateHint(PDNode::CandidateHint::Kind::kOp, {op_type});
   asserts_.emplace_back([op_type](Node *x) {
     return x && x->IsOp() && x->Op()->Type() == op_type;
   });
@@ -424,6 +555,7 @@ PDNode *PDNode::assert_is_op_nth_input(const std::string &op_type,
 
 PDNode *PDNode::assert_is_op_nth_output(const std::string &op_type,
                                         const std::string &argument, int nth) {
+  AddCandidateHint(PDNode::CandidateHint::Kind::kOpOutput, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -437,6 +569,7 @@ PDNode *PDNode::assert_is_op_nth_output(const std::string &op_type,
 }
 
 PDNode *PDNode::assert_is_only_input_of_op(const std::string &op_type) {
+  AddCandidateHint(PDNode::CandidateHint::Kind::kOpInput, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
@@ -451,6 +584,7 @@ PDNode *PDNode::assert_is_only_input_of_op(const std::string &op_type) {
 }
 
 PDNode *PDNode::assert_is_only_output_of_op(const std::string &op_type) {
+  AddCandidateHint(PDNode::CandidateHint::Kind::kOpOutput, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -465,6 +599,7 @@ PDNode *PDNode::assert_is_only_output_of_op(const std::string &op_type) {
 }
 
 PDNode *PDNode::assert_is_op_output(const std::string &op_type) {
+  AddCandidateHint(PDNode::CandidateHint::Kind::kOpOutput, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -485,6 +620,7 @@ PDNode *PDNode::assert_is_op_output(const std::string &op_type,
 }
 
 PDNode *PDNode::assert_is_op_input(const std::string &op_type) {
+  AddCandidateHint(PDNode::CandidateHint::Kind::kOpInput, {op_type});
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
@@ -542,6 +678,7 @@ PDNode *PDNode::assert_more(PDNode::teller_t &&teller) {
 }
 
 PDNode *PDNode::assert_is_ops(const std::unordered_set<std::string> &op_types) {
+  AddCandidateHint(PDNode::CandidateHint::Kind::kOp, op_types);
   asserts_.emplace_back([op_types](Node *x) {
     return x && x->IsOp() && op_types.count(x->Op()->Type());
   });
@@ -567,6 +704,7 @@ PDNode *PDNode::assert_is_ops_nth_input(
 PDNode *PDNode::assert_is_ops_nth_output(
     const std::unordered_set<std::string> &op_types,
     const std::string &argument, int nth) {
+  AddCandidateHint(PDNode::CandidateHint::Kind::kOpOutput, op_types);
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -580,6 +718,7 @@ PDNode *PDNode::assert_is_ops_nth_output(
 }
 PDNode *PDNode::assert_is_ops_output(
     const std::unordered_set<std::string> &op_types) {
+  AddCandidateHint(PDNode::CandidateHint::Kind::kOpOutput, op_types);
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->inputs) {
@@ -602,6 +741,7 @@ PDNode *PDNode::assert_is_ops_output(
 
 PDNode *PDNode::assert_is_ops_input(
     const std::unordered_set<std::string> &op_types) {
+  AddCandidateHint(PDNode::CandidateHint::Kind::kOpInput, op_types);
   assert_is_var();
   asserts_.emplace_back([=](Node *x) {
     for (auto *op : x->outputs) {
@@ -165,11 +165,26 @@ struct PDNode {
 
   PDNode(PDNode&& other) = default;
 
+  // A necessary condition of the asserts, the node is an op of the types, or
+  // an input or output var of such an op. GraphPatternDetector uses it to
+  // find the candidates from the op type index of the graph.
+  struct CandidateHint {
+    enum class Kind { kOp, kOpInput, kOpOutput };
+    Kind kind;
+    std::unordered_set<std::string> op_types;
+  };
+  void AddCandidateHint(CandidateHint::Kind kind,
+                        const std::unordered_set<std::string>& op_types) {
+    hints_.push_back(CandidateHint{kind, op_types});
+  }
+
   friend class PDPattern;
+  friend class GraphPatternDetector;
 
   // Will removed latter.
   teller_t teller_;
   std::vector<teller_t> asserts_;
+  std::vector<CandidateHint> hints_;
   PDPattern* pattern_;
   std::string name_;
   Type type_;
@@ -278,6 +293,11 @@ class GraphPatternDetector {
   // Mark the nodes that fits the pattern.
   bool MarkPDNodesInGraph(const ir::Graph& graph);
 
+  // Collect the nodes that might fit the PDNode by its candidate hints,
+  // returns false if the PDNode has no hint and all the nodes should be told.
+  bool CollectCandidates(const ir::Graph& graph, const PDNode& pdnode,
+                         std::vector<Node*>* candidates) const;
+
   // Detect all the pattern and output the hit records.
   std::vector<subgraph_t> DetectPatterns();
 
@@ -15,6 +15,8 @@
 #include "paddle/fluid/framework/ir/graph_pattern_detector.h"
 
 #include <gtest/gtest.h>
+#include <chrono>  // NOLINT
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
 
 namespace paddle {
 namespace framework {
@@ -201,6 +203,81 @@ TEST(GraphPatternDetector, IntermediateCheck) {
   ASSERT_EQ(count, 1);
 }
 
+// Builds num_fc blocks of relu(mul(x, w) + bias), and a mul without bias.
+static ProgramDesc BuildFCProgram(int num_fc) {
+  Layers layers;
+  auto* x = layers.data("x");
+  for (int i = 0; i < num_fc; ++i) {
+    auto* w = layers.data("w_" + std::to_string(i), {}, true);
+    auto* bias = layers.data("bias_" + std::to_string(i), {}, true);
+    x = layers.relu(layers.elementwise_add(layers.mul(x, w), bias));
+  }
+  layers.mul(x, layers.data("w", {}, true));
+  return ProgramDesc(layers.main_program());
+}
+
+static int DetectFC(Graph* graph) {
+  GraphPatternDetector detector;
+  auto* x = detector.mutable_pattern()
+                ->NewNode("fc/x")
+                ->AsInput()
+                ->assert_is_op_input("mul", "X");
+  patterns::FC fc_pattern(detector.mutable_pattern(), "fc");
+  fc_pattern(x, true /*with bias*/, true /*with relu*/);
+  int count = 0;
+  detector(graph, [&](const GraphPatternDetector::subgraph_t& subgraph,
+                      Graph* g) {
+    GET_IR_NODE_FROM_SUBGRAPH(mul, mul, fc_pattern);
+    GET_IR_NODE_FROM_SUBGRAPH(relu, relu, fc_pattern);
+    EXPECT_EQ(mul->Op()->Type(), "mul");
+    EXPECT_EQ(relu->Op()->Type(), "relu");
+    ++count;
+  });
+  return count;
+}
+
+TEST(GraphPatternDetector, OpTypeIndex) {
+  auto program = BuildFCProgram(3);
+  Graph graph(program);
+  ASSERT_EQ(DetectFC(&graph), 3);
+
+  // The ops whose types are changed in place are reindexed by the detector.
+  for (auto* node : graph.Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == "relu") {
+      node->Op()->SetType("sigmoid");
+      break;
+    }
+  }
+  ASSERT_EQ(DetectFC(&graph), 2);
+  for (auto* node : graph.Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == "sigmoid") {
+      node->Op()->SetType("relu");
+    }
+  }
+  ASSERT_EQ(DetectFC(&graph), 3);
+}
+
+TEST(GraphPatternDetector, ManyFC) {
+  const int num_fc = 50;
+  auto program = BuildFCProgram(num_fc);
+  Graph graph(program);
+  ASSERT_EQ(DetectFC(&graph), num_fc);
+}
+
+// The time to detect 2000 fc, which is run with
+// --gtest_also_run_disabled_tests.
+TEST(GraphPatternDetector, DISABLED_LargeGraph) {
+  const int num_fc = 2000;
+  auto program = BuildFCProgram(num_fc);
+  Graph graph(program);
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_EQ(DetectFC(&graph), num_fc);
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  LOG(INFO) << "detect " << num_fc << " fc in a graph of "
+            << graph.Nodes().size() << " nodes: " << elapsed.count() << " ms";
+}
+
 }  // namespace ir
 }  // namespace framework
 }  // namespace paddle
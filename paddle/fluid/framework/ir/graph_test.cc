@@ -252,5 +252,40 @@ TEST(GraphTest, TestException) {
   }
   ASSERT_TRUE(not_met_exception);
 }
+
+TEST(GraphTest, OpTypeIndex) {
+  ProgramDesc prog;
+  for (int i = 0; i < 3; ++i) {
+    auto *op = prog.MutableBlock(0)->AppendOp();
+    op->SetType(i < 2 ? "sum" : "dummy");
+    op->SetInput("X", {"a"});
+    op->SetOutput("Out", {"out_" + std::to_string(i)});
+  }
+  std::unique_ptr<ir::Graph> g(new ir::Graph(prog));
+  ASSERT_EQ(g->OpNodesOfType("sum").size(), 2UL);
+  ASSERT_EQ(g->OpNodesOfType("dummy").size(), 1UL);
+  ASSERT_EQ(g->OpNodesOfType("a").size(), 0UL);
+
+  // The index is updated as the nodes are removed and created.
+  ir::Node *dummy = *g->OpNodesOfType("dummy").begin();
+  g->RemoveNode(dummy);
+  ASSERT_EQ(g->OpNodesOfType("dummy").size(), 0UL);
+  OpDesc desc;
+  desc.SetType("dummy");
+  ir::Node *created = g->CreateOpNode(&desc);
+  ASSERT_EQ(g->OpNodesOfType("dummy").count(created), 1UL);
+
+  // The type changed in place is indexed after SyncOpTypeIndex.
+  ir::Node *sum = *g->OpNodesOfType("sum").begin();
+  sum->Op()->SetType("dummy");
+  ASSERT_EQ(g->OpNodesOfType("sum").size(), 2UL);
+  g->SyncOpTypeIndex();
+  ASSERT_EQ(g->OpNodesOfType("sum").size(), 1UL);
+  ASSERT_EQ(g->OpNodesOfType("dummy").size(), 2UL);
+  ASSERT_EQ(g->OpNodesOfType("dummy").count(sum), 1UL);
+
+  g->ReleaseNodes();
+  ASSERT_EQ(g->OpNodesOfType("sum").size(), 0UL);
+}
 }  // namespace framework
 }  // namespace paddle
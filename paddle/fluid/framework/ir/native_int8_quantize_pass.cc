@@ -0,0 +1,197 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/native_int8_quantize_pass.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+namespace {
+
+constexpr float kInt8MaxRange = 127.f;
+
+struct Int8OpInfo {
+  // The input of the weight.
+  std::string weight;
+  // The attr of the abs max of the activation, set by the
+  // quant_conv2d_dequant_fuse_pass or delete_quant_dequant_op_pass.
+  std::string input_abs_max;
+  // The attrs of the quantize scales read by the int8 kernel.
+  std::string scale_in;
+  std::string scale_weights;
+  // The output channels are the rows of the weight, otherwise the columns.
+  bool channel_is_row;
+};
+
+const std::unordered_map<std::string, Int8OpInfo>& Int8Ops() {
+  static const std::unordered_map<std::string, Int8OpInfo> ops = {
+      {"conv2d", {"Filter", "Input_scale", "Scale_in", "Scale_weights", true}},
+      {"fc", {"W", "Input_scale", "Scale_in", "Scale_weights", false}},
+      {"mul", {"Y", "X_scale", "scale_x", "scale_y", false}},
+      {"matmul", {"Y", "X_scale", "scale_x", "scale_y", false}}};
+  return ops;
+}
+
+template <typename T>
+T AttrOr(const OpDesc& op, const std::string& name, T value) {
+  return op.HasAttr(name) ? boost::get<T>(op.GetAttr(name)) : value;
+}
+
+// Gives the number of the output channels of the weight, or 0 if the op is
+// not supported by the int8 kernel.
+int64_t NumChannels(const OpDesc& op, const DDim& dims) {
+  const auto& type = op.Type();
+  if (type == "conv2d") {
+    if (dims.size() != 4 || AttrOr(op, "use_mkldnn", false)) return 0;
+    return dims[0];
+  } else if (type == "fc") {
+    if (dims.size() != 2 || AttrOr(op, "padding_weights", false)) return 0;
+    return dims[1];
+  } else if (type == "mul") {
+    return flatten_to_2d(dims, AttrOr(op, "y_num_col_dims", 1))[1];
+  } else if (type == "matmul") {
+    if (dims.size() != 2 || AttrOr(op, "transpose_X", false) ||
+        AttrOr(op, "transpose_Y", false) || AttrOr(op, "head_number", 1) > 1) {
+      return 0;
+    }
+    return dims[1];
+  }
+  return 0;
+}
+
+// Quantizes the weight in place, and gives the quantize scale of each
+// channel. The weight of the frozen model holds the quantized integers and
+// its weight_scale is the abs max of each channel.
+bool QuantizeWeight(const OpDesc& op, const Int8OpInfo& info,
+                    LoDTensor* weight, std::vector<float>* scales) {
+  int64_t channels = NumChannels(op, weight->dims());
+  if (channels <= 0 || weight->type() != proto::VarType::FP32) return false;
+  const int64_t numel = weight->numel();
+  const int64_t channel_size = numel / channels;
+  auto channel_of = [&](int64_t i) {
+    return info.channel_is_row ? i / channel_size : i % channels;
+  };
+  const float* data = weight->data<float>();
+
+  std::vector<float> abs_max(channels, 0.f);
+  bool is_frozen = op.HasAttr("weight_scale");
+  if (is_frozen) {
+    auto weight_scale =
+        boost::get<std::vector<float>>(op.GetAttr("weight_scale"));
+    if (weight_scale.size() != 1UL &&
+        weight_scale.size() != static_cast<size_t>(channels)) {
+      LOG(WARNING) << "The weight_scale of " << op.Type() << " has "
+                   << weight_scale.size() << " values for " << channels
+                   << " channels, it is not quantized.";
+      return false;
+    }
+    for (int64_t c = 0; c < channels; ++c) {
+      abs_max[c] = weight_scale[weight_scale.size() > 1 ? c : 0];
+    }
+    for (int64_t i = 0; i < numel; ++i) {
+      if (std::fabs(data[i]) > kInt8MaxRange + 0.5f) {
+        LOG(WARNING) << "The weight of " << op.Type()
+                     << " is not quantized to 8 bits.";
+        return false;
+      }
+    }
+  } else {
+    for (int64_t i = 0; i < numel; ++i) {
+      auto& m = abs_max[channel_of(i)];
+      m = std::max(m, std::fabs(data[i]));
+    }
+  }
+
+  scales->resize(channels);
+  for (int64_t c = 0; c < channels; ++c) {
+    (*scales)[c] = abs_max[c] > 0.f ? kInt8MaxRange / abs_max[c] : 1.f;
+  }
+  LoDTensor weight_int8;
+  weight_int8.Resize(weight->dims());
+  int8_t* q = weight_int8.mutable_data<int8_t>(platform::CPUPlace());
+  for (int64_t i = 0; i < numel; ++i) {
+    float v = is_frozen ? data[i] : data[i] * (*scales)[channel_of(i)];
+    v = std::min(std::max(std::round(v), -kInt8MaxRange), kInt8MaxRange);
+    q[i] = static_cast<int8_t>(v);
+  }
+  weight->ShareDataWith(weight_int8);
+  return true;
+}
+
+}  // namespace
+
+void NativeInt8QuantizePass::ApplyImpl(ir::Graph* graph) const {
+  const std::string pattern_name = "native_int8_quantize";
+  FusePassBase::Init(pattern_name, graph);
+  auto* scope = param_scope();
+  PADDLE_ENFORCE_NOT_NULL(scope, platform::errors::InvalidArgument(
+                                     "The param scope should not be null."));
+
+  int quantize_count = 0;
+  for (auto* node : graph->Nodes()) {
+    if (!node->IsOp()) continue;
+    auto* op = node->Op();
+    auto it = Int8Ops().find(op->Type());
+    if (it == Int8Ops().end() || !AttrOr(*op, "enable_int8", false) ||
+        !op->HasAttr(it->second.input_abs_max)) {
+      continue;
+    }
+    const auto& info = it->second;
+    auto weight_name = op->Input(info.weight).front();
+    Node* weight_node = nullptr;
+    for (auto* in : node->inputs) {
+      if (in->IsVar() && in->Name() == weight_name) weight_node = in;
+    }
+    // The weight shared with other ops is kept in float.
+    if (weight_node == nullptr || !weight_node->Var()->Persistable() ||
+        weight_node->outputs.size() != 1UL) {
+      VLOG(3) << "the weight " << weight_name << " of " << op->Type()
+              << " is not quantized";
+      continue;
+    }
+    auto* weight_var = scope->FindVar(weight_name);
+    PADDLE_ENFORCE_NOT_NULL(
+        weight_var, platform::errors::NotFound(
+                        "The weight %s is not found in the param scope.",
+                        weight_name));
+
+    std::vector<float> scale_weights;
+    if (!QuantizeWeight(*op, info, weight_var->GetMutable<LoDTensor>(),
+                        &scale_weights)) {
+      continue;
+    }
+    weight_node->Var()->SetDataType(proto::VarType::INT8);
+    float input_abs_max = boost::get<float>(op->GetAttr(info.input_abs_max));
+    op->SetAttr(info.scale_in,
+                input_abs_max > 0.f ? kInt8MaxRange / input_abs_max : 1.f);
+    op->SetAttr(info.scale_weights, scale_weights);
+    op->Flush();
+    ++quantize_count;
+  }
+  AddStatis(quantize_count);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+REGISTER_PASS(native_int8_quantize_pass,
+              paddle::framework::ir::NativeInt8QuantizePass);
@@ -0,0 +1,41 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+/*
+ * Quantizes the weights of the conv2d, fc, mul and matmul marked with
+ * enable_int8 by the quant_conv2d_dequant_fuse_pass and
+ * delete_quant_dequant_op_pass to int8, so that they are run by the native
+ * int8 CPU kernels without MKL-DNN. The weights with the attr weight_scale
+ * hold the integers of the frozen quantization-aware-trained model, the
+ * others are quantized by the abs max of each output channel.
+ */
+class NativeInt8QuantizePass : public FusePassBase {
+ public:
+  virtual ~NativeInt8QuantizePass() {}
+
+ protected:
+  void ApplyImpl(ir::Graph* graph) const override;
+};
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
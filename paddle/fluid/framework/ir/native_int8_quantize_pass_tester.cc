@@ -0,0 +1,134 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/ir/native_int8_quantize_pass.h"
+
+#include <gtest/gtest.h>
+#include "paddle/fluid/framework/ir/pass_tester_helper.h"
+
+namespace paddle {
+namespace framework {
+namespace ir {
+
+static float* AddVarToScope(Scope* param_scope, const std::string& name,
+                            const DDim& dims) {
+  auto* tensor = param_scope->Var(name)->GetMutable<LoDTensor>();
+  tensor->Resize(dims);
+  return tensor->mutable_data<float>(platform::CPUPlace());
+}
+
+static Node* FindOpNode(Graph* graph, const std::string& type) {
+  for (auto* node : graph->Nodes()) {
+    if (node->IsOp() && node->Op()->Type() == type) return node;
+  }
+  return nullptr;
+}
+
+TEST(NativeInt8QuantizePass, basic) {
+  // inputs                     operator            output
+  // --------------------------------------------------------
+  // (a, filters)               conv2d           -> conv2d_out
+  // (b, weights_0)             mul              -> mul_out
+  // (c, weights_2)             matmul           -> matmul_out_0
+  // (c, weights_1)             matmul           -> matmul_out_1
+  // (d, weights_1)             matmul           -> matmul_out_2
+  Layers layers;
+  auto* a = layers.data("a");
+  auto* filters = layers.data("filters", {2, 1, 1, 1}, true);
+  auto* bias = layers.data("bias", {}, true);
+  layers.conv2d(a, filters, bias);
+  auto* b = layers.data("b");
+  auto* weights_0 = layers.data("weights_0", {2, 3}, true);
+  layers.mul(b, weights_0);
+  auto* c = layers.data("c");
+  auto* weights_1 = layers.data("weights_1", {3, 2}, true);
+  auto* weights_2 = layers.data("weights_2", {3, 2}, true);
+  layers.matmul(c, weights_2);
+  auto* d = layers.data("d");
+  // weights_1 is shared by two ops, so it is kept in float.
+  layers.matmul(c, weights_1);
+  layers.matmul(d, weights_1);
+
+  ProgramDesc program(layers.main_program());
+  for (auto* op : program.MutableBlock(0)->AllOps()) {
+    op->SetAttr("enable_int8", true);
+    if (op->Type() == "conv2d") {
+      op->SetAttr("Input_scale", 2.f);
+      op->SetAttr("weight_scale", std::vector<float>{0.5f, 1.f});
+    } else {
+      op->SetAttr("X_scale", 4.f);
+    }
+    if (op->Type() == "mul") {
+      op->SetAttr("weight_scale", std::vector<float>{2.f});
+    }
+  }
+
+  // The scope is owned by the graph.
+  auto* scope = new Scope();
+  float* filters_data = AddVarToScope(scope, "filters", {2, 1, 1, 1});
+  filters_data[0] = 127.f;
+  filters_data[1] = -3.f;
+  float* weights_0_data = AddVarToScope(scope, "weights_0", {2, 3});
+  for (int i = 0; i < 6; ++i) {
+    weights_0_data[i] = i - 2;
+  }
+  float* weights_1_data = AddVarToScope(scope, "weights_1", {3, 2});
+  float* weights_2_data = AddVarToScope(scope, "weights_2", {3, 2});
+  for (int i = 0; i < 6; ++i) {
+    weights_1_data[i] = weights_2_data[i] = (i + 1) * (i % 2 ? -0.1f : 1.f);
+  }
+
+  std::unique_ptr<ir::Graph> graph(new ir::Graph(program));
+  graph->Set("__param_scope__", scope);
+  auto pass = PassRegistry::Instance().Get("native_int8_quantize_pass");
+  graph.reset(pass->Apply(graph.release()));
+
+  // conv2d: the frozen filter is kept, with the scales of the rows.
+  auto& filters_int8 = scope->FindVar("filters")->Get<LoDTensor>();
+  ASSERT_EQ(filters_int8.type(), proto::VarType::INT8);
+  EXPECT_EQ(filters_int8.data<int8_t>()[0], 127);
+  EXPECT_EQ(filters_int8.data<int8_t>()[1], -3);
+  auto* conv = FindOpNode(graph.get(), "conv2d")->Op();
+  EXPECT_FLOAT_EQ(boost::get<float>(conv->GetAttr("Scale_in")), 63.5f);
+  auto conv_scales =
+      boost::get<std::vector<float>>(conv->GetAttr("Scale_weights"));
+  ASSERT_EQ(conv_scales.size(), 2UL);
+  EXPECT_FLOAT_EQ(conv_scales[0], 254.f);
+  EXPECT_FLOAT_EQ(conv_scales[1], 127.f);
+
+  // mul: one frozen scale for all the columns.
+  auto& weights_0_int8 = scope->FindVar("weights_0")->Get<LoDTensor>();
+  ASSERT_EQ(weights_0_int8.type(), proto::VarType::INT8);
+  EXPECT_EQ(weights_0_int8.data<int8_t>()[5], 3);
+  auto* mul = FindOpNode(graph.get(), "mul")->Op();
+  EXPECT_FLOAT_EQ(boost::get<float>(mul->GetAttr("scale_x")), 31.75f);
+  auto mul_scales = boost::get<std::vector<float>>(mul->GetAttr("scale_y"));
+  ASSERT_EQ(mul_scales.size(), 3UL);
+  EXPECT_FLOAT_EQ(mul_scales[2], 63.5f);
+
+  // matmul: the float weight is quantized by the abs max of the columns.
+  auto& weights_2_int8 = scope->FindVar("weights_2")->Get<LoDTensor>();
+  ASSERT_EQ(weights_2_int8.type(), proto::VarType::INT8);
+  EXPECT_EQ(weights_2_int8.data<int8_t>()[4], 127);
+  EXPECT_EQ(weights_2_int8.data<int8_t>()[5], -127);
+  EXPECT_EQ(weights_2_int8.data<int8_t>()[0], 25);
+  EXPECT_EQ(scope->FindVar("weights_1")->Get<LoDTensor>().type(),
+            proto::VarType::FP32);
+}
+
+}  // namespace ir
+}  // namespace framework
+}  // namespace paddle
+
+USE_PASS(native_int8_quantize_pass);
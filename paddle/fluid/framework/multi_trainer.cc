@@ -12,9 +12,11 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <chrono>  // NOLINT
 #include <string>
 #include <vector>
 #include "io/fs.h"
+#include "paddle/fluid/framework/async_checkpoint.h"
 #include "paddle/fluid/framework/data_feed_factory.h"
 #include "paddle/fluid/framework/device_worker_factory.h"
 #include "paddle/fluid/framework/trainer.h"
@@ -43,6 +45,8 @@ void MultiTrainer::Initialize(const TrainerDesc& trainer_desc,
   mpi_rank_ = trainer_desc.mpi_rank();
   mpi_size_ = trainer_desc.mpi_size();
   dump_file_num_ = trainer_desc.dump_file_num();
+  checkpoint_config_ = trainer_desc.async_checkpoint_config();
+  checkpoint_stopped_ = false;
 
   for (int i = 0; i < trainer_desc.downpour_param().stat_var_names_size();
        i++) {
@@ -147,6 +151,7 @@ void MultiTrainer::InitOtherEnv(const ProgramDesc& main_program) {
   if (need_dump_field_) {
     InitDumpEnv();
   }
+  InitCheckpointEnv();
   VLOG(3) << "init other env done.";
 }
 
@@ -170,10 +175,54 @@ void MultiTrainer::Run() {
   }
 }
 
+void MultiTrainer::InitCheckpointEnv() {
+  if (checkpoint_config_.path().empty() ||
+      checkpoint_config_.interval_seconds() <= 0) {
+    return;
+  }
+  checkpoint_stopped_ = false;
+  checkpoint_thread_ = std::thread(&MultiTrainer::CheckpointWork, this);
+}
+
+void MultiTrainer::CheckpointWork() {
+  std::vector<std::string> var_names(checkpoint_config_.var_names().begin(),
+                                     checkpoint_config_.var_names().end());
+  auto interval = std::chrono::seconds(checkpoint_config_.interval_seconds());
+  int index = 0;
+  std::unique_lock<std::mutex> lock(checkpoint_mutex_);
+  while (!checkpoint_cv_.wait_for(lock, interval,
+                                  [this] { return checkpoint_stopped_; })) {
+    // Only the snapshot blocks here, the workers keep training while the
+    // checkpoint is written in the background.
+    AsyncCheckpointer::GetInstance()->Save(
+        *root_scope_, var_names,
+        checkpoint_config_.path() + "/checkpoint_" + std::to_string(index++));
+  }
+}
+
+void MultiTrainer::FinalizeCheckpointEnv() {
+  if (checkpoint_config_.path().empty()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(checkpoint_mutex_);
+    checkpoint_stopped_ = true;
+  }
+  checkpoint_cv_.notify_all();
+  if (checkpoint_thread_.joinable()) {
+    checkpoint_thread_.join();
+  }
+  std::vector<std::string> var_names(checkpoint_config_.var_names().begin(),
+                                     checkpoint_config_.var_names().end());
+  AsyncCheckpointer::GetInstance()->Save(
+      *root_scope_, var_names, checkpoint_config_.path() + "/checkpoint_final");
+}
+
 void MultiTrainer::Finalize() {
   if (need_dump_field_) {
     FinalizeDumpEnv();
   }
+  FinalizeCheckpointEnv();
   root_scope_->DropKids();
 }
 
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #include "paddle/fluid/framework/op_desc.h"
 #include <algorithm>
+#include <atomic>
 #include <functional>
 #include <mutex>  // NOLINT
 #include <string>
@@ -271,6 +272,11 @@ class CompileTimeInferShapeContext : public InferShapeContext {
   const BlockDesc &block_;
 };
 
+uint64_t OpDesc::NewVersion() {
+  static std::atomic<uint64_t> version{0};
+  return ++version;
+}
+
 OpDesc::OpDesc(const std::string &type, const VariableNameMap &inputs,
                const VariableNameMap &outputs, const AttributeMap &attrs) {
   desc_.set_type(type);
@@ -292,7 +298,7 @@ void OpDesc::CopyFrom(const OpDesc &op_desc) {
   inputs_ = op_desc.inputs_;
   outputs_ = op_desc.outputs_;
   attrs_ = op_desc.attrs_;
-  need_update_ = true;
+  MarkUpdated();
 }
 
 OpDesc::OpDesc(const proto::OpDesc &desc, BlockDesc *block)
@@ -354,7 +360,7 @@ std::vector<std::string> OpDesc::InputArgumentNames() const {
 
 void OpDesc::SetInput(const std::string &param_name,
                       const std::vector<std::string> &args) {
-  need_update_ = true;
+  MarkUpdated();
   inputs_[param_name] = args;
 }
 
@@ -375,7 +381,7 @@ std::vector<std::string> OpDesc::OutputArgumentNames() const {
 
 void OpDesc::SetOutput(const std::string &param_name,
                        const std::vector<std::string> &args) {
-  need_update_ = true;
+  MarkUpdated();
   this->outputs_[param_name] = args;
 }
 
@@ -413,7 +419,7 @@ std::vector<std::string> OpDesc::AttrNames() const {
 
 void OpDesc::RemoveAttr(const std::string &name) {
   attrs_.erase(name);
-  need_update_ = true;
+  MarkUpdated();
 }
 
 void OpDesc::SetAttr(const std::string &name, const Attribute &v) {
@@ -465,7 +471,7 @@ void OpDesc::SetAttr(const std::string &name, const Attribute &v) {
       default:
         PADDLE_THROW("Wrong attr type %d", attr.type());
     }
-    need_update_ = true;
+    MarkUpdated();
     return;
   }
 
@@ -473,29 +479,29 @@ void OpDesc::SetAttr(const std::string &name, const Attribute &v) {
   if (attr_type == proto::AttrType::INT && HasProtoAttr(name) &&
       GetProtoAttr(name).type() == proto::AttrType::BOOLEAN) {
     this->attrs_[name] = static_cast<bool>(boost::get<int>(v));
-    need_update_ = true;
+    MarkUpdated();
     return;
   }
 
   this->attrs_[name] = v;
-  need_update_ = true;
+  MarkUpdated();
 }
 
 void OpDesc::SetBlockAttr(const std::string &name, BlockDesc *block) {
   this->attrs_[name] = block;
-  need_update_ = true;
+  MarkUpdated();
 }
 
 void OpDesc::SetBlocksAttr(const std::string &name,
                            std::vector<BlockDesc *> blocks) {
   this->attrs_[name] = blocks;
-  need_update_ = true;
+  MarkUpdated();
 }
 
 void OpDesc::SetAttrMap(
     const std::unordered_map<std::string, Attribute> &attr_map) {
   attrs_ = attr_map;
-  need_update_ = true;
+  MarkUpdated();
 }
 
 Attribute OpDesc::GetAttr(const std::string &name) const {
@@ -552,7 +558,7 @@ const std::unordered_map<std::string, Attribute> &OpDesc::GetAttrMap() const {
 void OpDesc::Rename(const std::string &old_name, const std::string &new_name) {
   RenameInput(old_name, new_name);
   RenameOutput(old_name, new_name);
-  need_update_ = true;
+  MarkUpdated();
 }
 
 void OpDesc::RenameOutput(const std::string &old_name,
@@ -568,7 +574,7 @@ void OpDesc::RenameOutput(const std::string &old_name,
     std::replace(op_vars.begin(), op_vars.end(), old_name, new_name);
   }
 
-  need_update_ = true;
+  MarkUpdated();
 }
 
 void OpDesc::RenameInput(const std::string &old_name,
@@ -583,7 +589,7 @@ void OpDesc::RenameInput(const std::string &old_name,
     std::replace(op_vars.begin(), op_vars.end(), old_name, new_name);
   }
 
-  need_update_ = true;
+  MarkUpdated();
 }
 
 struct SetAttrDescVisitor : public boost::static_visitor<void> {
@@ -46,7 +46,10 @@ class OpDesc {
 
   std::string Type() const { return desc_.type(); }
 
-  void SetType(const std::string &type) { desc_.set_type(type); }
+  void SetType(const std::string &type) {
+    desc_.set_type(type);
+    MarkUpdated();
+  }
 
   const std::vector<std::string> &Input(const std::string &name) const;
 
@@ -118,7 +121,7 @@ class OpDesc {
   const VariableNameMap &Outputs() const { return outputs_; }
 
   AttributeMap *MutableAttrMap() {
-    this->need_update_ = true;
+    MarkUpdated();
     return &this->attrs_;
   }
 
@@ -136,7 +139,18 @@ class OpDesc {
 
   const BlockDesc *Block() const { return this->block_; }
 
+  // The version differs between the ops and changes on every change of the
+  // op, so that a cached operator created from it can be checked.
+  uint64_t Version() const { return version_; }
+
  private:
+  static uint64_t NewVersion();
+
+  void MarkUpdated() {
+    need_update_ = true;
+    version_ = NewVersion();
+  }
+
   template <typename MapType>
   static std::vector<typename MapType::key_type> MapKeys(const MapType &map) {
     std::vector<typename MapType::key_type> ret_val;
@@ -158,6 +172,7 @@ class OpDesc {
   // need_update_ indicate there some local changes not be synchronized. If
   // local changes should be synchronized, need_update_ should be set to true.
   bool need_update_{false};
+  uint64_t version_{NewVersion()};
 };
 }  // namespace framework
 }  // namespace paddle
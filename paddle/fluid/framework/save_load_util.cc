@@ -15,11 +15,18 @@
 #include "paddle/fluid/framework/save_load_util.h"
 
 #include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <sstream>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <unordered_set>
 
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/imperative/layer.h"
+#include "xxhash.h"  // NOLINT
 
 namespace paddle {
 namespace framework {
@@ -371,5 +378,309 @@ bool LoadTensorFromDisk(
   return true;
 }
 
+namespace {
+
+const char kShardedManifestName[] = "__manifest__";
+const char kShardedManifestMark[] = "PADDLE_SHARDED_CHECKPOINT";
+constexpr int kShardedManifestVersion = 0;
+
+struct ShardedEntry {
+  std::string name;
+  std::string shard;
+  uint64_t offset;
+  uint64_t size;
+  uint64_t checksum;
+};
+
+struct ShardedManifest {
+  int64_t generation{-1};
+  std::vector<ShardedEntry> entries;
+};
+
+int GetShardedThreadNum(int num_threads, size_t num_tasks) {
+  if (num_threads <= 0) {
+    num_threads = std::max(1U, std::thread::hardware_concurrency());
+  }
+  return std::max(1, std::min(num_threads, static_cast<int>(num_tasks)));
+}
+
+// Runs the tasks on a thread pool, and rethrows the first failure.
+void RunShardedTasks(const std::vector<std::function<void()>>& tasks,
+                     int num_threads) {
+  if (tasks.empty()) return;
+  ThreadPool pool(GetShardedThreadNum(num_threads, tasks.size()));
+  std::vector<std::future<std::unique_ptr<platform::EnforceNotMet>>> futures;
+  futures.reserve(tasks.size());
+  for (auto& task : tasks) {
+    futures.emplace_back(pool.RunAndGetException(task));
+  }
+  std::unique_ptr<platform::EnforceNotMet> first_error;
+  for (auto& f : futures) {
+    auto error = f.get();
+    if (error != nullptr && first_error == nullptr) {
+      first_error = std::move(error);
+    }
+  }
+  if (first_error != nullptr) {
+    throw *first_error;
+  }
+}
+
+bool ReadShardedManifest(const std::string& dir_name,
+                         ShardedManifest* manifest) {
+  std::ifstream fin(dir_name + "/" + kShardedManifestName);
+  if (!fin) return false;
+  std::string mark;
+  int version;
+  size_t count;
+  fin >> mark >> version >> manifest->generation >> count;
+  PADDLE_ENFORCE_EQ(mark, kShardedManifestMark,
+                    platform::errors::InvalidArgument(
+                        "The manifest of sharded checkpoint [%s] is damaged.",
+                        dir_name));
+  PADDLE_ENFORCE_EQ(version, kShardedManifestVersion,
+                    platform::errors::InvalidArgument(
+                        "The sharded checkpoint version %d is not supported.",
+                        version));
+  manifest->entries.resize(count);
+  for (auto& entry : manifest->entries) {
+    fin >> entry.name >> entry.shard >> entry.offset >> entry.size >>
+        std::hex >> entry.checksum >> std::dec;
+  }
+  PADDLE_ENFORCE_EQ(static_cast<bool>(fin), true,
+                    platform::errors::InvalidArgument(
+                        "The manifest of sharded checkpoint [%s] is "
+                        "incomplete.",
+                        dir_name));
+  return true;
+}
+
+void WriteShardedManifest(const std::string& dir_name,
+                          const ShardedManifest& manifest) {
+  // Write to a temporary file and rename it, so a crash while saving never
+  // leaves a manifest pointing to incomplete shards.
+  std::string path = dir_name + "/" + kShardedManifestName;
+  std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream fout(tmp_path);
+    PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                      platform::errors::Unavailable(
+                          "Can not open file [%s] to write.", tmp_path));
+    fout << kShardedManifestMark << " " << kShardedManifestVersion << " "
+         << manifest.generation << " " << manifest.entries.size() << "\n";
+    for (auto& entry : manifest.entries) {
+      fout << entry.name << " " << entry.shard << " " << entry.offset << " "
+           << entry.size << " " << std::hex << entry.checksum << std::dec
+           << "\n";
+    }
+    PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                      platform::errors::Unavailable(
+                          "Failed to write the manifest [%s].", tmp_path));
+  }
+  PADDLE_ENFORCE_EQ(std::rename(tmp_path.c_str(), path.c_str()), 0,
+                    platform::errors::Unavailable(
+                        "Failed to rename [%s] to [%s].", tmp_path, path));
+}
+
+}  // namespace
+
+bool SaveStaticNameListToShardedDir(
+    const std::string& dir_name,
+    const std::vector<std::string>& vec_tensor_name_list, const Scope& scope,
+    size_t shard_size_in_bytes, int num_threads, bool incremental) {
+  std::vector<const LoDTensor*> tensors;
+  tensors.reserve(vec_tensor_name_list.size());
+  for (auto& name : vec_tensor_name_list) {
+    PADDLE_ENFORCE_EQ(
+        name.find_first_of(" \t\n"), std::string::npos,
+        platform::errors::InvalidArgument(
+            "Variable name [%s] with whitespace can not be saved.", name));
+    auto var_ptr = scope.FindVar(name);
+    PADDLE_ENFORCE_NE(
+        var_ptr, nullptr,
+        "Variable find error, when save model, can't not find vairable [%s], "
+        "Please make sure you have run StartUpProgram",
+        name);
+    auto& tensor = var_ptr->Get<LoDTensor>();
+    PADDLE_ENFORCE_EQ(tensor.IsInitialized(), true,
+                      "Paramter [%s] not initialzed,"
+                      "Please make sure you have run StartUpProgram",
+                      name);
+    tensors.push_back(&tensor);
+  }
+
+  MkDirRecursively(dir_name.c_str());
+  ShardedManifest old_manifest;
+  std::unordered_map<std::string, const ShardedEntry*> old_entries;
+  if (ReadShardedManifest(dir_name, &old_manifest) && incremental) {
+    for (auto& entry : old_manifest.entries) {
+      old_entries[entry.name] = &entry;
+    }
+  }
+
+  ShardedManifest manifest;
+  manifest.generation = old_manifest.generation + 1;
+  manifest.entries.resize(tensors.size());
+
+  // Pack consecutive tensors into shards of about shard_size_in_bytes, each
+  // shard is written by one task.
+  std::vector<std::function<void()>> tasks;
+  size_t begin = 0;
+  while (begin < tensors.size()) {
+    size_t end = begin;
+    size_t bytes = 0;
+    while (end < tensors.size() &&
+           (end == begin || bytes < shard_size_in_bytes)) {
+      bytes += tensors[end]->memory_size();
+      ++end;
+    }
+    std::string shard = "shard_" + std::to_string(manifest.generation) + "_" +
+                        std::to_string(tasks.size());
+    tasks.emplace_back([&, begin, end, shard] {
+      std::ofstream fout;
+      uint64_t offset = 0;
+      for (size_t i = begin; i < end; ++i) {
+        auto& dev_ctx =
+            *platform::DeviceContextPool::Instance().Get(tensors[i]->place());
+        std::ostringstream oss;
+        SerializeToStream(oss, *tensors[i], dev_ctx);
+        auto buf = oss.str();
+
+        auto& entry = manifest.entries[i];
+        entry.name = vec_tensor_name_list[i];
+        entry.size = buf.size();
+        entry.checksum = XXH64(buf.data(), buf.size(), 0);
+        auto it = old_entries.find(entry.name);
+        if (it != old_entries.end() && it->second->size == entry.size &&
+            it->second->checksum == entry.checksum) {
+          entry.shard = it->second->shard;
+          entry.offset = it->second->offset;
+          continue;
+        }
+
+        if (!fout.is_open()) {
+          fout.open(dir_name + "/" + shard, std::ios::binary);
+          PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                            platform::errors::Unavailable(
+                                "Can not open shard [%s/%s] to write.",
+                                dir_name, shard));
+        }
+        entry.shard = shard;
+        entry.offset = offset;
+        fout.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+        offset += buf.size();
+      }
+      if (fout.is_open()) {
+        fout.close();
+        PADDLE_ENFORCE_EQ(static_cast<bool>(fout), true,
+                          platform::errors::Unavailable(
+                              "Failed to write shard [%s/%s].", dir_name,
+                              shard));
+      }
+    });
+    begin = end;
+  }
+  RunShardedTasks(tasks, num_threads);
+
+  WriteShardedManifest(dir_name, manifest);
+
+  // Remove the shards of the previous save which are no longer referenced.
+  std::unordered_set<std::string> used_shards;
+  for (auto& entry : manifest.entries) {
+    used_shards.insert(entry.shard);
+  }
+  for (auto& entry : old_manifest.entries) {
+    if (used_shards.insert(entry.shard).second) {
+      std::remove((dir_name + "/" + entry.shard).c_str());
+    }
+  }
+  return true;
+}
+
+bool LoadStaticNameListFromShardedDir(
+    const std::string& dir_name,
+    const std::vector<std::string>& vec_tensor_name_list, const Scope& scope,
+    int num_threads) {
+  ShardedManifest manifest;
+  PADDLE_ENFORCE_EQ(ReadShardedManifest(dir_name, &manifest), true,
+                    platform::errors::NotFound(
+                        "Can not find the manifest of sharded checkpoint "
+                        "[%s].",
+                        dir_name));
+  std::unordered_map<std::string, const ShardedEntry*> entries;
+  for (auto& entry : manifest.entries) {
+    entries[entry.name] = &entry;
+  }
+
+  // Group the requested tensors by shard, so every shard is read sequentially
+  // by a single task.
+  std::map<std::string, std::vector<std::pair<const ShardedEntry*, Tensor*>>>
+      shards;
+  for (auto& name : vec_tensor_name_list) {
+    auto it = entries.find(name);
+    PADDLE_ENFORCE(it != entries.end(),
+                   "Paramete not found in Model file, "
+                   "Can not find [%s] in model file [%s]",
+                   name, dir_name);
+    auto var_ptr = scope.FindVar(name);
+    PADDLE_ENFORCE_NE(
+        var_ptr, nullptr,
+        "Parameter not created, when load model, can't not find parameter [%s] "
+        "please make sure you have run StartUpProgram",
+        name);
+    Tensor* tensor = var_ptr->GetMutable<LoDTensor>();
+    PADDLE_ENFORCE_EQ(tensor->IsInitialized(), true,
+                      "Paramter [%s] not initialzed "
+                      "please make sure you have run StartUpProgram",
+                      name);
+    shards[it->second->shard].emplace_back(it->second, tensor);
+  }
+
+  std::vector<std::function<void()>> tasks;
+  for (auto& shard : shards) {
+    auto& items = shard.second;
+    std::sort(items.begin(), items.end(),
+              [](const std::pair<const ShardedEntry*, Tensor*>& a,
+                 const std::pair<const ShardedEntry*, Tensor*>& b) {
+                return a.first->offset < b.first->offset;
+              });
+    tasks.emplace_back([&dir_name, &shard] {
+      std::string path = dir_name + "/" + shard.first;
+      std::ifstream fin(path, std::ios::binary);
+      PADDLE_ENFORCE_EQ(static_cast<bool>(fin), true,
+                        platform::errors::NotFound(
+                            "Can not open shard [%s] to read.", path));
+      platform::CPUDeviceContext cpu_ctx;
+      std::string buf;
+      for (auto& item : shard.second) {
+        auto* entry = item.first;
+        buf.resize(entry->size);
+        fin.seekg(static_cast<std::streamoff>(entry->offset));
+        fin.read(&buf[0], static_cast<std::streamsize>(entry->size));
+        CheckInStreamState(fin, entry->size);
+        PADDLE_ENFORCE_EQ(XXH64(buf.data(), buf.size(), 0), entry->checksum,
+                          platform::errors::InvalidArgument(
+                              "Checksum of [%s] in shard [%s] mismatches, "
+                              "the checkpoint is damaged.",
+                              entry->name, path));
+
+        std::istringstream iss(buf);
+        LoDTensor loaded;
+        DeserializeFromStream(iss, &loaded, cpu_ctx);
+        auto* tensor = item.second;
+        PADDLE_ENFORCE_EQ(
+            tensor->dims(), loaded.dims(),
+            "Shape not matching: the Program requires a parameter with a "
+            "shape of (%s), while the loaded parameter (namely [ %s ]) has a "
+            "shape of  (%s).",
+            tensor->dims(), entry->name, loaded.dims());
+        TensorCopySync(loaded, tensor->place(), tensor);
+      }
+    });
+  }
+  RunShardedTasks(tasks, num_threads);
+  return true;
+}
+
 }  // namespace framework
 }  // namespace paddle
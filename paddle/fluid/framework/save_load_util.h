@@ -36,6 +36,22 @@ bool LoadStaticNameListFromDisk(
     const std::string& file_name,
     const std::vector<std::string>& vec_tensor_name_list, const Scope& scope);
 
+// Sharded checkpoint: the tensors are saved into a directory holding several
+// shard files, written and read in parallel, and a manifest recording the
+// shard, offset, size and checksum of every tensor. With `incremental`, the
+// tensors whose content did not change since the last save in the same
+// directory are not written again.
+bool SaveStaticNameListToShardedDir(
+    const std::string& dir_name,
+    const std::vector<std::string>& vec_tensor_name_list, const Scope& scope,
+    size_t shard_size_in_bytes = 64UL << 20, int num_threads = 0,
+    bool incremental = false);
+
+bool LoadStaticNameListFromShardedDir(
+    const std::string& dir_name,
+    const std::vector<std::string>& vec_tensor_name_list, const Scope& scope,
+    int num_threads = 0);
+
 bool SaveDygraphVarBaseListToDisk(
     const std::string& file_name,
     const std::vector<std::shared_ptr<imperative::VarBase>>& vec_var_base_list);
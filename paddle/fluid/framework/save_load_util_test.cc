@@ -12,13 +12,23 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 #include <stdlib.h>
+#include <sys/stat.h>
 #include <time.h>
+#ifdef _WIN32
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "paddle/fluid/framework/save_load_util.h"
 #include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/platform/timer.h"
 
 namespace paddle {
 namespace framework {
@@ -76,3 +86,146 @@ TEST(test_save_load_util, test_save_load) {
 }
 }  // namespace framework
 }  // namespace paddle
+
+namespace paddle {
+namespace framework {
+
+static void FillRandom(LoDTensor* tensor) {
+  float* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = (rand() % 10000) * 1.0 / 50000 - 1.0;  // NOLINT
+  }
+}
+
+// The modified time of the file, or -1 if it does not exist.
+static int64_t ModifiedTime(const std::string& path) {
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0) return -1;
+  return static_cast<int64_t>(st.st_mtime);
+}
+
+// The generation of the last save recorded in the manifest of the directory.
+static int64_t ShardedGeneration(const std::string& dir_name) {
+  std::ifstream fin(dir_name + "/__manifest__");
+  std::string mark;
+  int version;
+  int64_t generation = -1;
+  fin >> mark >> version >> generation;
+  return generation;
+}
+
+static std::string ShardPath(const std::string& dir_name, int64_t generation,
+                             int index) {
+  return dir_name + "/shard_" + std::to_string(generation) + "_" +
+         std::to_string(index);
+}
+
+static void ExpectSameTensor(const Tensor& a, const Tensor& b) {
+  ASSERT_EQ(a.dims(), b.dims());
+  const float* pa = a.data<float>();
+  const float* pb = b.data<float>();
+  for (int64_t i = 0; i < a.numel(); ++i) {
+    ASSERT_EQ(pa[i], pb[i]);
+  }
+}
+
+TEST(test_save_load_util, test_sharded_save_load) {
+  srand(time(NULL));
+  Scope scope;
+  std::vector<std::string> names;
+  for (int i = 0; i < 8; ++i) {
+    names.push_back("sharded_var_" + std::to_string(i));
+    auto* tensor = scope.Var(names.back())->GetMutable<LoDTensor>();
+    tensor->Resize({100 * (i + 1), 50});
+    FillRandom(tensor);
+  }
+  // a small shard size, so every shard holds a few tensors only
+  SaveStaticNameListToShardedDir("test_sharded", names, scope, 64 * 1024, 4);
+
+  Scope load_scope;
+  for (auto& name : names) {
+    auto* tensor = load_scope.Var(name)->GetMutable<LoDTensor>();
+    tensor->Resize(scope.FindVar(name)->Get<LoDTensor>().dims());
+    tensor->mutable_data<float>(platform::CPUPlace());
+  }
+  LoadStaticNameListFromShardedDir("test_sharded", names, load_scope, 4);
+  for (auto& name : names) {
+    ExpectSameTensor(scope.FindVar(name)->Get<LoDTensor>(),
+                     load_scope.FindVar(name)->Get<LoDTensor>());
+  }
+
+  // Only the changed tensor is written again by an incremental save. The
+  // tensors 0-2 fill the shard 0 and the tensor 3 fills the shard 1 alone.
+  // The shards are dated back, so a rewritten shard has a new modified time.
+  const int64_t generation = ShardedGeneration("test_sharded");
+  const int64_t kOldTime = 1000000000;
+  int num_shards = 0;
+  for (; ModifiedTime(ShardPath("test_sharded", generation, num_shards)) >= 0;
+       ++num_shards) {
+    struct utimbuf times;
+    times.actime = kOldTime;
+    times.modtime = kOldTime;
+    ASSERT_EQ(utime(ShardPath("test_sharded", generation, num_shards).c_str(),
+                    &times),
+              0);
+  }
+  ASSERT_GT(num_shards, 2);
+  FillRandom(scope.FindVar(names[3])->GetMutable<LoDTensor>());
+  SaveStaticNameListToShardedDir("test_sharded", names, scope, 64 * 1024, 4,
+                                 true);
+  EXPECT_EQ(ShardedGeneration("test_sharded"), generation + 1);
+  for (int i = 0; i < num_shards; ++i) {
+    // The old shard 1 is removed since it is no longer referenced.
+    EXPECT_EQ(ModifiedTime(ShardPath("test_sharded", generation, i)),
+              i == 1 ? -1 : kOldTime);
+    EXPECT_EQ(ModifiedTime(ShardPath("test_sharded", generation + 1, i)) >= 0,
+              i == 1);
+  }
+  LoadStaticNameListFromShardedDir("test_sharded", names, load_scope, 4);
+  for (auto& name : names) {
+    ExpectSameTensor(scope.FindVar(name)->Get<LoDTensor>(),
+                     load_scope.FindVar(name)->Get<LoDTensor>());
+  }
+}
+
+// Compares the throughput of the single file format and the sharded format on
+// 64MB, which is run with --gtest_also_run_disabled_tests.
+TEST(test_save_load_util, DISABLED_test_sharded_throughput) {
+  Scope scope;
+  std::vector<std::string> names;
+  size_t total_bytes = 0;
+  for (int i = 0; i < 16; ++i) {
+    names.push_back("throughput_var_" + std::to_string(i));
+    auto* tensor = scope.Var(names.back())->GetMutable<LoDTensor>();
+    tensor->Resize({1024, 1024});
+    FillRandom(tensor);
+    total_bytes += tensor->memory_size();
+  }
+  double mb = total_bytes / 1024.0 / 1024.0;
+  platform::Timer timer;
+
+  timer.Start();
+  SaveStaticNameListToDisk("test_throughput_single", names, scope);
+  timer.Pause();
+  LOG(INFO) << "single file save: " << mb / timer.ElapsedSec() << " MB/s";
+  timer.Reset();
+  timer.Start();
+  LoadStaticNameListFromDisk("test_throughput_single", names, scope);
+  timer.Pause();
+  LOG(INFO) << "single file load: " << mb / timer.ElapsedSec() << " MB/s";
+
+  timer.Reset();
+  timer.Start();
+  SaveStaticNameListToShardedDir("test_throughput_sharded", names, scope,
+                                 8UL << 20);
+  timer.Pause();
+  LOG(INFO) << "sharded save: " << mb / timer.ElapsedSec() << " MB/s";
+  timer.Reset();
+  timer.Start();
+  LoadStaticNameListFromShardedDir("test_throughput_sharded", names, scope);
+  timer.Pause();
+  LOG(INFO) << "sharded load: " << mb / timer.ElapsedSec() << " MB/s";
+}
+
+}  // namespace framework
+}  // namespace paddle
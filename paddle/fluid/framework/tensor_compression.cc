@@ -0,0 +1,202 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/framework/tensor_compression.h"
+
+#include <zlib.h>
+#include <algorithm>
+#include <vector>
+
+#include "gflags/gflags.h"
+#include "paddle/fluid/platform/enforce.h"
+
+DEFINE_bool(tensor_stream_compression, false,
+            "Whether to compress the tensor data when serializing tensors, "
+            "e.g. by save/save_combine op and checkpoints. The compressed "
+            "tensors are read back transparently.");
+DEFINE_int64(tensor_stream_compression_min_bytes, 64 << 10,
+             "The tensors smaller than this are never compressed, since the "
+             "saving is not worth the time.");
+
+namespace paddle {
+namespace framework {
+
+// Each block is compressed independently, so a corrupted block or a huge
+// tensor does not need the whole data in one zlib stream. The size must be a
+// multiple of the size of all the data types.
+static constexpr uint64_t kCompressBlockSize = 4 << 20;
+// The data is stored uncompressed if it does not shrink below this ratio.
+static constexpr double kMaxCompressRatio = 0.9;
+
+namespace {
+
+struct CompressHeader {
+  uint32_t codec;
+  uint32_t element_size;
+  uint64_t raw_size;
+  uint64_t block_size;
+  uint64_t num_blocks;
+};
+
+void ShuffleBytes(const char* src, size_t size, size_t element_size,
+                  char* dst) {
+  size_t num = size / element_size;
+  for (size_t i = 0; i < num; ++i) {
+    for (size_t b = 0; b < element_size; ++b) {
+      dst[b * num + i] = src[i * element_size + b];
+    }
+  }
+}
+
+void UnshuffleBytes(const char* src, size_t size, size_t element_size,
+                    char* dst) {
+  size_t num = size / element_size;
+  for (size_t b = 0; b < element_size; ++b) {
+    for (size_t i = 0; i < num; ++i) {
+      dst[i * element_size + b] = src[b * num + i];
+    }
+  }
+}
+
+}  // namespace
+
+bool NeedCompressTensorData(size_t size) {
+  return FLAGS_tensor_stream_compression && size > 0 &&
+         size >= static_cast<size_t>(FLAGS_tensor_stream_compression_min_bytes);
+}
+
+bool CompressTensorData(const void* data, size_t size, size_t element_size,
+                        std::string* out) {
+  PADDLE_ENFORCE_GT(element_size, 0,
+                    platform::errors::InvalidArgument(
+                        "The element size of tensor data must be positive."));
+  PADDLE_ENFORCE_EQ(size % element_size, 0,
+                    platform::errors::InvalidArgument(
+                        "The size of tensor data (%d) is not a multiple of "
+                        "the element size (%d).",
+                        size, element_size));
+  bool shuffle = element_size > 1;
+
+  CompressHeader header;
+  header.codec = static_cast<uint32_t>(shuffle
+                                           ? TensorCompressionCodec::kShuffleZlib
+                                           : TensorCompressionCodec::kZlib);
+  header.element_size = static_cast<uint32_t>(element_size);
+  header.raw_size = size;
+  header.block_size = kCompressBlockSize;
+  header.num_blocks = (size + kCompressBlockSize - 1) / kCompressBlockSize;
+
+  out->clear();
+  out->append(reinterpret_cast<const char*>(&header), sizeof(header));
+
+  const char* src = static_cast<const char*>(data);
+  std::vector<char> shuffled(shuffle ? std::min<uint64_t>(size,
+                                                          kCompressBlockSize)
+                                     : 0);
+  std::vector<Bytef> buf(compressBound(kCompressBlockSize));
+  for (uint64_t i = 0; i < header.num_blocks; ++i) {
+    uint64_t offset = i * kCompressBlockSize;
+    uint64_t n = std::min<uint64_t>(kCompressBlockSize, size - offset);
+    const char* block = src + offset;
+    if (shuffle) {
+      ShuffleBytes(block, n, element_size, shuffled.data());
+      block = shuffled.data();
+    }
+    uLongf compressed_size = static_cast<uLongf>(buf.size());
+    int ret = compress2(buf.data(), &compressed_size,
+                        reinterpret_cast<const Bytef*>(block),
+                        static_cast<uLong>(n), Z_BEST_SPEED);
+    PADDLE_ENFORCE_EQ(ret, Z_OK, platform::errors::External(
+                                     "zlib compress2 failed with %d.", ret));
+    // Give up early if the first block is incompressible, e.g. random
+    // initialized weights.
+    if (i == 0 && compressed_size > n * kMaxCompressRatio) {
+      return false;
+    }
+    uint64_t block_size = compressed_size;
+    out->append(reinterpret_cast<const char*>(&block_size), sizeof(block_size));
+    out->append(reinterpret_cast<const char*>(buf.data()), compressed_size);
+  }
+  return out->size() < size * kMaxCompressRatio;
+}
+
+void DecompressTensorData(std::istream& is, void* dst, size_t size) {
+  CompressHeader header;
+  is.read(reinterpret_cast<char*>(&header), sizeof(header));
+  PADDLE_ENFORCE_EQ(static_cast<bool>(is), true,
+                    platform::errors::InvalidArgument(
+                        "Failed to read the header of compressed tensor."));
+  bool shuffle = false;
+  switch (static_cast<TensorCompressionCodec>(header.codec)) {
+    case TensorCompressionCodec::kZlib:
+      break;
+    case TensorCompressionCodec::kShuffleZlib:
+      shuffle = true;
+      break;
+    default:
+      PADDLE_THROW(platform::errors::Unimplemented(
+          "Unsupported tensor compression codec %d.", header.codec));
+  }
+  PADDLE_ENFORCE_EQ(header.raw_size, size,
+                    platform::errors::InvalidArgument(
+                        "The size of compressed tensor data (%d) does not "
+                        "match the tensor description (%d).",
+                        header.raw_size, size));
+  PADDLE_ENFORCE_EQ(
+      header.element_size > 0 && header.block_size > 0 &&
+          header.block_size % header.element_size == 0 &&
+          header.num_blocks ==
+              (size + header.block_size - 1) / header.block_size,
+      true, platform::errors::InvalidArgument(
+                "The header of compressed tensor data is corrupted."));
+
+  char* out = static_cast<char*>(dst);
+  std::vector<char> in;
+  std::vector<char> shuffled(
+      shuffle ? std::min<uint64_t>(size, header.block_size) : 0);
+  for (uint64_t i = 0; i < header.num_blocks; ++i) {
+    uint64_t offset = i * header.block_size;
+    uint64_t n = std::min<uint64_t>(header.block_size, size - offset);
+    uint64_t compressed_size;
+    is.read(reinterpret_cast<char*>(&compressed_size), sizeof(compressed_size));
+    PADDLE_ENFORCE_EQ(
+        static_cast<bool>(is) && compressed_size <= compressBound(n), true,
+        platform::errors::InvalidArgument(
+            "The block %d of compressed tensor data is corrupted.", i));
+    in.resize(compressed_size);
+    is.read(in.data(), compressed_size);
+    PADDLE_ENFORCE_EQ(static_cast<bool>(is), true,
+                      platform::errors::InvalidArgument(
+                          "Failed to read the block %d of compressed tensor "
+                          "data.",
+                          i));
+
+    char* target = shuffle ? shuffled.data() : out + offset;
+    uLongf len = static_cast<uLongf>(n);
+    int ret = uncompress(reinterpret_cast<Bytef*>(target), &len,
+                         reinterpret_cast<const Bytef*>(in.data()),
+                         static_cast<uLong>(compressed_size));
+    PADDLE_ENFORCE_EQ(ret == Z_OK && len == n, true,
+                      platform::errors::InvalidArgument(
+                          "Failed to decompress the block %d of tensor data, "
+                          "zlib returns %d.",
+                          i, ret));
+    if (shuffle) {
+      UnshuffleBytes(target, n, header.element_size, out + offset);
+    }
+  }
+}
+
+}  // namespace framework
+}  // namespace paddle
@@ -0,0 +1,54 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <string>
+
+namespace paddle {
+namespace framework {
+
+// The codecs of the compressed tensor data written by TensorToStream.
+enum class TensorCompressionCodec : uint32_t {
+  kNone = 0,
+  kZlib = 1,
+  // The bytes of the elements are transposed before compression, i.e. the
+  // first bytes of all the elements are stored first, then the second bytes,
+  // and so on. It groups the sign and exponent bytes of floating point values
+  // and the high bytes of integers, which compress much better.
+  kShuffleZlib = 2,
+};
+
+// Returns true if the tensor data of `size` bytes should be compressed when
+// it is serialized, according to FLAGS_tensor_stream_compression and
+// FLAGS_tensor_stream_compression_min_bytes.
+bool NeedCompressTensorData(size_t size);
+
+// Compresses `size` bytes of tensor data, the elements of which take
+// `element_size` bytes, into `out`, including the header needed by
+// DecompressTensorData. The data is compressed in independent blocks.
+//
+// Returns false and leaves `out` unspecified if the data does not compress
+// well, in which case it should be written uncompressed.
+bool CompressTensorData(const void* data, size_t size, size_t element_size,
+                        std::string* out);
+
+// Reads the compressed tensor data written by CompressTensorData from `is`,
+// and decompresses it into `dst`, which must have `size` bytes.
+void DecompressTensorData(std::istream& is, void* dst, size_t size);
+
+}  // namespace framework
+}  // namespace paddle
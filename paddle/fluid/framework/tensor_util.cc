@@ -13,11 +13,14 @@
    limitations under the License. */
 #include "paddle/fluid/framework/tensor_util.h"
 #include <algorithm>
+#include <cstring>
 #include <limits>
 #include <memory>
+#include <string>
 #include <utility>
 #include <vector>
 #include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/framework/tensor_compression.h"
 #include "paddle/fluid/platform/profiler.h"
 
 namespace paddle {
@@ -380,10 +383,42 @@ void TensorIsfinite(const framework::Tensor& tensor, framework::Tensor* out) {
   platform::VisitPlace(place, visitor);
 }
 
+// The version of the tensors whose data is compressed. The uncompressed
+// tensors are still written as version 0, so they can be read by the older
+// releases.
+static constexpr uint32_t kCompressedTensorVersion = 1;
+
+static void CheckTensorVersion(uint32_t version) {
+  PADDLE_ENFORCE_EQ(
+      version == 0U || version == kCompressedTensorVersion, true,
+      platform::errors::InvalidArgument(
+          "tensor version %u is not supported, Only version 0 and %u are "
+          "supported",
+          version, kCompressedTensorVersion));
+}
+
 void TensorToStream(std::ostream& os, const Tensor& tensor,
                     const platform::DeviceContext& dev_ctx) {
+  // The data is compressed before writing anything, since the version
+  // depends on whether it compresses well.
+  std::string compressed;
+  bool is_compressed = false;
+  {
+    uint64_t size = tensor.numel() * framework::SizeOfType(tensor.type());
+    if (NeedCompressTensorData(size)) {
+      Tensor cpu_tensor;
+      const void* data_ptr = tensor.data<void>();
+      if (platform::is_gpu_place(tensor.place())) {
+        TensorCopy(tensor, platform::CPUPlace(), dev_ctx, &cpu_tensor);
+        dev_ctx.Wait();
+        data_ptr = cpu_tensor.data<void>();
+      }
+      is_compressed = CompressTensorData(
+          data_ptr, size, framework::SizeOfType(tensor.type()), &compressed);
+    }
+  }
   {  // the 1st field, uint32_t version
-    constexpr uint32_t version = 0;
+    const uint32_t version = is_compressed ? kCompressedTensorVersion : 0;
     os.write(reinterpret_cast<const char*>(&version), sizeof(version));
   }
   {  // the 2nd field, tensor description
@@ -400,6 +435,11 @@ void TensorToStream(std::ostream& os, const Tensor& tensor,
     auto out = desc.SerializeAsString();
     os.write(out.data(), size);
   }
+  if (is_compressed) {  // the 3rd field, compressed tensor data
+    os.write(compressed.data(),
+             static_cast<std::streamsize>(compressed.size()));
+    return;
+  }
   {  // the 3rd field, tensor data
     uint64_t size = tensor.numel() * framework::SizeOfType(tensor.type());
 
@@ -457,12 +497,7 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
                       const size_t& seek, const std::vector<int64_t>& shape) {
   uint32_t version;
   is.read(reinterpret_cast<char*>(&version), sizeof(version));
-
-  PADDLE_ENFORCE_EQ(
-      version, 0U,
-      platform::errors::InvalidArgument(
-          "tensor version %u is not supported, Only version 0 is supported",
-          version));
+  CheckTensorVersion(version);
 
   proto::VarType::TensorDesc desc;
   {  // int32_t size
@@ -478,11 +513,37 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
   {  // read tensor
     tensor->Resize(framework::make_ddim(shape));
     size_t seekg = seek * framework::SizeOfType(desc.data_type());
-    is.seekg(seekg, is.cur);
+    std::unique_ptr<char[]> decompressed;
+    size_t total = 0;
+    if (version == kCompressedTensorVersion) {
+      // The compressed data cannot be seeked, so decompress all of it and
+      // read the slice from memory.
+      int64_t numel = 1;
+      for (auto dim : desc.dims()) numel *= dim;
+      total = numel * framework::SizeOfType(desc.data_type());
+      decompressed.reset(new char[total]);
+      DecompressTensorData(is, decompressed.get(), total);
+    } else {
+      is.seekg(seekg, is.cur);
+    }
 
     void* buf;
     auto ctx = platform::CPUDeviceContext();
     size_t size = tensor->numel() * framework::SizeOfType(desc.data_type());
+    if (decompressed != nullptr) {
+      PADDLE_ENFORCE_LE(
+          seekg + size, total,
+          platform::errors::OutOfRange(
+              "The slice [%d, %d) of bytes is out of the tensor of %d bytes.",
+              seekg, seekg + size, total));
+    }
+    auto read_data = [&](void* dst) {
+      if (decompressed != nullptr) {
+        std::memcpy(dst, decompressed.get() + seekg, size);
+      } else {
+        is.read(static_cast<char*>(dst), size);
+      }
+    };
     if (platform::is_gpu_place(dev_ctx.GetPlace())) {
 #ifdef PADDLE_WITH_CUDA
       Tensor cpu_tensor;
@@ -490,7 +551,7 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
       framework::VisitDataType(
           desc.data_type(),
           DeserializedDataFunctor(&buf, &cpu_tensor, ctx.GetPlace()));
-      is.read(static_cast<char*>(buf), size);
+      read_data(buf);
       auto dst_place = dev_ctx.GetPlace();
       framework::TensorCopy(cpu_tensor, dst_place, dev_ctx, tensor);
 #else
@@ -501,7 +562,7 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
       framework::VisitDataType(
           desc.data_type(),
           DeserializedDataFunctor(&buf, tensor, ctx.GetPlace()));
-      is.read(static_cast<char*>(buf), size);
+      read_data(buf);
     }
   }
 }
@@ -510,11 +571,7 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
                       const platform::DeviceContext& dev_ctx) {
   uint32_t version;
   is.read(reinterpret_cast<char*>(&version), sizeof(version));
-  PADDLE_ENFORCE_EQ(
-      version, 0U,
-      platform::errors::InvalidArgument(
-          "tensor version %u is not supported, Only version 0 is supported",
-          version));
+  CheckTensorVersion(version);
   proto::VarType::TensorDesc desc;
   {  // int32_t size
      // proto buffer
@@ -534,6 +591,13 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
     void* buf;
     auto ctx = platform::CPUDeviceContext();
     size_t size = tensor->numel() * framework::SizeOfType(desc.data_type());
+    auto read_data = [&](void* dst) {
+      if (version == kCompressedTensorVersion) {
+        DecompressTensorData(is, dst, size);
+      } else {
+        is.read(static_cast<char*>(dst), size);
+      }
+    };
     if (platform::is_gpu_place(dev_ctx.GetPlace())) {
 #ifdef PADDLE_WITH_CUDA
       Tensor cpu_tensor;
@@ -541,7 +605,7 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
       framework::VisitDataType(
           desc.data_type(),
           DeserializedDataFunctor(&buf, &cpu_tensor, ctx.GetPlace()));
-      is.read(static_cast<char*>(buf), size);
+      read_data(buf);
       auto dst_place = dev_ctx.GetPlace();
       framework::TensorCopy(cpu_tensor, dst_place, dev_ctx, tensor);
 #else
@@ -552,7 +616,7 @@ void TensorFromStream(std::istream& is, Tensor* tensor,
       framework::VisitDataType(
           desc.data_type(),
           DeserializedDataFunctor(&buf, tensor, ctx.GetPlace()));
-      is.read(static_cast<char*>(buf), size);
+      read_data(buf);
     }
   }
 }
@@ -14,6 +14,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
 #include <fstream>
 #include <memory>
 #include <mutex>  // NOLINT
@@ -75,6 +76,9 @@ class MultiTrainer : public TrainerBase {
   virtual void InitDumpEnv();
   virtual Scope* GetWorkerScope(int thread_id);
   virtual void DumpWork(int tid);
+  virtual void InitCheckpointEnv();
+  virtual void FinalizeCheckpointEnv();
+  virtual void CheckpointWork();
 
  protected:
   int thread_num_;
@@ -93,6 +97,12 @@ class MultiTrainer : public TrainerBase {
   std::vector<std::thread> dump_thread_;
   int dump_thread_num_;
   std::shared_ptr<paddle::framework::ChannelObject<std::string>> queue_;
+
+  AsyncCheckpointConfig checkpoint_config_;
+  std::thread checkpoint_thread_;
+  std::mutex checkpoint_mutex_;
+  std::condition_variable checkpoint_cv_;
+  bool checkpoint_stopped_{false};
 };
 
 class DistMultiTrainer : public MultiTrainer {
@@ -0,0 +1,205 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/imperative/dispatch_cache.h"
+#include <cstring>
+#include <functional>
+#include <utility>
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/imperative/layer.h"
+
+namespace paddle {
+namespace imperative {
+
+// Entries are dropped all together when there are more, which only happens
+// when the attributes of ops keep changing, e.g. a step counter.
+static constexpr size_t kMaxDispatchEntries = 4096;
+
+static inline void HashCombine(size_t* seed, size_t value) {
+  *seed ^= value + 0x9e3779b9 + (*seed << 6) + (*seed >> 2);
+}
+
+namespace {
+struct AttrHashVisitor : public boost::static_visitor<size_t> {
+  size_t operator()(const boost::blank&) const { return 0; }
+
+  template <typename T>
+  size_t operator()(const T& value) const {
+    return std::hash<T>()(value);
+  }
+
+  template <typename T>
+  size_t operator()(const std::vector<T>& values) const {
+    size_t seed = values.size();
+    for (const auto& value : values) {
+      HashCombine(&seed, std::hash<T>()(value));
+    }
+    return seed;
+  }
+};
+
+// The floats are compared bitwise, so that an attribute of NaN equals itself
+// and the op still hits the cache.
+struct AttrEqualVisitor : public boost::static_visitor<bool> {
+  template <typename T, typename U>
+  bool operator()(const T&, const U&) const {
+    return false;
+  }
+
+  template <typename T>
+  bool operator()(const T& a, const T& b) const {
+    return a == b;
+  }
+
+  bool operator()(float a, float b) const {
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+  }
+
+  bool operator()(const std::vector<float>& a,
+                  const std::vector<float>& b) const {
+    return a.size() == b.size() &&
+           (a.empty() ||
+            std::memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0);
+  }
+};
+}  // namespace
+
+static size_t HashAttrs(const framework::AttributeMap& attrs) {
+  // AttributeMap is unordered, the hash of each attribute is summed up so that
+  // equal maps have equal hashes.
+  size_t hash = attrs.size();
+  for (const auto& pair : attrs) {
+    size_t seed = std::hash<std::string>()(pair.first);
+    HashCombine(&seed, pair.second.which());
+    HashCombine(&seed, boost::apply_visitor(AttrHashVisitor(), pair.second));
+    hash += seed;
+  }
+  return hash;
+}
+
+static bool AttrsEqual(const framework::AttributeMap& a,
+                       const framework::AttributeMap& b) {
+  if (a.size() != b.size()) return false;
+  for (const auto& pair : a) {
+    auto it = b.find(pair.first);
+    if (it == b.end() ||
+        !boost::apply_visitor(AttrEqualVisitor(), pair.second, it->second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static int64_t PlaceCode(const platform::Place& place) {
+  int64_t code = place.which();
+  if (platform::is_gpu_place(place)) {
+    code += static_cast<int64_t>(boost::get<platform::CUDAPlace>(place).device +
+                                 1)
+            << 8;
+  }
+  return code;
+}
+
+static void AppendSignature(const NameVarBaseMap& vars,
+                            std::vector<int64_t>* signature) {
+  for (const auto& pair : vars) {
+    signature->emplace_back(std::hash<std::string>()(pair.first));
+    signature->emplace_back(pair.second.size());
+    for (const auto& var_base : pair.second) {
+      if (var_base == nullptr) {
+        signature->emplace_back(-1);
+        continue;
+      }
+      signature->emplace_back(var_base->Type());
+      const auto& var = var_base->Var();
+      const framework::Tensor* tensor = nullptr;
+      if (var.IsType<framework::LoDTensor>()) {
+        tensor = &var.Get<framework::LoDTensor>();
+      } else if (var.IsType<framework::SelectedRows>()) {
+        tensor = &var.Get<framework::SelectedRows>().value();
+      }
+      if (tensor != nullptr && tensor->IsInitialized()) {
+        signature->emplace_back(tensor->type());
+        signature->emplace_back(PlaceCode(tensor->place()));
+        signature->emplace_back(static_cast<int64_t>(tensor->layout()));
+      } else {
+        signature->emplace_back(var_base->DataType());
+        signature->emplace_back(-1);
+        signature->emplace_back(-1);
+      }
+    }
+  }
+}
+
+DispatchCache& DispatchCache::Instance() {
+  static thread_local DispatchCache cache;
+  return cache;
+}
+
+std::shared_ptr<DispatchEntry> DispatchCache::Get(
+    const std::string& op_type, const platform::Place& place,
+    const NameVarBaseMap& ins, const NameVarBaseMap& outs,
+    const framework::AttributeMap& attrs) {
+  std::vector<int64_t> signature;
+  AppendSignature(ins, &signature);
+  // Separates the inputs from the outputs.
+  signature.emplace_back(-2);
+  AppendSignature(outs, &signature);
+
+  size_t key = std::hash<std::string>()(op_type);
+  HashCombine(&key, PlaceCode(place));
+  HashCombine(&key, HashAttrs(attrs));
+  for (auto code : signature) {
+    HashCombine(&key, std::hash<int64_t>()(code));
+  }
+
+  auto range = entries_.equal_range(key);
+  for (auto it = range.first; it != range.second; ++it) {
+    auto& entry = it->second;
+    if (entry->op_type_ == op_type && entry->place_ == place &&
+        entry->signature_ == signature && AttrsEqual(entry->attrs_, attrs)) {
+      return entry;
+    }
+  }
+
+  if (entries_.size() >= kMaxDispatchEntries) {
+    VLOG(3) << "Clear " << entries_.size() << " dygraph dispatch entries";
+    entries_.clear();
+  }
+  auto entry = std::make_shared<DispatchEntry>();
+  entry->op_type_ = op_type;
+  entry->place_ = place;
+  entry->signature_ = std::move(signature);
+  entry->attrs_ = attrs;
+  entries_.emplace(key, entry);
+  VLOG(5) << "Add dygraph dispatch entry of " << op_type;
+  return entry;
+}
+
+std::shared_ptr<framework::OperatorBase> DispatchCache::GetOperator(
+    const std::string& op_type) {
+  auto& op = operators_[op_type];
+  if (op == nullptr) {
+    op = framework::OpRegistry::CreateOp(op_type, {}, {}, {}, false);
+  }
+  return op;
+}
+
+void DispatchCache::Clear() {
+  entries_.clear();
+  operators_.clear();
+}
+
+}  // namespace imperative
+}  // namespace paddle
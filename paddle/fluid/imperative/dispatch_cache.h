@@ -0,0 +1,92 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "paddle/fluid/framework/op_kernel_type.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/imperative/type_defs.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace imperative {
+
+// DispatchEntry keeps what an op resolves before running its kernel in
+// dygraph mode: the var types set by InferVarType and the selected kernel.
+// It is shared by the runs of an op type with equal attributes, on the same
+// place, whose inputs and outputs have the same var type, data type, place
+// and layout, so tracing such an op again skips the resolving.
+struct DispatchEntry {
+  // A var type change made by InferVarType on an output. out_idx indexes
+  // the outputs in the order of NameVarBaseMap.
+  struct VarTypeChange {
+    size_t out_idx;
+    bool is_data_type;
+    framework::proto::VarType::Type type;
+  };
+
+  bool var_types_cached{false};
+  std::vector<VarTypeChange> var_type_changes;
+
+  std::unique_ptr<framework::OpKernelType> kernel_key;
+  framework::OperatorWithKernel::OpKernelFunc kernel_func;
+  std::vector<framework::KernelConfig>* kernel_configs{nullptr};
+
+ private:
+  friend class DispatchCache;
+
+  std::string op_type_;
+  platform::Place place_;
+  std::vector<int64_t> signature_;
+  framework::AttributeMap attrs_;
+};
+
+// DispatchCache is the per thread cache of DispatchEntry and of the operator
+// instances used by OpBase. It is disabled by FLAGS_dygraph_dispatch_cache.
+class DispatchCache {
+ public:
+  static DispatchCache& Instance();
+
+  // Returns the entry of the op, an empty entry is added on a miss.
+  std::shared_ptr<DispatchEntry> Get(const std::string& op_type,
+                                     const platform::Place& place,
+                                     const NameVarBaseMap& ins,
+                                     const NameVarBaseMap& outs,
+                                     const framework::AttributeMap& attrs);
+
+  // The operators of dygraph have no inputs, outputs and attributes of their
+  // own, so all the OpBase of a type share one instance.
+  std::shared_ptr<framework::OperatorBase> GetOperator(
+      const std::string& op_type);
+
+  size_t Size() const { return entries_.size(); }
+
+  void Clear();
+
+ private:
+  DispatchCache() = default;
+
+  std::unordered_multimap<size_t, std::shared_ptr<DispatchEntry>> entries_;
+  std::unordered_map<std::string, std::shared_ptr<framework::OperatorBase>>
+      operators_;
+
+  DISABLE_COPY_AND_ASSIGN(DispatchCache);
+};
+
+}  // namespace imperative
+}  // namespace paddle
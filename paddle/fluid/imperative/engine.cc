@@ -15,12 +15,17 @@
 #include "paddle/fluid/imperative/engine.h"
 
 #include <algorithm>
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <exception>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
+#include "paddle/fluid/imperative/flags.h"
 #include "paddle/fluid/imperative/gradient_accumulator.h"
 #include "paddle/fluid/imperative/layer.h"
 #include "paddle/fluid/imperative/tracer.h"
@@ -37,6 +42,16 @@ void Engine::RunOp(paddle::imperative::OpBase* op,
   op->Run(ins, outs);
 }
 
+static framework::AttributeMap FillConstantAttrs(
+    const framework::DDim& dims, framework::proto::VarType::Type dtype,
+    float value) {
+  framework::AttributeMap attrs;
+  attrs["shape"] = framework::vectorize<int64_t>(dims);
+  attrs["dtype"] = static_cast<int>(dtype);
+  attrs["value"] = value;
+  return attrs;
+}
+
 void BasicEngine::Init(VarBase* var, const detail::BackwardStrategy& strategy) {
   backward_strategy_ = strategy;
   const std::vector<OpBase*> ops = var->GradVarBase()->GradOps();
@@ -76,6 +91,12 @@ void BasicEngine::Init(VarBase* var, const detail::BackwardStrategy& strategy) {
   grad_var->Resize(fwd_var.dims());
   grad_var->mutable_data(fwd_var.place(), fwd_var.type());
   operators::math::set_constant(*dev_ctx, grad_var, 1.0);
+
+  if (program_desc_tracer_) {
+    program_desc_tracer_->InsertOp(
+        "fill_constant", {}, {{"Out", {var->GradVarBase()}}},
+        FillConstantAttrs(fwd_var.dims(), fwd_var.type(), 1.0f));
+  }
 }
 
 void BasicEngine::CheckBackwardInputs(OpBase* op) {
@@ -84,12 +105,20 @@ void BasicEngine::CheckBackwardInputs(OpBase* op) {
       if (var && IsGrad(var.get())) {
         // if grad var has OverridedStopGradient skip this Op
         if (!var->GradGenerated()) {
+          // No op writes the var in backward, it is set to zero only once
+          // so that the ops reading it may run at the same time.
+          if (!zero_filled_grad_vars_.insert(var.get()).second) continue;
           VLOG(6) << "Set ungenerated Grad: " << var->Name() << " as zero";
           auto* dev_ctx =
               platform::DeviceContextPool::Instance().Get(op->place());
           auto* tensor = var->MutableVar()->GetMutable<framework::LoDTensor>();
           tensor->mutable_data(op->place(), var->DataType());
           operators::math::set_constant(*dev_ctx, tensor, 0.0);
+          if (program_desc_tracer_) {
+            program_desc_tracer_->InsertOp(
+                "fill_constant", {}, {{"Out", {var}}},
+                FillConstantAttrs(tensor->dims(), var->DataType(), 0.0f));
+          }
         } else {
           continue;
         }
@@ -172,77 +201,221 @@ void BasicEngine::SumGradient(OpBase* op, std::shared_ptr<VarBase> src,
   PADDLE_ENFORCE_EQ(iter != accumulators_.end(), true,
                     "Cannot find gradient of variable %s", dst->Name());
   iter->second->Add(std::move(src), op->id());
+  if (iter->second->IncreaseAddedCnt() && reducer_) {
+    reducer_->MarkGradReady(dst);
+  }
 }
-void BasicEngine::Execute() {
-  PrepareDeps();
-  // Start execute Computation graph
-  std::queue<OpBase*> q;
-  for (const auto& init_op : init_ops_) {
-    q.push(init_op);
+
+void BasicEngine::TraceSumGradient(const std::shared_ptr<VarBase>& src,
+                                   const std::shared_ptr<VarBase>& dst) {
+  // The first gradient overwrites dst, the later ones are added to it, which
+  // is what EagerGradientAccumulator does. The sum order of
+  // SortedGradientAccumulator is not kept.
+  bool first = traced_grad_vars_.insert(dst.get()).second;
+  if (dst->OverridedStopGradient()) {
+    if (first) {
+      program_desc_tracer_->InsertOp("fill_zeros_like", {{"X", {src}}},
+                                     {{"Out", {dst}}}, {});
+    }
+  } else if (first) {
+    program_desc_tracer_->InsertOp("assign", {{"X", {src}}}, {{"Out", {dst}}},
+                                   {});
+  } else {
+    program_desc_tracer_->InsertOp("sum", {{"X", {dst, src}}},
+                                   {{"Out", {dst}}}, {});
   }
-  while (!q.empty()) {
-    OpBase* cur_op = q.front();
-    q.pop();
+}
+NameVarBaseMap BasicEngine::PrepareGradOutputs(
+    OpBase* op, GradVarPairList* need_accu_var_list) {
+  NameVarBaseMap tmp_outs(op->GetOutsMap());
+  // 1. construct the output map 2. replace the element in the map
+  // A var may be coresponding to several grad var in one op
+  for (auto it = tmp_outs.begin(); it != tmp_outs.end(); ++it) {
+    for (size_t i = 0; i < it->second.size(); ++i) {
+      auto tmp_var =
+          std::make_shared<VarBase>(false, "Gtmp@");  // Do not need grad
+
+      auto var = it->second[i];
+      it->second[i] = tmp_var;
+      if (var) {
+        need_accu_var_list->emplace_back(var, std::move(tmp_var));
+        var->ClearGradOps();
+      }
+    }
+  }
+  return tmp_outs;
+}
 
-    // CheckBackWardInput
-    CheckBackwardInputs(cur_op);
+void BasicEngine::RunGradOp(OpBase* op, const NameVarBaseMap& tmp_outs,
+                            GradVarPairList* need_accu_var_list) {
+  // Step 1: Run Backward
+  auto& bwd_ins = op->GetInsMap();
+  VLOG(3) << "Start to execute grad op " << op->Type();
+  RunOp(op, bwd_ins, tmp_outs, op->place());
+  if (program_desc_tracer_) {
+    program_desc_tracer_->InsertOp(op->Type(), bwd_ins, tmp_outs, op->Attrs());
+  }
 
-    // Step 1: Run Backward
-    auto& bwd_ins = cur_op->GetInsMap();
-    auto& bwd_outs = cur_op->GetOutsMap();
-
-    NameVarBaseMap tmp_outs(bwd_outs);
-    // 1. construct the output map 2. replace the element in the map
-    // A var may be coresponding to several grad var in one op
-    for (auto it = tmp_outs.begin(); it != tmp_outs.end(); ++it) {
-      for (size_t i = 0; i < it->second.size(); ++i) {
-        auto tmp_var =
-            std::make_shared<VarBase>(false, "Gtmp@");  // Do not need grad
-
-        auto var = it->second[i];
-        it->second[i] = tmp_var;
-        if (var) {
-          need_accu_var_list_.emplace_back(
-              make_pair(var.get(), std::move(tmp_var)));
-          var->ClearGradOps();
-        }
-      }
+  // Step 2: Sum Gradient
+  for (auto& pair : *need_accu_var_list) {
+    if (program_desc_tracer_) {
+      TraceSumGradient(pair.second, pair.first);
     }
+    SumGradient(op, std::move(pair.second), pair.first.get());
+  }
+  need_accu_var_list->clear();
+}
 
-    VLOG(3) << "Start to execute grad op " << cur_op->Type();
-    RunOp(cur_op, bwd_ins, tmp_outs, cur_op->place());
-    // Step 2: Sum Gradient
+void BasicEngine::CollectReadyOps(OpBase* op, std::deque<OpBase*>* ready_ops) {
+  for (auto* grad_pending_op : op->GradPendingOps()) {
+    PADDLE_ENFORCE_NOT_NULL(grad_pending_op);
+    auto iter = op_deps_.find(grad_pending_op);
+    if (iter == op_deps_.end()) {
+      continue;
+    }
 
-    if (need_accu_var_list_.size() > 0) {
-      for (auto& pair : need_accu_var_list_) {
-        SumGradient(cur_op, std::move(pair.second), pair.first);
-      }
+    VLOG(3) << "Found grad_pending op of " << op->Type();
+    // An Op is ready to go while its deps comes to zero
+
+    if (--(iter->second) == 0) {
+      ready_ops->push_back(grad_pending_op);
+      VLOG(3) << "Push grad_pending op " << grad_pending_op->Type()
+              << " into queue";
     }
+  }
+}
 
-    need_accu_var_list_.clear();
+void BasicEngine::ExecuteSerially() {
+  std::deque<OpBase*> q(init_ops_.begin(), init_ops_.end());
+  GradVarPairList need_accu_var_list;
+  while (!q.empty()) {
+    OpBase* cur_op = q.front();
+    q.pop_front();
+
+    // CheckBackWardInput
+    CheckBackwardInputs(cur_op);
+
+    auto tmp_outs = PrepareGradOutputs(cur_op, &need_accu_var_list);
+    RunGradOp(cur_op, tmp_outs, &need_accu_var_list);
 
     // Step 3: Collect ready ops
+    CollectReadyOps(cur_op, &q);
 
-    for (auto* grad_pending_op : cur_op->GradPendingOps()) {
-      PADDLE_ENFORCE_NOT_NULL(grad_pending_op);
-      auto iter = op_deps_.find(grad_pending_op);
-      if (iter == op_deps_.end()) {
-        continue;
+    // Step 4: Delete op to collect unused variables
+    VLOG(3) << "Remove op after op " << cur_op->Type() << " runs";
+    RemoveOp(cur_op);
+  }
+}
+
+void BasicEngine::ExecuteInParallel(size_t num_threads) {
+  if (thread_pool_ == nullptr || thread_pool_size_ != num_threads) {
+    thread_pool_.reset(new framework::ThreadPool(num_threads));
+    thread_pool_size_ = num_threads;
+  }
+
+  // The ops are scheduled by this thread, the pool threads only run them
+  // and sum their gradients, whose accumulators are thread safe. The deps
+  // of an op make it run after all the ops writing its input gradients.
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<OpBase*> finished_ops;
+  size_t num_running_ops = 0;
+  std::exception_ptr exception;
+
+  std::deque<OpBase*> ready_ops(init_ops_.begin(), init_ops_.end());
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    for (auto* op : finished_ops) {
+      if (!exception) {
+        CollectReadyOps(op, &ready_ops);
       }
+      VLOG(3) << "Remove op after op " << op->Type() << " runs";
+      RemoveOp(op);
+    }
+    finished_ops.clear();
 
-      VLOG(3) << "Found grad_pending op of " << cur_op->Type();
-      // An Op is ready to go while its deps comes to zero
+    if (exception) {
+      ready_ops.clear();
+    }
+    if (ready_ops.empty()) {
+      if (num_running_ops == 0) break;
+      cv.wait(lock);
+      continue;
+    }
 
-      if (--(iter->second) == 0) {
-        q.push(grad_pending_op);
-        VLOG(3) << "Push grad_pending op " << grad_pending_op->Type()
-                << " into queue";
+    OpBase* cur_op = ready_ops.front();
+    ready_ops.pop_front();
+    ++num_running_ops;
+    lock.unlock();
+
+    auto need_accu_var_list = std::make_shared<GradVarPairList>();
+    std::shared_ptr<NameVarBaseMap> tmp_outs;
+    try {
+      CheckBackwardInputs(cur_op);
+      tmp_outs = std::make_shared<NameVarBaseMap>(
+          PrepareGradOutputs(cur_op, need_accu_var_list.get()));
+    } catch (...) {
+      // The running ops still use the locals, so the exception is rethrown
+      // after they finish like the one of a grad op.
+      lock.lock();
+      if (!exception) {
+        exception = std::current_exception();
       }
+      finished_ops.push_back(cur_op);
+      --num_running_ops;
+      continue;
+    }
+    auto run_op = [=, &mutex, &cv, &finished_ops, &num_running_ops,
+                   &exception] {
+      std::exception_ptr op_exception;
+      try {
+        RunGradOp(cur_op, *tmp_outs, need_accu_var_list.get());
+      } catch (...) {
+        op_exception = std::current_exception();
+      }
+      std::lock_guard<std::mutex> guard(mutex);
+      if (op_exception && !exception) {
+        exception = op_exception;
+      }
+      finished_ops.push_back(cur_op);
+      --num_running_ops;
+      cv.notify_one();
+    };
+    if (platform::is_cpu_place(cur_op->place())) {
+      thread_pool_->Run(std::move(run_op));
+    } else {
+      // The handles of a device context are not to be used by several
+      // threads, so the grad ops of devices are run by this thread.
+      run_op();
     }
 
-    // Step 4: Delete op to collect unused variables
-    VLOG(3) << "Remove op after op " << cur_op->Type() << " runs";
-    RemoveOp(cur_op);
+    lock.lock();
+  }
+
+  if (exception) {
+    CleanEngine();
+    std::rethrow_exception(exception);
+  }
+}
+
+void BasicEngine::Execute() {
+  PrepareDeps();
+  if (reducer_) {
+    // Only the gradients with accumulators are computed by the backward.
+    reducer_->PrepareForBackward([this](VarBase* grad_var) {
+      return accumulators_.count(grad_var) > 0;
+    });
+  }
+  // Start execute Computation graph
+  size_t num_threads = GetBackwardThreadNum();
+  if (num_threads > 1 && program_desc_tracer_ == nullptr) {
+    VLOG(3) << "Run backward with " << num_threads << " threads";
+    ExecuteInParallel(num_threads);
+  } else {
+    ExecuteSerially();
+  }
+  if (reducer_) {
+    reducer_->FinalizeBackward();
   }
   VLOG(3) << "Clean properties of BasicEngine";
   CleanEngine();
@@ -16,14 +16,18 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
+#include "paddle/fluid/framework/threadpool.h"
 #include "paddle/fluid/imperative/backward_strategy.h"
 #include "paddle/fluid/imperative/gradient_accumulator.h"
+#include "paddle/fluid/imperative/jit/program_desc_tracer.h"
 #include "paddle/fluid/imperative/layer.h"
+#include "paddle/fluid/imperative/reducer.h"
 
 namespace paddle {
 namespace imperative {
@@ -66,6 +70,22 @@ class Engine {
     grad_vars_.clear();
   }
 
+  // The ops run in backward, including the initialization and the
+  // accumulation of gradients, are recorded into tracer when it is not null.
+  void SetProgramDescTracer(jit::ProgramDescTracer* tracer) {
+    program_desc_tracer_ = tracer;
+  }
+
+  // The gradients of data parallel training are all-reduced by reducer
+  // during backward when it is not null.
+  void SetReducer(std::shared_ptr<Reducer> reducer) {
+    reducer_ = std::move(reducer);
+  }
+
+ protected:
+  jit::ProgramDescTracer* program_desc_tracer_{nullptr};
+  std::shared_ptr<Reducer> reducer_;
+
  private:
   std::unordered_map<OpBase*, std::shared_ptr<OpBase>>
       grad_ops_;  // opBase for remove - grad_op
@@ -80,9 +100,15 @@ class BasicEngine : public Engine {
 
   ~BasicEngine() override = default;
 
+  // Runs the grad ops whose grad pending ops have all run. The CPU grad ops
+  // are run by FLAGS_dygraph_backward_threads threads when it is larger
+  // than 1, except when the ops are traced into a ProgramDesc.
   void Execute() override;
 
  private:
+  using GradVarPairList = std::vector<
+      std::pair<std::shared_ptr<VarBase>, std::shared_ptr<VarBase>>>;
+
   void PrepareDeps();
 
   void CheckBackwardInputs(OpBase* op);
@@ -91,14 +117,36 @@ class BasicEngine : public Engine {
 
   void PrepareGradAccumulators(OpBase* op);
 
+  // Returns the outputs of op replaced by temporary vars, the pairs of the
+  // gradient and its temporary var are appended to need_accu_var_list.
+  NameVarBaseMap PrepareGradOutputs(OpBase* op,
+                                    GradVarPairList* need_accu_var_list);
+
+  // Runs op and sums its outputs into the gradients. It may be called by
+  // several threads at the same time.
+  void RunGradOp(OpBase* op, const NameVarBaseMap& tmp_outs,
+                 GradVarPairList* need_accu_var_list);
+
+  // Appends the grad pending ops of op which are ready to run to ready_ops.
+  void CollectReadyOps(OpBase* op, std::deque<OpBase*>* ready_ops);
+
+  void ExecuteSerially();
+
+  void ExecuteInParallel(size_t num_threads);
+
   void SumGradient(OpBase* op, std::shared_ptr<VarBase> src, VarBase* dst);
 
+  void TraceSumGradient(const std::shared_ptr<VarBase>& src,
+                        const std::shared_ptr<VarBase>& dst);
+
   // TODO(jiabin): maybe we can optimize the performance of engine by cache the
   // result
   void CleanEngine() {
     init_ops_.clear();
     op_deps_.clear();
     accumulators_.clear();
+    zero_filled_grad_vars_.clear();
+    traced_grad_vars_.clear();
     Clear();
   }
 
@@ -108,8 +156,13 @@ class BasicEngine : public Engine {
   std::unordered_map<VarBase*, std::unique_ptr<GradientAccumulator>>
       accumulators_;
 
-  std::vector<std::pair<VarBase*, std::shared_ptr<VarBase>>>
-      need_accu_var_list_;
+  // The ungenerated gradients which have been set to zero in this backward.
+  std::unordered_set<VarBase*> zero_filled_grad_vars_;
+  // The gradients whose accumulation has been traced in this backward.
+  std::unordered_set<VarBase*> traced_grad_vars_;
+
+  std::unique_ptr<framework::ThreadPool> thread_pool_;
+  size_t thread_pool_size_{0};
 };
 
 }  // namespace imperative
@@ -18,6 +18,12 @@
 DEFINE_uint64(dygraph_debug, 0,
               "Debug level of dygraph. This flag is not "
               "open to users");
+DEFINE_bool(dygraph_dispatch_cache, true,
+            "Cache the selected kernels and inferred var types of dygraph "
+            "ops, and share the operator instances of each op type");
+DEFINE_int32(dygraph_backward_threads, 1,
+             "The number of threads running the independent CPU grad ops of "
+             "dygraph backward at the same time, 1 runs them one by one");
 
 namespace paddle {
 namespace imperative {
@@ -26,5 +32,13 @@ bool IsDebugEnabled() { return FLAGS_dygraph_debug != 0; }
 
 uint64_t GetDebugLevel() { return FLAGS_dygraph_debug; }
 
+bool IsDispatchCacheEnabled() { return FLAGS_dygraph_dispatch_cache; }
+
+size_t GetBackwardThreadNum() {
+  return FLAGS_dygraph_backward_threads > 1
+             ? static_cast<size_t>(FLAGS_dygraph_backward_threads)
+             : 1;
+}
+
 }  // namespace imperative
 }  // namespace paddle
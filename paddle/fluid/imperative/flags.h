@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 
 namespace paddle {
@@ -21,6 +22,8 @@ namespace imperative {
 
 extern bool IsDebugEnabled();
 extern uint64_t GetDebugLevel();
+extern bool IsDispatchCacheEnabled();
+extern size_t GetBackwardThreadNum();
 
 }  // namespace imperative
 }  // namespace paddle
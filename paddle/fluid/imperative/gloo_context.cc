@@ -0,0 +1,103 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/imperative/gloo_context.h"
+#include <vector>
+#ifdef PADDLE_WITH_GLOO
+#include <gloo/allreduce.h>
+#include <gloo/broadcast.h>
+#include <gloo/math.h>
+#include <gloo/rendezvous/context.h>
+#include <gloo/rendezvous/file_store.h>
+#include <gloo/rendezvous/prefix_store.h>
+#include <gloo/transport/tcp/device.h>
+#endif
+
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/string/split.h"
+
+namespace paddle {
+namespace imperative {
+#if defined(PADDLE_WITH_GLOO)
+void GlooParallelContext::Init() {
+  gloo::transport::tcp::attr attr;
+  auto addr = string::Split(strategy_.current_endpoint_, ':');
+  if (!addr.empty() && !addr[0].empty()) {
+    attr.hostname = addr[0];
+  }
+  auto file_store = gloo::rendezvous::FileStore(store_path_);
+  auto prefix_store = gloo::rendezvous::PrefixStore("dygraph", file_store);
+  auto dev = gloo::transport::tcp::CreateDevice(attr);
+  auto context = std::make_shared<gloo::rendezvous::Context>(
+      strategy_.local_rank_, strategy_.nranks_);
+  context->connectFullMesh(prefix_store, dev);
+  context_ = std::move(context);
+  VLOG(3) << "Init gloo context of rank " << strategy_.local_rank_ << " in "
+          << strategy_.nranks_ << " ranks";
+}
+
+template <typename T>
+static void GlooAllReduce(const std::shared_ptr<gloo::Context>& context,
+                          framework::Tensor* tensor) {
+  gloo::AllreduceOptions opts(context);
+  // Without input, gloo reduces the output in place.
+  opts.setOutput(tensor->data<T>(), tensor->numel());
+  opts.setReduceFunction(
+      static_cast<void (*)(void*, const void*, const void*, size_t)>(
+          &gloo::sum<T>));
+  gloo::allreduce(opts);
+}
+
+void GlooParallelContext::AllReduce(framework::Tensor* tensor) {
+  PADDLE_ENFORCE_NOT_NULL(context_, platform::errors::PreconditionNotMet(
+                                        "GlooParallelContext is not inited"));
+  PADDLE_ENFORCE_EQ(
+      platform::is_cpu_place(tensor->place()), true,
+      platform::errors::InvalidArgument("Gloo only reduces CPU tensors"));
+  switch (tensor->type()) {
+    case framework::proto::VarType::FP32:
+      GlooAllReduce<float>(context_, tensor);
+      break;
+    case framework::proto::VarType::FP64:
+      GlooAllReduce<double>(context_, tensor);
+      break;
+    case framework::proto::VarType::INT32:
+      GlooAllReduce<int>(context_, tensor);
+      break;
+    case framework::proto::VarType::INT64:
+      GlooAllReduce<int64_t>(context_, tensor);
+      break;
+    default:
+      PADDLE_THROW(platform::errors::Unimplemented(
+          "Gloo AllReduce of %s is not supported",
+          framework::DataTypeToString(tensor->type())));
+  }
+}
+
+void GlooParallelContext::Broadcast(framework::Tensor* tensor, int root) {
+  PADDLE_ENFORCE_NOT_NULL(context_, platform::errors::PreconditionNotMet(
+                                        "GlooParallelContext is not inited"));
+  PADDLE_ENFORCE_EQ(
+      platform::is_cpu_place(tensor->place()), true,
+      platform::errors::InvalidArgument("Gloo only broadcasts CPU tensors"));
+  gloo::BroadcastOptions opts(context_);
+  opts.setOutput(static_cast<uint8_t*>(tensor->data<void>()),
+                 tensor->numel() * framework::SizeOfType(tensor->type()));
+  opts.setRoot(root);
+  gloo::broadcast(opts);
+}
+#endif
+
+}  //  namespace imperative
+}  //  namespace paddle
@@ -0,0 +1,54 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#ifdef PADDLE_WITH_GLOO
+#include <gloo/context.h>
+#endif
+
+#include "paddle/fluid/imperative/nccl_context.h"
+
+namespace paddle {
+namespace imperative {
+
+#if defined(PADDLE_WITH_GLOO)
+// GlooParallelContext runs the collectives of dygraph data parallel on CPU
+// by gloo over TCP. The ranks meet by the files in store_path, which is to
+// be shared by all the trainers, e.g. on a network file system.
+class GlooParallelContext : public ParallelContext {
+ public:
+  GlooParallelContext(const ParallelStrategy& strategy,
+                      const std::string& store_path)
+      : ParallelContext(strategy, platform::CPUPlace()),
+        store_path_(store_path) {}
+
+  ~GlooParallelContext() override {}
+
+  void Init() override;
+
+  void AllReduce(framework::Tensor* tensor) override;
+
+  void Broadcast(framework::Tensor* tensor, int root) override;
+
+ private:
+  std::string store_path_;
+  std::shared_ptr<gloo::Context> context_;
+};
+#endif
+
+}  //  namespace imperative
+}  //  namespace paddle
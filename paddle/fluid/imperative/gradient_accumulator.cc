@@ -233,6 +233,7 @@ platform::Place GetPlaceOfVarBase(const std::shared_ptr<VarBase>& var) {
 
 void EagerGradientAccumulator::Add(std::shared_ptr<VarBase> var,
                                    size_t trace_id) {
+  std::lock_guard<std::mutex> guard(mutex_);
   auto* dst_var = var_->MutableVar();
   platform::Place place = GetPlaceOfVarBase(var);
   if (!var_->OverridedStopGradient()) {
@@ -270,6 +271,7 @@ void EagerGradientAccumulator::Add(std::shared_ptr<VarBase> var,
 
 void SortedGradientAccumulator::Add(std::shared_ptr<VarBase> var,
                                     size_t trace_id) {
+  std::lock_guard<std::mutex> guard(mutex_);
   auto* dst_var = var_->MutableVar();
   platform::Place place = GetPlaceOfVarBase(var);
   if (!var_->OverridedStopGradient()) {
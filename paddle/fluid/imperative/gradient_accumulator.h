@@ -14,7 +14,9 @@
 
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <utility>
 #include <vector>
 #include "paddle/fluid/imperative/layer.h"
@@ -22,6 +24,8 @@
 namespace paddle {
 namespace imperative {
 
+// The Add of accumulators may be called by several threads at the same time
+// when the backward runs in parallel, see BasicEngine::Execute.
 class GradientAccumulator {
  public:
   explicit GradientAccumulator(VarBase* var) : var_(var) {}
@@ -34,9 +38,15 @@ class GradientAccumulator {
 
   inline size_t RefCnt() const { return ref_cnt_; }
 
+  // Called after each Add, returns true when all the RefCnt() gradients are
+  // added, i.e. the sum is completed.
+  inline bool IncreaseAddedCnt() { return ++added_cnt_ == ref_cnt_; }
+
  protected:
   VarBase* var_;
   size_t ref_cnt_{0};
+  std::atomic<size_t> added_cnt_{0};
+  std::mutex mutex_;
 };
 
 class EagerGradientAccumulator : public GradientAccumulator {
@@ -215,6 +215,18 @@ void ProgramDescTracer::InsertVarIfNotExist(
   }
 
   const auto &inner_var = new_var->Var();
+  if (!inner_var.IsInitialized() && !is_input) {
+    // The outputs of the backward accumulation are traced before they hold
+    // any tensor, see BasicEngine::TraceSumGradient.
+    PADDLE_ENFORCE_EQ(
+        new_var->Type(), framework::proto::VarType::LOD_TENSOR,
+        platform::errors::Unimplemented(
+            "Uninitialized output %s of type %d cannot be traced",
+            new_var->Name(), new_var->Type()));
+    new_var_desc->SetType(framework::proto::VarType::LOD_TENSOR);
+    new_var_desc->SetDataType(new_var->DataType());
+    return;
+  }
   PADDLE_ENFORCE_EQ(inner_var.IsInitialized(), true);
   if (inner_var.IsType<framework::LoDTensor>()) {
     const auto &tensor = inner_var.Get<framework::LoDTensor>();
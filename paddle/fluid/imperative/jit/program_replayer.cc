@@ -0,0 +1,203 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/imperative/jit/program_replayer.h"
+#include <utility>
+#include "paddle/fluid/framework/ir/fuse_pass_base.h"
+#include "paddle/fluid/framework/ir/graph.h"
+#include "paddle/fluid/framework/ir/pass.h"
+#include "paddle/fluid/framework/lod_tensor.h"
+
+namespace paddle {
+namespace imperative {
+namespace jit {
+
+static void ShareLoDTensor(const framework::LoDTensor &src,
+                           framework::LoDTensor *dst) {
+  dst->ShareDataWith(src);
+  dst->set_lod(src.lod());
+}
+
+ProgramReplayer::ProgramReplayer(
+    const framework::ProgramDesc &program,
+    const std::vector<std::string> &feed_names,
+    const std::vector<std::string> &fetch_names,
+    const std::vector<std::shared_ptr<VarBase>> &persistable_vars,
+    const std::vector<std::string> &passes, const platform::Place &place)
+    : traced_program_(program),
+      feed_names_(feed_names),
+      fetch_names_(fetch_names),
+      persistable_vars_(persistable_vars),
+      executor_(place) {
+  auto &block = traced_program_.Block(0);
+  for (auto &name : feed_names_) {
+    PADDLE_ENFORCE_NOT_NULL(
+        block.FindVar(name),
+        platform::errors::NotFound("Feed var %s is not in the program", name));
+  }
+  for (auto &var : persistable_vars_) {
+    PADDLE_ENFORCE_NOT_NULL(
+        block.FindVar(var->Name()),
+        platform::errors::NotFound("Persistable var %s is not in the program",
+                                   var->Name()));
+  }
+
+  // The fusion passes may read the parameters in scope.
+  SharePersistableVars();
+  ApplyPasses(passes);
+
+  executor_.CreateVariables(*program_, &scope_, 0);
+  // The fetched vars are read after running, they must not be collected by
+  // the eager deletion of the executor.
+  ctx_ = framework::Executor::Prepare(*program_, 0, fetch_names_);
+}
+
+void ProgramReplayer::ApplyPasses(const std::vector<std::string> &passes) {
+  if (passes.empty()) {
+    program_.reset(new framework::ProgramDesc(traced_program_));
+    return;
+  }
+
+  std::unique_ptr<framework::ir::Graph> graph(
+      new framework::ir::Graph(traced_program_));
+  graph->SetNotOwned(framework::ir::kParamScopeAttr, &scope_);
+  for (auto &pass_name : passes) {
+    VLOG(3) << "Apply pass " << pass_name << " to the traced program";
+    auto pass = framework::ir::PassRegistry::Instance().Get(pass_name);
+    graph.reset(pass->Apply(graph.release()));
+  }
+
+  program_.reset(new framework::ProgramDesc());
+  program_->CopyFrom(*traced_program_.Proto());
+  auto pass =
+      framework::ir::PassRegistry::Instance().Get("graph_to_program_pass");
+  pass->SetNotOwned("program", program_.get());
+  graph.reset(pass->Apply(graph.release()));
+}
+
+void ProgramReplayer::SharePersistableVars() {
+  for (auto &var : persistable_vars_) {
+    auto *tensor = scope_.Var(var->Name())->GetMutable<framework::LoDTensor>();
+    ShareLoDTensor(var->Var().Get<framework::LoDTensor>(), tensor);
+  }
+}
+
+bool ProgramReplayer::IsReplayable(
+    const std::vector<std::shared_ptr<VarBase>> &feeds) const {
+  if (feeds.size() != feed_names_.size()) {
+    VLOG(3) << "Cannot replay with " << feeds.size() << " feeds, "
+            << feed_names_.size() << " are traced";
+    return false;
+  }
+
+  auto &block = traced_program_.Block(0);
+  for (size_t i = 0; i < feeds.size(); ++i) {
+    auto *var_desc = block.FindVar(feed_names_[i]);
+    const auto &var = feeds[i]->Var();
+    if (!var.IsType<framework::LoDTensor>() ||
+        !var.Get<framework::LoDTensor>().IsInitialized()) {
+      VLOG(3) << "Cannot replay with feed " << feeds[i]->Name()
+              << " which is not an initialized LoDTensor";
+      return false;
+    }
+    const auto &tensor = var.Get<framework::LoDTensor>();
+    if (tensor.type() != var_desc->GetDataType() ||
+        framework::vectorize<int64_t>(tensor.dims()) != var_desc->GetShape() ||
+        tensor.lod().size() != static_cast<size_t>(var_desc->GetLoDLevel())) {
+      VLOG(3) << "Cannot replay with feed " << feeds[i]->Name()
+              << " of shape " << tensor.dims()
+              << ", whose shape, data type or lod level differs from "
+              << feed_names_[i];
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ProgramReplayer::IsSameTrace(const framework::ProgramDesc &program) const {
+  auto &block = traced_program_.Block(0);
+  auto &other = program.Block(0);
+  if (block.OpSize() != other.OpSize()) return false;
+  for (size_t i = 0; i < block.OpSize(); ++i) {
+    auto *op = block.Op(static_cast<int>(i));
+    auto *other_op = other.Op(static_cast<int>(i));
+    if (op->Type() != other_op->Type() || op->Inputs() != other_op->Inputs() ||
+        op->Outputs() != other_op->Outputs() ||
+        op->GetAttrMap() != other_op->GetAttrMap()) {
+      VLOG(3) << "Op " << i << " " << other_op->Type()
+              << " differs from the replayed " << op->Type();
+      return false;
+    }
+  }
+
+  auto other_vars = other.AllVars();
+  if (other_vars.size() != block.AllVars().size()) return false;
+  for (auto *other_var : other_vars) {
+    auto *var = block.FindVar(other_var->Name());
+    if (var == nullptr || var->GetType() != other_var->GetType() ||
+        var->GetDataType() != other_var->GetDataType() ||
+        var->GetShape() != other_var->GetShape() ||
+        var->Persistable() != other_var->Persistable()) {
+      VLOG(3) << "Var " << other_var->Name() << " differs from the replayed";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ProgramReplayer::Run(const std::vector<std::shared_ptr<VarBase>> &feeds,
+                          std::vector<std::shared_ptr<VarBase>> *fetches) {
+  if (!IsReplayable(feeds)) return false;
+
+  // The VarBase may get new tensors between runs, e.g. by set_value, so they
+  // are shared again on every run.
+  SharePersistableVars();
+  for (size_t i = 0; i < feeds.size(); ++i) {
+    auto *tensor =
+        scope_.Var(feed_names_[i])->GetMutable<framework::LoDTensor>();
+    ShareLoDTensor(feeds[i]->Var().Get<framework::LoDTensor>(), tensor);
+  }
+
+  executor_.RunPreparedContext(ctx_.get(), &scope_,
+                               /*create_local_scope=*/false,
+                               /*create_vars=*/false);
+
+  // The ops may allocate new tensors for their outputs, e.g. when the shape
+  // of a persistable var changes, which are given back to the VarBase.
+  for (auto &var : persistable_vars_) {
+    const auto &tensor =
+        scope_.FindVar(var->Name())->Get<framework::LoDTensor>();
+    ShareLoDTensor(tensor,
+                   var->MutableVar()->GetMutable<framework::LoDTensor>());
+  }
+
+  fetches->clear();
+  fetches->reserve(fetch_names_.size());
+  for (auto &name : fetch_names_) {
+    auto *tensor = scope_.FindVar(name)->GetMutable<framework::LoDTensor>();
+    std::shared_ptr<VarBase> fetch(new VarBase(false, name));
+    ShareLoDTensor(*tensor,
+                   fetch->MutableVar()->GetMutable<framework::LoDTensor>());
+    fetch->SetType(framework::proto::VarType::LOD_TENSOR);
+    fetch->SetDataType(tensor->type());
+    // The next run must not write into the fetched tensor.
+    tensor->clear();
+    fetches->emplace_back(std::move(fetch));
+  }
+  return true;
+}
+
+}  // namespace jit
+}  // namespace imperative
+}  // namespace paddle
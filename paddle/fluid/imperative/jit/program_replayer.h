@@ -0,0 +1,81 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "paddle/fluid/framework/executor.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+#include "paddle/fluid/imperative/layer.h"
+#include "paddle/fluid/platform/macros.h"
+#include "paddle/fluid/platform/place.h"
+
+namespace paddle {
+namespace imperative {
+namespace jit {
+
+// ProgramReplayer runs a step of dygraph traced by ProgramDescTracer, forward
+// and backward included, with the static Executor. The IR passes are applied
+// and the ops are prepared once, so the later steps skip the tracing and the
+// kernel dispatching of dygraph. The persistable vars are shared with their
+// VarBase, the feeds and fetches are VarBase too.
+class ProgramReplayer {
+  DISABLE_COPY_AND_ASSIGN(ProgramReplayer);
+
+ public:
+  ProgramReplayer(const framework::ProgramDesc &program,
+                  const std::vector<std::string> &feed_names,
+                  const std::vector<std::string> &fetch_names,
+                  const std::vector<std::shared_ptr<VarBase>> &persistable_vars,
+                  const std::vector<std::string> &passes,
+                  const platform::Place &place);
+
+  // Whether feeds have the var types, data types, shapes and lod levels of
+  // the traced feeds.
+  bool IsReplayable(const std::vector<std::shared_ptr<VarBase>> &feeds) const;
+
+  // Whether program, which is traced from another step, has the same ops and
+  // vars as the replayed one. The control flow of the step changed if not.
+  bool IsSameTrace(const framework::ProgramDesc &program) const;
+
+  // Returns false without running anything when feeds are not replayable,
+  // the step should be run by dygraph then.
+  bool Run(const std::vector<std::shared_ptr<VarBase>> &feeds,
+           std::vector<std::shared_ptr<VarBase>> *fetches);
+
+  const framework::ProgramDesc &Program() const { return *program_; }
+
+ private:
+  void ApplyPasses(const std::vector<std::string> &passes);
+
+  void SharePersistableVars();
+
+ private:
+  framework::ProgramDesc traced_program_;
+  std::unique_ptr<framework::ProgramDesc> program_;
+  std::vector<std::string> feed_names_;
+  std::vector<std::string> fetch_names_;
+  std::vector<std::shared_ptr<VarBase>> persistable_vars_;
+
+  framework::Scope scope_;
+  framework::Executor executor_;
+  std::unique_ptr<framework::ExecutorPrepareContext> ctx_;
+};
+
+}  // namespace jit
+}  // namespace imperative
+}  // namespace paddle
@@ -19,6 +19,7 @@
 #include "paddle/fluid/framework/framework.pb.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/variable_helper.h"
+#include "paddle/fluid/imperative/dispatch_cache.h"
 #include "paddle/fluid/imperative/prepared_operator.h"
 #include "paddle/fluid/operators/math/math_function.h"
 #include "paddle/fluid/platform/device_context.h"
@@ -281,6 +282,91 @@ std::shared_ptr<VarBase> VarBase::NewVarBase(const platform::Place& dst_place,
     return new_var;
   }
 }
+
+static std::shared_ptr<framework::OperatorBase> CreateOperator(
+    const std::string& type) {
+  if (IsDispatchCacheEnabled()) {
+    return DispatchCache::Instance().GetOperator(type);
+  }
+  return framework::OpRegistry::CreateOp(type, {}, {}, {}, false);
+}
+
+// Records the var type changes made on the outputs, so that they can be
+// replayed on the outputs of later runs with the same DispatchEntry.
+class RecordingInferVarTypeContext : public RuntimeInferVarTypeContext {
+ public:
+  RecordingInferVarTypeContext(const NameVarBaseMap& inputs,
+                               const NameVarBaseMap* outputs,
+                               const framework::AttributeMap& attrs_map)
+      : RuntimeInferVarTypeContext(inputs, outputs, attrs_map) {
+    size_t idx = 0;
+    for (auto& pair : *outputs) {
+      for (auto& var : pair.second) {
+        out_idx_.emplace(var->Name(), idx++);
+      }
+    }
+  }
+
+  void SetType(const std::string& name,
+               framework::proto::VarType::Type type) override {
+    RuntimeInferVarTypeContext::SetType(name, type);
+    if (name != kLookupTablePathVarName) Record(name, false, type);
+  }
+
+  void SetDataType(const std::string& name,
+                   framework::proto::VarType::Type type) override {
+    RuntimeInferVarTypeContext::SetDataType(name, type);
+    Record(name, true, type);
+  }
+
+  bool Cacheable() const { return cacheable_; }
+
+  const std::vector<DispatchEntry::VarTypeChange>& Changes() const {
+    return changes_;
+  }
+
+ private:
+  void Record(const std::string& name, bool is_data_type,
+              framework::proto::VarType::Type type) {
+    auto it = out_idx_.find(name);
+    if (it == out_idx_.end()) {
+      // Only the changes of outputs can be replayed.
+      cacheable_ = false;
+      return;
+    }
+    changes_.push_back({it->second, is_data_type, type});
+  }
+
+  std::unordered_map<std::string, size_t> out_idx_;
+  std::vector<DispatchEntry::VarTypeChange> changes_;
+  bool cacheable_{true};
+};
+
+static void ReplayVarTypeChanges(
+    const std::vector<DispatchEntry::VarTypeChange>& changes,
+    const NameVarBaseMap& outs) {
+  if (changes.empty()) return;
+  std::vector<VarBase*> out_vars;
+  for (auto& pair : outs) {
+    for (auto& var : pair.second) {
+      out_vars.emplace_back(var.get());
+    }
+  }
+  for (auto& change : changes) {
+    auto* var = out_vars.at(change.out_idx);
+    if (change.is_data_type) {
+      var->SetDataType(change.type);
+      continue;
+    }
+    // The same as RuntimeInferVarTypeContext::SetType
+    var->SetType(change.type);
+    if (var->MutableVar()->IsInitialized() &&
+        var->MutableVar()->Type() != change.type) {
+      var->MutableVar()->Clear();
+    }
+  }
+}
+
 // create OpBase from optype
 OpBase::OpBase(size_t id, const std::string& type, const NameVarBaseMap& ins,
                const NameVarBaseMap& outs, const framework::AttributeMap& attrs,
@@ -293,7 +379,7 @@ OpBase::OpBase(size_t id, const std::string& type, const NameVarBaseMap& ins,
     info.Checker()->Check(&attrs_);
   }
 
-  op_ = framework::OpRegistry::CreateOp(type, {}, {}, {}, false);
+  op_ = CreateOperator(type);
 
   VLOG(3) << "Construct Op: " << type << std::endl;
 }
@@ -303,16 +389,29 @@ void OpBase::CreateOperatorBase() {
   if (info.Checker() != nullptr) {
     info.Checker()->Check(&attrs_);
   }
-  op_ = framework::OpRegistry::CreateOp(type_, {}, {}, {}, false);
+  op_ = CreateOperator(type_);
 }
 
 void OpBase::Run(const NameVarBaseMap& ins, const NameVarBaseMap& outs) {
   auto* op_kernel = dynamic_cast<framework::OperatorWithKernel*>(op_.get());
   PADDLE_ENFORCE_NOT_NULL(op_kernel, "only support op with kernel");
   auto& info = op_->Info();
+  std::shared_ptr<DispatchEntry> entry;
+  if (IsDispatchCacheEnabled()) {
+    entry = DispatchCache::Instance().Get(Type(), place(), ins, outs, attrs_);
+  }
   if (info.infer_var_type_) {
-    RuntimeInferVarTypeContext infer_var_type_ctx(ins, &outs, attrs_);
-    info.infer_var_type_(&infer_var_type_ctx);
+    if (entry != nullptr && entry->var_types_cached) {
+      ReplayVarTypeChanges(entry->var_type_changes, outs);
+    } else if (entry != nullptr) {
+      RecordingInferVarTypeContext infer_var_type_ctx(ins, &outs, attrs_);
+      info.infer_var_type_(&infer_var_type_ctx);
+      entry->var_types_cached = infer_var_type_ctx.Cacheable();
+      entry->var_type_changes = infer_var_type_ctx.Changes();
+    } else {
+      RuntimeInferVarTypeContext infer_var_type_ctx(ins, &outs, attrs_);
+      info.infer_var_type_(&infer_var_type_ctx);
+    }
   }
   // Initialize output var type
   for (auto& var_pair : outs) {
@@ -324,7 +423,7 @@ void OpBase::Run(const NameVarBaseMap& ins, const NameVarBaseMap& outs) {
   VLOG(3) << "Running Op " << Type();
   VLOG(5) << LayerDebugString(Type(), ins, outs);
   auto prepared_op =
-      PreparedOp::Prepare(ins, outs, *op_kernel, place(), &attrs_);
+      PreparedOp::Prepare(ins, outs, *op_kernel, place(), &attrs_, entry.get());
 
   prepared_op.Run(&ins, &outs, &attrs_);
 
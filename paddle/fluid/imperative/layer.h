@@ -400,6 +400,10 @@ class DygraphExecutionContext : public framework::ExecutionContext {
   const framework::AttributeMap* attrs_;
 };
 
+// The InferVarType of the save op sets the type of this var for the pserver,
+// which is not a var in imperative mode, so setting it is skipped.
+constexpr char kLookupTablePathVarName[] = "kLookupTablePath";
+
 // infer var type context for imperative mode
 class RuntimeInferVarTypeContext : public framework::InferVarTypeContext {
  public:
@@ -482,7 +486,7 @@ class RuntimeInferVarTypeContext : public framework::InferVarTypeContext {
 
   void SetType(const std::string& name,
                framework::proto::VarType::Type type) override {
-    if (name == "kLookupTablePath") {
+    if (name == kLookupTablePathVarName) {
       VLOG(2) << "SUPER UGLY FIX, remove this when move imperative mode in C++";
     } else {
       var_set_[name]->SetType(type);
@@ -660,7 +664,7 @@ class OpBase : public std::enable_shared_from_this<OpBase> {
  private:
   size_t id_;
 
-  std::unique_ptr<framework::OperatorBase> op_;
+  std::shared_ptr<framework::OperatorBase> op_;
 
   std::vector<std::function<void()>> backward_hooks_;
   platform::Place place_;
@@ -24,6 +24,7 @@
 #include <string>
 #include <vector>
 
+#include "paddle/fluid/framework/tensor.h"
 #include "paddle/fluid/framework/variable.h"
 #include "paddle/fluid/platform/device_context.h"
 #if defined(PADDLE_WITH_NCCL)
@@ -52,6 +53,21 @@ class ParallelContext {
 
   virtual void Init() = 0;
 
+  // Sums tensor over all the ranks in place. It may be called by a thread
+  // other than the one running the backward, see Reducer.
+  virtual void AllReduce(framework::Tensor* tensor) {
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "AllReduce is not supported by this ParallelContext"));
+  }
+
+  // Sets tensor of all the ranks to the tensor of rank root.
+  virtual void Broadcast(framework::Tensor* tensor, int root) {
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "Broadcast is not supported by this ParallelContext"));
+  }
+
+  const ParallelStrategy& Strategy() const { return strategy_; }
+
  protected:
   ParallelStrategy strategy_;
   platform::Place place_;
@@ -70,14 +70,13 @@ PreparedOp::PreparedOp(const framework::OperatorBase& op,
       dev_ctx_(dev_ctx),
       kernel_configs_(kernel_configs) {}
 
-PreparedOp PreparedOp::Prepare(const NameVarBaseMap& ins,
-                               const NameVarBaseMap& outs,
-                               const framework::OperatorWithKernel& op,
-                               platform::Place place,
-                               const framework::AttributeMap* attrs) {
-  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
-  auto* dev_ctx = pool.Get(place);
-
+// Selects the kernel of op and keeps it in entry.
+static void ChooseKernel(const NameVarBaseMap& ins, const NameVarBaseMap& outs,
+                         const framework::OperatorWithKernel& op,
+                         const platform::DeviceContext& dev_ctx,
+                         const framework::RuntimeContext& ctx,
+                         const framework::AttributeMap* attrs,
+                         DispatchEntry* entry) {
   // check if op[type] has kernel registered.
   auto& all_op_kernels = op.AllOpKernels();
   auto kernels_iter = all_op_kernels.find(op.Type());
@@ -89,9 +88,8 @@ PreparedOp PreparedOp::Prepare(const NameVarBaseMap& ins,
 
   auto& kernels = kernels_iter->second;
 
-  framework::RuntimeContext ctx({}, {});
   auto expected_kernel_key = op.GetExpectedKernelType(DygraphExecutionContext(
-      op, framework::Scope(), *dev_ctx, ctx, nullptr, ins, outs, attrs));
+      op, framework::Scope(), dev_ctx, ctx, nullptr, ins, outs, attrs));
   VLOG(3) << "expected_kernel_key:" << expected_kernel_key;
 
   auto kernel_iter = kernels.find(expected_kernel_key);
@@ -100,8 +98,31 @@ PreparedOp PreparedOp::Prepare(const NameVarBaseMap& ins,
     PADDLE_THROW("op %s does not have kernel for %s", op.Type(),
                  KernelTypeToString(expected_kernel_key));
   }
-  std::vector<framework::KernelConfig>* kernel_configs =
-      op.GetKernelConfig(expected_kernel_key);
+  entry->kernel_configs = op.GetKernelConfig(expected_kernel_key);
+  entry->kernel_func = kernel_iter->second;
+  entry->kernel_key.reset(new framework::OpKernelType(expected_kernel_key));
+}
+
+PreparedOp PreparedOp::Prepare(const NameVarBaseMap& ins,
+                               const NameVarBaseMap& outs,
+                               const framework::OperatorWithKernel& op,
+                               platform::Place place,
+                               const framework::AttributeMap* attrs,
+                               DispatchEntry* entry) {
+  platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
+  auto* dev_ctx = pool.Get(place);
+
+  // PreparedOp keeps a reference of it, so it must outlive this function.
+  static const framework::RuntimeContext ctx({}, {});
+
+  DispatchEntry local_entry;
+  if (entry == nullptr) {
+    entry = &local_entry;
+  }
+  if (entry->kernel_key == nullptr) {
+    ChooseKernel(ins, outs, op, *dev_ctx, ctx, attrs, entry);
+  }
+  const auto& expected_kernel_key = *entry->kernel_key;
 
   if (!(expected_kernel_key.place_ == place)) {
     dev_ctx = pool.Get(expected_kernel_key.place_);
@@ -109,7 +130,8 @@ PreparedOp PreparedOp::Prepare(const NameVarBaseMap& ins,
   }
 
   PrepareData(place, ins, op, expected_kernel_key);
-  return PreparedOp(op, ctx, kernel_iter->second, dev_ctx, kernel_configs);
+  return PreparedOp(op, ctx, entry->kernel_func, dev_ctx,
+                    entry->kernel_configs);
 }
 
 void PreparedOp::Run(const NameVarBaseMap* in, const NameVarBaseMap* out,
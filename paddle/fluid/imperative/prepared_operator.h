@@ -20,6 +20,7 @@
 #include "paddle/fluid/framework/data_transform.h"
 #include "paddle/fluid/framework/op_kernel_type.h"
 #include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/imperative/dispatch_cache.h"
 #include "paddle/fluid/imperative/layer.h"
 #include "paddle/fluid/imperative/type_defs.h"
 
@@ -34,7 +35,8 @@ class PreparedOp {
                             const NameVarBaseMap& outs,
                             const framework::OperatorWithKernel& op,
                             platform::Place place,
-                            const framework::AttributeMap* attrs);
+                            const framework::AttributeMap* attrs,
+                            DispatchEntry* entry = nullptr);
 
   inline platform::DeviceContext* GetDeviceContext() const { return dev_ctx_; }
 
@@ -0,0 +1,231 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/imperative/reducer.h"
+#include <cstring>
+#include <exception>
+#include "paddle/fluid/framework/data_type.h"
+
+namespace paddle {
+namespace imperative {
+
+Reducer::Reducer(const std::vector<std::shared_ptr<VarBase>>& params,
+                 const std::shared_ptr<ParallelContext>& parallel_ctx,
+                 size_t bucket_bytes)
+    : parallel_ctx_(parallel_ctx), reduce_pool_(new framework::ThreadPool(1)) {
+  PADDLE_ENFORCE_NOT_NULL(parallel_ctx_,
+                          platform::errors::InvalidArgument(
+                              "ParallelContext of Reducer cannot be null"));
+  size_t cur_bytes = 0;
+  auto cur_dtype = framework::proto::VarType::FP32;
+  for (auto it = params.rbegin(); it != params.rend(); ++it) {
+    auto& param = *it;
+    PADDLE_ENFORCE_NOT_NULL(
+        param->GradVarBase(),
+        platform::errors::InvalidArgument("Parameter %s has no gradient",
+                                          param->Name()));
+    const auto& tensor = param->Var().Get<framework::LoDTensor>();
+    PADDLE_ENFORCE_EQ(platform::is_cpu_place(tensor.place()), true,
+                      platform::errors::Unimplemented(
+                          "Reducer only supports CPU parameters, %s is not",
+                          param->Name()));
+    auto dtype = tensor.type();
+    size_t bytes = tensor.numel() * framework::SizeOfType(dtype);
+    if (buckets_.empty() || dtype != cur_dtype ||
+        cur_bytes + bytes > bucket_bytes) {
+      buckets_.emplace_back();
+      cur_bytes = 0;
+      cur_dtype = dtype;
+    }
+    auto& bucket = buckets_.back();
+    int64_t offset = bucket.offsets.empty()
+                         ? 0
+                         : bucket.offsets.back() +
+                               bucket.params.back()->Var()
+                                   .Get<framework::LoDTensor>()
+                                   .numel();
+    grad_slots_[param->GradVarBase().get()] = {
+        buckets_.size() - 1, bucket.params.size(), false};
+    bucket.params.emplace_back(param);
+    bucket.offsets.emplace_back(offset);
+    cur_bytes += bytes;
+  }
+
+  platform::CPUPlace place;
+  for (auto& bucket : buckets_) {
+    const auto& last = bucket.params.back()->Var().Get<framework::LoDTensor>();
+    bucket.buffer.Resize({bucket.offsets.back() + last.numel()});
+    bucket.buffer.mutable_data(place, last.type());
+  }
+  VLOG(3) << "Reducer puts " << params.size() << " parameters into "
+          << buckets_.size() << " buckets";
+}
+
+Reducer::~Reducer() {
+  try {
+    WaitBuckets();
+  } catch (...) {
+    LOG(WARNING) << "Reducer is destroyed with a failed bucket";
+  }
+}
+
+void Reducer::PrepareForBackward(
+    const std::function<bool(VarBase*)>& computed) {
+  // A former backward may have failed with some buckets launched.
+  WaitBuckets();
+  for (auto& bucket : buckets_) {
+    bucket.num_pending = bucket.params.size();
+  }
+  for (auto& pair : grad_slots_) {
+    pair.second.ready = false;
+  }
+  next_bucket_idx_ = 0;
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  size_t num_unused = 0;
+  for (auto& pair : grad_slots_) {
+    if (!computed(pair.first)) {
+      MarkSlotZero(&pair.second);
+      ++num_unused;
+    }
+  }
+  VLOG(5) << num_unused << " gradients are not computed by the backward";
+  LaunchReadyBuckets();
+}
+
+void Reducer::CopyToBucket(Bucket* bucket, size_t var_idx,
+                           const framework::Tensor& grad) {
+  const auto& param =
+      bucket->params[var_idx]->Var().Get<framework::LoDTensor>();
+  PADDLE_ENFORCE_EQ(
+      grad.numel(), param.numel(),
+      platform::errors::InvalidArgument(
+          "The gradient of %s has %d elements, but the parameter has %d",
+          bucket->params[var_idx]->Name(), grad.numel(), param.numel()));
+  PADDLE_ENFORCE_EQ(grad.type(), bucket->buffer.type(),
+                    platform::errors::InvalidArgument(
+                        "The gradient of %s has data type %s, but %s is "
+                        "expected",
+                        bucket->params[var_idx]->Name(),
+                        framework::DataTypeToString(grad.type()),
+                        framework::DataTypeToString(bucket->buffer.type())));
+  PADDLE_ENFORCE_EQ(platform::is_cpu_place(grad.place()), true,
+                    platform::errors::Unimplemented(
+                        "Reducer only supports CPU gradients"));
+  size_t size = framework::SizeOfType(grad.type());
+  auto* dst = reinterpret_cast<uint8_t*>(bucket->buffer.data<void>()) +
+              bucket->offsets[var_idx] * size;
+  std::memcpy(dst, grad.data<void>(), grad.numel() * size);
+}
+
+void Reducer::MarkGradReady(VarBase* grad_var) {
+  auto iter = grad_slots_.find(grad_var);
+  if (iter == grad_slots_.end()) {
+    return;
+  }
+  auto& slot = iter->second;
+  const auto& var = grad_var->Var();
+  PADDLE_ENFORCE_EQ(var.IsType<framework::LoDTensor>(), true,
+                    platform::errors::Unimplemented(
+                        "Reducer only supports dense gradients, %s is not",
+                        grad_var->Name()));
+  // Each slot has its own part of the buffer, so the copying needs no lock.
+  CopyToBucket(&buckets_[slot.bucket_idx], slot.var_idx,
+               var.Get<framework::LoDTensor>());
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  MarkSlotReady(&slot);
+  LaunchReadyBuckets();
+}
+
+void Reducer::MarkSlotReady(GradSlot* slot) {
+  if (slot->ready) {
+    return;
+  }
+  slot->ready = true;
+  --buckets_[slot->bucket_idx].num_pending;
+}
+
+void Reducer::MarkSlotZero(GradSlot* slot) {
+  auto& bucket = buckets_[slot->bucket_idx];
+  const auto& param =
+      bucket.params[slot->var_idx]->Var().Get<framework::LoDTensor>();
+  size_t size = framework::SizeOfType(param.type());
+  std::memset(reinterpret_cast<uint8_t*>(bucket.buffer.data<void>()) +
+                  bucket.offsets[slot->var_idx] * size,
+              0, param.numel() * size);
+  MarkSlotReady(slot);
+}
+
+void Reducer::LaunchReadyBuckets() {
+  while (next_bucket_idx_ < buckets_.size() &&
+         buckets_[next_bucket_idx_].num_pending == 0) {
+    auto* buffer = &buckets_[next_bucket_idx_].buffer;
+    VLOG(5) << "Launch allreduce of bucket " << next_bucket_idx_;
+    reduce_futures_.emplace_back(reduce_pool_->Run(
+        [this, buffer] { parallel_ctx_->AllReduce(buffer); }));
+    ++next_bucket_idx_;
+  }
+}
+
+void Reducer::WaitBuckets() {
+  // All the futures are waited for before rethrowing an exception.
+  std::exception_ptr exception;
+  for (auto& future : reduce_futures_) {
+    try {
+      future.get();
+    } catch (...) {
+      if (!exception) exception = std::current_exception();
+    }
+  }
+  reduce_futures_.clear();
+  if (exception) {
+    std::rethrow_exception(exception);
+  }
+}
+
+void Reducer::FinalizeBackward() {
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    for (auto& pair : grad_slots_) {
+      if (!pair.second.ready) {
+        MarkSlotZero(&pair.second);
+      }
+    }
+    LaunchReadyBuckets();
+  }
+  WaitBuckets();
+
+  platform::CPUPlace place;
+  for (auto& bucket : buckets_) {
+    size_t size = framework::SizeOfType(bucket.buffer.type());
+    const auto* src = reinterpret_cast<uint8_t*>(bucket.buffer.data<void>());
+    for (size_t i = 0; i < bucket.params.size(); ++i) {
+      const auto& param = bucket.params[i]->Var().Get<framework::LoDTensor>();
+      // The gradients not computed on this rank get the ones of the others.
+      auto* grad = bucket.params[i]
+                       ->GradVarBase()
+                       ->MutableVar()
+                       ->GetMutable<framework::LoDTensor>();
+      if (!grad->IsInitialized() || grad->numel() != param.numel()) {
+        grad->Resize(param.dims());
+      }
+      auto* dst = grad->mutable_data(place, param.type());
+      std::memcpy(dst, src + bucket.offsets[i] * size, param.numel() * size);
+    }
+  }
+}
+
+}  // namespace imperative
+}  // namespace paddle
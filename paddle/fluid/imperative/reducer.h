@@ -0,0 +1,108 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/framework/threadpool.h"
+#include "paddle/fluid/imperative/layer.h"
+#include "paddle/fluid/imperative/nccl_context.h"
+#include "paddle/fluid/platform/macros.h"
+
+namespace paddle {
+namespace imperative {
+
+// Reducer all-reduces the gradients of the parameters in data parallel
+// dygraph training while the backward is still running. The gradients are
+// coalesced into buckets of about bucket_bytes, in the reverse order of the
+// parameters since the backward computes the gradients of the last layers
+// first. The buckets are all-reduced by a thread of the reducer one by one
+// in the same order on all the ranks, each as soon as the gradients of it
+// and of the buckets before it are summed up by the engine. The gradients
+// which the backward does not compute are ready as zeros from the start, so
+// they do not hold back the buckets after them.
+//
+// Only the dense gradients of CPU parameters are supported.
+class Reducer {
+  DISABLE_COPY_AND_ASSIGN(Reducer);
+
+ public:
+  Reducer(const std::vector<std::shared_ptr<VarBase>>& params,
+          const std::shared_ptr<ParallelContext>& parallel_ctx,
+          size_t bucket_bytes);
+
+  ~Reducer();
+
+  // Called by the engine before the backward, computed(grad_var) tells
+  // whether the backward computes grad_var.
+  void PrepareForBackward(const std::function<bool(VarBase*)>& computed);
+
+  // Called by the engine when grad_var is summed up, it may be called by
+  // several threads at the same time.
+  void MarkGradReady(VarBase* grad_var);
+
+  // Called by the engine after the backward. The gradients not summed up by
+  // the backward are reduced as zeros, then the reduced gradients are copied
+  // back when all the buckets are reduced.
+  void FinalizeBackward();
+
+  size_t BucketNum() const { return buckets_.size(); }
+
+ private:
+  struct Bucket {
+    std::vector<std::shared_ptr<VarBase>> params;
+    std::vector<int64_t> offsets;
+    framework::LoDTensor buffer;
+    size_t num_pending{0};
+  };
+
+  // The position of a gradient in buckets_.
+  struct GradSlot {
+    size_t bucket_idx;
+    size_t var_idx;
+    bool ready;
+  };
+
+  void CopyToBucket(Bucket* bucket, size_t var_idx,
+                    const framework::Tensor& grad);
+
+  void MarkSlotReady(GradSlot* slot);
+
+  // Fills the part of slot in its bucket with zeros and marks it ready.
+  void MarkSlotZero(GradSlot* slot);
+
+  void LaunchReadyBuckets();
+
+  void WaitBuckets();
+
+ private:
+  std::shared_ptr<ParallelContext> parallel_ctx_;
+  std::vector<Bucket> buckets_;
+  std::unordered_map<VarBase*, GradSlot> grad_slots_;
+
+  std::mutex mutex_;
+  size_t next_bucket_idx_{0};
+  std::unique_ptr<framework::ThreadPool> reduce_pool_;
+  std::vector<std::future<void>> reduce_futures_;
+};
+
+}  // namespace imperative
+}  // namespace paddle
@@ -0,0 +1,221 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/imperative/reducer.h"
+#include "paddle/fluid/imperative/tracer.h"
+
+namespace paddle {
+namespace imperative {
+
+using vb_vector = std::vector<std::shared_ptr<imperative::VarBase>>;
+using var_pair = std::pair<std::string, vb_vector>;
+
+// Simulates nranks ranks holding the same gradients on a link of
+// bytes_per_us bandwidth.
+class FakeParallelContext : public ParallelContext {
+ public:
+  FakeParallelContext(int nranks, double bytes_per_us)
+      : ParallelContext(ParallelStrategy(), platform::CPUPlace()),
+        nranks_(nranks),
+        bytes_per_us_(bytes_per_us) {}
+
+  void Init() override {}
+
+  void AllReduce(framework::Tensor* tensor) override {
+    size_t bytes = tensor->numel() * sizeof(float);
+    auto us = static_cast<int64_t>(bytes / bytes_per_us_);
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+    comm_us_ += us;
+    ++num_allreduce_;
+    float* data = tensor->data<float>();
+    for (int64_t i = 0; i < tensor->numel(); ++i) {
+      data[i] *= nranks_;
+    }
+  }
+
+  int64_t CommUs() const { return comm_us_; }
+
+  int NumAllReduce() const { return num_allreduce_; }
+
+ private:
+  int nranks_;
+  double bytes_per_us_;
+  std::atomic<int64_t> comm_us_{0};
+  std::atomic<int> num_allreduce_{0};
+};
+
+static std::shared_ptr<VarBase> CreateVar(const std::string& name,
+                                          std::vector<int64_t> dims,
+                                          float value) {
+  std::shared_ptr<VarBase> var(new VarBase(true, name));
+  var->SetOverridedStopGradient(false);
+  auto* tensor = var->MutableVar()->GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim(dims));
+  auto* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = value * static_cast<float>(i % 5 + 1);
+  }
+  return var;
+}
+
+// Runs the forward and backward of a chain of mul ops, returns the time of
+// the backward in us.
+static double RunChainBackward(Tracer* tracer,
+                               const std::shared_ptr<VarBase>& x,
+                               const vb_vector& weights) {
+  platform::CPUPlace place;
+  framework::AttributeMap attrs;
+  attrs["use_mkldnn"] = false;
+  auto hidden = x;
+  for (auto& w : weights) {
+    std::shared_ptr<VarBase> out(new VarBase(true, "out"));
+    NameVarBaseMap ins = {var_pair("X", vb_vector(1, hidden)),
+                          var_pair("Y", vb_vector(1, w))};
+    NameVarBaseMap outs = {var_pair("Out", vb_vector(1, out))};
+    tracer->TraceOp("mul", ins, outs, attrs, place, true);
+    hidden = out;
+  }
+
+  detail::BackwardStrategy back_st;
+  auto start = std::chrono::steady_clock::now();
+  auto* engine = tracer->GetDefaultEngine();
+  engine->Init(hidden.get(), back_st);
+  engine->Execute();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+static std::vector<float> GradData(const std::shared_ptr<VarBase>& var) {
+  const auto& tensor = var->GradVar().Get<framework::LoDTensor>();
+  return std::vector<float>(tensor.data<float>(),
+                            tensor.data<float>() + tensor.numel());
+}
+
+TEST(test_reducer, bucket_and_overlap) {
+  const int64_t batch = 64;
+  const int64_t width = 256;
+  const size_t num_layers = 16;
+  const int runs = 5;
+  const size_t weight_bytes = width * width * sizeof(float);
+
+  auto x = CreateVar("x", {batch, width}, 0.01f);
+  vb_vector weights;
+  for (size_t i = 0; i < num_layers; ++i) {
+    weights.emplace_back(
+        CreateVar("w" + std::to_string(i), {width, width}, 0.01f));
+  }
+  // A parameter not used by the model, in the middle of the parameters.
+  auto unused = CreateVar("unused", {3, 4}, 1.0f);
+  vb_vector params(weights.begin(), weights.begin() + num_layers / 2);
+  params.emplace_back(unused);
+  params.insert(params.end(), weights.begin() + num_layers / 2, weights.end());
+
+  // The baseline without data parallel.
+  Tracer tracer;
+  double backward_us = 0;
+  for (int run = 0; run < runs; ++run) {
+    backward_us += RunChainBackward(&tracer, x, weights) / runs;
+  }
+  std::vector<std::vector<float>> local_grads;
+  for (auto& w : weights) {
+    local_grads.emplace_back(GradData(w));
+  }
+
+  // The link reduces all the gradients in about the time of the backward.
+  double bytes_per_us = num_layers * weight_bytes / backward_us;
+  auto ctx = std::make_shared<FakeParallelContext>(2, bytes_per_us);
+  // Two weights a bucket. The unused parameter shares the fifth bucket with
+  // the weight before it, which leaves the first weight alone in the last
+  // bucket. The buckets after it must not wait for the end of the backward.
+  auto reducer = std::make_shared<Reducer>(params, ctx, 2 * weight_bytes);
+  ASSERT_EQ(reducer->BucketNum(), num_layers / 2 + 1);
+  tracer.GetDefaultEngine()->SetReducer(reducer);
+
+  double overlapped_us = 0;
+  for (int run = 0; run < runs; ++run) {
+    overlapped_us += RunChainBackward(&tracer, x, weights) / runs;
+  }
+  double comm_us = static_cast<double>(ctx->CommUs()) / runs;
+  double hidden = (backward_us + comm_us - overlapped_us) / comm_us;
+  LOG(INFO) << "backward: " << backward_us << " us, allreduce: " << comm_us
+            << " us, backward with overlapped allreduce: " << overlapped_us
+            << " us, " << hidden * 100 << "% of the allreduce is hidden";
+  tracer.GetDefaultEngine()->SetReducer(nullptr);
+
+  for (size_t i = 0; i < num_layers; ++i) {
+    auto grad = GradData(weights[i]);
+    ASSERT_EQ(grad.size(), local_grads[i].size());
+    for (size_t j = 0; j < grad.size(); ++j) {
+      ASSERT_EQ(grad[j], 2 * local_grads[i][j]);
+    }
+  }
+  for (auto value : GradData(unused)) {
+    ASSERT_EQ(value, 0.0f);
+  }
+}
+
+// The bucket of a parameter not used by the backward is all-reduced as soon
+// as the buckets before it are, without waiting for the end of the backward.
+TEST(test_reducer, unused_param_ready) {
+  auto a = CreateVar("a", {4}, 1.0f);
+  auto unused = CreateVar("unused", {4}, 1.0f);
+  auto b = CreateVar("b", {4}, 1.0f);
+  for (auto* var : {a.get(), b.get()}) {
+    auto* grad = var->MutableGradVar()->GetMutable<framework::LoDTensor>();
+    grad->Resize({4});
+    auto* data = grad->mutable_data<float>(platform::CPUPlace());
+    std::fill(data, data + 4, 1.0f);
+  }
+  auto ctx = std::make_shared<FakeParallelContext>(2, 1e6);
+  // A bucket for each parameter, in the order of b, unused and a.
+  Reducer reducer({a, unused, b}, ctx, 4 * sizeof(float));
+  ASSERT_EQ(reducer.BucketNum(), 3UL);
+
+  reducer.PrepareForBackward([&](VarBase* grad_var) {
+    return grad_var != unused->GradVarBase().get();
+  });
+  // Nothing is launched before the gradient of b.
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  ASSERT_EQ(ctx->NumAllReduce(), 0);
+  reducer.MarkGradReady(b->GradVarBase().get());
+  // The buckets of b and unused are launched, but not the one of a.
+  for (int i = 0; i < 1000 && ctx->NumAllReduce() < 2; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_EQ(ctx->NumAllReduce(), 2);
+  reducer.MarkGradReady(a->GradVarBase().get());
+  reducer.FinalizeBackward();
+  ASSERT_EQ(ctx->NumAllReduce(), 3);
+
+  for (auto value : GradData(a)) {
+    ASSERT_EQ(value, 2.0f);
+  }
+  for (auto value : GradData(unused)) {
+    ASSERT_EQ(value, 0.0f);
+  }
+}
+
+}  // namespace imperative
+}  // namespace paddle
+
+USE_OP(mul);
@@ -17,13 +17,23 @@
 //
 
 #include <paddle/fluid/framework/op_registry.h>
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cmath>
+#include <limits>
 #include <memory>
 #include <string>
 #include <vector>
+#include "gflags/gflags.h"
 #include "gtest/gtest.h"
+#include "paddle/fluid/imperative/dispatch_cache.h"
+#include "paddle/fluid/imperative/jit/program_replayer.h"
 #include "paddle/fluid/imperative/tracer.h"
 #include "paddle/fluid/memory/memcpy.h"
 
+DECLARE_bool(dygraph_dispatch_cache);
+DECLARE_int32(dygraph_backward_threads);
+
 namespace imperative = paddle::imperative;
 namespace platform = paddle::platform;
 namespace framework = paddle::framework;
@@ -369,6 +379,298 @@ TEST(test_tracer, test_var_without_grad_var) {
   }
 }
 
+TEST(test_tracer, test_dispatch_cache) {
+  imperative::Tracer tracer;
+  platform::CPUPlace place;
+  std::shared_ptr<imperative::VarBase> x_in(
+      new imperative::VarBase(false, "x_in"));
+  std::shared_ptr<imperative::VarBase> y_in(
+      new imperative::VarBase(false, "y_in"));
+  for (auto* var : {x_in.get(), y_in.get()}) {
+    auto* tensor = var->MutableVar()->GetMutable<framework::LoDTensor>();
+    tensor->Resize(framework::make_ddim({2, 2}));
+    auto* data = tensor->mutable_data<float>(place);
+    for (int i = 0; i < 4; ++i) data[i] = 1.0f;
+  }
+  framework::AttributeMap attrs;
+  attrs["use_mkldnn"] = false;
+
+  const int num_ops = 10000;
+  bool cache_flag = FLAGS_dygraph_dispatch_cache;
+  for (bool cache : {false, true}) {
+    FLAGS_dygraph_dispatch_cache = cache;
+    imperative::DispatchCache::Instance().Clear();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_ops; ++i) {
+      std::shared_ptr<imperative::VarBase> vout(
+          new imperative::VarBase(false, "vout"));
+      imperative::NameVarBaseMap ins = {var_pair("X", vb_vector(1, x_in)),
+                                        var_pair("Y", vb_vector(1, y_in))};
+      imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, vout))};
+      tracer.TraceOp("elementwise_add", ins, outs, attrs, place, false);
+      const auto& out_tensor = vout->Var().Get<framework::LoDTensor>();
+      ASSERT_EQ(out_tensor.numel(), 4);
+      ASSERT_EQ(out_tensor.data<float>()[3], 2.0f);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double sec = std::chrono::duration<double>(end - start).count();
+    LOG(INFO) << "elementwise_add of 2x2 tensors "
+              << (cache ? "with" : "without")
+              << " dispatch cache: " << num_ops / sec << " ops/s";
+    // All the runs share one entry.
+    ASSERT_EQ(imperative::DispatchCache::Instance().Size(), cache ? 1UL : 0UL);
+  }
+
+  // An attribute of NaN hits the cache too.
+  imperative::DispatchCache::Instance().Clear();
+  framework::AttributeMap fill_attrs;
+  fill_attrs["shape"] = std::vector<int64_t>{2, 2};
+  fill_attrs["value"] = std::numeric_limits<float>::quiet_NaN();
+  for (int i = 0; i < 3; ++i) {
+    std::shared_ptr<imperative::VarBase> vout(
+        new imperative::VarBase(false, "vout"));
+    imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, vout))};
+    tracer.TraceOp("fill_constant", {}, outs, fill_attrs, place, false);
+    const auto& out_tensor = vout->Var().Get<framework::LoDTensor>();
+    ASSERT_TRUE(std::isnan(out_tensor.data<float>()[0]));
+  }
+  ASSERT_EQ(imperative::DispatchCache::Instance().Size(), 1UL);
+  FLAGS_dygraph_dispatch_cache = cache_flag;
+}
+
+TEST(test_tracer, test_replay_traced_program) {
+  imperative::Tracer tracer;
+  platform::CPUPlace place;
+  std::shared_ptr<imperative::VarBase> x_in(
+      new imperative::VarBase(true, "x_in"));
+  std::shared_ptr<imperative::VarBase> y_in(
+      new imperative::VarBase(true, "y_in"));
+  std::shared_ptr<imperative::VarBase> vout(
+      new imperative::VarBase(true, "vout"));
+  x_in->SetOverridedStopGradient(false);
+  auto fill = [&place](imperative::VarBase* var, std::vector<int64_t> dims,
+                       float value) {
+    auto* tensor = var->MutableVar()->GetMutable<framework::LoDTensor>();
+    tensor->Resize(framework::make_ddim(dims));
+    auto* data = tensor->mutable_data<float>(place);
+    for (int64_t i = 0; i < tensor->numel(); ++i) data[i] = value;
+  };
+  fill(x_in.get(), {2, 5}, 2.0f);
+  fill(y_in.get(), {5, 2}, 2.0f);
+
+  // Trace the forward and backward of mul.
+  tracer.SetEnableProgramDescTracing(true);
+  imperative::NameVarBaseMap ins = {var_pair("X", vb_vector(1, x_in)),
+                                    var_pair("Y", vb_vector(1, y_in))};
+  imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, vout))};
+  framework::AttributeMap mul_attr_map;
+  mul_attr_map["use_mkldnn"] = false;
+  tracer.TraceOp("mul", ins, outs, mul_attr_map, place, true);
+  detail::BackwardStrategy back_st;
+  imperative::Engine* engine = tracer.GetDefaultEngine();
+  engine->Init(vout.get(), back_st);
+  engine->Execute();
+  tracer.SetEnableProgramDescTracing(false);
+
+  auto traced = tracer.GetProgramDescTracer()->CreateProgramDesc(
+      {x_in}, "feed_", {vout, x_in->GradVarBase()}, "fetch_", "t_");
+  auto& program = std::get<0>(traced);
+  std::vector<std::string> op_types;
+  for (auto* op : program->Block(0).AllOps()) {
+    op_types.emplace_back(op->Type());
+  }
+  ASSERT_EQ(op_types, std::vector<std::string>(
+                          {"mul", "fill_constant", "mul_grad", "assign"}));
+
+  jit::ProgramReplayer replayer(*program, std::get<1>(traced),
+                                std::get<2>(traced), std::get<3>(traced), {},
+                                place);
+  ASSERT_TRUE(replayer.IsSameTrace(*program));
+
+  std::shared_ptr<imperative::VarBase> x_new(
+      new imperative::VarBase(false, "x_new"));
+  fill(x_new.get(), {2, 5}, 3.0f);
+  vb_vector fetches;
+  for (int run = 0; run < 2; ++run) {
+    ASSERT_TRUE(replayer.Run({x_new}, &fetches));
+    ASSERT_EQ(fetches.size(), 2UL);
+    const auto& out = fetches[0]->Var().Get<framework::LoDTensor>();
+    const auto& x_grad = fetches[1]->Var().Get<framework::LoDTensor>();
+    ASSERT_EQ(out.numel(), 4);
+    ASSERT_EQ(x_grad.numel(), 10);
+    for (int i = 0; i < out.numel(); ++i) {
+      ASSERT_EQ(out.data<float>()[i], 30.0f);
+    }
+    for (int i = 0; i < x_grad.numel(); ++i) {
+      ASSERT_EQ(x_grad.data<float>()[i], 4.0f);
+    }
+  }
+
+  // A feed of another shape has to be run by dygraph.
+  fill(x_new.get(), {3, 5}, 3.0f);
+  ASSERT_FALSE(replayer.Run({x_new}, &fetches));
+}
+
+// Traces a model of num_branches mul ops sharing the input x, whose outputs
+// are added up, and runs its backward. Returns the time of the backward.
+static double RunWideModelBackward(imperative::Tracer* tracer,
+                                   const std::shared_ptr<VarBase>& x,
+                                   const vb_vector& weights, bool sorted_sum) {
+  platform::CPUPlace place;
+  framework::AttributeMap attrs;
+  attrs["use_mkldnn"] = false;
+  std::shared_ptr<imperative::VarBase> sum;
+  for (auto& w : weights) {
+    std::shared_ptr<imperative::VarBase> out(
+        new imperative::VarBase(true, "out"));
+    imperative::NameVarBaseMap ins = {var_pair("X", vb_vector(1, x)),
+                                      var_pair("Y", vb_vector(1, w))};
+    imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, out))};
+    tracer->TraceOp("mul", ins, outs, attrs, place, true);
+    if (sum == nullptr) {
+      sum = out;
+      continue;
+    }
+    std::shared_ptr<imperative::VarBase> new_sum(
+        new imperative::VarBase(true, "sum"));
+    ins = {var_pair("X", vb_vector(1, sum)), var_pair("Y", vb_vector(1, out))};
+    outs = {var_pair("Out", vb_vector(1, new_sum))};
+    tracer->TraceOp("elementwise_add", ins, outs, attrs, place, true);
+    sum = new_sum;
+  }
+
+  detail::BackwardStrategy back_st;
+  back_st.sorted_sum_gradient_ = sorted_sum;
+  auto start = std::chrono::steady_clock::now();
+  imperative::Engine* engine = tracer->GetDefaultEngine();
+  engine->Init(sum.get(), back_st);
+  engine->Execute();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+TEST(test_tracer, test_parallel_backward) {
+  const int64_t width = 128;
+  const size_t num_branches = 16;
+  const int runs = 10;
+  platform::CPUPlace place;
+  auto create_var = [&](const std::string& name, float value) {
+    std::shared_ptr<imperative::VarBase> var(
+        new imperative::VarBase(true, name));
+    var->SetOverridedStopGradient(false);
+    auto* tensor = var->MutableVar()->GetMutable<framework::LoDTensor>();
+    tensor->Resize(framework::make_ddim({width, width}));
+    auto* data = tensor->mutable_data<float>(place);
+    for (int64_t i = 0; i < tensor->numel(); ++i) {
+      data[i] = value * static_cast<float>(i % 7 + 1);
+    }
+    return var;
+  };
+  auto x = create_var("x", 0.1f);
+  vb_vector weights;
+  for (size_t i = 0; i < num_branches; ++i) {
+    weights.emplace_back(create_var("w" + std::to_string(i), 0.01f * (i + 1)));
+  }
+
+  auto threads_flag = FLAGS_dygraph_backward_threads;
+  for (bool sorted_sum : {false, true}) {
+    std::vector<std::vector<float>> grads;
+    for (int threads : {1, 4}) {
+      FLAGS_dygraph_backward_threads = threads;
+      imperative::Tracer tracer;
+      // The first run creates the threads.
+      RunWideModelBackward(&tracer, x, weights, sorted_sum);
+      double ms = 0;
+      for (int run = 0; run < runs; ++run) {
+        ms += RunWideModelBackward(&tracer, x, weights, sorted_sum);
+      }
+      LOG(INFO) << "backward of " << num_branches << " branches with "
+                << threads << " threads and "
+                << (sorted_sum ? "sorted" : "eager")
+                << " sum: " << ms / runs << " ms";
+
+      std::vector<float> grad;
+      for (auto& var : vb_vector{x, weights[0], weights.back()}) {
+        const auto& tensor = var->GradVar().Get<framework::LoDTensor>();
+        grad.insert(grad.end(), tensor.data<float>(),
+                    tensor.data<float>() + tensor.numel());
+      }
+      grads.emplace_back(std::move(grad));
+    }
+
+    ASSERT_EQ(grads[0].size(), grads[1].size());
+    for (size_t i = 0; i < grads[0].size(); ++i) {
+      // The eager sum of x@GRAD runs in the order the grad ops finish.
+      if (sorted_sum) {
+        ASSERT_EQ(grads[0][i], grads[1][i]);
+      } else {
+        ASSERT_NEAR(grads[0][i], grads[1][i], 1e-3 * std::abs(grads[0][i]));
+      }
+    }
+  }
+  FLAGS_dygraph_backward_threads = threads_flag;
+}
+
+TEST(test_tracer, test_parallel_backward_exception) {
+  const int64_t width = 16;
+  platform::CPUPlace place;
+  auto create_var = [&](const std::string& name) {
+    std::shared_ptr<imperative::VarBase> var(
+        new imperative::VarBase(true, name));
+    var->SetOverridedStopGradient(false);
+    auto* tensor = var->MutableVar()->GetMutable<framework::LoDTensor>();
+    tensor->Resize(framework::make_ddim({width, width}));
+    auto* data = tensor->mutable_data<float>(place);
+    std::fill(data, data + tensor->numel(), 0.5f);
+    return var;
+  };
+  auto x = create_var("x");
+  vb_vector weights;
+  for (int i = 0; i < 4; ++i) {
+    weights.emplace_back(create_var("w" + std::to_string(i)));
+  }
+
+  auto threads_flag = FLAGS_dygraph_backward_threads;
+  FLAGS_dygraph_backward_threads = 4;
+  imperative::Tracer tracer;
+  framework::AttributeMap attrs;
+  attrs["use_mkldnn"] = false;
+  std::shared_ptr<imperative::VarBase> sum;
+  for (auto& w : weights) {
+    std::shared_ptr<imperative::VarBase> out(
+        new imperative::VarBase(true, "out"));
+    imperative::NameVarBaseMap ins = {var_pair("X", vb_vector(1, x)),
+                                      var_pair("Y", vb_vector(1, w))};
+    imperative::NameVarBaseMap outs = {var_pair("Out", vb_vector(1, out))};
+    tracer.TraceOp("mul", ins, outs, attrs, place, true);
+    if (sum == nullptr) {
+      sum = out;
+      continue;
+    }
+    std::shared_ptr<imperative::VarBase> new_sum(
+        new imperative::VarBase(true, "sum"));
+    ins = {var_pair("X", vb_vector(1, sum)), var_pair("Y", vb_vector(1, out))};
+    outs = {var_pair("Out", vb_vector(1, new_sum))};
+    tracer.TraceOp("elementwise_add", ins, outs, attrs, place, true);
+    sum = new_sum;
+  }
+  // The input Y of a mul_grad op is not initialized, the exception of it is
+  // rethrown after the other grad ops finish.
+  weights[2]->MutableVar()->Clear();
+
+  detail::BackwardStrategy back_st;
+  imperative::Engine* engine = tracer.GetDefaultEngine();
+  engine->Init(sum.get(), back_st);
+  ASSERT_ANY_THROW(engine->Execute());
+
+  // The engine is cleaned and runs the next backward.
+  weights[2] = create_var("w2");
+  RunWideModelBackward(&tracer, x, weights, false);
+  const auto& x_grad = x->GradVar().Get<framework::LoDTensor>();
+  ASSERT_EQ(x_grad.numel(), width * width);
+  FLAGS_dygraph_backward_threads = threads_flag;
+}
+
 }  // namespace imperative
 }  // namespace paddle
 
@@ -376,3 +678,5 @@ USE_OP(mul);
 USE_OP(reduce_sum);
 USE_OP(reduce_sum_grad);
 USE_OP(elementwise_add);
+USE_OP(fill_constant);
+USE_OP(assign);
@@ -71,6 +71,8 @@ class Tracer {
 
   void SetEnableProgramDescTracing(bool enabled) {
     enable_program_desc_tracing_ = enabled;
+    engine_->SetProgramDescTracer(enabled ? program_desc_tracer_.get()
+                                          : nullptr);
   }
 
   bool IsProgramDescTracingEnabled() const {
@@ -95,6 +95,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(model_dir_);
   CP_MEMBER(model_from_memory_);  // the memory model reuses prog_file_ and
                                   // params_file_ fields.
+  CP_MEMBER(use_mmap_params_);
 
   CP_MEMBER(opt_cache_dir_);
   prog_file_ = std::move(other.prog_file_);
@@ -108,6 +109,7 @@ AnalysisConfig::AnalysisConfig(const AnalysisConfig &other) {
   CP_MEMBER(memory_pool_init_size_mb_);
 
   CP_MEMBER(enable_memory_optim_);
+  CP_MEMBER(use_optim_program_cache_);
   // TensorRT related.
   CP_MEMBER(use_tensorrt_);
   CP_MEMBER(tensorrt_workspace_size_);
@@ -371,6 +373,7 @@ std::string AnalysisConfig::SerializeInfoCache() {
   ss << tensorrt_min_subgraph_size_;
 
   ss << enable_memory_optim_;
+  ss << use_optim_program_cache_;
 
   ss << use_ngraph_;
 
@@ -381,6 +384,7 @@ std::string AnalysisConfig::SerializeInfoCache() {
 
   ss << use_mkldnn_quantizer_;
   ss << model_from_memory_;
+  ss << use_mmap_params_;
 
   ss << with_profile_;
 
@@ -421,6 +425,11 @@ float AnalysisConfig::fraction_of_gpu_memory_for_pool() const {
 #endif
 }
 
+void AnalysisConfig::EnableMemoryMapParams(bool x) {
+  use_mmap_params_ = x;
+  Update();
+}
+
 void AnalysisConfig::EnableMemoryOptim() {
   enable_memory_optim_ = true;
   Update();
@@ -430,6 +439,11 @@ bool AnalysisConfig::enable_memory_optim() const {
   return enable_memory_optim_;
 }
 
+void AnalysisConfig::EnableOptimProgramCache(bool x) {
+  use_optim_program_cache_ = x;
+  Update();
+}
+
 void AnalysisConfig::SetModelBuffer(const char *prog_buffer,
                                     size_t prog_buffer_size,
                                     const char *param_buffer,
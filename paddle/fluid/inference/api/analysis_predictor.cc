@@ -15,9 +15,14 @@
 #include "paddle/fluid/inference/api/analysis_predictor.h"
 #include <glog/logging.h>
 #include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
 #include <fstream>
+#include <functional>
+#include <iterator>
 #include <memory>
 #include <set>
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -69,6 +74,19 @@ bool IsPersistable(const framework::VarDesc *var) {
   }
   return false;
 }
+
+// The size and the modification time of the file, so the parameters need not
+// be read to compute the cache key.
+std::string FileStamp(const std::string &path) {
+  std::stringstream ss;
+  ss << path;
+  struct stat statbuf;
+  if (stat(path.c_str(), &statbuf) != -1) {
+    ss << ":" << statbuf.st_size << ":" << statbuf.st_mtime;
+  }
+  ss << ";";
+  return ss.str();
+}
 }  // namespace
 
 bool PaddleTensorToLoDTensor(const PaddleTensor &pt, framework::LoDTensor *t,
@@ -400,6 +418,7 @@ void AnalysisPredictor::PrepareArgument() {
   argument_.SetEnableAnalysisOptim(config_.enable_ir_optim_);
   argument_.SetEnableMemoryOptim(config_.enable_memory_optim());
   argument_.SetModelFromMemory(config_.model_from_memory_);
+  argument_.SetModelParamsUseMmap(config_.use_mmap_params_);
   // Analyze inference_program
   argument_.SetPredictorID(predictor_id_);
   argument_.SetOptimCacheDir(config_.opt_cache_dir_);
@@ -462,6 +481,18 @@ void AnalysisPredictor::PrepareArgument() {
 
 // NOTE All the members in AnalysisConfig should be copied to Argument.
 void AnalysisPredictor::OptimizeInferenceProgram() {
+  inference::Timer timer;
+  timer.tic();
+  std::string cache_key;
+  std::string cache_path = GetOptimProgramCachePath(&cache_key);
+  if (!cache_path.empty() && LoadOptimProgramCache(cache_path, cache_key)) {
+    status_optim_program_cache_hit_ = true;
+    config_.PartiallyRelease();
+    LOG(INFO) << "======= load the optimized program from " << cache_path
+              << ", cost " << timer.toc() << " ms =======";
+    return;
+  }
+
   PrepareArgument();
   Analyzer().Run(&argument_);
 
@@ -470,11 +501,14 @@ void AnalysisPredictor::OptimizeInferenceProgram() {
   ARGUMENT_CHECK_FIELD((&argument_), ir_analyzed_program);
   inference_program_.reset(
       new framework::ProgramDesc(argument_.ir_analyzed_program()));
+  if (!cache_path.empty()) {
+    SaveOptimProgramCache(cache_path, cache_key);
+  }
   // The config and argument take a lot of storage,
   // when the predictor settings are complete, we release these stores.
   argument_.PartiallyRelease();
   config_.PartiallyRelease();
-  LOG(INFO) << "======= optimize end =======";
+  LOG(INFO) << "======= optimize end, cost " << timer.toc() << " ms =======";
 }
 
 template <>
@@ -736,6 +770,7 @@ bool AnalysisPredictor::LoadParameters() {
     op->SetType("load_combine");
     op->SetOutput("Out", params);
     op->SetAttr("file_path", {config_.params_file()});
+    op->SetAttr("use_mmap", {config_.memory_map_params_enabled()});
     op->CheckAttrs();
   }
 
@@ -748,6 +783,161 @@ bool AnalysisPredictor::LoadParameters() {
   return true;
 }
 
+std::string AnalysisPredictor::GetOptimProgramCachePath(std::string *key) {
+  if (!config_.optim_program_cache_enabled()) return "";
+  if (config_.tensorrt_engine_enabled() || config_.lite_engine_enabled() ||
+      config_.mkldnn_quantizer_enabled()) {
+    LOG(WARNING) << "The optimized program cache is not supported with the "
+                    "TensorRT or Lite subgraph engines and the MKLDNN "
+                    "quantizer, it is disabled.";
+    return "";
+  }
+  std::string cache_dir = config_.opt_cache_dir_;
+  if (cache_dir.empty()) {
+    if (config_.model_from_memory()) {
+      LOG(WARNING) << "The model is loaded from memory, please set the opt "
+                      "cache dir to use the optimized program cache.";
+      return "";
+    }
+    cache_dir = (config_.model_dir().empty()
+                     ? inference::analysis::GetDirRoot(config_.prog_file())
+                     : config_.model_dir()) +
+                "/_opt_cache";
+  }
+  if (!inference::analysis::PathExists(cache_dir) &&
+      MKDIR(cache_dir.c_str()) == -1) {
+    LOG(WARNING) << "Can not create the optimize cache directory "
+                 << cache_dir << ", the optimized program is not cached.";
+    return "";
+  }
+
+  // The key covers the program, the parameter files and the config that
+  // affects the analysis. It is saved with the cache and compared on loading,
+  // since the path only has its hash.
+  std::stringstream ss;
+  ss << framework::kCurProgramVersion << ";";
+  ss << inference_program_->Proto()->SerializeAsString() << ";";
+  if (config_.model_from_memory()) {
+    ss << config_.params_file().size() << ":"
+       << std::hash<std::string>()(config_.params_file()) << ";";
+  } else if (!config_.params_file().empty()) {
+    ss << FileStamp(config_.params_file());
+  } else {
+    for (auto *var : inference_program_->Block(0).AllVars()) {
+      if (IsPersistable(var)) {
+        ss << FileStamp(config_.model_dir() + "/" + var->Name());
+      }
+    }
+  }
+  ss << config_.use_gpu() << config_.use_fc_padding()
+     << config_.enable_memory_optim() << config_.use_ngraph_
+     << config_.use_mkldnn_ << config_.ir_optim()
+     << config_.use_feed_fetch_ops_ << config_.memory_map_params_enabled()
+     << ";";
+  std::set<std::string> mkldnn_op_types(
+      config_.mkldnn_enabled_op_types_.begin(),
+      config_.mkldnn_enabled_op_types_.end());
+  for (auto &type : mkldnn_op_types) ss << type << ",";
+  for (auto &pass : config_.pass_builder()->AllPasses()) ss << pass << ",";
+  for (auto &pass : config_.pass_builder()->AnalysisPasses()) {
+    ss << pass << ",";
+  }
+  *key = ss.str();
+
+  std::stringstream path;
+  path << cache_dir << "/program_" << std::hex
+       << std::hash<std::string>()(*key);
+  return path.str();
+}
+
+bool AnalysisPredictor::LoadOptimProgramCache(const std::string &cache_path,
+                                               const std::string &key) {
+  std::string model_path = cache_path + "/model";
+  std::string params_path = cache_path + "/params";
+  std::string key_path = cache_path + "/key";
+  if (!inference::analysis::FileExists(model_path) ||
+      !inference::analysis::FileExists(params_path) ||
+      !inference::analysis::FileExists(key_path)) {
+    VLOG(3) << "the optimized program is not cached in " << cache_path;
+    return false;
+  }
+  std::ifstream fin(key_path, std::ios::in | std::ios::binary);
+  std::string cached_key((std::istreambuf_iterator<char>(fin)),
+                         std::istreambuf_iterator<char>());
+  if (cached_key != key) {
+    LOG(WARNING) << "The optimized program cached in " << cache_path
+                 << " belongs to another model or config, it is not used.";
+    return false;
+  }
+  inference_program_.reset(new framework::ProgramDesc(
+      inference::analysis::LoadProgramDesc(model_path)));
+  executor_->CreateVariables(*inference_program_, 0, true, sub_scope_);
+
+  // The parameters are saved by SaveOptimModel in the sorted order.
+  framework::ProgramDesc load_program;
+  framework::BlockDesc *load_block = load_program.MutableBlock(0);
+  std::vector<std::string> params;
+  for (auto *var : inference_program_->Block(0).AllVars()) {
+    if (IsPersistable(var)) {
+      framework::VarDesc *new_var = load_block->Var(var->Name());
+      new_var->SetShape(var->GetShape());
+      new_var->SetDataType(var->GetDataType());
+      new_var->SetType(var->GetType());
+      new_var->SetLoDLevel(var->GetLoDLevel());
+      new_var->SetPersistable(true);
+      params.push_back(new_var->Name());
+    }
+  }
+  std::sort(params.begin(), params.end());
+  framework::OpDesc *op = load_block->AppendOp();
+  op->SetType("load_combine");
+  op->SetOutput("Out", params);
+  op->SetAttr("file_path", params_path);
+  op->SetAttr("use_mmap", config_.memory_map_params_enabled());
+  op->CheckAttrs();
+
+  framework::NaiveExecutor e(place_);
+  e.Prepare(scope_.get(), load_program, 0, false);
+  e.Run();
+  return true;
+}
+
+void AnalysisPredictor::SaveOptimProgramCache(const std::string &cache_path,
+                                              const std::string &key) {
+  // Save to a temporary directory and rename it, so the other predictors
+  // never load a partial cache.
+  std::stringstream tmp;
+  tmp << cache_path << ".tmp"
+      << std::chrono::steady_clock::now().time_since_epoch().count();
+  std::string tmp_path = tmp.str();
+  if (MKDIR(tmp_path.c_str()) == -1) {
+    LOG(WARNING) << "Can not create " << tmp_path
+                 << ", the optimized program is not cached.";
+    return;
+  }
+  bool saved = true;
+  try {
+    SaveOptimModel(tmp_path);
+    std::ofstream fout(tmp_path + "/key", std::ios::out | std::ios::binary);
+    fout << key;
+    fout.close();
+    saved = fout.good();
+  } catch (const std::exception &e) {
+    LOG(WARNING) << "Failed to save the optimized program to " << tmp_path
+                 << ": " << e.what();
+    saved = false;
+  }
+  // The rename fails if another predictor has saved the cache.
+  if (!saved || std::rename(tmp_path.c_str(), cache_path.c_str()) != 0) {
+    std::remove((tmp_path + "/model").c_str());
+    std::remove((tmp_path + "/params").c_str());
+    std::remove((tmp_path + "/key").c_str());
+    std::remove(tmp_path.c_str());
+    return;
+  }
+  LOG(INFO) << "Save the optimized program to " << cache_path;
+}
+
 #if PADDLE_WITH_TENSORRT
 bool AnalysisPredictor::SaveTrtCalibToDisk() {
   PADDLE_ENFORCE(config_.tensorrt_engine_enabled(),
@@ -901,6 +1091,8 @@ void AnalysisPredictor::SaveOptimModel(const std::string &dir) {
   op->SetType("save_combine");
   op->SetInput("X", save_var_list);
   op->SetAttr("file_path", dir + "/params");
+  // The aligned parameters can be memory mapped when they are loaded.
+  op->SetAttr("save_as_aligned", config_.memory_map_params_enabled());
   op->CheckAttrs();
 
   platform::CPUPlace place;
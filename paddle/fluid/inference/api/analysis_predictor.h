@@ -100,6 +100,17 @@ class AnalysisPredictor : public PaddlePredictor {
   bool LoadProgramDesc();
   bool LoadParameters();
 
+  // Gives the directory of the optimized program cache of the model and
+  // config, or an empty string if the cache is not used. The key identifying
+  // the model and config is written to key.
+  std::string GetOptimProgramCachePath(std::string *key);
+  // Loads the optimized program and parameters saved by SaveOptimModel,
+  // returns false if they are not cached or cached with another key.
+  bool LoadOptimProgramCache(const std::string &cache_path,
+                             const std::string &key);
+  void SaveOptimProgramCache(const std::string &cache_path,
+                             const std::string &key);
+
   bool SetFeed(const std::vector<PaddleTensor> &input_datas,
                framework::Scope *scope);
   bool GetFetch(std::vector<PaddleTensor> *output_data,
@@ -135,6 +146,7 @@ class AnalysisPredictor : public PaddlePredictor {
   FRIEND_TEST(AnalysisPredictor, analysis_off);
   FRIEND_TEST(AnalysisPredictor, analysis_on);
   FRIEND_TEST(AnalysisPredictor, with_gpu);
+  FRIEND_TEST(AnalysisPredictor, optim_program_cache);
 #endif
 
  private:
@@ -180,6 +192,7 @@ class AnalysisPredictor : public PaddlePredictor {
   // Some status here that help to determine the status inside the predictor.
   bool status_is_cloned_{false};
   bool status_use_gpu_{false};
+  bool status_optim_program_cache_hit_{false};
 };
 
 }  // namespace paddle
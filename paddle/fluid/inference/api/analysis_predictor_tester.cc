@@ -15,9 +15,12 @@
 #include "paddle/fluid/inference/api/analysis_predictor.h"
 #include <glog/logging.h>
 #include <gtest/gtest.h>
+#include <chrono>  // NOLINT
+#include <cstdio>
 #include <thread>  // NOLINT
 #include "paddle/fluid/framework/ir/pass.h"
 #include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/inference/analysis/helper.h"
 #include "paddle/fluid/inference/api/helper.h"
 #include "paddle/fluid/inference/api/paddle_inference_api.h"
 #include "paddle/fluid/inference/tests/api/tester_helper.h"
@@ -193,6 +196,68 @@ TEST(AnalysisPredictor, Clone) {
   }
 }
 
+TEST(AnalysisPredictor, optim_program_cache) {
+  std::string cache_dir =
+      ::testing::TempDir() + "optim_program_cache_test." +
+      std::to_string(
+          std::chrono::steady_clock::now().time_since_epoch().count());
+  ASSERT_NE(MKDIR(cache_dir.c_str()), -1);
+  AnalysisConfig config;
+  config.SetModel(FLAGS_dirname);
+  config.DisableGpu();
+  config.SetOptimCacheDir(cache_dir);
+  config.EnableOptimProgramCache();
+
+  int64_t data[4] = {1, 2, 3, 4};
+  PaddleTensor tensor;
+  tensor.shape = std::vector<int>({4, 1});
+  tensor.data.Reset(data, sizeof(data));
+  tensor.dtype = PaddleDType::INT64;
+  std::vector<PaddleTensor> inputs(4, tensor);
+
+  // The first predictor runs the analysis and saves the optimized program,
+  // the second one loads it.
+  std::vector<PaddleTensor> outputs, cached_outputs;
+  std::string program, cached_program, cache_path;
+  {
+    AnalysisConfig config0(config);
+    auto _predictor = CreatePaddlePredictor<AnalysisConfig>(config0);
+    auto* predictor = static_cast<AnalysisPredictor*>(_predictor.get());
+    ASSERT_FALSE(predictor->status_optim_program_cache_hit_);
+    ASSERT_TRUE(predictor->Run(inputs, &outputs));
+    program = predictor->GetSerializedProgram();
+  }
+  {
+    AnalysisConfig config1(config);
+    auto _predictor = CreatePaddlePredictor<AnalysisConfig>(config1);
+    auto* predictor = static_cast<AnalysisPredictor*>(_predictor.get());
+    ASSERT_TRUE(predictor->status_optim_program_cache_hit_);
+    ASSERT_TRUE(predictor->Run(inputs, &cached_outputs));
+    cached_program = predictor->GetSerializedProgram();
+  }
+  ASSERT_EQ(program, cached_program);
+  inference::CompareResult(outputs, cached_outputs);
+
+  // The cache of another key is not loaded even at the same path.
+  {
+    AnalysisConfig config2(config);
+    auto _predictor = CreatePaddlePredictor<AnalysisConfig>(config2);
+    auto* predictor = static_cast<AnalysisPredictor*>(_predictor.get());
+    std::string key;
+    cache_path = predictor->GetOptimProgramCachePath(&key);
+    ASSERT_TRUE(inference::analysis::FileExists(cache_path + "/key"));
+    ASSERT_TRUE(predictor->LoadOptimProgramCache(cache_path, key));
+    ASSERT_FALSE(predictor->LoadOptimProgramCache(cache_path, key + "x"));
+  }
+
+  for (auto* name : {"/model", "/params", "/key"}) {
+    std::remove((cache_path + name).c_str());
+  }
+  std::remove(cache_path.c_str());
+  std::remove(cache_dir.c_str());
+  ASSERT_FALSE(inference::analysis::PathExists(cache_dir));
+}
+
 // This function is not released yet, will fail on some machine.
 // TODO(Superjomn) Turn on it latter.
 /*
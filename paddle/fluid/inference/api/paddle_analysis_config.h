@@ -246,6 +246,18 @@ struct AnalysisConfig {
    */
   bool model_from_memory() const { return model_from_memory_; }
 
+  /** \brief Load the parameters by memory map.
+   *
+   * It only takes effect when the combined parameters file is saved in the
+   * aligned format (see `save_as_aligned` of save_combine_op) and the
+   * parameters are loaded on CPU. The parameters then share the pages of the
+   * file, which starts up faster and shares the memory between processes.
+   */
+  void EnableMemoryMapParams(bool x = true);
+  /** A boolean state telling whether the parameters are memory mapped.
+   */
+  bool memory_map_params_enabled() const { return use_mmap_params_; }
+
   /** Turn on memory optimize
    * NOTE still in development, will release latter.
    */
@@ -253,6 +265,19 @@ struct AnalysisConfig {
   /** Tell whether the memory optimization is activated. */
   bool enable_memory_optim() const;
 
+  /** \brief Turn on the cache of the optimized program.
+   *
+   * The optimized program and parameters are saved in the opt cache dir, or
+   * `_opt_cache` under the model directory, and the later predictors of the
+   * same model and config load them instead of running the analysis again.
+   * It is not supported with the TensorRT or Lite subgraph engines and the
+   * MKLDNN quantizer.
+   */
+  void EnableOptimProgramCache(bool x = true);
+  /** A boolean state telling whether the optimized program cache is enabled.
+   */
+  bool optim_program_cache_enabled() const { return use_optim_program_cache_; }
+
   /** \brief Turn on profiling report.
    *
    * If not turned on, no profiling report will be generateed.
@@ -326,11 +351,14 @@ struct AnalysisConfig {
   // memory reuse related.
   bool enable_memory_optim_{false};
 
+  bool use_optim_program_cache_{false};
+
   bool use_ngraph_{false};
   bool use_mkldnn_{false};
   std::unordered_set<std::string> mkldnn_enabled_op_types_;
 
   bool model_from_memory_{false};
+  bool use_mmap_params_{false};
 
   bool enable_ir_optim_{true};
   bool use_feed_fetch_ops_{true};
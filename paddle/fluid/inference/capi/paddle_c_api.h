@@ -254,6 +254,12 @@ PADDLE_CAPI_EXPORT extern void PD_EnableMemoryOptim(PD_AnalysisConfig* config);
 PADDLE_CAPI_EXPORT extern bool PD_MemoryOptimEnabled(
     const PD_AnalysisConfig* config);
 
+PADDLE_CAPI_EXPORT extern void PD_EnableOptimProgramCache(
+    PD_AnalysisConfig* config, bool x);
+
+PADDLE_CAPI_EXPORT extern bool PD_OptimProgramCacheEnabled(
+    const PD_AnalysisConfig* config);
+
 PADDLE_CAPI_EXPORT extern void PD_EnableProfile(PD_AnalysisConfig* config);
 
 PADDLE_CAPI_EXPORT extern bool PD_ProfileEnabled(
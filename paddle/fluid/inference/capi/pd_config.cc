@@ -240,6 +240,16 @@ bool PD_MemoryOptimEnabled(const PD_AnalysisConfig* config) {
   return config->config.enable_memory_optim();
 }
 
+void PD_EnableOptimProgramCache(PD_AnalysisConfig* config, bool x) {
+  PADDLE_ENFORCE_NOT_NULL(config);
+  config->config.EnableOptimProgramCache(x);
+}
+
+bool PD_OptimProgramCacheEnabled(const PD_AnalysisConfig* config) {
+  PADDLE_ENFORCE_NOT_NULL(config);
+  return config->config.optim_program_cache_enabled();
+}
+
 void PD_EnableProfile(PD_AnalysisConfig* config) {
   PADDLE_ENFORCE_NOT_NULL(config);
   config->config.EnableProfile();
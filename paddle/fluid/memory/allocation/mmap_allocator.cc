@@ -51,6 +51,28 @@ MemoryMapReaderAllocation::~MemoryMapReaderAllocation() {
   VLOG(3) << "~MemoryMapReaderAllocation: " << this->ipc_name();
 }
 
+MemoryMapFileAllocation::~MemoryMapFileAllocation() {
+  if (this->size() == 0) return;
+  PADDLE_ENFORCE_NE(
+      munmap(this->ptr(), this->size()), -1,
+      platform::errors::Unavailable("could not unmap the file %s",
+                                    this->file_path()));
+  VLOG(3) << "~MemoryMapFileAllocation: " << this->file_path();
+}
+
+MemoryMapFileRegionAllocation::MemoryMapFileRegionAllocation(
+    std::shared_ptr<MemoryMapFileAllocation> file, size_t offset, size_t size)
+    : Allocation(static_cast<uint8_t *>(file->ptr()) + offset, size,
+                 platform::CPUPlace()),
+      file_(std::move(file)) {
+  PADDLE_ENFORCE_LE(offset + size, file_->size(),
+                    platform::errors::OutOfRange(
+                        "The region [%d, %d) exceeds the size %d of the "
+                        "memory mapped file %s.",
+                        offset, offset + size, file_->size(),
+                        file_->file_path()));
+}
+
 std::string GetIPCName() {
   static std::random_device rd;
   std::string handle = "/paddle_";
@@ -87,13 +109,15 @@ std::shared_ptr<MemoryMapWriterAllocation> AllocateMemoryMapWriterAllocation(
 }
 
 std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
-    const std::string &ipc_name, size_t size) {
+    const std::string &ipc_name, size_t size, bool copy_on_write) {
   int fd = shm_open(ipc_name.c_str(), O_RDONLY, 0644);
   PADDLE_ENFORCE_NE(
       fd, -1, platform::errors::Unavailable("File descriptor %s open failed",
                                             ipc_name.c_str()));
 
-  void *ptr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  void *ptr = copy_on_write
+                  ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0)
+                  : mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
   PADDLE_ENFORCE_NE(ptr, MAP_FAILED,
                     platform::errors::Unavailable(
                         "Memory map failed when rebuild shared memory."));
@@ -101,6 +125,33 @@ std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
   return std::make_shared<MemoryMapReaderAllocation>(ptr, size, ipc_name);
 }
 
+std::shared_ptr<MemoryMapFileAllocation> MapFileToMemory(
+    const std::string &file_path) {
+  int fd = open(file_path.c_str(), O_RDONLY);
+  PADDLE_ENFORCE_NE(fd, -1, platform::errors::NotFound(
+                                "Cannot open file %s to map it into memory.",
+                                file_path));
+  struct stat file_stat;
+  PADDLE_ENFORCE_EQ(
+      fstat(fd, &file_stat), 0,
+      platform::errors::Unavailable("Cannot get the status of file %s.",
+                                    file_path));
+  size_t size = static_cast<size_t>(file_stat.st_size);
+  void *ptr = nullptr;
+  if (size > 0) {
+    // A private writable mapping lets the owner of a tensor modify it in place
+    // without touching the file, while clean pages stay in the page cache.
+    ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    PADDLE_ENFORCE_NE(ptr, MAP_FAILED,
+                      platform::errors::Unavailable(
+                          "Memory map failed when mapping file %s.",
+                          file_path));
+  }
+  close(fd);
+  VLOG(3) << "MapFileToMemory: " << file_path << ", size: " << size;
+  return std::make_shared<MemoryMapFileAllocation>(ptr, size, file_path);
+}
+
 MemoryMapFdSet &MemoryMapFdSet::Instance() {  // NOLINT
   static MemoryMapFdSet set;
   return set;
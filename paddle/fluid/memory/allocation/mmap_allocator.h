@@ -58,11 +58,47 @@ class MemoryMapReaderAllocation : public Allocation {
   std::string ipc_name_;
 };
 
+// Maps a regular file into memory with a private, copy-on-write mapping.
+// Pages are loaded lazily and shared with the page cache (and therefore with
+// other processes mapping the same file) until they are written.
+class MemoryMapFileAllocation : public Allocation {
+ public:
+  explicit MemoryMapFileAllocation(void *ptr, size_t size,
+                                   std::string file_path)
+      : Allocation(ptr, size, platform::CPUPlace()),
+        file_path_(std::move(file_path)) {}
+
+  inline const std::string &file_path() const { return file_path_; }
+
+  ~MemoryMapFileAllocation() override;
+
+ private:
+  std::string file_path_;
+};
+
+// A sub-region of a MemoryMapFileAllocation. It keeps the whole mapping
+// alive, so that tensors can hold a region of the file as their own buffer.
+class MemoryMapFileRegionAllocation : public Allocation {
+ public:
+  explicit MemoryMapFileRegionAllocation(
+      std::shared_ptr<MemoryMapFileAllocation> file, size_t offset,
+      size_t size);
+
+ private:
+  std::shared_ptr<MemoryMapFileAllocation> file_;
+};
+
 std::shared_ptr<MemoryMapWriterAllocation> AllocateMemoryMapWriterAllocation(
     size_t size);
 
+// Maps the shared memory written by a MemoryMapWriterAllocation. If
+// copy_on_write is true, the mapping is private and writable, so the reader
+// can modify the data without affecting the shared memory.
 std::shared_ptr<MemoryMapReaderAllocation> RebuildMemoryMapReaderAllocation(
-    const std::string &ipc_name, size_t size);
+    const std::string &ipc_name, size_t size, bool copy_on_write = false);
+
+std::shared_ptr<MemoryMapFileAllocation> MapFileToMemory(
+    const std::string &file_path);
 
 class MemoryMapFdSet {
  public:
@@ -144,6 +144,63 @@ inline void ExtractActivationGradTensor(
   }
 }
 
+namespace detail {
+// Gives the elements [begin, end) of v if v has numel elements, or v itself
+// if not, e.g. for an unused input.
+template <typename EigenVec>
+EigenVec Chunk(const EigenVec& v, int64_t numel, int64_t begin, int64_t end) {
+  if (v.size() != numel) return v;
+  return EigenVec(v.data() + begin, end - begin);
+}
+}  // namespace detail
+
+// The elements of a chunk activated by one intra-op thread.
+constexpr int64_t kActivationGrainSize = 16384;
+
+template <typename DeviceContext, typename Functor, typename X, typename Out>
+void RunActivationFunctor(const DeviceContext& ctx, Functor functor, X x,
+                          Out out) {
+  functor(*ctx.eigen_device(), x, out);
+}
+
+// On CPU, the large tensors are split into chunks activated by the intra-op
+// threads of the context.
+template <typename Functor, typename X, typename Out>
+void RunActivationFunctor(const platform::CPUDeviceContext& ctx,
+                          Functor functor, X x, Out out) {
+  int64_t numel = out.size();
+  ctx.ParallelFor(numel, kActivationGrainSize,
+                  [&](int64_t begin, int64_t end) {
+                    Functor chunk_functor = functor;
+                    chunk_functor(*ctx.eigen_device(),
+                                  detail::Chunk(x, numel, begin, end),
+                                  detail::Chunk(out, numel, begin, end));
+                  });
+}
+
+template <typename DeviceContext, typename Functor, typename X, typename Out,
+          typename dOut, typename dX>
+void RunActivationFunctor(const DeviceContext& ctx, Functor functor, X x,
+                          Out out, dOut dout, dX dx) {
+  functor(*ctx.eigen_device(), x, out, dout, dx);
+}
+
+template <typename Functor, typename X, typename Out, typename dOut,
+          typename dX>
+void RunActivationFunctor(const platform::CPUDeviceContext& ctx,
+                          Functor functor, X x, Out out, dOut dout, dX dx) {
+  int64_t numel = dx.size();
+  ctx.ParallelFor(numel, kActivationGrainSize,
+                  [&](int64_t begin, int64_t end) {
+                    Functor chunk_functor = functor;
+                    chunk_functor(*ctx.eigen_device(),
+                                  detail::Chunk(x, numel, begin, end),
+                                  detail::Chunk(out, numel, begin, end),
+                                  detail::Chunk(dout, numel, begin, end),
+                                  detail::Chunk(dx, numel, begin, end));
+                  });
+}
+
 template <typename DeviceContext, typename Functor>
 class ActivationKernel
     : public framework::OpKernel<typename Functor::ELEMENT_TYPE> {
@@ -158,15 +215,14 @@ class ActivationKernel
 
     auto x = framework::EigenVector<T>::Flatten(detail::Ref(X));
     auto out = framework::EigenVector<T>::Flatten(detail::Ref(Out));
-    auto* place =
-        context.template device_context<DeviceContext>().eigen_device();
+    auto& dev_ctx = context.template device_context<DeviceContext>();
     Functor functor;
 
     auto attrs = functor.GetAttrs();
     for (auto& attr : attrs) {
       *attr.second = context.Attr<float>(attr.first);
     }
-    functor(*place, x, out);
+    RunActivationFunctor(dev_ctx, functor, x, out);
   }
 };
 
@@ -186,14 +242,13 @@ class ActivationGradKernel
     auto out = framework::EigenVector<T>::Flatten(detail::Ref(Out));
     auto dx = framework::EigenVector<T>::Flatten(detail::Ref(dX));
     auto x = framework::EigenVector<T>::Flatten(detail::Ref(X));
-    auto* place =
-        context.template device_context<DeviceContext>().eigen_device();
+    auto& dev_ctx = context.template device_context<DeviceContext>();
     Functor functor;
     auto attrs = functor.GetAttrs();
     for (auto& attr : attrs) {
       *attr.second = context.Attr<float>(attr.first);
     }
-    functor(*place, x, out, dout, dx);
+    RunActivationFunctor(dev_ctx, functor, x, out, dout, dx);
   }
 };
 
@@ -1643,8 +1698,7 @@ class PowKernel : public framework::OpKernel<typename Functor::ELEMENT_TYPE> {
 
     auto x = framework::EigenVector<T>::Flatten(detail::Ref(X));
     auto out = framework::EigenVector<T>::Flatten(detail::Ref(Out));
-    auto* place =
-        context.template device_context<DeviceContext>().eigen_device();
+    auto& dev_ctx = context.template device_context<DeviceContext>();
     Functor functor;
     auto attrs = functor.GetAttrs();
     for (auto& attr : attrs) {
@@ -1670,7 +1724,7 @@ class PowKernel : public framework::OpKernel<typename Functor::ELEMENT_TYPE> {
         *attr.second = factor[0];
       }
     }
-    functor(*place, x, out);
+    RunActivationFunctor(dev_ctx, functor, x, out);
   }
 };
 
@@ -1690,8 +1744,7 @@ class PowGradKernel
     auto out = framework::EigenVector<T>::Flatten(detail::Ref(Out));
     auto dx = framework::EigenVector<T>::Flatten(detail::Ref(dX));
     auto x = framework::EigenVector<T>::Flatten(detail::Ref(X));
-    auto* place =
-        context.template device_context<DeviceContext>().eigen_device();
+    auto& dev_ctx = context.template device_context<DeviceContext>();
     Functor functor;
     auto attrs = functor.GetAttrs();
     for (auto& attr : attrs) {
@@ -1718,7 +1771,7 @@ class PowGradKernel
         *attr.second = factor[0];
       }
     }
-    functor(*place, x, out, dout, dx);
+    RunActivationFunctor(dev_ctx, functor, x, out, dout, dx);
   }
 };
 }  // namespace operators
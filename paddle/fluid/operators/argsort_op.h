@@ -18,6 +18,7 @@ limitations under the License. */
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/math/topk.h"
 #include "paddle/fluid/operators/transpose_op.h"
 
 namespace paddle {
@@ -33,42 +34,6 @@ using EigenVector = framework::EigenVector<T, MajorType, IndexType>;
 
 using Tensor = framework::Tensor;
 
-template <typename T, typename Type>
-static void FullSort(Type input_height, Type input_width, int input_dim,
-                     const framework::Tensor* input, T* t_out, Type* t_indices,
-                     bool descending) {
-#ifdef PADDLE_WITH_MKLML
-#pragma omp parallel for
-#endif
-  for (Type i = 0; i < input_height; ++i) {
-    std::vector<std::pair<T, Type>> col_vec;
-    col_vec.reserve(input_width);
-    if (input_dim == 1) {
-      auto e_input = EigenVector<T>::Flatten(*input);
-      for (Type j = 0; j < input_width; ++j) {
-        col_vec.push_back(std::pair<T, Type>(e_input(j), j));
-      }
-    } else {
-      auto e_input = EigenMatrix<T>::Reshape(*input, input_dim - 1);
-      for (Type j = 0; j < input_width; ++j) {
-        col_vec.push_back(std::pair<T, Type>(e_input(i, j), j));
-      }
-    }
-    std::sort(col_vec.begin(), col_vec.end(),
-              [&](const std::pair<T, Type>& l, const std::pair<T, Type>& r) {
-                if (descending)
-                  return l.first > r.first;
-                else
-                  return l.first < r.first;
-              });
-
-    for (Type j = 0; j < input_width; ++j) {
-      t_out[i * input_width + j] = col_vec[j].first;
-      t_indices[i * input_width + j] = col_vec[j].second;
-    }
-  }
-}
-
 template <typename T, typename Type>
 static void FullAssign(Type input_height, Type input_width, int input_dim,
                        const framework::Tensor* input,
@@ -115,8 +80,10 @@ class ArgsortKernel : public framework::OpKernel<T> {
       const int64_t input_width = in_dims[in_dims.size() - 1];
 
       int64_t* ids_data = indices->mutable_data<int64_t>(ctx.GetPlace());
-      FullSort<T, int64_t>(input_height, input_width, in_dims.size(), input,
-                           out_data, ids_data, descending);
+      math::ArgsortRows<T>(
+          ctx.template device_context<platform::CPUDeviceContext>(),
+          input->data<T>(), input_height, input_width, descending, out_data,
+          ids_data);
     } else {
       // If not full sort do transpose
       std::vector<int> trans;
@@ -154,8 +121,8 @@ class ArgsortKernel : public framework::OpKernel<T> {
       auto* t_ind =
           tmp_indices.mutable_data<int64_t>(trans_dims, ctx.GetPlace());
 
-      FullSort<T, int64_t>(input_height, input_width, in_dims.size(),
-                           &trans_inp, t_out, t_ind, descending);
+      math::ArgsortRows<T>(dev_ctx, trans_inp.data<T>(), input_height,
+                           input_width, descending, t_out, t_ind);
 
       indices->mutable_data<int64_t>(ctx.GetPlace());
       TransCompute<platform::CPUDeviceContext, int64_t>(
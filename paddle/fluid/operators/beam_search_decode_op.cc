@@ -25,8 +25,10 @@ struct BeamSearchDecodeFunctor {
   BeamSearchDecodeFunctor(const LoDTensorArray& step_ids,
                           const LoDTensorArray& step_scores,
                           LoDTensor* id_tensor, LoDTensor* score_tensor,
-                          size_t beam_size, int end_id)
-      : beam_size_(beam_size),
+                          size_t beam_size, int end_id,
+                          const platform::CPUDeviceContext& cpu_ctx)
+      : cpu_ctx_(cpu_ctx),
+        beam_size_(beam_size),
         end_id_(end_id),
         step_ids_origin_(step_ids),
         step_scores_origin_(step_scores),
@@ -76,6 +78,8 @@ struct BeamSearchDecodeFunctor {
   template <typename T>
   void apply() const;
 
+  // The backtrace runs on the CPU copies of the tensors.
+  const platform::CPUDeviceContext& cpu_ctx_;
   bool tensor_on_gpu_;
   size_t beam_size_;
   int end_id_;
@@ -95,11 +99,12 @@ void BeamSearchDecodeFunctor::apply() const {
   BeamSearchDecoder<T> beam_search_decoder(beam_size_, end_id_);
   // Check if the tensor is on GPU. If so, use the CPU copy instead
   if (tensor_on_gpu_) {
-    beam_search_decoder.Backtrace(step_ids_, step_scores_, id_tensor_,
-                                  score_tensor_);
-  } else {
-    beam_search_decoder.Backtrace(step_ids_origin_, step_scores_origin_,
+    beam_search_decoder.Backtrace(cpu_ctx_, step_ids_, step_scores_,
                                   id_tensor_, score_tensor_);
+  } else {
+    beam_search_decoder.Backtrace(cpu_ctx_, step_ids_origin_,
+                                  step_scores_origin_, id_tensor_,
+                                  score_tensor_);
   }
 }
 
@@ -145,10 +150,15 @@ class BeamSearchDecodeOp : public framework::OperatorBase {
     LoDTensor* sentenceIds = ctx.Output<LoDTensor>("SentenceIds");
     LoDTensor* sentenceScores = ctx.Output<LoDTensor>("SentenceScores");
 
+    // The context of the op unless it runs on GPU, whose outputs are
+    // decoded on CPU anyway.
+    auto* cpu_ctx = static_cast<platform::CPUDeviceContext*>(
+        platform::is_cpu_place(dev_place) ? &dev_ctx
+                                          : pool.Get(platform::CPUPlace()));
     framework::VisitDataType(
         scores->at(0).type(),
         BeamSearchDecodeFunctor(*ids, *scores, sentenceIds, sentenceScores,
-                                beam_size, end_id));
+                                beam_size, end_id, *cpu_ctx));
   }
 };
 
@@ -15,10 +15,12 @@ limitations under the License. */
 #pragma once
 
 #include <algorithm>
+#include <utility>
 #include <vector>
 
 #include "paddle/fluid/framework/lod_tensor_array.h"
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/platform/device_context.h"
 
 namespace paddle {
 namespace operators {
@@ -66,12 +68,23 @@ struct BeamSearchDecoder {
 
   /**
    * Gather the hypotheses for each source sentence by backtrace though the
-   * LoDTensorArray step_ids whose lods reserve the path in the tree.
+   * LoDTensorArray step_ids whose lods reserve the path in the tree. The
+   * sources are split among the intra-op threads of the context.
    */
-  void Backtrace(const LoDTensorArray& step_ids,
+  void Backtrace(const platform::CPUDeviceContext& context,
+                 const LoDTensorArray& step_ids,
                  const LoDTensorArray& step_scores, LoDTensor* id_tensor,
                  LoDTensor* score_tensor) const;
 
+  /**
+   * Backtrace the hypotheses of the source src_idx by one step. The
+   * prefix_idx_vector keeps the prefix of each hypothesis in the step.
+   */
+  void BacktraceStep(const LoDTensor& cur_ids, const LoDTensor& cur_scores,
+                     size_t step_id, size_t src_idx,
+                     std::vector<size_t>* prefix_idx_vector,
+                     SentenceVector<T>* sentence_vector) const;
+
   size_t beam_size_;
   int end_id_;
 };
@@ -86,8 +99,6 @@ void BeamSearchDecoder<T>::ConvertSentenceVectorToLodTensor(
 
   std::vector<size_t> source_level_lod = {0};
   std::vector<size_t> sentence_level_lod = {0};
-  std::vector<int64_t> id_data;
-  std::vector<T> score_data;
 
   for (size_t src_idx = 0; src_idx < src_num; ++src_idx) {
     if (sort_by_score) {
@@ -101,18 +112,6 @@ void BeamSearchDecoder<T>::ConvertSentenceVectorToLodTensor(
            });
     }
     for (Sentence<T>& sentence : sentence_vector_list[src_idx]) {
-      if (reverse) {
-        id_data.insert(id_data.end(), sentence.word_ids.rbegin(),
-                       sentence.word_ids.rend());
-        score_data.insert(score_data.end(), sentence.scores.rbegin(),
-                          sentence.scores.rend());
-      } else {
-        id_data.insert(id_data.end(), sentence.word_ids.begin(),
-                       sentence.word_ids.end());
-        score_data.insert(score_data.end(), sentence.scores.begin(),
-                          sentence.scores.end());
-      }
-
       sentence_level_lod.push_back(sentence_level_lod.back() +
                                    sentence.word_ids.size());
     }
@@ -120,30 +119,41 @@ void BeamSearchDecoder<T>::ConvertSentenceVectorToLodTensor(
                                sentence_vector_list[src_idx].size());
   }
 
-  auto cpu_place = std::unique_ptr<paddle::platform::CPUPlace>(
-      new paddle::platform::CPUPlace());
-  paddle::platform::CPUDeviceContext cpu_ctx(*cpu_place);
-
   framework::LoD lod;
   lod.push_back(source_level_lod);
   lod.push_back(sentence_level_lod);
 
+  // The sentences are written into the outputs directly.
+  const int64_t num_words = static_cast<int64_t>(sentence_level_lod.back());
   id_tensor->set_lod(lod);
-  id_tensor->Resize({static_cast<int64_t>(id_data.size())});
-  id_tensor->mutable_data<int64_t>(paddle::platform::CPUPlace());
-  framework::TensorFromVector<int64_t>(id_data, cpu_ctx, id_tensor);
-
+  id_tensor->Resize({num_words});
+  int64_t* id_data = id_tensor->mutable_data<int64_t>(platform::CPUPlace());
   score_tensor->set_lod(lod);
-  score_tensor->Resize({static_cast<int64_t>(score_data.size())});
-  score_tensor->mutable_data<T>(paddle::platform::CPUPlace());
-  framework::TensorFromVector<T>(score_data, cpu_ctx, score_tensor);
+  score_tensor->Resize({num_words});
+  T* score_data = score_tensor->mutable_data<T>(platform::CPUPlace());
+
+  for (auto& sentence_vector : sentence_vector_list) {
+    for (Sentence<T>& sentence : sentence_vector) {
+      if (reverse) {
+        id_data = std::copy(sentence.word_ids.rbegin(),
+                            sentence.word_ids.rend(), id_data);
+        score_data = std::copy(sentence.scores.rbegin(),
+                               sentence.scores.rend(), score_data);
+      } else {
+        id_data = std::copy(sentence.word_ids.begin(), sentence.word_ids.end(),
+                            id_data);
+        score_data = std::copy(sentence.scores.begin(), sentence.scores.end(),
+                               score_data);
+      }
+    }
+  }
 }
 
 template <typename T>
-void BeamSearchDecoder<T>::Backtrace(const LoDTensorArray& step_ids,
-                                     const LoDTensorArray& step_scores,
-                                     LoDTensor* id_tensor,
-                                     LoDTensor* score_tensor) const {
+void BeamSearchDecoder<T>::Backtrace(
+    const platform::CPUDeviceContext& context, const LoDTensorArray& step_ids,
+    const LoDTensorArray& step_scores, LoDTensor* id_tensor,
+    LoDTensor* score_tensor) const {
   PADDLE_ENFORCE(!step_ids.empty(), "step num should be larger than 0");
   PADDLE_ENFORCE_EQ(step_ids.size(), step_scores.size(),
                     "step_ids and step_scores should be the same");
@@ -151,65 +161,80 @@ void BeamSearchDecoder<T>::Backtrace(const LoDTensorArray& step_ids,
   const size_t src_num = step_ids.at(0).lod().at(kSourceLevel).size() - 1;
   std::vector<SentenceVector<T>> sentence_vector_list(
       src_num, SentenceVector<T>(beam_size_));
-  std::vector<std::vector<size_t>> prefix_idx_vector_list(src_num);
-  for (int step_id = step_num - 1; step_id >= 0; --step_id) {
-    auto& cur_ids = step_ids.at(step_id);
-    auto& cur_scores = step_scores.at(step_id);
-    for (size_t src_idx = 0; src_idx < src_num; ++src_idx) {
-      // for each source sentence
+  // The sources are backtraced independently, each by one intra-op thread.
+  context.ParallelFor(src_num, 1, [&](int64_t begin, int64_t end) {
+    std::vector<size_t> prefix_idx_vector;
+    prefix_idx_vector.reserve(beam_size_);
+    for (int64_t src_idx = begin; src_idx < end; ++src_idx) {
       auto& sentence_vector = sentence_vector_list.at(src_idx);
-      auto& prefix_idx_vector = prefix_idx_vector_list.at(src_idx);
-      size_t src_prefix_start = cur_ids.lod().at(kSourceLevel)[src_idx];
-      size_t src_prefix_end = cur_ids.lod().at(kSourceLevel)[src_idx + 1];
-      if (prefix_idx_vector.empty()) {  // be finished and pruned at this step
-                                        // or the last time step
-        for (size_t prefix_idx = src_prefix_start; prefix_idx < src_prefix_end;
-             ++prefix_idx) {
-          size_t candidate_start = cur_ids.lod().at(kSentenceLevel)[prefix_idx];
-          size_t candidate_end =
-              cur_ids.lod().at(kSentenceLevel)[prefix_idx + 1];
-          for (size_t candidate_idx = candidate_start;
-               candidate_idx < candidate_end; ++candidate_idx) {
-            prefix_idx_vector.push_back(prefix_idx);
-            size_t idx = prefix_idx_vector.size() - 1;
-            auto cur_id = cur_ids.data<int64_t>()[candidate_idx];
-            auto cur_score = cur_scores.data<T>()[candidate_idx];
-            sentence_vector.at(idx).word_ids.push_back(cur_id);
-            sentence_vector.at(idx).scores.push_back(cur_score);
-          }
-        }
-      } else {  // use prefix_idx_vector to backtrace
-        size_t src_candidate_start =
-            cur_ids.lod().at(kSentenceLevel)[src_prefix_start];
-        size_t prefix_idx = src_prefix_start;
-        size_t candidate_num =
-            cur_ids.lod().at(kSentenceLevel)[prefix_idx + 1] -
-            cur_ids.lod().at(kSentenceLevel)[prefix_idx];
-        for (size_t idx = 0; idx < prefix_idx_vector.size(); ++idx) {
-          auto candidate_idx = prefix_idx_vector.at(idx);
-          auto cur_id = cur_ids.data<int64_t>()[candidate_idx];
-          auto cur_score = cur_scores.data<T>()[candidate_idx];
-          if (cur_id != end_id_ || sentence_vector.at(idx).word_ids.empty()) {
-            // to skip redundant end tokens
-            sentence_vector.at(idx).word_ids.push_back(cur_id);
-            sentence_vector.at(idx).scores.push_back(cur_score);
-          }
-
-          while (src_candidate_start + candidate_num <=
-                 candidate_idx) {  // search the corresponding prefix
-            prefix_idx++;
-            candidate_num += cur_ids.lod().at(kSentenceLevel)[prefix_idx + 1] -
-                             cur_ids.lod().at(kSentenceLevel)[prefix_idx];
-          }
-          prefix_idx_vector.at(idx) = prefix_idx;
-        }
+      prefix_idx_vector.clear();
+      for (int step_id = step_num - 1; step_id >= 0; --step_id) {
+        BacktraceStep(step_ids.at(step_id), step_scores.at(step_id), step_id,
+                      src_idx, &prefix_idx_vector, &sentence_vector);
       }
     }
-  }
+  });
 
-  ConvertSentenceVectorToLodTensor(sentence_vector_list, id_tensor,
+  ConvertSentenceVectorToLodTensor(std::move(sentence_vector_list), id_tensor,
                                    score_tensor, true, true);
 }
 
+template <typename T>
+void BeamSearchDecoder<T>::BacktraceStep(
+    const LoDTensor& cur_ids, const LoDTensor& cur_scores, size_t step_id,
+    size_t src_idx, std::vector<size_t>* prefix_idx_vector_ptr,
+    SentenceVector<T>* sentence_vector_ptr) const {
+  auto& prefix_idx_vector = *prefix_idx_vector_ptr;
+  auto& sentence_vector = *sentence_vector_ptr;
+  const auto& source_level = cur_ids.lod().at(kSourceLevel);
+  const auto& sentence_level = cur_ids.lod().at(kSentenceLevel);
+  const int64_t* cur_ids_data = cur_ids.data<int64_t>();
+  const T* cur_scores_data = cur_scores.data<T>();
+  size_t src_prefix_start = source_level[src_idx];
+  size_t src_prefix_end = source_level[src_idx + 1];
+  if (prefix_idx_vector.empty()) {  // be finished and pruned at this step
+                                    // or the last time step
+    for (size_t prefix_idx = src_prefix_start; prefix_idx < src_prefix_end;
+         ++prefix_idx) {
+      size_t candidate_start = sentence_level[prefix_idx];
+      size_t candidate_end = sentence_level[prefix_idx + 1];
+      for (size_t candidate_idx = candidate_start;
+           candidate_idx < candidate_end; ++candidate_idx) {
+        prefix_idx_vector.push_back(prefix_idx);
+        size_t idx = prefix_idx_vector.size() - 1;
+        auto& sentence = sentence_vector.at(idx);
+        // A sentence started at this step has at most step_id + 1 words.
+        sentence.word_ids.reserve(step_id + 1);
+        sentence.scores.reserve(step_id + 1);
+        sentence.word_ids.push_back(cur_ids_data[candidate_idx]);
+        sentence.scores.push_back(cur_scores_data[candidate_idx]);
+      }
+    }
+  } else {  // use prefix_idx_vector to backtrace
+    size_t src_candidate_start = sentence_level[src_prefix_start];
+    size_t prefix_idx = src_prefix_start;
+    size_t candidate_num =
+        sentence_level[prefix_idx + 1] - sentence_level[prefix_idx];
+    for (size_t idx = 0; idx < prefix_idx_vector.size(); ++idx) {
+      auto candidate_idx = prefix_idx_vector.at(idx);
+      auto cur_id = cur_ids_data[candidate_idx];
+      auto cur_score = cur_scores_data[candidate_idx];
+      if (cur_id != end_id_ || sentence_vector.at(idx).word_ids.empty()) {
+        // to skip redundant end tokens
+        sentence_vector.at(idx).word_ids.push_back(cur_id);
+        sentence_vector.at(idx).scores.push_back(cur_score);
+      }
+
+      while (src_candidate_start + candidate_num <=
+             candidate_idx) {  // search the corresponding prefix
+        prefix_idx++;
+        candidate_num +=
+            sentence_level[prefix_idx + 1] - sentence_level[prefix_idx];
+      }
+      prefix_idx_vector.at(idx) = prefix_idx;
+    }
+  }
+}
+
 }  // namespace operators
 }  // namespace paddle
@@ -108,7 +108,8 @@ TEST(BeamSearchDecodeOp, Backtrace) {
 
   LoDTensor id_tensor;
   LoDTensor score_tensor;
-  helper.Backtrace(ids, scores, &id_tensor, &score_tensor);
+  paddle::platform::CPUDeviceContext context;
+  helper.Backtrace(context, ids, scores, &id_tensor, &score_tensor);
 
   LoD lod = id_tensor.lod();
   std::vector<size_t> expect_source_lod = {0, 2, 4};
@@ -19,6 +19,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_info.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/variable_helper.h"
+#include "paddle/fluid/platform/cpu_helper.h"
 #include "paddle/fluid/platform/init.h"
 #include "paddle/fluid/platform/profiler.h"
 #include "paddle/fluid/platform/timer.h"
@@ -101,6 +102,35 @@ void OpTester::Run() {
   config_.runtime = timer.ElapsedMS() / config_.repeat;
   LOG(INFO) << "=== Run " << config_.repeat
             << " times, latency: " << config_.runtime << " ms ===";
+
+  if (platform::is_cpu_place(place_) && !config_.intra_op_threads.empty()) {
+    RunIntraOpScaling();
+  }
+}
+
+void OpTester::RunIntraOpScaling() {
+  int num_threads = platform::GetIntraOpNumThreads();
+  double base_runtime = 0.0;
+  for (int threads : config_.intra_op_threads) {
+    platform::SetIntraOpNumThreads(threads);
+    // Warm up
+    RunImpl();
+
+    platform::Timer timer;
+    timer.Start();
+    for (int i = config_.repeat; i > 0; --i) {
+      RunImpl();
+    }
+    timer.Pause();
+    double runtime = timer.ElapsedMS() / config_.repeat;
+    if (base_runtime == 0.0) {
+      base_runtime = runtime;
+    }
+    LOG(INFO) << "=== intra_op_threads: " << threads
+              << ", latency: " << runtime
+              << " ms, speedup: " << base_runtime / runtime << " ===";
+  }
+  platform::SetIntraOpNumThreads(num_threads);
 }
 
 void OpTester::RunImpl() {
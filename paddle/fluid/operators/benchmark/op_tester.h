@@ -58,6 +58,8 @@ class OpTester {
                    const std::string &initializer, const std::string &filename);
 
   void RunImpl();
+  // Measures the latency with each of config_.intra_op_threads.
+  void RunIntraOpScaling();
 
  private:
   OpTesterConfig config_;
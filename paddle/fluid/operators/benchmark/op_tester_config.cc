@@ -175,6 +175,8 @@ bool OpTesterConfig::Init(std::istream& is) {
         is >> profile;
       } else if (sep == "print_debug_string" || sep == "print_debug_string:") {
         is >> print_debug_string;
+      } else if (sep == "intra_op_threads" || sep == "intra_op_threads:") {
+        ParseIntraOpThreads(is);
       } else if (sep == "input" || sep == "input:") {
         OpInputConfig input_config(is);
         inputs.push_back(input_config);
@@ -192,6 +194,18 @@ bool OpTesterConfig::Init(std::istream& is) {
   return true;
 }
 
+void OpTesterConfig::ParseIntraOpThreads(std::istream& is) {
+  std::string threads_str;
+  is >> threads_str;
+
+  intra_op_threads.clear();
+  std::string token;
+  std::istringstream token_stream(threads_str);
+  while (std::getline(token_stream, token, ',')) {
+    intra_op_threads.push_back(std::stoi(token));
+  }
+}
+
 bool OpTesterConfig::ParseAttrs(std::istream& is) {
   std::string sep;
   is >> sep;
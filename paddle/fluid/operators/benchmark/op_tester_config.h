@@ -48,6 +48,7 @@ struct OpTesterConfig {
   bool Init(std::istream& is);
 
   bool ParseAttrs(std::istream& is);
+  void ParseIntraOpThreads(std::istream& is);
 
   const OpInputConfig* GetInput(const std::string& name);
 
@@ -58,6 +59,8 @@ struct OpTesterConfig {
   int repeat{1};
   int profile{0};
   int print_debug_string{0};
+  // The intra-op threads to measure the scaling of, e.g. 1,2,4,8.
+  std::vector<int> intra_op_threads;
   double runtime{0.0};
 };
 
@@ -57,9 +57,8 @@ class ConditionalBlockInferOp : public ConditionalOp {
       scopes->front() = &scope.NewScope();
       auto &cur_scope = *scopes->front();
 
-      framework::Executor exec(dev_place);
-      auto *block = Attr<framework::BlockDesc *>("sub_block");
-      exec.Run(*block->Program(), &cur_scope, block->ID(), false);
+      RunSubBlock(dev_place, &cur_scope, std::vector<std::string>(),
+                  /* keep_kid_scopes */ false);
       scope.DeleteScope(scopes->front());
     }
   }
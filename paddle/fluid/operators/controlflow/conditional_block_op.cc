@@ -61,15 +61,13 @@ class ConditionalBlockOp : public ConditionalOp {
       scopes->resize(1);
       scopes->front() = &scope.NewScope();
       auto &cur_scope = *scopes->front();
-      framework::Executor exec(dev_place);
       auto *block = Attr<framework::BlockDesc *>("sub_block");
       VLOG(3) << "Conditional block.idx = " << block->ID()
               << ", scope = " << &cur_scope;
       auto &skip_vars =
           Attr<std::vector<std::string>>(ConditionalOp::kSkipEagerDeletionVars);
-      exec.Run(*block->Program(), &cur_scope, block->ID(), false, true,
-               skip_vars, /* force_disable_gc */ false,
-               /* keep_kid_scopes */ true);
+      RunSubBlock(dev_place, &cur_scope, skip_vars,
+                  /* keep_kid_scopes */ true);
     }
   }
 };
@@ -125,14 +123,12 @@ class ConditionalBlockGradOp : public ConditionalOp {
                             "Scope must be set in conditional block op"));
       framework::Scope &cur_scope = *scopes[0];
 
-      framework::Executor exec(dev_place);
       auto *block = Attr<framework::BlockDesc *>("sub_block");
 
       VLOG(3) << "Conditional Grad block.idx = " << block->ID()
               << ", scope = " << &cur_scope;
-      exec.Run(*block->Program(), &cur_scope, block->ID(), false, true,
-               inside_grads, /* force_disable_gc */ false,
-               /* keep_kid_scopes */ false);
+      RunSubBlock(dev_place, &cur_scope, inside_grads,
+                  /* keep_kid_scopes */ false);
 
       AssignLocalGradientToParentScope(dev_place, cur_scope, scope,
                                        inside_grads, outside_grads);
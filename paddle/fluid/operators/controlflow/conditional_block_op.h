@@ -22,6 +22,8 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/var_type.h"
 
+DECLARE_bool(use_mkldnn);
+
 namespace paddle {
 namespace operators {
 
@@ -79,6 +81,22 @@ class ConditionalOp : public framework::OperatorBase {
     }
     return res;
   }
+
+  // Runs the sub-block in scope, the prepared sub-block is cached between
+  // the runs of this op.
+  void RunSubBlock(const platform::Place &dev_place, framework::Scope *scope,
+                   const std::vector<std::string> &skip_vars,
+                   bool keep_kid_scopes) const {
+    framework::Executor exec(dev_place);
+    auto *block = Attr<framework::BlockDesc *>("sub_block");
+    auto *program = block->Program();
+    if (FLAGS_use_mkldnn) exec.EnableMKLDNN(*program);
+    auto ctx = ctx_cache_.Get(*program, block->ID(), skip_vars);
+    exec.RunPreparedContext(ctx.get(), scope, false, true, keep_kid_scopes);
+  }
+
+ private:
+  mutable framework::ExecutorPrepareContextCache ctx_cache_;
 };
 
 class ConditionalBlockOpProtoMaker : public framework::OpProtoAndCheckerMaker {
@@ -21,6 +21,8 @@
 #include "paddle/fluid/operators/controlflow/while_op_helper.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
 
+DECLARE_bool(cache_sub_block_context);
+
 namespace paddle {
 namespace operators {
 
@@ -63,6 +65,16 @@ class WhileOp : public framework::OperatorBase {
     auto step_scopes =
         scope.FindVar(Output(kStepScopes))->GetMutable<StepScopeVar>();
 
+    bool is_test = Attr<bool>("is_test");
+    // In inference the scope of the last run is reused, it has been reused
+    // between the iterations of that run already.
+    framework::Scope *test_scope = nullptr;
+    if (is_test && FLAGS_cache_sub_block_context &&
+        step_scopes->size() == 1 && scope.HasKid(step_scopes->front())) {
+      test_scope = step_scopes->front();
+      step_scopes->clear();
+    }
+
     if (step_scopes->size() > 0) {
       platform::DeviceContextPool::Instance().Get(dev_place)->Wait();
       for (auto &s : *step_scopes) {
@@ -76,11 +88,10 @@ class WhileOp : public framework::OperatorBase {
     PADDLE_ENFORCE_EQ(step_scopes->size(), 0, "The StepScope should be empty.");
 
     bool cond_data = GetCondData(cond);
-    bool is_test = Attr<bool>("is_test");
     auto &skip_vars = Attr<std::vector<std::string>>(kSkipEagerDeletionVars);
     VLOG(2) << GetSkipEagerDeletionVarsDebugString(skip_vars);
 
-    auto ctx = executor.Prepare(*program, block->ID(), skip_vars);
+    auto ctx = ctx_cache_.Get(*program, block->ID(), skip_vars);
     if (!is_test) {
       while (cond_data) {
         auto &current_scope = scope.NewScope();
@@ -91,8 +102,11 @@ class WhileOp : public framework::OperatorBase {
             GetCondData(scope.FindVar(Input(kCondition))->Get<LoDTensor>());
       }
     } else {
-      auto &current_scope = scope.NewScope();
-      executor.CreateVariables(*program, &current_scope, block->ID());
+      if (test_scope == nullptr) {
+        test_scope = &scope.NewScope();
+        executor.CreateVariables(*program, test_scope, block->ID());
+      }
+      auto &current_scope = *test_scope;
       while (cond_data) {
         for (auto &name : current_scope.LocalVarNames()) {
           auto *var = current_scope.Var(name);
@@ -112,9 +126,15 @@ class WhileOp : public framework::OperatorBase {
         cond_data =
             GetCondData(scope.FindVar(Input(kCondition))->Get<LoDTensor>());
       }
-      scope.DeleteScope(&current_scope);
+      if (FLAGS_cache_sub_block_context) {
+        step_scopes->push_back(&current_scope);
+      } else {
+        scope.DeleteScope(&current_scope);
+      }
     }
   }
+
+  mutable framework::ExecutorPrepareContextCache ctx_cache_;
 };
 
 class WhileOpMaker : public framework::OpProtoAndCheckerMaker {
@@ -172,7 +192,7 @@ class WhileGradOp : public framework::OperatorBase {
 
     auto &skip_vars = Attr<std::vector<std::string>>(kSkipEagerDeletionVars);
     VLOG(2) << GetSkipEagerDeletionVarsDebugString(skip_vars);
-    auto ctx = executor.Prepare(*program, block->ID(), skip_vars);
+    auto ctx = ctx_cache_.Get(*program, block->ID(), skip_vars);
 
     auto *step_scopes =
         scope.FindVar(Input(kStepScopes))->GetMutable<StepScopeVar>();
@@ -321,6 +341,8 @@ class WhileGradOp : public framework::OperatorBase {
     }
     step_scopes->clear();
   }
+
+  mutable framework::ExecutorPrepareContextCache ctx_cache_;
 };
 
 template <typename T>
@@ -0,0 +1,160 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <chrono>  // NOLINT
+#include <memory>
+#include <string>
+#include <vector>
+#include "gflags/gflags.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/program_desc.h"
+#include "paddle/fluid/framework/scope.h"
+
+USE_NO_KERNEL_OP(while);
+USE_OP(increment);
+USE_OP(less_than);
+USE_OP(scale);
+
+DECLARE_bool(cache_sub_block_context);
+
+namespace paddle {
+namespace operators {
+
+using framework::LoDTensor;
+using framework::Scope;
+
+// A decoder like loop: every step increases the counter, scales x num_scale
+// times and checks the counter against n.
+static std::unique_ptr<framework::ProgramDesc> BuildWhileProgram(
+    int num_scale, float scale_factor, bool is_test) {
+  std::unique_ptr<framework::ProgramDesc> program(new framework::ProgramDesc);
+  auto* root = program->MutableBlock(0);
+  for (auto* name : {"i", "n", "x", "cond", "step_scopes"}) {
+    root->Var(name);
+  }
+  auto* sub = program->AppendBlock(*root);
+
+  auto* increment = sub->AppendOp();
+  increment->SetType("increment");
+  increment->SetInput("X", {"i"});
+  increment->SetOutput("Out", {"i"});
+  increment->SetAttr("step", 1.0f);
+  for (int k = 0; k < num_scale; ++k) {
+    auto* scale = sub->AppendOp();
+    scale->SetType("scale");
+    scale->SetInput("X", {"x"});
+    scale->SetOutput("Out", {"x"});
+    scale->SetAttr("scale", scale_factor);
+  }
+  auto* less_than = sub->AppendOp();
+  less_than->SetType("less_than");
+  less_than->SetInput("X", {"i"});
+  less_than->SetInput("Y", {"n"});
+  less_than->SetOutput("Out", {"cond"});
+
+  auto* while_op = root->AppendOp();
+  while_op->SetType("while");
+  while_op->SetInput("X", {"i", "n", "x"});
+  while_op->SetInput("Condition", {"cond"});
+  while_op->SetOutput("Out", {"i", "x", "cond"});
+  while_op->SetOutput("StepScopes", {"step_scopes"});
+  while_op->SetBlockAttr("sub_block", sub);
+  while_op->SetAttr("is_test", is_test);
+  return program;
+}
+
+static void InitScope(Scope* scope, int64_t steps) {
+  platform::CPUPlace place;
+  scope->Var("i")->GetMutable<LoDTensor>()->mutable_data<int64_t>({1},
+                                                                 place)[0] = 0;
+  scope->Var("n")->GetMutable<LoDTensor>()->mutable_data<int64_t>({1},
+                                                                 place)[0] =
+      steps;
+  scope->Var("cond")->GetMutable<LoDTensor>()->mutable_data<bool>({1},
+                                                                 place)[0] =
+      true;
+  scope->Var("x")->GetMutable<LoDTensor>()->mutable_data<float>({1, 4},
+                                                               place);
+  float* x = scope->Var("x")->GetMutable<LoDTensor>()->data<float>();
+  for (int k = 0; k < 4; ++k) x[k] = 1.0f;
+  scope->Var("step_scopes")->GetMutable<std::vector<Scope*>>();
+}
+
+static float RunWhile(framework::OperatorBase* op, Scope* scope,
+                      int64_t steps) {
+  InitScope(scope, steps);
+  op->Run(*scope, platform::CPUPlace());
+  EXPECT_EQ(scope->FindVar("i")->Get<LoDTensor>().data<int64_t>()[0], steps);
+  return scope->FindVar("x")->Get<LoDTensor>().data<float>()[0];
+}
+
+TEST(WhileOp, cached_sub_block) {
+  for (bool is_test : {true, false}) {
+    auto program = BuildWhileProgram(1, 2.0f, is_test);
+    auto op = framework::OpRegistry::CreateOp(*program->Block(0).Op(0));
+    Scope scope;
+    for (int run = 0; run < 3; ++run) {
+      EXPECT_FLOAT_EQ(RunWhile(op.get(), &scope, 4), 16.0f);
+      auto& step_scopes =
+          scope.FindVar("step_scopes")->Get<std::vector<Scope*>>();
+      EXPECT_EQ(step_scopes.size(), is_test ? 1UL : 4UL);
+    }
+
+    // The cached sub-block must follow the changes of the block.
+    auto* scale = program->MutableBlock(1)->InsertOp(1);
+    scale->SetType("scale");
+    scale->SetInput("X", {"x"});
+    scale->SetOutput("Out", {"x"});
+    scale->SetAttr("scale", 2.0f);
+    EXPECT_FLOAT_EQ(RunWhile(op.get(), &scope, 4), 256.0f);
+
+    // And the changes of the attributes of its ops in place.
+    scale->SetAttr("scale", 0.5f);
+    EXPECT_FLOAT_EQ(RunWhile(op.get(), &scope, 4), 1.0f);
+    program->MutableBlock(1)->Op(2)->SetAttr("scale", 3.0f);
+    EXPECT_FLOAT_EQ(RunWhile(op.get(), &scope, 4), 5.0625f);
+  }
+}
+
+TEST(WhileOp, decoder_benchmark) {
+  const int64_t steps = 32;
+  const int runs = 200;
+  auto program = BuildWhileProgram(8, 1.0f, true);
+  auto op = framework::OpRegistry::CreateOp(*program->Block(0).Op(0));
+
+  bool cache_flag = FLAGS_cache_sub_block_context;
+  float results[2];
+  for (bool cache : {false, true}) {
+    FLAGS_cache_sub_block_context = cache;
+    Scope scope;
+    RunWhile(op.get(), &scope, steps);
+    auto start = std::chrono::steady_clock::now();
+    for (int run = 0; run < runs; ++run) {
+      results[cache] = RunWhile(op.get(), &scope, steps);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double us =
+        std::chrono::duration<double, std::micro>(end - start).count();
+    LOG(INFO) << "while op with " << (cache ? "cached" : "uncached")
+              << " sub-block: " << us / runs << " us/run, "
+              << us / runs / steps << " us/step";
+  }
+  FLAGS_cache_sub_block_context = cache_flag;
+  EXPECT_FLOAT_EQ(results[0], 1.0f);
+  EXPECT_FLOAT_EQ(results[1], 1.0f);
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -136,6 +136,97 @@ void ConvOp::InferShape(framework::InferShapeContext* ctx) const {
   ctx->ShareLoD("Input", "Output");
 }
 
+template <>
+void Int8GemmConv2D<platform::CPUDeviceContext, float>(
+    const framework::ExecutionContext& context, const Tensor& input,
+    const Tensor& filter, const std::vector<int>& strides,
+    const std::vector<int>& paddings, const std::vector<int>& dilations,
+    int groups, Tensor* output) {
+  PADDLE_ENFORCE_EQ(filter.dims().size(), 4,
+                    platform::errors::Unimplemented(
+                        "The int8 filter is only supported by conv2d."));
+  auto& dev_ctx = context.template device_context<platform::CPUDeviceContext>();
+  const float scale_in = context.Attr<float>("Scale_in");
+  const auto scale_weights = context.Attr<std::vector<float>>("Scale_weights");
+  const int out_channels = static_cast<int>(filter.dims()[0]);
+  PADDLE_ENFORCE_EQ(scale_weights.size() == 1UL ||
+                        scale_weights.size() ==
+                            static_cast<size_t>(out_channels),
+                    true, platform::errors::InvalidArgument(
+                              "The number of Scale_weights should be 1 or "
+                              "%d, but got %d.",
+                              out_channels, scale_weights.size()));
+  std::vector<float> dequant_scale(out_channels);
+  for (int c = 0; c < out_channels; ++c) {
+    dequant_scale[c] =
+        1.f / (scale_in * scale_weights[scale_weights.size() > 1 ? c : 0]);
+  }
+
+  Tensor input_int8;
+  input_int8.Resize(input.dims());
+  math::QuantizeInt8(dev_ctx, input.numel(), input.data<float>(), scale_in,
+                     input_int8.mutable_data<int8_t>(platform::CPUPlace()));
+
+  const int batch_size = static_cast<int>(input.dims()[0]);
+  const int in_step = static_cast<int>(input.dims()[1]) / groups;
+  const int out_step = out_channels / groups;
+  const int K = static_cast<int>(filter.numel() / out_channels);
+  const int spatial = static_cast<int>(output->dims()[2] * output->dims()[3]);
+
+  std::vector<int64_t> filter_shape_vec(framework::vectorize(filter.dims()));
+  bool is_expand = IsExpand(filter_shape_vec, strides, paddings, dilations);
+  Tensor col;
+  if (is_expand) {
+    col.mutable_data<int8_t>(
+        framework::make_ddim({in_step, filter_shape_vec[2],
+                              filter_shape_vec[3], output->dims()[2],
+                              output->dims()[3]}),
+        platform::CPUPlace());
+  }
+  Tensor out_int32;
+  int32_t* out_int32_data = out_int32.mutable_data<int32_t>(
+      framework::make_ddim({out_step, spatial}), platform::CPUPlace());
+
+  math::Im2ColFunctor<math::ColFormat::kCFO, platform::CPUDeviceContext,
+                      int8_t>
+      im2col;
+  framework::DDim in_matrix_shape =
+      framework::slice_ddim(input.dims(), 1, input.dims().size());
+  const int8_t* filter_data = filter.data<int8_t>();
+  float* output_data = output->data<float>();
+  for (int i = 0; i < batch_size; i++) {
+    Tensor in_batch = input_int8.Slice(i, i + 1).Resize(in_matrix_shape);
+    for (int g = 0; g < groups; g++) {
+      Tensor in_slice = in_batch.Slice(g * in_step, (g + 1) * in_step);
+      const int8_t* col_data = in_slice.data<int8_t>();
+      if (is_expand) {
+        im2col(dev_ctx, in_slice, dilations, strides,
+               std::vector<int>{paddings[0], paddings[2], paddings[1],
+                                paddings[3]},
+               &col);
+        col_data = col.data<int8_t>();
+      }
+      math::Int8Gemm(dev_ctx, out_step, spatial, K,
+                     filter_data + static_cast<int64_t>(g) * out_step * K,
+                     col_data, out_int32_data);
+
+      int channel_begin = g * out_step;
+      float* out_slice = output_data +
+                         (static_cast<int64_t>(i) * out_channels +
+                          channel_begin) *
+                             spatial;
+      for (int c = 0; c < out_step; ++c) {
+        float scale = dequant_scale[channel_begin + c];
+        const int32_t* src = out_int32_data + static_cast<int64_t>(c) * spatial;
+        float* dst = out_slice + static_cast<int64_t>(c) * spatial;
+        for (int s = 0; s < spatial; ++s) {
+          dst[s] = src[s] * scale;
+        }
+      }
+    }
+  }
+}
+
 framework::OpKernelType ConvOp::GetExpectedKernelType(
     const framework::ExecutionContext& ctx) const {
   int customized_type_value =
@@ -168,8 +259,13 @@ framework::OpKernelType ConvOp::GetExpectedKernelType(
   if (input_data_type != framework::proto::VarType::INT8 &&
       input_data_type != framework::proto::VarType::UINT8) {
     auto filter_data_type = ctx.Input<Tensor>("Filter")->type();
-    PADDLE_ENFORCE_EQ(input_data_type, filter_data_type,
-                      "input and filter data type should be consistent");
+    // The int8 filter of the float input is quantized by the
+    // native_int8_quantize_pass.
+    if (filter_data_type != framework::proto::VarType::INT8 ||
+        input_data_type != framework::proto::VarType::FP32) {
+      PADDLE_ENFORCE_EQ(input_data_type, filter_data_type,
+                        "input and filter data type should be consistent");
+    }
   }
   if (input_data_type == framework::proto::VarType::FP16) {
     PADDLE_ENFORCE_EQ(library, framework::LibraryType::kCUDNN,
@@ -24,6 +24,7 @@ limitations under the License. */
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/depthwise_conv.h"
 #include "paddle/fluid/operators/math/im2col.h"
+#include "paddle/fluid/operators/math/int8_gemm.h"
 #include "paddle/fluid/operators/math/vol2col.h"
 
 namespace paddle {
@@ -288,6 +289,28 @@ class ConvOpDoubleGrad : public framework::OperatorWithKernel {
       const framework::ExecutionContext& ctx) const override;
 };
 
+// Computes conv2d by the int8 filter quantized by the
+// native_int8_quantize_pass, the input is quantized by the attr Scale_in and
+// the output channel c is dequantized by 1 / (Scale_in * Scale_weights[c]).
+// The input and output are channel first.
+template <typename DeviceContext, typename T>
+void Int8GemmConv2D(const framework::ExecutionContext& context,
+                    const Tensor& input, const Tensor& filter,
+                    const std::vector<int>& strides,
+                    const std::vector<int>& paddings,
+                    const std::vector<int>& dilations, int groups,
+                    Tensor* output) {
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "The int8 filter is only supported by the float CPU kernel."));
+}
+
+template <>
+void Int8GemmConv2D<platform::CPUDeviceContext, float>(
+    const framework::ExecutionContext& context, const Tensor& input,
+    const Tensor& filter, const std::vector<int>& strides,
+    const std::vector<int>& paddings, const std::vector<int>& dilations,
+    int groups, Tensor* output);
+
 template <typename DeviceContext, typename T>
 class GemmConvKernel : public framework::OpKernel<T> {
  public:
@@ -338,6 +361,17 @@ class GemmConvKernel : public framework::OpKernel<T> {
     UpdatePaddingAndDilation(&paddings, &dilations, padding_algorithm,
                              in_data_dims, strides, ksize);
 
+    if (filter.type() == framework::proto::VarType::INT8) {
+      Int8GemmConv2D<DeviceContext, T>(context, transformed_input, filter,
+                                       strides, paddings, dilations, groups,
+                                       &transformed_output);
+      if (channel_last) {
+        TransToChannelLast<DeviceContext, T>(context, &transformed_output,
+                                             output);
+      }
+      return;
+    }
+
     auto& dev_ctx = context.template device_context<DeviceContext>();
 
     const int batch_size = static_cast<int>(transformed_input.dims()[0]);
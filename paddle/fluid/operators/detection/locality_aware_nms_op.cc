@@ -148,7 +148,6 @@ class LocalityAwareNMSKernel : public framework::OpKernel<T> {
     int64_t box_size = bbox->dims()[1];
 
     std::vector<std::pair<T, int>> sorted_indices;
-    T adaptive_threshold = nms_threshold;
     T* bbox_data = bbox->data<T>();
     T* scores_data = scores->data<T>();
 
@@ -156,42 +155,24 @@ class LocalityAwareNMSKernel : public framework::OpKernel<T> {
         scores_data, bbox_data, box_size, score_threshold, top_k, num_boxes,
         &sorted_indices, nms_threshold, normalized);
 
-    selected_indices->clear();
-
-    while (sorted_indices.size() != 0) {
-      const int idx = sorted_indices.front().second;
-      bool keep = true;
-      for (size_t k = 0; k < selected_indices->size(); ++k) {
-        if (keep) {
-          const int kept_idx = (*selected_indices)[k];
-          T overlap = T(0.);
-          // 4: [xmin ymin xmax ymax]
-          if (box_size == 4) {
-            overlap =
-                JaccardOverlap<T>(bbox_data + idx * box_size,
-                                  bbox_data + kept_idx * box_size, normalized);
-          }
-          // 8: [x1 y1 x2 y2 x3 y3 x4 y4] or 16, 24, 32
-          if (box_size == 8 || box_size == 16 || box_size == 24 ||
-              box_size == 32) {
-            overlap = PolyIoU<T>(bbox_data + idx * box_size,
-                                 bbox_data + kept_idx * box_size, box_size,
-                                 normalized);
-          }
-          keep = overlap <= adaptive_threshold;
-        } else {
-          break;
-        }
-      }
-      if (keep) {
-        selected_indices->push_back(idx);
-      }
-      sorted_indices.erase(sorted_indices.begin());
-      if (keep && eta < 1 && adaptive_threshold > 0.5) {
-        adaptive_threshold *= eta;
-      }
+    // 4: [xmin ymin xmax ymax]
+    if (box_size == 4) {
+      GreedyBoxNMS<T>(bbox_data, box_size, sorted_indices, nms_threshold, eta,
+                      normalized, selected_indices);
+      return;
     }
-    //    delete bbox_data;
+    GreedyNMS<T>(sorted_indices, nms_threshold, eta,
+                 [&](int idx, int kept_idx) {
+                   // 8: [x1 y1 x2 y2 x3 y3 x4 y4] or 16, 24, 32
+                   if (box_size == 8 || box_size == 16 || box_size == 24 ||
+                       box_size == 32) {
+                     return PolyIoU<T>(bbox_data + idx * box_size,
+                                       bbox_data + kept_idx * box_size,
+                                       box_size, normalized);
+                   }
+                   return T(0.);
+                 },
+                 selected_indices);
   }
 
   void LocalityAwareNMS(const framework::ExecutionContext& ctx, Tensor* scores,
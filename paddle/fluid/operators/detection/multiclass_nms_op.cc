@@ -129,43 +129,25 @@ class MultiClassNMSKernel : public framework::OpKernel<T> {
     std::vector<std::pair<T, int>> sorted_indices;
     GetMaxScoreIndex(scores_data, score_threshold, top_k, &sorted_indices);
 
-    selected_indices->clear();
-    T adaptive_threshold = nms_threshold;
     const T* bbox_data = bbox.data<T>();
-
-    while (sorted_indices.size() != 0) {
-      const int idx = sorted_indices.front().second;
-      bool keep = true;
-      for (size_t k = 0; k < selected_indices->size(); ++k) {
-        if (keep) {
-          const int kept_idx = (*selected_indices)[k];
-          T overlap = T(0.);
-          // 4: [xmin ymin xmax ymax]
-          if (box_size == 4) {
-            overlap =
-                JaccardOverlap<T>(bbox_data + idx * box_size,
-                                  bbox_data + kept_idx * box_size, normalized);
-          }
-          // 8: [x1 y1 x2 y2 x3 y3 x4 y4] or 16, 24, 32
-          if (box_size == 8 || box_size == 16 || box_size == 24 ||
-              box_size == 32) {
-            overlap = PolyIoU<T>(bbox_data + idx * box_size,
-                                 bbox_data + kept_idx * box_size, box_size,
-                                 normalized);
-          }
-          keep = overlap <= adaptive_threshold;
-        } else {
-          break;
-        }
-      }
-      if (keep) {
-        selected_indices->push_back(idx);
-      }
-      sorted_indices.erase(sorted_indices.begin());
-      if (keep && eta < 1 && adaptive_threshold > 0.5) {
-        adaptive_threshold *= eta;
-      }
+    // 4: [xmin ymin xmax ymax]
+    if (box_size == 4) {
+      GreedyBoxNMS<T>(bbox_data, box_size, sorted_indices, nms_threshold, eta,
+                      normalized, selected_indices);
+      return;
     }
+    GreedyNMS<T>(sorted_indices, nms_threshold, eta,
+                 [&](int idx, int kept_idx) {
+                   // 8: [x1 y1 x2 y2 x3 y3 x4 y4] or 16, 24, 32
+                   if (box_size == 8 || box_size == 16 || box_size == 24 ||
+                       box_size == 32) {
+                     return PolyIoU<T>(bbox_data + idx * box_size,
+                                       bbox_data + kept_idx * box_size,
+                                       box_size, normalized);
+                   }
+                   return T(0.);
+                 },
+                 selected_indices);
   }
 
   void MultiClassNMS(const framework::ExecutionContext& ctx,
@@ -185,29 +167,41 @@ class MultiClassNMSKernel : public framework::OpKernel<T> {
     int num_det = 0;
 
     int64_t class_num = scores_size == 3 ? scores.dims()[0] : scores.dims()[1];
-    Tensor bbox_slice, score_slice;
+    // The classes are independent, so they are suppressed in parallel. The
+    // entries of indices are created first to be filled by the threads.
+    std::vector<std::vector<int>*> class_indices(class_num, nullptr);
     for (int64_t c = 0; c < class_num; ++c) {
       if (c == background_label) continue;
-      if (scores_size == 3) {
-        score_slice = scores.Slice(c, c + 1);
-        bbox_slice = bboxes;
-      } else {
-        score_slice.Resize({scores.dims()[0], 1});
-        bbox_slice.Resize({scores.dims()[0], 4});
-        SliceOneClass<T>(dev_ctx, scores, c, &score_slice);
-        SliceOneClass<T>(dev_ctx, bboxes, c, &bbox_slice);
-      }
-      NMSFast(bbox_slice, score_slice, score_threshold, nms_threshold, nms_eta,
-              nms_top_k, &((*indices)[c]), normalized);
-      if (scores_size == 2) {
-        std::stable_sort((*indices)[c].begin(), (*indices)[c].end());
+      class_indices[c] = &(*indices)[c];
+    }
+    dev_ctx.ParallelFor(class_num, 1, [&](int64_t begin, int64_t end) {
+      Tensor bbox_slice, score_slice;
+      for (int64_t c = begin; c < end; ++c) {
+        if (c == background_label) continue;
+        if (scores_size == 3) {
+          score_slice = scores.Slice(c, c + 1);
+          bbox_slice = bboxes;
+        } else {
+          score_slice.Resize({scores.dims()[0], 1});
+          bbox_slice.Resize({scores.dims()[0], 4});
+          SliceOneClass<T>(dev_ctx, scores, c, &score_slice);
+          SliceOneClass<T>(dev_ctx, bboxes, c, &bbox_slice);
+        }
+        NMSFast(bbox_slice, score_slice, score_threshold, nms_threshold,
+                nms_eta, nms_top_k, class_indices[c], normalized);
+        if (scores_size == 2) {
+          std::stable_sort(class_indices[c]->begin(), class_indices[c]->end());
+        }
       }
-      num_det += (*indices)[c].size();
+    });
+    for (auto* selected : class_indices) {
+      if (selected) num_det += selected->size();
     }
 
     *num_nmsed_out = num_det;
     const T* scores_data = scores.data<T>();
     if (keep_top_k > -1 && num_det > keep_top_k) {
+      Tensor score_slice;
       const T* sdata;
       std::vector<std::pair<float, std::pair<int, int>>> score_index_pairs;
       for (const auto& it : *indices) {
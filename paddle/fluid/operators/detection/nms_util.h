@@ -99,5 +99,199 @@ T PolyIoU(const T* box1, const T* box2, const size_t box_size,
   }
 }
 
+// Greedy NMS of the candidates in sorted_indices, which are sorted by their
+// scores in descending order. A candidate is kept if its overlap with each
+// kept one is not larger than the adaptive threshold, which is multiplied by
+// eta after a candidate is kept while it is larger than 0.5. overlap(i, j)
+// gives the overlap of the boxes i and j.
+template <class T, typename Overlap>
+void GreedyNMS(const std::vector<std::pair<T, int>>& sorted_indices,
+               const T nms_threshold, const T eta, Overlap overlap,
+               std::vector<int>* selected_indices) {
+  selected_indices->clear();
+  T adaptive_threshold = nms_threshold;
+  for (const auto& candidate : sorted_indices) {
+    const int idx = candidate.second;
+    bool keep = true;
+    for (int kept_idx : *selected_indices) {
+      if (!(overlap(idx, kept_idx) <= adaptive_threshold)) {
+        keep = false;
+        break;
+      }
+    }
+    if (keep) {
+      selected_indices->push_back(idx);
+      if (eta < 1 && adaptive_threshold > 0.5) {
+        adaptive_threshold *= eta;
+      }
+    }
+  }
+}
+
+// The boxes [xmin, ymin, xmax, ymax] stored by coordinates, so that the
+// overlaps of a box with all of them are computed in a vectorized loop.
+template <class T>
+class NMSBoxList {
+ public:
+  void Add(const T* box, const T area) {
+    xmin_.push_back(box[0]);
+    ymin_.push_back(box[1]);
+    xmax_.push_back(box[2]);
+    ymax_.push_back(box[3]);
+    area_.push_back(area);
+  }
+
+  // Whether JaccardOverlap(box, b) <= threshold is false for any box b of the
+  // list.
+  bool Suppress(const T* box, const T area, const T threshold,
+                const bool normalized) const {
+    constexpr size_t kBlock = 16;
+    const T norm = normalized ? static_cast<T>(0.) : static_cast<T>(1.);
+    const size_t num = xmin_.size();
+    for (size_t begin = 0; begin < num; begin += kBlock) {
+      const size_t end = std::min(num, begin + kBlock);
+      bool suppressed = false;
+      for (size_t k = begin; k < end; ++k) {
+        // The same computation as JaccardOverlap(box, b), a disjoint box has
+        // the overlap 0, which is still suppressed by a negative or NaN
+        // threshold.
+        bool disjoint = (xmin_[k] > box[2]) || (xmax_[k] < box[0]) ||
+                        (ymin_[k] > box[3]) || (ymax_[k] < box[1]);
+        T inter_w = std::min(box[2], xmax_[k]) - std::max(box[0], xmin_[k]) +
+                    norm;
+        T inter_h = std::min(box[3], ymax_[k]) - std::max(box[1], ymin_[k]) +
+                    norm;
+        T inter_area = inter_w * inter_h;
+        T overlap = disjoint ? static_cast<T>(0.)
+                             : inter_area / (area + area_[k] - inter_area);
+        suppressed |= !(overlap <= threshold);
+      }
+      if (suppressed) return true;
+    }
+    return false;
+  }
+
+ private:
+  std::vector<T> xmin_;
+  std::vector<T> ymin_;
+  std::vector<T> xmax_;
+  std::vector<T> ymax_;
+  std::vector<T> area_;
+};
+
+// GreedyNMS with JaccardOverlap of the boxes [xmin, ymin, xmax, ymax], the box
+// i is at bbox_data + i * stride. With many candidates and a non-negative
+// threshold, the kept boxes are also bucketed into a uniform grid and a
+// candidate is only compared with the ones in the cells it covers, since the
+// boxes not intersecting do not overlap.
+template <class T>
+void GreedyBoxNMS(const T* bbox_data, const int64_t stride,
+                  const std::vector<std::pair<T, int>>& sorted_indices,
+                  const T nms_threshold, const T eta, const bool normalized,
+                  std::vector<int>* selected_indices) {
+  // The least candidates to use the grid.
+  constexpr size_t kGridMinBoxes = 512;
+  // The most cells a box is bucketed into, larger boxes are kept in a list
+  // compared with all the candidates.
+  constexpr int kGridMaxCells = 16;
+  constexpr int kGridMaxSize = 64;
+
+  selected_indices->clear();
+  const bool use_grid =
+      sorted_indices.size() >= kGridMinBoxes && nms_threshold >= 0;
+
+  // The grid covers the candidates with cells about twice the average size
+  // of them, the boxes out of it are clamped to the border cells.
+  T x0 = 0, y0 = 0, cell_w = 1, cell_h = 1;
+  int grid_w = 1, grid_h = 1;
+  if (use_grid) {
+    T x1 = 0, y1 = 0, sum_w = 0, sum_h = 0;
+    size_t num_valid = 0;
+    for (const auto& candidate : sorted_indices) {
+      const T* box = bbox_data + candidate.second * stride;
+      if (!(box[0] <= box[2] && box[1] <= box[3])) continue;
+      if (num_valid == 0) {
+        x0 = box[0], y0 = box[1], x1 = box[2], y1 = box[3];
+      }
+      x0 = std::min(x0, box[0]), y0 = std::min(y0, box[1]);
+      x1 = std::max(x1, box[2]), y1 = std::max(y1, box[3]);
+      sum_w += box[2] - box[0];
+      sum_h += box[3] - box[1];
+      ++num_valid;
+    }
+    if (num_valid > 0) {
+      cell_w = std::max(2 * sum_w / num_valid, static_cast<T>(1e-6));
+      cell_h = std::max(2 * sum_h / num_valid, static_cast<T>(1e-6));
+      grid_w = std::min<T>((x1 - x0) / cell_w + 1, kGridMaxSize);
+      grid_h = std::min<T>((y1 - y0) / cell_h + 1, kGridMaxSize);
+      grid_w = std::max(grid_w, 1);
+      grid_h = std::max(grid_h, 1);
+      cell_w = std::max((x1 - x0) / grid_w, static_cast<T>(1e-6));
+      cell_h = std::max((y1 - y0) / grid_h, static_cast<T>(1e-6));
+    }
+  }
+  auto cell_x = [&](T x) {
+    T c = (x - x0) / cell_w;
+    if (!(c > 0)) return 0;
+    return c >= grid_w - 1 ? grid_w - 1 : static_cast<int>(c);
+  };
+  auto cell_y = [&](T y) {
+    T c = (y - y0) / cell_h;
+    if (!(c > 0)) return 0;
+    return c >= grid_h - 1 ? grid_h - 1 : static_cast<int>(c);
+  };
+
+  NMSBoxList<T> kept;
+  NMSBoxList<T> large;
+  std::vector<NMSBoxList<T>> cells(use_grid ? grid_w * grid_h : 0);
+  T adaptive_threshold = nms_threshold;
+  for (const auto& candidate : sorted_indices) {
+    const int idx = candidate.second;
+    const T* box = bbox_data + idx * stride;
+    const T area = BBoxArea<T>(box, normalized);
+    // The invalid boxes, and the boxes covering too many cells, are compared
+    // without the grid.
+    bool in_grid = use_grid && box[0] <= box[2] && box[1] <= box[3];
+    int cx0 = 0, cx1 = 0, cy0 = 0, cy1 = 0;
+    if (in_grid) {
+      cx0 = cell_x(box[0]), cx1 = cell_x(box[2]);
+      cy0 = cell_y(box[1]), cy1 = cell_y(box[3]);
+      in_grid = (cx1 - cx0 + 1) * (cy1 - cy0 + 1) <= kGridMaxCells;
+    }
+
+    bool keep;
+    if (in_grid) {
+      keep = !large.Suppress(box, area, adaptive_threshold, normalized);
+      for (int cy = cy0; keep && cy <= cy1; ++cy) {
+        for (int cx = cx0; keep && cx <= cx1; ++cx) {
+          keep = !cells[cy * grid_w + cx].Suppress(box, area,
+                                                  adaptive_threshold,
+                                                  normalized);
+        }
+      }
+    } else {
+      keep = !kept.Suppress(box, area, adaptive_threshold, normalized);
+    }
+    if (!keep) continue;
+
+    selected_indices->push_back(idx);
+    kept.Add(box, area);
+    if (use_grid) {
+      if (in_grid) {
+        for (int cy = cy0; cy <= cy1; ++cy) {
+          for (int cx = cx0; cx <= cx1; ++cx) {
+            cells[cy * grid_w + cx].Add(box, area);
+          }
+        }
+      } else {
+        large.Add(box, area);
+      }
+    }
+    if (eta < 1 && adaptive_threshold > 0.5) {
+      adaptive_threshold *= eta;
+    }
+  }
+}
+
 }  // namespace operators
 }  // namespace paddle
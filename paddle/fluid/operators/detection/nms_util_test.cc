@@ -0,0 +1,168 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/detection/nms_util.h"
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/platform/timer.h"
+
+namespace paddle {
+namespace operators {
+
+// The NMS of the kernels before, which erases the candidates one by one and
+// compares each of them with all the kept boxes.
+template <typename T>
+void EraseNMS(const T* bbox_data, std::vector<std::pair<T, int>> sorted_indices,
+              const T nms_threshold, const T eta, const bool normalized,
+              std::vector<int>* selected_indices) {
+  selected_indices->clear();
+  T adaptive_threshold = nms_threshold;
+  while (sorted_indices.size() != 0) {
+    const int idx = sorted_indices.front().second;
+    bool keep = true;
+    for (size_t k = 0; k < selected_indices->size(); ++k) {
+      const int kept_idx = (*selected_indices)[k];
+      T overlap = JaccardOverlap<T>(bbox_data + idx * 4,
+                                    bbox_data + kept_idx * 4, normalized);
+      keep = overlap <= adaptive_threshold;
+      if (!keep) break;
+    }
+    if (keep) {
+      selected_indices->push_back(idx);
+    }
+    sorted_indices.erase(sorted_indices.begin());
+    if (keep && eta < 1 && adaptive_threshold > 0.5) {
+      adaptive_threshold *= eta;
+    }
+  }
+}
+
+// Random boxes in an image of the size, some of them invalid or empty.
+void RandomBoxes(int num, float size, float max_box_size, std::mt19937* engine,
+                 std::vector<float>* boxes,
+                 std::vector<std::pair<float, int>>* sorted_indices) {
+  std::uniform_real_distribution<float> pos(0.f, size);
+  std::uniform_real_distribution<float> len(0.f, max_box_size);
+  std::uniform_real_distribution<float> score(0.f, 1.f);
+  boxes->resize(num * 4);
+  std::vector<float> scores(num);
+  for (int i = 0; i < num; ++i) {
+    float* box = boxes->data() + i * 4;
+    box[0] = pos(*engine);
+    box[1] = pos(*engine);
+    box[2] = box[0] + len(*engine);
+    box[3] = box[1] + len(*engine);
+    if (i % 97 == 0) {
+      std::swap(box[0], box[2]);
+    } else if (i % 101 == 0) {
+      box[2] = box[0];
+      box[3] = box[1];
+    }
+    scores[i] = score(*engine);
+  }
+  sorted_indices->clear();
+  GetMaxScoreIndex(scores, 0.05f, -1, sorted_indices);
+}
+
+void CheckGreedyNMS(int num, bool normalized, float max_box_ratio,
+                    float nms_threshold, float eta) {
+  std::mt19937 engine(num);
+  const float size = normalized ? 1.f : 800.f;
+  std::vector<float> boxes;
+  std::vector<std::pair<float, int>> sorted_indices;
+  RandomBoxes(num, size, size * max_box_ratio, &engine, &boxes,
+              &sorted_indices);
+
+  std::vector<int> expected, selected;
+  EraseNMS<float>(boxes.data(), sorted_indices, nms_threshold, eta,
+                  normalized, &expected);
+  GreedyBoxNMS<float>(boxes.data(), 4, sorted_indices, nms_threshold, eta,
+                      normalized, &selected);
+  EXPECT_EQ(selected, expected);
+  GreedyNMS<float>(sorted_indices, nms_threshold, eta,
+                   [&](int i, int j) {
+                     return JaccardOverlap<float>(boxes.data() + i * 4,
+                                                  boxes.data() + j * 4,
+                                                  normalized);
+                   },
+                   &selected);
+  EXPECT_EQ(selected, expected);
+}
+
+TEST(GreedyBoxNMS, compare_erase) {
+  for (bool normalized : {true, false}) {
+    // Too few boxes for the grid.
+    CheckGreedyNMS(100, normalized, 0.1f, 0.3f, 1.f);
+    // The grid with small boxes, and with some boxes out of the grid.
+    CheckGreedyNMS(3000, normalized, 0.08f, 0.5f, 1.f);
+    CheckGreedyNMS(3000, normalized, 0.5f, 0.4f, 1.f);
+    // The adaptive threshold and a zero threshold.
+    CheckGreedyNMS(2000, normalized, 0.08f, 0.7f, 0.9f);
+    CheckGreedyNMS(2000, normalized, 0.08f, 0.f, 1.f);
+  }
+}
+
+TEST(GreedyBoxNMS, negative_threshold) {
+  // The overlap of the disjoint boxes is 0, which is greater than a negative
+  // threshold, so only the first box is kept. So is it with a NaN threshold.
+  for (float nms_threshold :
+       {-0.1f, std::numeric_limits<float>::quiet_NaN()}) {
+    for (int num : {100, 1000}) {
+      CheckGreedyNMS(num, false, 0.08f, nms_threshold, 1.f);
+    }
+    std::vector<float> boxes = {0.f, 0.f, 1.f, 1.f, 2.f, 2.f, 3.f, 3.f};
+    std::vector<std::pair<float, int>> sorted_indices = {{0.9f, 0},
+                                                         {0.8f, 1}};
+    std::vector<int> selected;
+    GreedyBoxNMS<float>(boxes.data(), 4, sorted_indices, nms_threshold, 1.f,
+                        true, &selected);
+    EXPECT_EQ(selected, std::vector<int>({0}));
+  }
+}
+
+TEST(GreedyBoxNMS, benchmark) {
+  std::mt19937 engine(0);
+  const int repeat = 3;
+  for (int num : {1000, 5000, 20000}) {
+    std::vector<float> boxes;
+    std::vector<std::pair<float, int>> sorted_indices;
+    RandomBoxes(num, 800.f, 64.f, &engine, &boxes, &sorted_indices);
+    std::vector<int> selected;
+    platform::Timer timer;
+    timer.Start();
+    for (int i = 0; i < repeat; ++i) {
+      EraseNMS<float>(boxes.data(), sorted_indices, 0.5f, 1.f, false,
+                      &selected);
+    }
+    timer.Pause();
+    double erase_ms = timer.ElapsedMS() / repeat;
+    timer.Reset();
+    timer.Start();
+    for (int i = 0; i < repeat; ++i) {
+      GreedyBoxNMS<float>(boxes.data(), 4, sorted_indices, 0.5f, 1.f, false,
+                          &selected);
+    }
+    timer.Pause();
+    double greedy_ms = timer.ElapsedMS() / repeat;
+    LOG(INFO) << "NMS of " << sorted_indices.size() << " boxes, "
+              << selected.size() << " kept: erase " << erase_ms
+              << " ms, GreedyBoxNMS " << greedy_ms << " ms";
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
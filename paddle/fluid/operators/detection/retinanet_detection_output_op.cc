@@ -13,6 +13,7 @@ limitations under the License. */
 
 #include <glog/logging.h>
 #include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/operators/detection/nms_util.h"
 
 namespace paddle {
 namespace operators {
@@ -100,76 +101,12 @@ class RetinanetDetectionOutputOp : public framework::OperatorWithKernel {
   }
 };
 
-template <class T>
-bool SortScorePairDescend(const std::pair<float, T>& pair1,
-                          const std::pair<float, T>& pair2) {
-  return pair1.first > pair2.first;
-}
-
 template <class T>
 bool SortScoreTwoPairDescend(const std::pair<float, std::pair<T, T>>& pair1,
                              const std::pair<float, std::pair<T, T>>& pair2) {
   return pair1.first > pair2.first;
 }
 
-template <class T>
-static inline void GetMaxScoreIndex(
-    const std::vector<T>& scores, const T threshold, int top_k,
-    std::vector<std::pair<T, int>>* sorted_indices) {
-  for (size_t i = 0; i < scores.size(); ++i) {
-    if (scores[i] > threshold) {
-      sorted_indices->push_back(std::make_pair(scores[i], i));
-    }
-  }
-  // Sort the score pair according to the scores in descending order
-  std::stable_sort(sorted_indices->begin(), sorted_indices->end(),
-                   SortScorePairDescend<int>);
-  // Keep top_k scores if needed.
-  if (top_k > -1 && top_k < static_cast<int>(sorted_indices->size())) {
-    sorted_indices->resize(top_k);
-  }
-}
-
-template <class T>
-static inline T BBoxArea(const std::vector<T>& box, const bool normalized) {
-  if (box[2] < box[0] || box[3] < box[1]) {
-    // If coordinate values are is invalid
-    // (e.g. xmax < xmin or ymax < ymin), return 0.
-    return static_cast<T>(0.);
-  } else {
-    const T w = box[2] - box[0];
-    const T h = box[3] - box[1];
-    if (normalized) {
-      return w * h;
-    } else {
-      // If coordinate values are not within range [0, 1].
-      return (w + 1) * (h + 1);
-    }
-  }
-}
-
-template <class T>
-static inline T JaccardOverlap(const std::vector<T>& box1,
-                               const std::vector<T>& box2,
-                               const bool normalized) {
-  if (box2[0] > box1[2] || box2[2] < box1[0] || box2[1] > box1[3] ||
-      box2[3] < box1[1]) {
-    return static_cast<T>(0.);
-  } else {
-    const T inter_xmin = std::max(box1[0], box2[0]);
-    const T inter_ymin = std::max(box1[1], box2[1]);
-    const T inter_xmax = std::min(box1[2], box2[2]);
-    const T inter_ymax = std::min(box1[3], box2[3]);
-    T norm = normalized ? static_cast<T>(0.) : static_cast<T>(1.);
-    T inter_w = inter_xmax - inter_xmin + norm;
-    T inter_h = inter_ymax - inter_ymin + norm;
-    const T inter_area = inter_w * inter_h;
-    const T bbox1_area = BBoxArea<T>(box1, normalized);
-    const T bbox2_area = BBoxArea<T>(box2, normalized);
-    return inter_area / (bbox1_area + bbox2_area - inter_area);
-  }
-}
-
 template <typename T>
 class RetinanetDetectionOutputKernel : public framework::OpKernel<T> {
  public:
@@ -178,37 +115,16 @@ class RetinanetDetectionOutputKernel : public framework::OpKernel<T> {
                std::vector<int>* selected_indices) const {
     int64_t num_boxes = cls_dets.size();
     std::vector<std::pair<T, int>> sorted_indices;
+    std::vector<T> boxes(num_boxes * 4);
     for (int64_t i = 0; i < num_boxes; ++i) {
       sorted_indices.push_back(std::make_pair(cls_dets[i][4], i));
+      std::copy_n(cls_dets[i].begin(), 4, boxes.begin() + i * 4);
     }
     // Sort the score pair according to the scores in descending order
     std::stable_sort(sorted_indices.begin(), sorted_indices.end(),
                      SortScorePairDescend<int>);
-    selected_indices->clear();
-    T adaptive_threshold = nms_threshold;
-
-    while (sorted_indices.size() != 0) {
-      const int idx = sorted_indices.front().second;
-      bool keep = true;
-      for (size_t k = 0; k < selected_indices->size(); ++k) {
-        if (keep) {
-          const int kept_idx = (*selected_indices)[k];
-          T overlap = T(0.);
-
-          overlap = JaccardOverlap<T>(cls_dets[idx], cls_dets[kept_idx], false);
-          keep = overlap <= adaptive_threshold;
-        } else {
-          break;
-        }
-      }
-      if (keep) {
-        selected_indices->push_back(idx);
-      }
-      sorted_indices.erase(sorted_indices.begin());
-      if (keep && eta < 1 && adaptive_threshold > 0.5) {
-        adaptive_threshold *= eta;
-      }
-    }
+    GreedyBoxNMS<T>(boxes.data(), 4, sorted_indices, nms_threshold, eta, false,
+                    selected_indices);
   }
 
   void DeltaScoreToPrediction(
@@ -269,19 +185,31 @@ class RetinanetDetectionOutputKernel : public framework::OpKernel<T> {
     }
   }
 
-  void MultiClassNMS(const std::map<int, std::vector<std::vector<T>>>& preds,
+  void MultiClassNMS(const platform::CPUDeviceContext& dev_ctx,
+                     const std::map<int, std::vector<std::vector<T>>>& preds,
                      int class_num, const int keep_top_k, const T nms_threshold,
                      const T nms_eta, std::vector<std::vector<T>>* nmsed_out,
                      int* num_nmsed_out) const {
+    // The classes are suppressed in parallel, each into its own entry of
+    // indices created beforehand.
     std::map<int, std::vector<int>> indices;
-    int num_det = 0;
-    for (int c = 0; c < class_num; ++c) {
-      if (static_cast<bool>(preds.count(c))) {
-        const std::vector<std::vector<T>> cls_dets = preds.at(c);
-        NMSFast(cls_dets, nms_threshold, nms_eta, &(indices[c]));
-        num_det += indices[c].size();
+    std::vector<std::pair<const std::vector<std::vector<T>>*,
+                          std::vector<int>*>>
+        classes;
+    for (const auto& it : preds) {
+      if (it.first >= 0 && it.first < class_num) {
+        classes.emplace_back(&it.second, &indices[it.first]);
       }
     }
+    dev_ctx.ParallelFor(classes.size(), 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; ++c) {
+        NMSFast(*classes[c].first, nms_threshold, nms_eta, classes[c].second);
+      }
+    });
+    int num_det = 0;
+    for (const auto& it : indices) {
+      num_det += it.second.size();
+    }
 
     std::vector<std::pair<float, std::pair<int, int>>> score_index_pairs;
     for (const auto& it : indices) {
@@ -363,7 +291,8 @@ class RetinanetDetectionOutputKernel : public framework::OpKernel<T> {
                              im_scale, class_num, sorted_indices, &preds);
     }
 
-    MultiClassNMS(preds, class_num, keep_top_k, nms_threshold, nms_eta,
+    auto& dev_ctx = ctx.template device_context<platform::CPUDeviceContext>();
+    MultiClassNMS(dev_ctx, preds, class_num, keep_top_k, nms_threshold, nms_eta,
                   nmsed_out, num_nmsed_out);
   }
 
@@ -83,6 +83,20 @@ google::protobuf::int64 GrpcByteBufferSource::ByteCount() const {
   return byte_count_;
 }
 
+bool GrpcByteBufferSource::RefSlice(const void* data, size_t size,
+                                    ::grpc::Slice* slice) const {
+  if (cur_ >= slices_.size()) {
+    return false;
+  }
+  const ::grpc::Slice& s = slices_[cur_];
+  auto* p = static_cast<const uint8_t*>(data);
+  if (p < s.begin() || p + size > s.end()) {
+    return false;
+  }
+  *slice = s;
+  return true;
+}
+
 }  // namespace distributed
 }  // namespace operators
 }  // namespace paddle
@@ -19,6 +19,7 @@ limitations under the License. */
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "google/protobuf/io/coded_stream.h"
@@ -96,6 +97,21 @@ class GrpcBufferReader final
     return byte_count_ - backup_count_;
   }
 
+  // Gets a new reference of the last slice returned by Next if
+  // [data, data + size) is in it.
+  bool RefSlice(const void* data, size_t size, ::grpc::Slice* slice) const {
+    if (byte_count_ == 0) {
+      return false;
+    }
+    auto* begin = GRPC_SLICE_START_PTR(slice_);
+    auto* p = static_cast<const uint8_t*>(data);
+    if (p < begin || p + size > begin + GRPC_SLICE_LENGTH(slice_)) {
+      return false;
+    }
+    *slice = ::grpc::Slice(slice_, ::grpc::Slice::ADD_REF);
+    return true;
+  }
+
  private:
   int64_t byte_count_;
   int64_t backup_count_;
@@ -109,6 +125,18 @@ namespace paddle {
 namespace operators {
 namespace distributed {
 
+// An allocation sharing a part of a received slice, which holds a reference
+// of the slice to keep the data alive.
+class GrpcSliceAllocation : public memory::Allocation {
+ public:
+  GrpcSliceAllocation(const ::grpc::Slice& slice, const void* ptr, size_t size)
+      : Allocation(const_cast<void*>(ptr), size, platform::CPUPlace()),
+        slice_(slice) {}
+
+ private:
+  ::grpc::Slice slice_;
+};
+
 // A ZeroCopyInputStream that reads from a grpc::ByteBuffer.
 class GrpcByteBufferSource
     : public ::google::protobuf::io::ZeroCopyInputStream {
@@ -120,6 +148,10 @@ class GrpcByteBufferSource
   bool Skip(int count) override;
   ::google::protobuf::int64 ByteCount() const override;
 
+  // Gets a new reference of the current slice if [data, data + size) is in
+  // it.
+  bool RefSlice(const void* data, size_t size, ::grpc::Slice* slice) const;
+
  private:
   std::vector<::grpc::Slice> slices_;
   size_t cur_;       // Current slice index.
@@ -136,6 +168,15 @@ class GrpcByteBufferSourceWrapper : public Source {
     return source_;
   }
 
+  std::shared_ptr<memory::Allocation> ShareBuffer(const void* data,
+                                                  size_t size) override {
+    ::grpc::Slice slice;
+    if (!source_->RefSlice(data, size, &slice)) {
+      return nullptr;
+    }
+    return std::make_shared<GrpcSliceAllocation>(slice, data, size);
+  }
+
  private:
   GrpcByteBufferSource* source_;
 };
@@ -153,6 +194,15 @@ class GrpcByteSource : public Source {
     return stream_;
   }
 
+  std::shared_ptr<memory::Allocation> ShareBuffer(const void* data,
+                                                  size_t size) override {
+    ::grpc::Slice slice;
+    if (stream_ == nullptr || !stream_->RefSlice(data, size, &slice)) {
+      return nullptr;
+    }
+    return std::make_shared<GrpcSliceAllocation>(slice, data, size);
+  }
+
  private:
   void DeleteStream() {
     if (stream_) {
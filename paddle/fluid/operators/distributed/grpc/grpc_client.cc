@@ -86,7 +86,8 @@ VarHandlePtr GRPCClient::AsyncSendVar(const std::string& ep,
       auto* var = p_scope->FindVar(var_name_val);
 
       ::grpc::ByteBuffer req;
-      SerializeToByteBuffer(var_name_val, var, *p_ctx, &req, "", trainer_id_);
+      SerializeToByteBuffer(var_name_val, var, *p_ctx, &req, "", trainer_id_,
+                            "", UseShmTransport(h->ep()), &s->shm_name_);
 
       VLOG(3) << s->GetVarHandlePtr()->String() << " begin";
 
@@ -497,6 +498,9 @@ void GRPCClient::Proceed() {
     GPR_ASSERT(ok);
     PADDLE_ENFORCE(c);
 
+    if (!c->status_.ok() && !c->shm_name_.empty()) {
+      UnlinkShm(c->shm_name_);
+    }
     if (c->status_.ok()) {
       VLOG(3) << c->GetVarHandlePtr()->String() << " process";
       c->Process();
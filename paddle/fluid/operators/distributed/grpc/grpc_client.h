@@ -84,6 +84,8 @@ class BaseProcessor {
 
   std::unique_ptr<grpc::ClientContext> context_;
   grpc::Status status_;
+  // The shared memory of the request, see SerializeToByteBuffer.
+  std::string shm_name_;
 
  protected:
   VarHandlePtr var_h_;
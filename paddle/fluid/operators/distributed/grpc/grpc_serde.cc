@@ -22,6 +22,7 @@ limitations under the License. */
 #include "google/protobuf/io/coded_stream.h"
 #include "google/protobuf/io/zero_copy_stream.h"
 #include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/memory/allocation/mmap_allocator.h"
 #include "paddle/fluid/operators/distributed/grpc/grpc_bytebuffer_stream.h"
 #include "paddle/fluid/operators/distributed/grpc/grpc_serde.h"
 #include "paddle/fluid/operators/distributed/grpc/grpc_variable_response.h"
@@ -30,6 +31,8 @@ limitations under the License. */
 #include "paddle/fluid/platform/port.h"
 #include "paddle/fluid/platform/profiler.h"
 
+DECLARE_int64(rpc_shm_min_bytes);
+
 namespace paddle {
 namespace operators {
 namespace distributed {
@@ -38,8 +41,12 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
                            const platform::DeviceContext& ctx,
                            ::grpc::ByteBuffer* msg, const std::string& out_name,
                            const int trainer_id,
-                           const std::string& table_name) {
+                           const std::string& table_name, bool use_shm,
+                           std::string* shm_name) {
   platform::RecordRPCEvent record_event("serial");
+  if (shm_name != nullptr) {
+    shm_name->clear();
+  }
   VarMsg request;
   TensorPayload* payload = nullptr;
 
@@ -77,6 +84,27 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
                  typeid(var->Type()).name());
   }
 
+#ifndef _WIN32
+  // Only the name of the shared memory is sent, the receiver maps it into its
+  // tensor without copying.
+  bool send_by_shm =
+      use_shm && payload != nullptr &&
+      payload->memory_size() >= static_cast<size_t>(FLAGS_rpc_shm_min_bytes);
+  if (send_by_shm) {
+    auto shm = memory::allocation::AllocateMemoryMapWriterAllocation(
+        payload->memory_size());
+    memcpy(shm->ptr(), payload->ptr(), payload->memory_size());
+    request.set_shm_name(shm->ipc_name());
+    if (shm_name != nullptr) {
+      *shm_name = shm->ipc_name();
+    }
+    delete payload;
+    payload = nullptr;
+  }
+#else
+  bool send_by_shm = false;
+#endif
+
   std::string header;
   request.AppendToString(&header);
   auto buffer = std::unique_ptr<char[]>(new char[1024]);
@@ -100,25 +128,32 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
     return;
   }
 #endif
-  PADDLE_ENFORCE_NOT_NULL(payload);
-
-  e.WriteVarlengthBeginning(VarMsg::kSerializedFieldNumber,
-                            payload->memory_size());
-  if (payload->memory_size() >= std::numeric_limits<int>::max()) {
-    LOG(FATAL) << "FATAL error: varname:" << name
-               << ", vlen:" << payload->memory_size()
-               << " >= std::numeric_limits<int>::max():"
-               << std::numeric_limits<int>::max() << ", so exit!";
-  }
-  // steal reference of tensor data
   ::grpc::Slice slices[4];  // metadata, tensor, rows meta, rows
-  int num_slices = 2;       // only SelectedRows have rows buffer
-  slices[0] = ::grpc::Slice(e.size());
-  memcpy(const_cast<uint8_t*>(slices[0].begin()), e.data(), e.size());
-  slices[1] = ::grpc::Slice(
-      grpc_slice_new_with_user_data(payload->ptr(), payload->memory_size(),
-                                    SerializeDestroyCallback, payload),
-      ::grpc::Slice::STEAL_REF);
+  int num_slices = 0;       // only SelectedRows have rows buffer
+  if (send_by_shm) {
+    slices[0] = ::grpc::Slice(e.size());
+    memcpy(const_cast<uint8_t*>(slices[0].begin()), e.data(), e.size());
+    num_slices = 1;
+  } else {
+    PADDLE_ENFORCE_NOT_NULL(payload);
+
+    e.WriteVarlengthBeginning(VarMsg::kSerializedFieldNumber,
+                              payload->memory_size());
+    if (payload->memory_size() >= std::numeric_limits<int>::max()) {
+      LOG(FATAL) << "FATAL error: varname:" << name
+                 << ", vlen:" << payload->memory_size()
+                 << " >= std::numeric_limits<int>::max():"
+                 << std::numeric_limits<int>::max() << ", so exit!";
+    }
+    // steal reference of tensor data
+    slices[0] = ::grpc::Slice(e.size());
+    memcpy(const_cast<uint8_t*>(slices[0].begin()), e.data(), e.size());
+    slices[1] = ::grpc::Slice(
+        grpc_slice_new_with_user_data(payload->ptr(), payload->memory_size(),
+                                      SerializeDestroyCallback, payload),
+        ::grpc::Slice::STEAL_REF);
+    num_slices = 2;
+  }
 
   if (var->IsType<framework::SelectedRows>()) {
     auto* slr = var->GetMutable<framework::SelectedRows>();
@@ -128,10 +163,11 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
     size_t rows_memory_size = slr->rows().size() * sizeof(int64_t);
 
     e2.WriteVarlengthBeginning(VarMsg::kRowsFieldNumber, rows_memory_size);
-    slices[2] = ::grpc::Slice(e2.size());
-    memcpy(const_cast<uint8_t*>(slices[2].begin()), e2.data(), e2.size());
+    slices[num_slices] = ::grpc::Slice(e2.size());
+    memcpy(const_cast<uint8_t*>(slices[num_slices].begin()), e2.data(),
+           e2.size());
 
-    slices[3] = ::grpc::Slice(
+    slices[num_slices + 1] = ::grpc::Slice(
         grpc_slice_new_with_user_data(
             const_cast<void*>(
                 reinterpret_cast<const void*>(slr->rows().data())),
@@ -139,7 +175,7 @@ void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
             const_cast<char*>(
                 reinterpret_cast<const char*>(slr->rows().data()))),
         ::grpc::Slice::STEAL_REF);
-    num_slices = 4;
+    num_slices += 2;
   }
 
   ::grpc::ByteBuffer tmp(&slices[0], num_slices);
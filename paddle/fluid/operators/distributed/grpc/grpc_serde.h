@@ -35,12 +35,19 @@ namespace distributed {
 
 typedef void (*DestroyCallback)(void*);
 
+// If use_shm is true, the tensor data no smaller than FLAGS_rpc_shm_min_bytes
+// is written to shared memory, and only its name is in msg. It must only be
+// used for a peer on the same host, see UseShmTransport. The receiver unlinks
+// the shared memory, so the sender gets its name in shm_name, which is empty
+// if it is not used, to unlink it if msg is not delivered.
 void SerializeToByteBuffer(const std::string& name, framework::Variable* var,
                            const platform::DeviceContext& ctx,
                            ::grpc::ByteBuffer* msg,
                            const std::string& out_varname = std::string(),
                            const int trainer_id = 0,
-                           const std::string& table_name = std::string());
+                           const std::string& table_name = std::string(),
+                           bool use_shm = false,
+                           std::string* shm_name = nullptr);
 
 void DeserializeFromByteBuffer(const ::grpc::ByteBuffer& msg,
                                const platform::DeviceContext& ctx,
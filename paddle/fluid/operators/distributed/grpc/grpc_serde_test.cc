@@ -12,9 +12,14 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <unistd.h>
+#include <chrono>  // NOLINT
+#include <cstdlib>
 #include <string>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "google/protobuf/text_format.h"
 #include "gtest/gtest.h"
@@ -35,6 +40,9 @@ namespace operators = paddle::operators;
 namespace math = paddle::operators::math;
 namespace memory = paddle::memory;
 
+DECLARE_bool(rpc_zero_copy_recv);
+DECLARE_int64(rpc_shm_min_bytes);
+
 void RunSerdeTestSelectedRows(platform::Place place) {
   platform::DeviceContextPool& pool = platform::DeviceContextPool::Instance();
   auto& ctx = *pool.Get(place);
@@ -222,3 +230,181 @@ TEST(SelectedRows, Run) {
   RunSerdeTestSelectedRows(gpu);
 #endif
 }
+
+// Rebuilds msg with the data split into slices of chunk_size bytes, like the
+// buffers received from the network.
+static ::grpc::ByteBuffer Rechunk(const ::grpc::ByteBuffer& msg,
+                                  size_t chunk_size) {
+  std::vector<::grpc::Slice> slices;
+  (void)msg.Dump(&slices);
+  std::string data;
+  for (const auto& s : slices) {
+    data.append(reinterpret_cast<const char*>(s.begin()), s.size());
+  }
+  std::vector<::grpc::Slice> chunks;
+  for (size_t offset = 0; offset < data.size(); offset += chunk_size) {
+    size_t n = std::min(chunk_size, data.size() - offset);
+    chunks.emplace_back(data.data() + offset, n);
+  }
+  return ::grpc::ByteBuffer(chunks.data(), chunks.size());
+}
+
+static void InitFloatVar(framework::Variable* var, int64_t numel) {
+  auto* tensor = var->GetMutable<framework::LoDTensor>();
+  tensor->Resize(framework::make_ddim({numel}));
+  float* data = tensor->mutable_data<float>(platform::CPUPlace());
+  for (int64_t i = 0; i < numel; ++i) data[i] = static_cast<float>(i % 1000);
+}
+
+static void CheckFloatVar(const framework::Variable& var, int64_t numel) {
+  auto& tensor = var.Get<framework::LoDTensor>();
+  ASSERT_EQ(tensor.numel(), numel);
+  const float* data = tensor.data<float>();
+  for (int64_t i = 0; i < numel; ++i) {
+    ASSERT_EQ(data[i], static_cast<float>(i % 1000));
+  }
+}
+
+TEST(VariableResponse, ZeroCopyRecv) {
+  FLAGS_rpc_zero_copy_recv = true;
+  platform::CPUPlace place;
+  auto& ctx = *platform::DeviceContextPool::Instance().Get(place);
+  framework::Variable var;
+  int64_t numel = 256 * 1024;
+  InitFloatVar(&var, numel);
+  ::grpc::ByteBuffer msg;
+  operators::distributed::SerializeToByteBuffer("myvar", &var, ctx, &msg);
+
+  framework::Scope scope;
+  scope.Var("myvar");
+  {
+    // The tensor data is in one slice, so it is shared.
+    ::grpc::ByteBuffer single = Rechunk(msg, msg.Length());
+    operators::distributed::GRPCVariableResponse resp(&scope, &ctx);
+    EXPECT_EQ(resp.Parse(single), 0);
+    EXPECT_EQ(resp.copied_bytes(), 0);
+    CheckFloatVar(*resp.GetVar(), numel);
+  }
+  {
+    // The allocation of the tensor is large enough, so the data is copied
+    // into it rather than replacing it.
+    const void* data =
+        scope.FindVar("myvar")->Get<framework::LoDTensor>().data<float>();
+    ::grpc::ByteBuffer single = Rechunk(msg, msg.Length());
+    operators::distributed::GRPCVariableResponse resp(&scope, &ctx);
+    EXPECT_EQ(resp.Parse(single), 0);
+    EXPECT_EQ(resp.copied_bytes(), numel * sizeof(float));
+    CheckFloatVar(*resp.GetVar(), numel);
+    EXPECT_EQ(resp.GetVar()->Get<framework::LoDTensor>().data<float>(), data);
+  }
+  {
+    ::grpc::ByteBuffer chunked = Rechunk(msg, 64 * 1024);
+    operators::distributed::GRPCVariableResponse resp(&scope, &ctx);
+    EXPECT_EQ(resp.Parse(chunked), 0);
+    EXPECT_EQ(resp.copied_bytes(), numel * sizeof(float));
+    CheckFloatVar(*resp.GetVar(), numel);
+  }
+  FLAGS_rpc_zero_copy_recv = false;
+  {
+    framework::Scope new_scope;
+    new_scope.Var("myvar");
+    ::grpc::ByteBuffer single = Rechunk(msg, msg.Length());
+    operators::distributed::GRPCVariableResponse resp(&new_scope, &ctx);
+    EXPECT_EQ(resp.Parse(single), 0);
+    EXPECT_EQ(resp.copied_bytes(), numel * sizeof(float));
+    CheckFloatVar(*resp.GetVar(), numel);
+  }
+}
+
+TEST(VariableResponse, ShmTransport) {
+  platform::CPUPlace place;
+  auto& ctx = *platform::DeviceContextPool::Instance().Get(place);
+  framework::Variable var;
+  int64_t numel = 256 * 1024;
+  InitFloatVar(&var, numel);
+  ::grpc::ByteBuffer msg;
+  operators::distributed::SerializeToByteBuffer("myvar", &var, ctx, &msg, "",
+                                                0, "", true);
+  // Only the header is sent.
+  EXPECT_LT(msg.Length(), 1024UL);
+
+  framework::Scope scope;
+  scope.Var("myvar");
+  operators::distributed::GRPCVariableResponse resp(&scope, &ctx);
+  EXPECT_EQ(resp.Parse(Rechunk(msg, 64 * 1024)), 0);
+  EXPECT_EQ(resp.copied_bytes(), 0);
+  CheckFloatVar(*resp.GetVar(), numel);
+  // The mapping is private, the received tensor can be updated in place.
+  resp.GetVar()->GetMutable<framework::LoDTensor>()->data<float>()[0] = -1.0f;
+}
+
+// The sender unlinks the shared memory of a message which is not delivered.
+TEST(VariableResponse, ShmUnlinkUndelivered) {
+  platform::CPUPlace place;
+  auto& ctx = *platform::DeviceContextPool::Instance().Get(place);
+  framework::Variable var;
+  InitFloatVar(&var, 256 * 1024);
+  ::grpc::ByteBuffer msg;
+  std::string shm_name;
+  operators::distributed::SerializeToByteBuffer("myvar", &var, ctx, &msg, "",
+                                                0, "", true, &shm_name);
+  ASSERT_FALSE(shm_name.empty());
+  int fd = shm_open(shm_name.c_str(), O_RDONLY, 0644);
+  ASSERT_NE(fd, -1);
+  close(fd);
+
+  operators::distributed::UnlinkShm(shm_name);
+  EXPECT_EQ(shm_open(shm_name.c_str(), O_RDONLY, 0644), -1);
+
+  // The receiver of the unlinked shared memory fails the message.
+  framework::Scope scope;
+  scope.Var("myvar");
+  operators::distributed::GRPCVariableResponse resp(&scope, &ctx);
+  EXPECT_NE(resp.Parse(Rechunk(msg, 64 * 1024)), 0);
+
+  // Without the shared memory the tensor is sent through the network.
+  operators::distributed::SerializeToByteBuffer("myvar", &var, ctx, &msg, "",
+                                                0, "", false, &shm_name);
+  EXPECT_TRUE(shm_name.empty());
+}
+
+// Reports the bytes copied by the receiver and the throughput of serializing
+// and deserializing tensors from 1MB to PADDLE_RPC_BENCH_MAX_MB (4 by default
+// for the CI, whose /dev/shm may be small) through the chunked network
+// buffers, one buffer, and the shared memory.
+TEST(VariableResponse, RecvBenchmark) {
+  platform::CPUPlace place;
+  auto& ctx = *platform::DeviceContextPool::Instance().Get(place);
+  int64_t max_mb = 4;
+  if (const char* env = std::getenv("PADDLE_RPC_BENCH_MAX_MB")) {
+    max_mb = std::atoll(env);
+  }
+  const char* modes[] = {"network", "one_buffer", "shm"};
+  for (int64_t mb = 1; mb <= max_mb; mb *= 4) {
+    framework::Variable var;
+    int64_t numel = mb * (1 << 20) / sizeof(float);
+    InitFloatVar(&var, numel);
+    for (int mode = 0; mode < 3; ++mode) {
+      framework::Scope scope;
+      scope.Var("myvar");
+      auto start = std::chrono::steady_clock::now();
+      ::grpc::ByteBuffer msg;
+      operators::distributed::SerializeToByteBuffer("myvar", &var, ctx, &msg,
+                                                    "", 0, "", mode == 2);
+      auto serialized = std::chrono::steady_clock::now();
+      // The transfer itself is not timed.
+      auto received = Rechunk(msg, mode == 1 ? msg.Length() : 64 * 1024);
+      auto start_parse = std::chrono::steady_clock::now();
+      FLAGS_rpc_zero_copy_recv = mode == 1;
+      operators::distributed::GRPCVariableResponse resp(&scope, &ctx);
+      EXPECT_EQ(resp.Parse(received), 0);
+      auto end = std::chrono::steady_clock::now();
+      FLAGS_rpc_zero_copy_recv = false;
+      double sec = std::chrono::duration<double>(serialized - start).count() +
+                   std::chrono::duration<double>(end - start_parse).count();
+      LOG(INFO) << mb << "MB " << modes[mode]
+                << ": copied by receiver = " << resp.copied_bytes()
+                << " bytes, " << mb / sec << " MB/s";
+    }
+  }
+}
@@ -74,6 +74,13 @@ class RequestBase {
   }
   virtual std::string GetReqName() = 0;
 
+  // Called if the reply is not delivered.
+  void OnReplyFailed() {
+    if (!shm_name_.empty()) {
+      UnlinkShm(shm_name_);
+    }
+  }
+
  protected:
   mutable std::mutex status_mu_;
   ::grpc::ServerContext ctx_;
@@ -82,6 +89,8 @@ class RequestBase {
   CallStatus status_;
   RequestHandler* request_handler_;
   int req_id_;
+  // The shared memory of the reply, see SerializeToByteBuffer.
+  std::string shm_name_;
 };
 
 class RequestSend final : public RequestBase {
@@ -155,7 +164,8 @@ class RequestGet final : public RequestBase {
     VLOG(1) << "before SerializeToByteBuffer";
     if (outvar) {
       SerializeToByteBuffer(out_varname, outvar, *request_handler_->dev_ctx(),
-                            &reply_);
+                            &reply_, "", 0, "", UseShmTransport(ctx_.peer()),
+                            &shm_name_);
     }
     VLOG(1) << "after SerializeToByteBuffer";
     Finish(reply_, &responder_);
@@ -202,7 +212,8 @@ class RequestGetNoBarrier final : public RequestBase {
 
     if (outvar) {
       SerializeToByteBuffer(out_varname, outvar, *request_handler_->dev_ctx(),
-                            &reply_);
+                            &reply_, "", 0, "", UseShmTransport(ctx_.peer()),
+                            &shm_name_);
     }
     Finish(reply_, &responder_);
   }
@@ -626,6 +637,9 @@ void AsyncGRPCServer::HandleRequest(
     if (!ok) {
       VLOG(4) << "completion queue:" << rpc_name << " recv no regular event"
               << " context:" << base->Status2String(rpc_name);
+      if (base->Status() == FINISH) {
+        base->OnReplyFailed();
+      }
       TryToRegisterNewOne(rpc_name, req_id);
       delete base;
       continue;
@@ -104,6 +104,7 @@ bool ParseLodData(::google::protobuf::io::CodedInputStream* input,
 }
 
 int GRPCVariableResponse::Parse(Source* source) {
+  source_ = source;
   ::google::protobuf::io::ZeroCopyInputStream* input_stream =
       source->contents();
   ::google::protobuf::io::CodedInputStream input(input_stream);
@@ -315,6 +316,23 @@ int GRPCVariableResponse::Parse(Source* source) {
         meta_.set_table_name(temp);
         break;
       }
+      case sendrecv::VariableMessage::kShmNameFieldNumber: {
+        uint32_t length;
+        if ((wt != WIRETYPE_LENGTH_DELIMITED) || !input.ReadVarint32(&length)) {
+          return tag;
+        }
+
+        std::string temp;
+        if (!input.ReadString(&temp, length)) {
+          return tag;
+        }
+
+        meta_.set_shm_name(temp);
+        if (!ProcShmField()) {
+          return tag;
+        }
+        break;
+      }
       default: {
         // Unknown tag, return unknown error.
         return -1;
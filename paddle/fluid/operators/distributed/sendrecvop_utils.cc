@@ -15,8 +15,17 @@ limitations under the License. */
 #ifdef PADDLE_WITH_NCCL
 #include <nccl.h>
 #endif
+#ifndef _WIN32
+#include <ifaddrs.h>
+#include <netdb.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
 #include <memory>
+#include <string>
 #include <thread>  // NOLINT
+#include <unordered_set>
 
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/operators/distributed/sendrecvop_utils.h"
@@ -26,6 +35,12 @@ limitations under the License. */
 DEFINE_bool(rpc_disable_reuse_port, false, "Disable SO_REUSEPORT or not.");
 DEFINE_int32(rpc_retry_bind_port, 3,
              "Retry to bind the address if address is already used.");
+DEFINE_bool(rpc_shm_transport, false,
+            "Pass the tensor data through shared memory instead of the "
+            "network if the peer is on the same host.");
+DEFINE_int64(rpc_shm_min_bytes, 256 << 10,
+             "The tensors smaller than this are always sent through the "
+             "network, even if rpc_shm_transport is on.");
 
 namespace paddle {
 namespace operators {
@@ -33,6 +48,77 @@ namespace distributed {
 
 using VarMsg = sendrecv::VariableMessage;
 
+#ifndef _WIN32
+static std::string GetPeerHost(std::string peer) {
+  for (const std::string prefix : {"ipv4:", "ipv6:"}) {
+    if (peer.compare(0, prefix.size(), prefix) == 0) {
+      peer = peer.substr(prefix.size());
+      break;
+    }
+  }
+  auto pos = peer.rfind(':');
+  std::string host = pos == std::string::npos ? peer : peer.substr(0, pos);
+  if (host.size() >= 2 && host.front() == '[' && host.back() == ']') {
+    host = host.substr(1, host.size() - 2);
+  }
+  const std::string v4_mapped = "::ffff:";
+  if (host.compare(0, v4_mapped.size(), v4_mapped) == 0) {
+    host = host.substr(v4_mapped.size());
+  }
+  return host;
+}
+
+static std::unordered_set<std::string> GetLocalHosts() {
+  std::unordered_set<std::string> hosts{"localhost", "127.0.0.1", "::1"};
+  char hostname[256];
+  if (gethostname(hostname, sizeof(hostname)) == 0) {
+    hostname[sizeof(hostname) - 1] = '\0';
+    hosts.insert(hostname);
+  }
+  struct ifaddrs* ifaddr = nullptr;
+  if (getifaddrs(&ifaddr) != 0) {
+    return hosts;
+  }
+  for (auto* ifa = ifaddr; ifa != nullptr; ifa = ifa->ifa_next) {
+    if (ifa->ifa_addr == nullptr) continue;
+    int family = ifa->ifa_addr->sa_family;
+    if (family != AF_INET && family != AF_INET6) continue;
+    char host[NI_MAXHOST];
+    socklen_t len = family == AF_INET ? sizeof(struct sockaddr_in)
+                                      : sizeof(struct sockaddr_in6);
+    if (getnameinfo(ifa->ifa_addr, len, host, NI_MAXHOST, nullptr, 0,
+                    NI_NUMERICHOST) == 0) {
+      // Drop the scope id of the link local addresses, e.g. "fe80::1%eth0".
+      std::string addr(host);
+      hosts.insert(addr.substr(0, addr.find('%')));
+    }
+  }
+  freeifaddrs(ifaddr);
+  return hosts;
+}
+#endif
+
+bool UseShmTransport(const std::string& peer) {
+#ifdef _WIN32
+  return false;
+#else
+  if (!FLAGS_rpc_shm_transport) {
+    return false;
+  }
+  static const std::unordered_set<std::string> local_hosts = GetLocalHosts();
+  return local_hosts.count(GetPeerHost(peer)) > 0;
+#endif
+}
+
+void UnlinkShm(const std::string& shm_name) {
+#ifndef _WIN32
+  // The receiver may have mapped and unlinked it already.
+  if (shm_unlink(shm_name.c_str()) == 0) {
+    VLOG(3) << "unlink the undelivered shared memory " << shm_name;
+  }
+#endif
+}
+
 static TensorPayload GetCommunicationAllocationFromTensor(
     const platform::DeviceContext& ctx, const framework::Tensor& tensor) {
   if (is_gpu_place(ctx.GetPlace())) {
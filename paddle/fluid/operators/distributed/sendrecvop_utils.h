@@ -65,6 +65,15 @@ TensorPayload GetSelectedRowsPayload(framework::Variable* var,
                                      const platform::DeviceContext& ctx,
                                      VarMsg* request);
 
+// Returns true if the tensor data sent to `peer` should be passed through
+// shared memory, i.e. FLAGS_rpc_shm_transport is on and `peer` is on this
+// host. `peer` is an endpoint "ip:port", or a gRPC peer like "ipv4:ip:port".
+bool UseShmTransport(const std::string& peer);
+
+// Unlinks the shared memory of a message which is not delivered. It is
+// unlinked by the receiver otherwise.
+void UnlinkShm(const std::string& shm_name);
+
 inline framework::proto::VarType::Type ToVarType(
     sendrecv::VariableMessage::Type type) {
   switch (type) {
@@ -14,10 +14,15 @@
 
 #include "paddle/fluid/operators/distributed/variable_response.h"
 #include <vector>
+#include "paddle/fluid/memory/allocation/mmap_allocator.h"
 #include "paddle/fluid/operators/distributed/sendrecvop_utils.h"
 
 DEFINE_string(rpc_server_profile_path, "./profile_ps",
               "the profile log file path");
+DEFINE_bool(rpc_zero_copy_recv, false,
+            "Let the received CPU tensors share the receive buffer instead of "
+            "copying the data out of it, when the data is in one buffer and "
+            "the tensor has no allocation large enough to reuse.");
 
 namespace paddle {
 namespace operators {
@@ -60,6 +65,7 @@ bool VariableResponse::ReadRaw(::google::protobuf::io::CodedInputStream* input,
       input->Skip(size_to_write);
     }
     gpu_dev_ctx.Wait();
+    copied_bytes_ += total_written;
 #else
     PADDLE_THROW("Unexpected branch");
 #endif
@@ -87,10 +93,54 @@ bool VariableResponse::ReadRaw(::google::protobuf::io::CodedInputStream* input,
 
     input->Skip(size_to_write);
   }
+  copied_bytes_ += total_written;
 
   return true;
 }
 
+bool VariableResponse::ShareRaw(::google::protobuf::io::CodedInputStream* input,
+                                framework::Tensor* tensor,
+                                framework::proto::VarType::Type type,
+                                int64_t size) {
+  if (!FLAGS_rpc_zero_copy_recv || source_ == nullptr || size == 0 ||
+      !platform::is_cpu_place(dev_ctx_->GetPlace())) {
+    return false;
+  }
+  // The data is copied into the allocation of the tensor if it fits, which
+  // keeps the tensor memory in place.
+  if (tensor->IsInitialized() && platform::is_cpu_place(tensor->place()) &&
+      tensor->memory_size() >= static_cast<size_t>(size)) {
+    return false;
+  }
+  const void* data = nullptr;
+  int buffer_size = 0;
+  if (!input->GetDirectBufferPointer(&data, &buffer_size) ||
+      buffer_size < size ||
+      reinterpret_cast<uintptr_t>(data) % framework::SizeOfType(type) != 0) {
+    return false;
+  }
+  auto holder = source_->ShareBuffer(data, size);
+  if (holder == nullptr) {
+    return false;
+  }
+  VLOG(7) << "share " << size << " received bytes without copying";
+  tensor->clear();
+  tensor->ResetHolderWithType(holder, type);
+  return input->Skip(size);
+}
+
+static framework::LoD GetLoD(const sendrecv::VariableMessage& meta) {
+  framework::LoD lod;
+  for (int i = 0; i < meta.lod_level(); ++i) {
+    framework::Vector<size_t> v;
+    for (int j = 0; j < meta.lod(i).lod_data_size(); ++j) {
+      v.push_back(meta.lod(i).lod_data(j));
+    }
+    lod.push_back(v);
+  }
+  return lod;
+}
+
 bool VariableResponse::CopyLodTensorData(
     ::google::protobuf::io::CodedInputStream* input,
     const platform::DeviceContext& ctx, const framework::DDim& dims,
@@ -103,18 +153,14 @@ bool VariableResponse::CopyLodTensorData(
   }
   auto* tensor = GetVar()->GetMutable<framework::LoDTensor>();
   tensor->Resize(dims);
-  framework::LoD lod;
-  for (int i = 0; i < meta_.lod_level(); ++i) {
-    framework::Vector<size_t> v;
-    for (int j = 0; j < meta_.lod(i).lod_data_size(); ++j) {
-      v.push_back(meta_.lod(i).lod_data(j));
-    }
-    lod.push_back(v);
-  }
-  tensor->set_lod(lod);
+  tensor->set_lod(GetLoD(meta_));
 
-  void* tensor_data =
-      tensor->mutable_data(ctx.GetPlace(), ToVarType(meta_.data_type()));
+  auto type = ToVarType(meta_.data_type());
+  if (ShareRaw(input, tensor, type, length)) {
+    return true;
+  }
+  // mutable_data reuses the allocation of the tensor if it is large enough.
+  void* tensor_data = tensor->mutable_data(ctx.GetPlace(), type);
 
   VLOG(6) << "Tensor.memory_size = " << tensor->memory_size()
           << ", Buffer Size = " << length << ", dims:" << dims
@@ -144,9 +190,11 @@ bool VariableResponse::CopySelectRowsTensorData(
       static_cast<size_t>(tensor->numel()),
       length / framework::SizeOfType(paddle::operators::distributed::ToVarType(
                    meta_.data_type())));
-  void* tensor_data = tensor->mutable_data(
-      ctx.GetPlace(),
-      paddle::operators::distributed::ToVarType(meta_.data_type()));
+  auto type = ToVarType(meta_.data_type());
+  if (ShareRaw(input, tensor, type, length)) {
+    return true;
+  }
+  void* tensor_data = tensor->mutable_data(ctx.GetPlace(), type);
 
   if (!ReadRaw(input, ctx, tensor->place(), tensor_data, length)) {
     return false;
@@ -172,6 +220,66 @@ bool VariableResponse::CopySelectRowsData(
   return true;
 }
 
+bool VariableResponse::ProcShmField() {
+#ifndef _WIN32
+  PADDLE_ENFORCE_EQ(
+      meta_.type() == sendrecv::LOD_TENSOR ||
+          meta_.type() == sendrecv::SELECTED_ROWS,
+      true, platform::errors::InvalidArgument(
+                "Only LoDTensor and SelectedRows can be sent by shared "
+                "memory, but variable %s has type %d.",
+                meta_.varname(), meta_.type()));
+  auto* var = GetVar();
+  if (var == nullptr) {
+    LOG(ERROR) << "recved var should not on current server: "
+               << meta_.varname();
+    return false;
+  }
+  framework::Tensor* tensor = nullptr;
+  if (meta_.type() == sendrecv::LOD_TENSOR) {
+    auto* lod_tensor = var->GetMutable<framework::LoDTensor>();
+    lod_tensor->set_lod(GetLoD(meta_));
+    tensor = lod_tensor;
+  } else {
+    auto* slr = var->GetMutable<framework::SelectedRows>();
+    slr->set_height(meta_.slr_height());
+    tensor = slr->mutable_value();
+  }
+  auto dims = GetDims(meta_.dims());
+  auto type = ToVarType(meta_.data_type());
+  size_t size = framework::product(dims) * framework::SizeOfType(type);
+  // The private mapping lets the ops update the tensor in place without
+  // writing the shared memory. The sender may have unlinked it already, which
+  // fails the message instead of the server.
+  std::shared_ptr<memory::allocation::MemoryMapReaderAllocation> holder;
+  try {
+    holder = memory::allocation::RebuildMemoryMapReaderAllocation(
+        meta_.shm_name(), size, /*copy_on_write=*/true);
+  } catch (platform::EnforceNotMet& e) {
+    LOG(ERROR) << "Cannot map the shared memory " << meta_.shm_name()
+               << " of var " << meta_.varname() << ": " << e.what();
+    return false;
+  }
+  VLOG(7) << "map " << size << " bytes of " << meta_.varname()
+          << " from shared memory " << meta_.shm_name();
+  if (platform::is_cpu_place(dev_ctx_->GetPlace())) {
+    tensor->Resize(dims);
+    tensor->clear();
+    tensor->ResetHolderWithType(holder, type);
+  } else {
+    framework::Tensor cpu_tensor;
+    cpu_tensor.Resize(dims);
+    cpu_tensor.ResetHolderWithType(holder, type);
+    framework::TensorCopySync(cpu_tensor, dev_ctx_->GetPlace(), tensor);
+    copied_bytes_ += size;
+  }
+  return true;
+#else
+  PADDLE_THROW(platform::errors::Unimplemented(
+      "Shared memory transport is not supported on Windows."));
+#endif
+}
+
 bool VariableResponse::ProcSerializedField(
     int tag, ::google::protobuf::io::CodedInputStream* input,
     int64_t num_bytes) {
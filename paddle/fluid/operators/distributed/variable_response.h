@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include "paddle/fluid/framework/data_type.h"
@@ -28,6 +29,7 @@
 #include "paddle/fluid/operators/distributed/distributed_pb.h"
 
 DECLARE_string(rpc_server_profile_path);
+DECLARE_bool(rpc_zero_copy_recv);
 
 namespace paddle {
 namespace operators {
@@ -51,6 +53,17 @@ class Source {
   // Ownership of the returned stream is retained by the Source and
   // should not be deleted by the caller.
   virtual ::google::protobuf::io::ZeroCopyInputStream* contents() = 0;
+
+  // Returns an allocation sharing [data, data + size), which must be in the
+  // last buffer returned by the stream of contents(), without copying. The
+  // allocation keeps the received buffer alive.
+  //
+  // Returns nullptr if the source cannot share the range, e.g. it spans
+  // several buffers, in which case the data should be copied.
+  virtual std::shared_ptr<memory::Allocation> ShareBuffer(const void* data,
+                                                          size_t size) {
+    return nullptr;
+  }
 };
 
 class VariableResponse {
@@ -98,11 +111,25 @@ class VariableResponse {
 
   int GetTrainerId() { return static_cast<int>(meta_.trainer_id()); }
 
+  // The bytes of tensor data copied out of the received buffers, which is 0
+  // if the tensors share the received buffers or the shared memory.
+  int64_t copied_bytes() const { return copied_bytes_; }
+
  protected:
   bool ReadRaw(::google::protobuf::io::CodedInputStream* input,
                const platform::DeviceContext& dev_ctx, platform::Place place,
                void* dest, int64_t size);
 
+  // Makes `tensor` share the next `size` bytes of `input` if they are in one
+  // received buffer, so that the data is not copied. Returns false if the
+  // data can not be shared, and `input` is unchanged.
+  bool ShareRaw(::google::protobuf::io::CodedInputStream* input,
+                framework::Tensor* tensor, framework::proto::VarType::Type type,
+                int64_t size);
+
+  // Reads the tensor data from the shared memory named meta_.shm_name().
+  bool ProcShmField();
+
   bool CopySelectRowsTensorData(::google::protobuf::io::CodedInputStream* input,
                                 const platform::DeviceContext& ctx,
                                 const framework::DDim& dims, int length);
@@ -123,6 +150,9 @@ class VariableResponse {
   const platform::DeviceContext* dev_ctx_;
   bool create_scope_ = false;
   framework::Scope* local_scope_ = nullptr;
+  // The source being parsed, set by Parse if it supports ShareBuffer.
+  Source* source_ = nullptr;
+  int64_t copied_bytes_ = 0;
 
   sendrecv::VariableMessage meta_;
 };
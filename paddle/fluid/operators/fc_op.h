@@ -18,6 +18,7 @@ limitations under the License. */
 #include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/fc.h"
+#include "paddle/fluid/operators/math/int8_gemm.h"
 
 namespace paddle {
 namespace operators {
@@ -72,10 +73,22 @@ class FCOpKernel : public framework::OpKernel<T> {
     int M = framework::product(out_dims) / w_dims1;
 
     const T* input_data = input->data<T>();
-    const T* w_data = w->data<T>();
     T* output_data = output->mutable_data<T>(ctx.GetPlace());
 
     auto& dev_ctx = ctx.template device_context<DeviceContext>();
+    if (w->type() == framework::proto::VarType::INT8) {
+      // W is quantized by the native_int8_quantize_pass.
+      PADDLE_ENFORCE_EQ(padding_weights, false,
+                        platform::errors::Unimplemented(
+                            "The int8 weights can not be padded."));
+      math::Int8FCFunctor<DeviceContext, T> int8_fc;
+      int8_fc(dev_ctx, M, w_dims1, w_dims0, input_data,
+              ctx.Attr<float>("Scale_in"), w->data<int8_t>(),
+              ctx.Attr<std::vector<float>>("Scale_weights"), output_data,
+              bias ? bias->data<T>() : NULL, with_relu);
+      return;
+    }
+    const T* w_data = w->data<T>();
     math::FCFunctor<DeviceContext, T> fc;
     fc(dev_ctx, M, w_dims1, w_dims0, input_data, w_data, output_data,
        bias ? bias->data<T>() : NULL, with_relu, padding_weights);
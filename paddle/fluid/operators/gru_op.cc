@@ -15,9 +15,11 @@ limitations under the License. */
 #include "paddle/fluid/operators/gru_op.h"
 #include <memory>
 #include <string>
+#include "paddle/fluid/operators/jit/kernels.h"
 #include "paddle/fluid/operators/math/blas.h"
 #include "paddle/fluid/operators/math/detail/gru_cpu_kernel.h"
 #include "paddle/fluid/operators/math/detail/gru_kernel.h"
+#include "paddle/fluid/operators/math/sequence_rnn.h"
 
 DECLARE_int32(paddle_num_threads);
 
@@ -145,6 +147,12 @@ class GRUOpMaker : public framework::OpProtoAndCheckerMaker {
                   "bool"
                   "use origin mode in article https://arxiv.org/abs/1412.3555")
         .SetDefault(false);
+    AddAttr<bool>("is_test",
+                  "(bool, default false) Set to true for inference only, false "
+                  "for training. Some layers may run faster when this is true. "
+                  "The CPU kernel then computes the sequences in place and "
+                  "leaves the batch outputs empty.")
+        .SetDefault(false);
     AddComment(R"DOC(
 GRU Operator implements part calculations of the complete GRU as following:
 
@@ -379,8 +387,31 @@ class GRUCPUKernel : public framework::OpKernel<T> {
     to_seq(dev_ctx, *batch_hidden, hidden);
   }
 
+  // Computes Hidden of each sequence in place, without reordering the input
+  // into batches. The jit GRU kernels do not support origin_mode.
+  void SeqCompute(const framework::ExecutionContext& context) const {
+    auto* input = context.Input<LoDTensor>("Input");
+    auto* h0 = context.Input<Tensor>("H0");
+    auto* weight = context.Input<Tensor>("Weight");
+    auto* bias = context.Input<Tensor>("Bias");
+    auto* hidden = context.Output<LoDTensor>("Hidden");
+    const jit::gru_attr_t attr(
+        weight->dims()[0],
+        jit::to_kerneltype(context.Attr<std::string>("gate_activation")),
+        jit::to_kerneltype(context.Attr<std::string>("activation")));
+    math::SequenceGRU<T>(
+        context.template device_context<platform::CPUDeviceContext>(),
+        *input, *weight, bias ? bias->data<T>() : nullptr,
+        h0 ? h0->data<T>() : nullptr, context.Attr<bool>("is_reverse"), attr,
+        hidden);
+  }
+
   void Compute(const framework::ExecutionContext& context) const override {
-    BatchCompute(context);
+    if (context.Attr<bool>("is_test") && !context.Attr<bool>("origin_mode")) {
+      SeqCompute(context);
+    } else {
+      BatchCompute(context);
+    }
   }
 };
 
@@ -0,0 +1,188 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/operator.h"
+
+USE_OP(mul);
+USE_OP(matmul);
+USE_OP(conv2d);
+
+namespace paddle {
+namespace operators {
+
+using framework::LoDTensor;
+
+static LoDTensor* RandomTensor(framework::Scope* scope,
+                               const std::string& name,
+                               const framework::DDim& dims,
+                               std::mt19937* engine) {
+  std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  float* data = tensor->mutable_data<float>(dims, platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = dist(*engine);
+  }
+  return tensor;
+}
+
+static float AbsMax(const LoDTensor& tensor) {
+  float abs_max = 0.f;
+  for (int64_t i = 0; i < tensor.numel(); ++i) {
+    abs_max = std::max(abs_max, std::fabs(tensor.data<float>()[i]));
+  }
+  return abs_max;
+}
+
+// Quantizes the float weight name into the INT8 weight name + "_int8" by the
+// abs max of each of the num_channels channels, the element i belongs to the
+// channel channel_of(i), like the native_int8_quantize_pass. Returns the
+// scales of the channels.
+static std::vector<float> QuantizeWeight(
+    framework::Scope* scope, const std::string& name, int num_channels,
+    const std::function<int(int64_t)>& channel_of) {
+  const auto& weight = scope->FindVar(name)->Get<LoDTensor>();
+  std::vector<float> abs_max(num_channels, 0.f);
+  for (int64_t i = 0; i < weight.numel(); ++i) {
+    auto& m = abs_max[channel_of(i)];
+    m = std::max(m, std::fabs(weight.data<float>()[i]));
+  }
+  std::vector<float> scales(num_channels);
+  for (int c = 0; c < num_channels; ++c) {
+    scales[c] = 127.f / abs_max[c];
+  }
+  auto* weight_int8 = scope->Var(name + "_int8")->GetMutable<LoDTensor>();
+  int8_t* data =
+      weight_int8->mutable_data<int8_t>(weight.dims(), platform::CPUPlace());
+  for (int64_t i = 0; i < weight.numel(); ++i) {
+    data[i] = static_cast<int8_t>(
+        std::round(weight.data<float>()[i] * scales[channel_of(i)]));
+  }
+  return scales;
+}
+
+// The bound of the quantization error of a sum of k products of the inputs
+// of abs max x_max and w_max, quantized by scale_x and the scales_w.
+static float ErrorBound(int64_t k, float x_max, float scale_x, float w_max,
+                        const std::vector<float>& scales_w) {
+  const float dx = 0.5f / scale_x;
+  const float dw = 0.5f / *std::min_element(scales_w.begin(), scales_w.end());
+  return k * (x_max * dw + w_max * dx + dx * dw) + 1e-4f;
+}
+
+static void RunOp(const std::string& type,
+                  const framework::VariableNameMap& inputs,
+                  const std::string& output_slot, const std::string& output,
+                  const framework::AttributeMap& attrs,
+                  framework::Scope* scope) {
+  scope->Var(output)->GetMutable<LoDTensor>();
+  auto op = framework::OpRegistry::CreateOp(type, inputs,
+                                            {{output_slot, {output}}}, attrs);
+  op->Run(*scope, platform::CPUPlace());
+}
+
+static void ExpectNear(const framework::Scope& scope, const std::string& x,
+                       const std::string& y, float abs_error) {
+  auto& x_tensor = scope.FindVar(x)->Get<LoDTensor>();
+  auto& y_tensor = scope.FindVar(y)->Get<LoDTensor>();
+  ASSERT_EQ(x_tensor.dims(), y_tensor.dims());
+  for (int64_t i = 0; i < x_tensor.numel(); ++i) {
+    ASSERT_NEAR(x_tensor.data<float>()[i], y_tensor.data<float>()[i],
+                abs_error);
+  }
+}
+
+TEST(Int8Op, mul) {
+  framework::Scope scope;
+  std::mt19937 engine(0);
+  const int M = 6, K = 32, N = 16;
+  auto* x = RandomTensor(&scope, "X", {M, K}, &engine);
+  auto* y = RandomTensor(&scope, "Y", {K, N}, &engine);
+  auto scale_y =
+      QuantizeWeight(&scope, "Y", N, [=](int64_t i) { return i % N; });
+  const float scale_x = 127.f / AbsMax(*x);
+
+  RunOp("mul", {{"X", {"X"}}, {"Y", {"Y"}}}, "Out", "Out", {}, &scope);
+  framework::AttributeMap attrs = {{"scale_x", scale_x}, {"scale_y", scale_y}};
+  RunOp("mul", {{"X", {"X"}}, {"Y", {"Y_int8"}}}, "Out", "int8_Out", attrs,
+        &scope);
+  ExpectNear(scope, "Out", "int8_Out",
+             ErrorBound(K, AbsMax(*x), scale_x, AbsMax(*y), scale_y));
+}
+
+TEST(Int8Op, matmul) {
+  framework::Scope scope;
+  std::mt19937 engine(1);
+  const int K = 32, N = 16;
+  const float alpha = 0.5f;
+  // The rows of a 3-D X are multiplied by the same Y.
+  auto* x = RandomTensor(&scope, "X", {2, 3, K}, &engine);
+  auto* y = RandomTensor(&scope, "Y", {K, N}, &engine);
+  auto scale_y =
+      QuantizeWeight(&scope, "Y", N, [=](int64_t i) { return i % N; });
+  const float scale_x = 127.f / AbsMax(*x);
+
+  framework::AttributeMap attrs = {{"alpha", alpha}};
+  RunOp("matmul", {{"X", {"X"}}, {"Y", {"Y"}}}, "Out", "Out", attrs, &scope);
+  attrs["scale_x"] = scale_x;
+  attrs["scale_y"] = scale_y;
+  RunOp("matmul", {{"X", {"X"}}, {"Y", {"Y_int8"}}}, "Out", "int8_Out", attrs,
+        &scope);
+  ExpectNear(scope, "Out", "int8_Out",
+             alpha * ErrorBound(K, AbsMax(*x), scale_x, AbsMax(*y), scale_y));
+}
+
+static void CompareConv2D(int groups) {
+  framework::Scope scope;
+  std::mt19937 engine(groups);
+  const int in_channels = 4, out_channels = 6, ksize = 3;
+  const int64_t filter_size = in_channels / groups * ksize * ksize;
+  auto* input = RandomTensor(&scope, "Input", {2, in_channels, 8, 8}, &engine);
+  auto* filter = RandomTensor(
+      &scope, "Filter", {out_channels, in_channels / groups, ksize, ksize},
+      &engine);
+  auto scale_weights =
+      QuantizeWeight(&scope, "Filter", out_channels,
+                     [=](int64_t i) { return i / filter_size; });
+  const float scale_in = 127.f / AbsMax(*input);
+
+  framework::AttributeMap attrs = {{"strides", std::vector<int>{1, 1}},
+                                   {"paddings", std::vector<int>{1, 1}},
+                                   {"dilations", std::vector<int>{1, 1}},
+                                   {"groups", groups}};
+  RunOp("conv2d", {{"Input", {"Input"}}, {"Filter", {"Filter"}}}, "Output",
+        "Output", attrs, &scope);
+  attrs["Scale_in"] = scale_in;
+  attrs["Scale_weights"] = scale_weights;
+  RunOp("conv2d", {{"Input", {"Input"}}, {"Filter", {"Filter_int8"}}},
+        "Output", "int8_Output", attrs, &scope);
+  ExpectNear(scope, "Output", "int8_Output",
+             ErrorBound(filter_size, AbsMax(*input), scale_in,
+                        AbsMax(*filter), scale_weights));
+}
+
+TEST(Int8Op, conv2d) {
+  CompareConv2D(1);
+  CompareConv2D(2);
+}
+
+}  // namespace operators
+}  // namespace paddle
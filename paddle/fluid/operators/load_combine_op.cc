@@ -59,6 +59,12 @@ class LoadCombineOpProtoMaker : public framework::OpProtoAndCheckerMaker {
                   "If true, file_path is in memory, and LoDTensors will be "
                   "loaded directly from memory")
         .SetDefault(false);
+    AddAttr<bool>("use_mmap",
+                  "(boolean, default false)"
+                  "If true and the file is in the aligned combined format, "
+                  "the file will be memory mapped and the LoDTensors on CPU "
+                  "will share the mapped pages instead of copying them.")
+        .SetDefault(false);
     AddComment(R"DOC(
 LoadCombine Operator.
 
@@ -71,6 +77,11 @@ in the SaveCombine operator. Hence, the LoadCombine operator is tightly coupled
 with the SaveCombine operator, and can only deserialize one or more LoDTensors
 that were saved using the SaveCombine operator.
 
+Files saved with the `save_as_aligned` attribute of the SaveCombine operator
+are detected automatically. For such files, the `use_mmap` attribute lets the
+CPU kernel map the file into memory, so that the LoDTensors point directly to
+the mapped pages, which are loaded lazily and shared between processes.
+
 )DOC");
   }
 };
@@ -18,6 +18,7 @@ limitations under the License. */
 #include <string>
 #include <vector>
 
+#include "paddle/fluid/framework/aligned_combine.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/framework/op_registry.h"
@@ -33,6 +34,7 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
     auto filename = ctx.Attr<std::string>("file_path");
     auto load_as_fp16 = ctx.Attr<bool>("load_as_fp16");
     auto model_from_memory = ctx.Attr<bool>("model_from_memory");
+    auto use_mmap = ctx.Attr<bool>("use_mmap");
     auto out_var_names = ctx.OutputNames("Out");
 
     PADDLE_ENFORCE_GT(
@@ -44,14 +46,95 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
                      "OP(LoadCombine) fail to open file %s, please check "
                      "whether the model file is complete or damaged.",
                      filename);
-      LoadParamsFromBuffer(ctx, place, &fin, load_as_fp16, out_var_names);
+      if (framework::IsAlignedCombineStream(fin)) {
+#ifndef _WIN32
+        if (use_mmap && platform::is_cpu_place(place)) {
+          fin.close();
+          LoadAlignedParamsByMemoryMap(ctx, place, filename, load_as_fp16,
+                                       out_var_names);
+          return;
+        }
+#endif
+        LoadAlignedParamsFromBuffer(ctx, place, &fin, load_as_fp16,
+                                    out_var_names);
+      } else {
+        LoadParamsFromBuffer(ctx, place, &fin, load_as_fp16, out_var_names);
+      }
     } else {
       PADDLE_ENFORCE(!filename.empty(),
                      "OP(LoadCombine) fail to open file %s, please check "
                      "whether the model file is complete or damaged.",
                      filename);
       std::stringstream fin(filename, std::ios::in | std::ios::binary);
-      LoadParamsFromBuffer(ctx, place, &fin, load_as_fp16, out_var_names);
+      if (framework::IsAlignedCombineStream(fin)) {
+        LoadAlignedParamsFromBuffer(ctx, place, &fin, load_as_fp16,
+                                    out_var_names);
+      } else {
+        LoadParamsFromBuffer(ctx, place, &fin, load_as_fp16, out_var_names);
+      }
+    }
+  }
+
+  void LoadAlignedParamsFromBuffer(
+      const framework::ExecutionContext &context, const platform::Place &place,
+      std::istream *buffer, bool load_as_fp16,
+      const std::vector<std::string> &out_var_names) const {
+    platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
+    auto &dev_ctx = *pool.Get(place);
+    auto out_vars = context.MultiOutputVar("Out");
+    framework::DeserializeFromAlignedCombineStream(
+        *buffer, GetOutputTensors(out_vars, out_var_names), dev_ctx);
+    for (auto *out_var : out_vars) {
+      MaybeConvertToFP16(place, load_as_fp16, out_var);
+    }
+  }
+
+  void LoadAlignedParamsByMemoryMap(
+      const framework::ExecutionContext &context, const platform::Place &place,
+      const std::string &filename, bool load_as_fp16,
+      const std::vector<std::string> &out_var_names) const {
+    auto out_vars = context.MultiOutputVar("Out");
+    framework::LoadAlignedCombineFileByMemoryMap(
+        filename, GetOutputTensors(out_vars, out_var_names));
+    for (auto *out_var : out_vars) {
+      MaybeConvertToFP16(place, load_as_fp16, out_var);
+    }
+  }
+
+  std::vector<framework::LoDTensor *> GetOutputTensors(
+      const std::vector<framework::Variable *> &out_vars,
+      const std::vector<std::string> &out_var_names) const {
+    std::vector<framework::LoDTensor *> tensors;
+    tensors.reserve(out_vars.size());
+    for (size_t i = 0; i < out_vars.size(); i++) {
+      PADDLE_ENFORCE(out_vars[i] != nullptr,
+                     "Output variable %s cannot be found", out_var_names[i]);
+      tensors.push_back(out_vars[i]->GetMutable<framework::LoDTensor>());
+    }
+    return tensors;
+  }
+
+  void MaybeConvertToFP16(const platform::Place &place, bool load_as_fp16,
+                          framework::Variable *out_var) const {
+    auto *tensor = out_var->GetMutable<framework::LoDTensor>();
+    auto in_dtype = tensor->type();
+    auto out_dtype = load_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
+
+    if (in_dtype != out_dtype) {
+      // convert to float16 tensor
+      auto in_kernel_type = framework::OpKernelType(in_dtype, place);
+      auto out_kernel_type = framework::OpKernelType(out_dtype, place);
+      framework::LoDTensor fp16_tensor;
+      // copy LoD info to the new tensor
+      fp16_tensor.set_lod(tensor->lod());
+      framework::TransDataType(in_kernel_type, out_kernel_type, *tensor,
+                               &fp16_tensor);
+
+      // reset output tensor
+      out_var->Clear();
+      tensor = out_var->GetMutable<framework::LoDTensor>();
+      tensor->set_lod(fp16_tensor.lod());
+      tensor->ShareDataWith(fp16_tensor);
     }
   }
 
@@ -78,26 +161,7 @@ class LoadCombineOpKernel : public framework::OpKernel<T> {
       // Get data from fin to tensor
       DeserializeFromStream(*buffer, tensor, dev_ctx);
 
-      auto in_dtype = tensor->type();
-      auto out_dtype =
-          load_as_fp16 ? framework::proto::VarType::FP16 : in_dtype;
-
-      if (in_dtype != out_dtype) {
-        // convert to float16 tensor
-        auto in_kernel_type = framework::OpKernelType(in_dtype, place);
-        auto out_kernel_type = framework::OpKernelType(out_dtype, place);
-        framework::LoDTensor fp16_tensor;
-        // copy LoD info to the new tensor
-        fp16_tensor.set_lod(tensor->lod());
-        framework::TransDataType(in_kernel_type, out_kernel_type, *tensor,
-                                 &fp16_tensor);
-
-        // reset output tensor
-        out_vars[i]->Clear();
-        tensor = out_vars[i]->GetMutable<framework::LoDTensor>();
-        tensor->set_lod(fp16_tensor.lod());
-        tensor->ShareDataWith(fp16_tensor);
-      }
+      MaybeConvertToFP16(place, load_as_fp16, out_vars[i]);
     }
     buffer->peek();
     PADDLE_ENFORCE(buffer->eof(),
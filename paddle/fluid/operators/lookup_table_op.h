@@ -21,7 +21,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/lod_tensor.h"
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/selected_rows.h"
-#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/embedding_lookup.h"
 
 #ifdef PADDLE_WITH_DISTRIBUTE
 #include "paddle/fluid/operators/distributed/parameter_prefetch.h"
@@ -73,6 +73,8 @@ class LookupTableKernel : public framework::OpKernel<T> {
       int64_t padding_idx = context.Attr<int64_t>("padding_idx");
       int64_t *ids = const_cast<int64_t *>(ids_t->data<int64_t>());
       int64_t ids_numel = ids_t->numel();
+      auto &dev_ctx =
+          context.template device_context<platform::CPUDeviceContext>();
 
       if (table_var->IsType<LoDTensor>()) {
         auto *table_t = context.Input<LoDTensor>("W");
@@ -82,55 +84,64 @@ class LookupTableKernel : public framework::OpKernel<T> {
         auto *table = table_t->data<T>();
         auto *output = output_t->mutable_data<T>(context.GetPlace());
 
-        for (int64_t i = 0; i < ids_numel; ++i) {
-          if (padding_idx != kNoPadding && ids[i] == padding_idx) {
-            memset(output + i * row_width, 0, row_width * sizeof(T));
+        // The rows of the padding ids are filled with zeros.
+        std::vector<int64_t> rows(ids, ids + ids_numel);
+        for (auto &row : rows) {
+          if (padding_idx != kNoPadding && row == padding_idx) {
+            row = -1;
           } else {
             PADDLE_ENFORCE_LT(
-                ids[i], row_number,
+                row, row_number,
                 "Variable value (input) of OP(fluid.layers.embedding) "
                 "expected >= 0 and < %ld, but got %ld. Please check input "
                 "value.",
-                row_number, ids[i]);
+                row_number, row);
             PADDLE_ENFORCE_GE(
-                ids[i], 0,
+                row, 0,
                 "Variable value (input) of OP(fluid.layers.embedding) "
                 "expected >= 0 and < %ld, but got %ld. Please check input "
                 "value.",
-                row_number, ids[i]);
-            memcpy(output + i * row_width, table + ids[i] * row_width,
-                   row_width * sizeof(T));
+                row_number, row);
           }
         }
+        math::GatherRows(dev_ctx, table, row_width, rows.data(), ids_numel,
+                         output);
       } else if (table_var->IsType<SelectedRows>()) {
         const auto &table_t = table_var->Get<SelectedRows>();
         int64_t row_width = table_t.value().dims()[1];
         const auto *table = table_t.value().data<T>();
         auto *output = output_t->mutable_data<T>(context.GetPlace());
-        auto input_data_type = table_t.value().type();
+
+        // The index of a key in the table is searched once for the same ids.
+        math::UniqueIds unique_ids(ids, ids_numel);
+        const auto &keys = unique_ids.values();
+        std::vector<int64_t> unique_rows(unique_ids.size());
+        dev_ctx.ParallelFor(
+            unique_ids.size(), 16, [&](int64_t begin, int64_t end) {
+              for (int64_t u = begin; u < end; ++u) {
+                if (padding_idx != kNoPadding && keys[u] == padding_idx) {
+                  unique_rows[u] = -1;
+                  continue;
+                }
+                PADDLE_ENFORCE_GE(
+                    keys[u], 0,
+                    "Variable value (input) of OP(fluid.layers.embedding) "
+                    "expected >= 0. But received %ld",
+                    keys[u]);
+                auto id_index = table_t.Index(keys[u]);
+                PADDLE_ENFORCE_GE(
+                    id_index, 0,
+                    "the input key should be exists. But received %d.",
+                    id_index);
+                unique_rows[u] = id_index;
+              }
+            });
+        std::vector<int64_t> rows(ids_numel);
         for (int64_t i = 0; i < ids_numel; ++i) {
-          if (padding_idx != kNoPadding && ids[i] == padding_idx) {
-            memset(output + i * row_width, 0, row_width * sizeof(T));
-          } else {
-            PADDLE_ENFORCE_GE(
-                ids[i], 0,
-                "Variable value (input) of OP(fluid.layers.embedding) "
-                "expected >= 0. But received %ld",
-                ids[i]);
-            auto id_index = table_t.Index(ids[i]);
-            PADDLE_ENFORCE_GE(
-                id_index, 0, "the input key should be exists. But received %d.",
-                id_index);
-            if (input_data_type == framework::proto::VarType::INT8) {
-              memcpy(output + i * row_width, table + id_index * row_width,
-                     row_width * sizeof(T));
-            } else {
-              auto blas = math::GetBlas<platform::CPUDeviceContext, T>(context);
-              blas.VCOPY(row_width, table + id_index * row_width,
-                         output + i * row_width);
-            }
-          }
+          rows[i] = unique_rows[unique_ids.index(i)];
         }
+        math::GatherRows(dev_ctx, table, row_width, rows.data(), ids_numel,
+                         output);
       }
     }
   }
@@ -165,13 +176,6 @@ class LookupTableGradKernel : public framework::OpKernel<T> {
       auto *ids_data = ids->data<int64_t>();
       int64_t ids_num = ids->numel();
 
-      std::vector<int64_t> new_rows;
-      new_rows.resize(ids_num);
-      std::memcpy(&new_rows[0], ids_data, ids_num * sizeof(int64_t));
-      d_table->set_rows(new_rows);
-
-      auto *d_table_value = d_table->mutable_value();
-      d_table_value->Resize({ids_num, table_dim[1]});
       // FIXME(minqiyang):
       // memory optimization will NOT reuse Tensor with SelectedRows
       // so we could just share the tensor here directly.
@@ -181,25 +185,38 @@ class LookupTableGradKernel : public framework::OpKernel<T> {
       // the InferVarType's bug was fixed
       bool grad_inplace = context.Attr<bool>("grad_inplace");
       if (grad_inplace) {
+        std::vector<int64_t> new_rows;
+        new_rows.resize(ids_num);
+        std::memcpy(&new_rows[0], ids_data, ids_num * sizeof(int64_t));
+        d_table->set_rows(new_rows);
+
+        auto *d_table_value = d_table->mutable_value();
+        d_table_value->Resize({ids_num, table_dim[1]});
         d_table_value->ShareDataWith(*d_output);
       } else {
-        d_table_value->mutable_data<T>(context.GetPlace());
-
-        d_table->set_height(table_dim[0]);
-
-        auto *d_output_data = d_output->data<T>();
-        auto *d_table_data = d_table_value->data<T>();
-
         auto d_output_dims = d_output->dims();
         auto d_output_dims_2d =
             framework::flatten_to_2d(d_output_dims, d_output_dims.size() - 1);
-        PADDLE_ENFORCE_EQ(d_table_value->dims(), d_output_dims_2d,
-                          "ShapeError: The shape of lookup_table@Grad and "
-                          "output@Grad should be same. "
-                          "But received lookup_table@Grad's shape = [%s], "
-                          "output@Grad's shape = [%s].",
-                          d_table_value->dims(), d_output_dims_2d);
-        memcpy(d_table_data, d_output_data, sizeof(T) * d_output->numel());
+        PADDLE_ENFORCE_EQ(d_output_dims_2d,
+                          framework::make_ddim({ids_num, table_dim[1]}),
+                          "ShapeError: The shape of output@Grad should be "
+                          "[number of ids, width of lookup_table]. "
+                          "But received output@Grad's shape = [%s], "
+                          "number of ids = %ld, width of lookup_table = %ld.",
+                          d_output_dims_2d, ids_num, table_dim[1]);
+
+        // The rows of the same ids are merged, so that each row of the gradient
+        // is updated once by the optimizer.
+        math::UniqueIds unique_ids(ids_data, ids_num);
+        d_table->set_rows(unique_ids.values());
+        d_table->set_height(table_dim[0]);
+        auto *d_table_value = d_table->mutable_value();
+        d_table_value->Resize({unique_ids.size(), table_dim[1]});
+        auto &dev_ctx =
+            context.template device_context<platform::CPUDeviceContext>();
+        math::MergeRows(dev_ctx, unique_ids, d_output->data<T>(),
+                        table_dim[1],
+                        d_table_value->mutable_data<T>(context.GetPlace()));
       }
     } else {
       auto *ids = context.Input<LoDTensor>("Ids");
@@ -231,11 +248,14 @@ class LookupTableGradKernel : public framework::OpKernel<T> {
               "Variable value (input) of OP(fluid.layers.embedding) "
               "expected >= 0 and < %ld, but got %ld. Please check input value.",
               N, ids_data[i]);
-          for (int j = 0; j < D; ++j) {
-            d_table_data[ids_data[i] * D + j] += d_output_data[i * D + j];
-          }
         }
       }
+      // The rows of the same ids are added by one thread.
+      auto &dev_ctx =
+          context.template device_context<platform::CPUDeviceContext>();
+      math::UniqueIds unique_ids(ids_data, ids->numel());
+      math::ScatterAddRows(dev_ctx, unique_ids, d_output_data, D, padding_idx,
+                           d_table_data);
     }
   }
 };
@@ -0,0 +1,104 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/framework/selected_rows.h"
+
+USE_OP(lookup_table);
+USE_OP(lookup_table_v2);
+
+namespace paddle {
+namespace operators {
+
+using framework::LoDTensor;
+using framework::SelectedRows;
+
+// Runs the sparse gradient op of the type on n ids of a height x width
+// table, of which many are repeated, and checks that the rows of W@GRAD are
+// the unique ids and their values are the sums of the rows of Out@GRAD.
+static void CheckSparseGrad(const std::string& type, int64_t n, int64_t height,
+                            int64_t width) {
+  framework::Scope scope;
+  std::mt19937 engine(n);
+  std::uniform_int_distribution<int64_t> id_dist(0, height - 1);
+  std::uniform_real_distribution<float> value_dist(-1.f, 1.f);
+  const platform::CPUPlace place;
+
+  auto* w = scope.Var("W")->GetMutable<LoDTensor>();
+  float* w_data = w->mutable_data<float>({height, width}, place);
+  for (int64_t i = 0; i < height * width; ++i) w_data[i] = value_dist(engine);
+
+  // The ids of lookup_table have the last dimension 1.
+  auto* ids = scope.Var("Ids")->GetMutable<LoDTensor>();
+  const framework::DDim ids_dims =
+      type == "lookup_table" ? framework::make_ddim({n, 1})
+                             : framework::make_ddim({n});
+  int64_t* ids_data = ids->mutable_data<int64_t>(ids_dims, place);
+  for (int64_t i = 0; i < n; ++i) ids_data[i] = id_dist(engine);
+
+  auto* d_out = scope.Var("Out@GRAD")->GetMutable<LoDTensor>();
+  float* d_out_data = d_out->mutable_data<float>({n, width}, place);
+  for (int64_t i = 0; i < n * width; ++i) d_out_data[i] = value_dist(engine);
+
+  auto* d_w = scope.Var("W@GRAD")->GetMutable<SelectedRows>();
+  framework::AttributeMap attrs = {{"is_sparse", true},
+                                   {"padding_idx", int64_t{-1}}};
+  if (type == "lookup_table") attrs["grad_inplace"] = false;
+  auto op = framework::OpRegistry::CreateOp(
+      type + "_grad",
+      {{"W", {"W"}}, {"Ids", {"Ids"}}, {"Out@GRAD", {"Out@GRAD"}}},
+      {{"W@GRAD", {"W@GRAD"}}}, attrs);
+  op->Run(scope, place);
+
+  std::map<int64_t, std::vector<float>> sums;
+  for (int64_t i = 0; i < n; ++i) {
+    auto& sum = sums[ids_data[i]];
+    sum.resize(width, 0.f);
+    for (int64_t j = 0; j < width; ++j) {
+      sum[j] += d_out_data[i * width + j];
+    }
+  }
+  const auto& rows = d_w->rows();
+  ASSERT_EQ(d_w->height(), height);
+  ASSERT_EQ(rows.size(), sums.size());
+  ASSERT_EQ(std::set<int64_t>(rows.begin(), rows.end()).size(), rows.size());
+  const auto& value = d_w->value();
+  ASSERT_EQ(value.dims(),
+            framework::make_ddim({static_cast<int64_t>(rows.size()), width}));
+  for (size_t k = 0; k < rows.size(); ++k) {
+    auto it = sums.find(rows[k]);
+    ASSERT_TRUE(it != sums.end());
+    for (int64_t j = 0; j < width; ++j) {
+      ASSERT_NEAR(value.data<float>()[k * width + j], it->second[j], 1e-5);
+    }
+  }
+}
+
+TEST(LookupTableOp, sparse_grad) {
+  for (const std::string type : {"lookup_table", "lookup_table_v2"}) {
+    CheckSparseGrad(type, 1, 10, 8);
+    CheckSparseGrad(type, 1000, 50, 13);
+    CheckSparseGrad(type, 1000, 10000, 32);
+  }
+}
+
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,260 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include "glog/logging.h"
+#include "gtest/gtest.h"
+#include "paddle/fluid/framework/op_registry.h"
+#include "paddle/fluid/framework/operator.h"
+#include "paddle/fluid/operators/math/fc.h"
+#include "paddle/fluid/platform/cpu_helper.h"
+#include "paddle/fluid/platform/timer.h"
+
+USE_OP(lstm);
+USE_OP(gru);
+USE_CPU_ONLY_OP(fusion_lstm);
+USE_CPU_ONLY_OP(fusion_gru);
+
+namespace paddle {
+namespace operators {
+
+using framework::LoDTensor;
+
+// The LoD of num_seqs sequences of random lengths in [1, max_len].
+static framework::LoD RandomLoD(int num_seqs, int max_len,
+                                std::mt19937* engine) {
+  std::uniform_int_distribution<int> dist(1, max_len);
+  std::vector<size_t> offsets = {0};
+  for (int i = 0; i < num_seqs; ++i) {
+    offsets.push_back(offsets.back() + dist(*engine));
+  }
+  return {offsets};
+}
+
+static LoDTensor* RandomTensor(framework::Scope* scope,
+                               const std::string& name,
+                               const framework::DDim& dims,
+                               std::mt19937* engine) {
+  std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+  auto* tensor = scope->Var(name)->GetMutable<LoDTensor>();
+  float* data = tensor->mutable_data<float>(dims, platform::CPUPlace());
+  for (int64_t i = 0; i < tensor->numel(); ++i) {
+    data[i] = dist(*engine);
+  }
+  return tensor;
+}
+
+// Runs the op, the output of each slot is written to the variable named by
+// the prefix and the slot.
+static void RunOp(const std::string& type,
+                  const framework::VariableNameMap& inputs,
+                  const std::vector<std::string>& output_slots,
+                  const framework::AttributeMap& attrs,
+                  const std::string& prefix, framework::Scope* scope) {
+  framework::VariableNameMap outputs;
+  for (auto& slot : output_slots) {
+    outputs[slot] = {prefix + slot};
+    scope->Var(prefix + slot)->GetMutable<LoDTensor>();
+  }
+  auto op = framework::OpRegistry::CreateOp(type, inputs, outputs, attrs);
+  op->Run(*scope, platform::CPUPlace());
+}
+
+static void ExpectNear(const framework::Scope& scope, const std::string& x,
+                       const std::string& y, float abs_error) {
+  auto& x_tensor = scope.FindVar(x)->Get<LoDTensor>();
+  auto& y_tensor = scope.FindVar(y)->Get<LoDTensor>();
+  ASSERT_EQ(x_tensor.dims(), y_tensor.dims());
+  EXPECT_EQ(x_tensor.lod(), y_tensor.lod());
+  for (int64_t i = 0; i < x_tensor.numel(); ++i) {
+    ASSERT_NEAR(x_tensor.data<float>()[i], y_tensor.data<float>()[i],
+                abs_error);
+  }
+}
+
+static void CompareLSTM(bool use_peepholes, bool is_reverse, bool has_h0) {
+  framework::Scope scope;
+  std::mt19937 engine(use_peepholes + 2 * is_reverse + 4 * has_h0);
+  const int num_seqs = 7, frame_size = 16;
+  auto lod = RandomLoD(num_seqs, 20, &engine);
+  const int64_t total_t = lod[0].back();
+  RandomTensor(&scope, "Input", {total_t, 4 * frame_size}, &engine)
+      ->set_lod(lod);
+  RandomTensor(&scope, "Weight", {frame_size, 4 * frame_size}, &engine);
+  RandomTensor(&scope, "Bias", {1, (use_peepholes ? 7 : 4) * frame_size},
+               &engine);
+  framework::VariableNameMap inputs = {
+      {"Input", {"Input"}}, {"Weight", {"Weight"}}, {"Bias", {"Bias"}}};
+  if (has_h0) {
+    RandomTensor(&scope, "H0", {num_seqs, frame_size}, &engine);
+    RandomTensor(&scope, "C0", {num_seqs, frame_size}, &engine);
+    inputs["H0"] = {"H0"};
+    inputs["C0"] = {"C0"};
+  }
+  const std::vector<std::string> outputs = {"Hidden", "Cell", "BatchGate",
+                                            "BatchCellPreAct"};
+  framework::AttributeMap attrs = {{"use_peepholes", use_peepholes},
+                                   {"is_reverse", is_reverse}};
+  RunOp("lstm", inputs, outputs, attrs, "batch_", &scope);
+  attrs["is_test"] = true;
+  RunOp("lstm", inputs, outputs, attrs, "seq_", &scope);
+  ExpectNear(scope, "batch_Hidden", "seq_Hidden", 1e-5f);
+  ExpectNear(scope, "batch_Cell", "seq_Cell", 1e-5f);
+}
+
+static void CompareGRU(bool is_reverse, bool has_h0) {
+  framework::Scope scope;
+  std::mt19937 engine(is_reverse + 2 * has_h0);
+  const int num_seqs = 7, frame_size = 16;
+  auto lod = RandomLoD(num_seqs, 20, &engine);
+  const int64_t total_t = lod[0].back();
+  RandomTensor(&scope, "Input", {total_t, 3 * frame_size}, &engine)
+      ->set_lod(lod);
+  RandomTensor(&scope, "Weight", {frame_size, 3 * frame_size}, &engine);
+  RandomTensor(&scope, "Bias", {1, 3 * frame_size}, &engine);
+  framework::VariableNameMap inputs = {
+      {"Input", {"Input"}}, {"Weight", {"Weight"}}, {"Bias", {"Bias"}}};
+  if (has_h0) {
+    RandomTensor(&scope, "H0", {num_seqs, frame_size}, &engine);
+    inputs["H0"] = {"H0"};
+  }
+  const std::vector<std::string> outputs = {
+      "Hidden", "BatchGate", "BatchResetHiddenPrev", "BatchHidden"};
+  framework::AttributeMap attrs = {{"is_reverse", is_reverse}};
+  RunOp("gru", inputs, outputs, attrs, "batch_", &scope);
+  attrs["is_test"] = true;
+  RunOp("gru", inputs, outputs, attrs, "seq_", &scope);
+  ExpectNear(scope, "batch_Hidden", "seq_Hidden", 1e-5f);
+}
+
+TEST(LSTMOp, is_test_compare_batch) {
+  for (bool use_peepholes : {false, true}) {
+    for (bool is_reverse : {false, true}) {
+      CompareLSTM(use_peepholes, is_reverse, false);
+      CompareLSTM(use_peepholes, is_reverse, true);
+    }
+  }
+  // The sequences are split into groups for the intra-op threads.
+  platform::SetIntraOpNumThreads(3);
+  CompareLSTM(true, false, true);
+  platform::SetIntraOpNumThreads(1);
+}
+
+TEST(GRUOp, is_test_compare_batch) {
+  for (bool is_reverse : {false, true}) {
+    CompareGRU(is_reverse, false);
+    CompareGRU(is_reverse, true);
+  }
+  platform::SetIntraOpNumThreads(3);
+  CompareGRU(false, true);
+  platform::SetIntraOpNumThreads(1);
+}
+
+// Compares the lstm and gru ops for inference, after an FC of the input, with
+// fusion_lstm and fusion_gru on variable-length sequences.
+static void BenchmarkRNN(bool lstm, int num_seqs, int max_len, int input_size,
+                         int frame_size) {
+  framework::Scope scope;
+  std::mt19937 engine(0);
+  const int gates = (lstm ? 4 : 3) * frame_size;
+  auto lod = RandomLoD(num_seqs, max_len, &engine);
+  const int64_t total_t = lod[0].back();
+  auto* x = RandomTensor(&scope, "X", {total_t, input_size}, &engine);
+  x->set_lod(lod);
+  auto* weight_x =
+      RandomTensor(&scope, "WeightX", {input_size, gates}, &engine);
+  RandomTensor(&scope, "WeightH", {frame_size, gates}, &engine);
+  RandomTensor(&scope, "Bias", {1, gates}, &engine);
+  auto* input = scope.Var("Input")->GetMutable<LoDTensor>();
+  input->Resize({total_t, gates});
+  input->set_lod(lod);
+
+  std::vector<std::string> fusion_outputs = {"Hidden", "XX", "BatchedInput",
+                                             "ReorderedH0"};
+  std::vector<std::string> outputs = {"Hidden", "BatchGate"};
+  if (lstm) {
+    fusion_outputs.insert(fusion_outputs.end(),
+                          {"Cell", "BatchedHidden", "BatchedCell",
+                           "ReorderedC0", "CheckedCell"});
+    outputs.insert(outputs.end(), {"Cell", "BatchCellPreAct"});
+  } else {
+    fusion_outputs.push_back("BatchedOut");
+    outputs.insert(outputs.end(), {"BatchResetHiddenPrev", "BatchHidden"});
+  }
+  const std::string fusion_type = lstm ? "fusion_lstm" : "fusion_gru";
+  const std::string type = lstm ? "lstm" : "gru";
+  framework::VariableNameMap fusion_inputs = {{"X", {"X"}},
+                                              {"WeightX", {"WeightX"}},
+                                              {"WeightH", {"WeightH"}},
+                                              {"Bias", {"Bias"}}};
+  framework::VariableNameMap inputs = {
+      {"Input", {"Input"}}, {"Weight", {"WeightH"}}, {"Bias", {"Bias"}}};
+  framework::AttributeMap attrs = {{"is_test", true}};
+  if (lstm) attrs["use_peepholes"] = false;
+
+  const int repeat = 5;
+  platform::CPUDeviceContext context;
+  platform::Timer timer;
+  auto time_ms = [&](const std::function<void()>& fn) {
+    fn();
+    timer.Reset();
+    timer.Start();
+    for (int i = 0; i < repeat; ++i) fn();
+    timer.Pause();
+    return timer.ElapsedMS() / repeat;
+  };
+  double fusion_batch_ms = time_ms([&] {
+    RunOp(fusion_type, fusion_inputs, fusion_outputs, {{"use_seq", false}},
+          "fusion_batch_", &scope);
+  });
+  double fusion_seq_ms = time_ms([&] {
+    RunOp(fusion_type, fusion_inputs, fusion_outputs, {{"use_seq", true}},
+          "fusion_seq_", &scope);
+  });
+  auto fc_rnn = [&] {
+    math::FCFunctor<platform::CPUDeviceContext, float> fc;
+    fc(context, total_t, gates, input_size, x->data<float>(),
+       weight_x->data<float>(),
+       input->mutable_data<float>(platform::CPUPlace()));
+    RunOp(type, inputs, outputs, attrs, "seq_", &scope);
+  };
+  double seq_ms = time_ms(fc_rnn);
+  platform::SetIntraOpNumThreads(4);
+  double seq_4_threads_ms = time_ms(fc_rnn);
+  platform::SetIntraOpNumThreads(1);
+
+  ExpectNear(scope, "fusion_batch_Hidden", "seq_Hidden", 1e-4f);
+  LOG(INFO) << type << " of " << num_seqs << " sequences up to " << max_len
+            << " steps, M=" << input_size << " D=" << frame_size << ": "
+            << fusion_type << " batch " << fusion_batch_ms << " ms, seq "
+            << fusion_seq_ms << " ms; fc + " << type << " is_test "
+            << seq_ms << " ms, 4 threads " << seq_4_threads_ms << " ms";
+}
+
+// The benchmarks are run with --gtest_also_run_disabled_tests.
+TEST(LSTMOp, DISABLED_benchmark) {
+  BenchmarkRNN(true, 64, 100, 128, 128);
+  BenchmarkRNN(true, 8, 200, 256, 256);
+}
+
+TEST(GRUOp, DISABLED_benchmark) {
+  BenchmarkRNN(false, 64, 100, 128, 128);
+  BenchmarkRNN(false, 8, 200, 256, 256);
+}
+
+}  // namespace operators
+}  // namespace paddle
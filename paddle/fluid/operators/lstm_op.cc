@@ -15,6 +15,8 @@ limitations under the License. */
 #include "paddle/fluid/operators/lstm_op.h"
 #include <memory>
 #include <string>
+#include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/operators/math/sequence_rnn.h"
 
 namespace paddle {
 namespace operators {
@@ -179,6 +181,12 @@ class LSTMOpMaker : public framework::OpProtoAndCheckerMaker {
                          "`tanh` by default.")
         .SetDefault("tanh")
         .InEnum({"sigmoid", "tanh", "relu", "identity"});
+    AddAttr<bool>("is_test",
+                  "(bool, default false) Set to true for inference only, false "
+                  "for training. Some layers may run faster when this is true. "
+                  "The CPU kernel then computes the sequences in place and "
+                  "leaves the batch outputs empty.")
+        .SetDefault(false);
     AddComment(R"DOC(
 Long-Short Term Memory (LSTM) Operator.
 
@@ -307,6 +315,39 @@ class LSTMGradOpMaker : public framework::SingleGradOpMaker<T> {
   }
 };
 
+// For inference, the CPU kernel computes Hidden and Cell of each sequence in
+// place instead of reordering the input into batches.
+template <typename T>
+class LSTMCPUKernel : public LSTMKernel<platform::CPUDeviceContext, T> {
+ public:
+  void Compute(const framework::ExecutionContext& ctx) const override {
+    if (!ctx.Attr<bool>("is_test")) {
+      LSTMKernel<platform::CPUDeviceContext, T>::Compute(ctx);
+      return;
+    }
+    auto* input = ctx.Input<LoDTensor>("Input");
+    auto* weight = ctx.Input<Tensor>("Weight");
+    auto* bias = ctx.Input<Tensor>("Bias");
+    auto* hidden_t0 = ctx.Input<Tensor>("H0");
+    auto* cell_t0 = ctx.Input<Tensor>("C0");
+    auto* hidden_out = ctx.Output<LoDTensor>("Hidden");
+    auto* cell_out = ctx.Output<LoDTensor>("Cell");
+
+    const jit::lstm_attr_t attr(
+        weight->dims()[0],
+        jit::to_kerneltype(ctx.Attr<std::string>("gate_activation")),
+        jit::to_kerneltype(ctx.Attr<std::string>("candidate_activation")),
+        jit::to_kerneltype(ctx.Attr<std::string>("cell_activation")),
+        ctx.Attr<bool>("use_peepholes"));
+    math::SequenceLSTM<T>(
+        ctx.template device_context<platform::CPUDeviceContext>(), *input,
+        *weight, bias->data<T>(),
+        hidden_t0 ? hidden_t0->data<T>() : nullptr,
+        cell_t0 ? cell_t0->data<T>() : nullptr, ctx.Attr<bool>("is_reverse"),
+        attr, hidden_out, cell_out);
+  }
+};
+
 }  // namespace operators
 }  // namespace paddle
 
@@ -315,9 +356,8 @@ REGISTER_OPERATOR(lstm, ops::LSTMOp, ops::LSTMOpMaker,
                   ops::LSTMGradOpMaker<paddle::framework::OpDesc>,
                   ops::LSTMGradOpMaker<paddle::imperative::OpBase>);
 REGISTER_OPERATOR(lstm_grad, ops::LSTMGradOp);
-REGISTER_OP_CPU_KERNEL(
-    lstm, ops::LSTMKernel<paddle::platform::CPUDeviceContext, float>,
-    ops::LSTMKernel<paddle::platform::CPUDeviceContext, double>);
+REGISTER_OP_CPU_KERNEL(lstm, ops::LSTMCPUKernel<float>,
+                       ops::LSTMCPUKernel<double>);
 REGISTER_OP_CPU_KERNEL(
     lstm_grad, ops::LSTMGradKernel<paddle::platform::CPUDeviceContext, float>,
     ops::LSTMGradKernel<paddle::platform::CPUDeviceContext, double>);
@@ -14,12 +14,17 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/beam_search.h"
 #include <algorithm>
-#include <map>
+#include <cmath>
+#include <string>
+#include <vector>
 
 namespace paddle {
 namespace operators {
 namespace math {
 
+// The candidates of the sources given to one intra-op thread.
+static constexpr size_t kBeamSearchGrainSize = 32768;
+
 template <typename T>
 class BeamSearchFunctor<platform::CPUDeviceContext, T> {
  public:
@@ -34,25 +39,43 @@ class BeamSearchFunctor<platform::CPUDeviceContext, T> {
                   int end_id, bool is_accumulated) {
     auto abs_lod = framework::ToAbsOffset(scores->lod());
     auto &high_level = abs_lod[level];
+    const size_t num_seqs = high_level.size() - 1;
+    const size_t num_prefixes = high_level.back();
+
+    Workspace &workspace = GetWorkspace();
+    workspace.items.resize(num_seqs * beam_size);
+    workspace.num_items.resize(num_seqs);
 
-    auto items = SelectTopBeamSizeItems(pre_ids, pre_scores, ids, scores, level,
-                                        beam_size, end_id, is_accumulated);
-    auto selected_items = ToMap(items, high_level.back());
+    SelectTopBeamSizeItems(context, pre_ids, pre_scores, ids, scores,
+                           high_level, beam_size, end_id, is_accumulated,
+                           &workspace);
     if (FLAGS_v == 3) {
       VLOG(3) << "selected_items:";
-      for (size_t i = 0; i < selected_items.size(); ++i) {
-        VLOG(3) << "offset: " << i;
-        for (auto &item : selected_items[i]) {
-          VLOG(3) << item.ToString();
+      for (size_t seq_id = 0; seq_id < num_seqs; ++seq_id) {
+        VLOG(3) << "source: " << seq_id;
+        for (size_t i = 0; i < workspace.num_items[seq_id]; ++i) {
+          VLOG(3) << workspace.items[seq_id * beam_size + i].ToString();
         }
       }
     }
 
-    PruneEndBeams(pre_ids, abs_lod, &selected_items, level, end_id);
+    PruneEndBeams(pre_ids, high_level, beam_size, end_id, &workspace);
+
+    // The items of a source are sorted by their offsets, and the sources are
+    // in the order of the offsets, so the items are written out in order.
+    auto &low_level = workspace.low_level;
+    low_level.assign(num_prefixes + 1, 0);
+    for (size_t seq_id = 0; seq_id < num_seqs; ++seq_id) {
+      const Item *items = workspace.items.data() + seq_id * beam_size;
+      for (size_t i = 0; i < workspace.num_items[seq_id]; ++i) {
+        ++low_level[items[i].offset + 1];
+      }
+    }
+    for (size_t offset = 0; offset < num_prefixes; ++offset) {
+      low_level[offset + 1] += low_level[offset];
+    }
     // calculate the output tensor's height
-    size_t num_instances = std::accumulate(
-        std::begin(selected_items), std::end(selected_items), 0,
-        [](size_t a, std::vector<Item> &b) { return a + b.size(); });
+    size_t num_instances = low_level.back();
     // the output tensor shape should be [num_instances, 1]
     auto dims = framework::make_ddim(
         std::vector<int64_t>({static_cast<int>(num_instances), 1}));
@@ -67,20 +90,18 @@ class BeamSearchFunctor<platform::CPUDeviceContext, T> {
             : nullptr;
 
     // fill in data
-    std::vector<size_t> low_level;
     size_t low_offset = 0;
-    for (auto &items : selected_items) {
-      low_level.push_back(low_offset);
-      for (auto &item : items) {
+    for (size_t seq_id = 0; seq_id < num_seqs; ++seq_id) {
+      const Item *items = workspace.items.data() + seq_id * beam_size;
+      for (size_t i = 0; i < workspace.num_items[seq_id]; ++i) {
         if (parent_idx) {
-          parent_idx_data[low_offset] = static_cast<int>(low_level.size() - 1);
+          parent_idx_data[low_offset] = static_cast<int>(items[i].offset);
         }
-        selected_ids_data[low_offset] = item.id;
-        selected_scores_data[low_offset] = item.score;
+        selected_ids_data[low_offset] = items[i].id;
+        selected_scores_data[low_offset] = items[i].score;
         low_offset++;
       }
     }
-    low_level.push_back(low_offset);
 
     // fill lod
     framework::LoD lod(2);
@@ -132,72 +153,62 @@ class BeamSearchFunctor<platform::CPUDeviceContext, T> {
   };
 
  protected:
+  /*
+   * The buffers of a step. They are kept by the calling thread, so the steps
+   * of a decoding reuse them instead of allocating them again.
+   */
+  struct Workspace {
+    // The top beam_size items of each source, items[seq_id * beam_size + i].
+    std::vector<Item> items;
+    // The number of the items of each source.
+    std::vector<size_t> num_items;
+    // The lower lod level of the outputs.
+    std::vector<size_t> low_level;
+  };
+
+  static Workspace &GetWorkspace() {
+    static thread_local Workspace workspace;
+    return workspace;
+  }
+
   /*
    * Prune the source sentences all branchs finished, and it is optional.
    * Pruning must one step later than finishing (thus pre_ids is needed here),
    * since the end tokens must be writed out.
    */
   void PruneEndBeams(const framework::LoDTensor *pre_ids,
-                     const framework::LoD &abs_lod,
-                     std::vector<std::vector<Item>> *items, size_t lod_level,
-                     int end_id) {
+                     const std::vector<size_t> &high_level, size_t beam_size,
+                     int end_id, Workspace *workspace) {
     auto *pre_ids_data = pre_ids->data<int64_t>();
-    auto &high_level = abs_lod[lod_level];
-    for (size_t src_idx = 0; src_idx < high_level.size() - 1; ++src_idx) {
-      size_t src_prefix_start = high_level[src_idx];
-      size_t src_prefix_end = high_level[src_idx + 1];
+    for (size_t seq_id = 0; seq_id + 1 < high_level.size(); ++seq_id) {
+      const Item *items = workspace->items.data() + seq_id * beam_size;
       bool finish_flag = true;
-      for (size_t offset = src_prefix_start; offset < src_prefix_end;
-           offset++) {
-        for (auto &item : items->at(offset)) {
-          if (item.id != static_cast<size_t>(end_id) ||
-              pre_ids_data[offset] != end_id) {
-            finish_flag = false;
-            break;
-          }
+      for (size_t i = 0; i < workspace->num_items[seq_id]; ++i) {
+        if (items[i].id != static_cast<size_t>(end_id) ||
+            pre_ids_data[items[i].offset] != end_id) {
+          finish_flag = false;
+          break;
         }
-        if (!finish_flag) break;
       }
       if (finish_flag) {  // all branchs of the beam (source sentence) end and
                           // prune this beam
-        for (size_t offset = src_prefix_start; offset < src_prefix_end;
-             offset++)
-          items->at(offset).clear();
+        workspace->num_items[seq_id] = 0;
       }
     }
   }
 
-  /*
-   * Transform the items into a map whose key is offset, value is the items.
-   * NOTE low performance.
-   */
-  std::vector<std::vector<Item>> ToMap(
-      const std::vector<std::vector<Item>> &items, size_t element_num) {
-    std::vector<std::vector<Item>> result;
-    result.resize(element_num);
-    for (auto &entries : items) {
-      for (const auto &item : entries) {
-        result[item.offset].push_back(item);
-      }
-    }
-    return result;
-  }
-
-  void Insert(std::vector<Item> *top_beam_ptr, const Item &item,
-              size_t beam_size) {
-    std::vector<Item> &top_beam = *top_beam_ptr;
-
-    size_t num_beams = top_beam.size();
-    if (num_beams < beam_size) {
-      top_beam.resize(num_beams + 1);
-      num_beams++;
+  static void Insert(Item *top_beam, size_t *num_beams, const Item &item,
+                     size_t beam_size) {
+    size_t n = *num_beams;
+    if (n < beam_size) {
+      *num_beams = ++n;
     } else {
       if (item < top_beam[beam_size - 1]) {
         return;
       }
     }
 
-    for (int k = static_cast<int>(num_beams) - 2; k >= 0; --k) {
+    for (int k = static_cast<int>(n) - 2; k >= 0; --k) {
       if (top_beam[k] < item) {
         top_beam[k + 1] = top_beam[k];
       } else {
@@ -209,73 +220,98 @@ class BeamSearchFunctor<platform::CPUDeviceContext, T> {
   }
 
   /*
-   * For each source, select top beam_size records.
+   * For each source, select top beam_size records into the workspace, sorted
+   * by their offsets. The sources are selected in parallel.
    */
-  std::vector<std::vector<Item>> SelectTopBeamSizeItems(
-      const framework::LoDTensor *pre_ids,
-      const framework::LoDTensor *pre_scores, const framework::LoDTensor *ids,
-      const framework::LoDTensor *scores, size_t lod_level, size_t beam_size,
-      int end_id, bool is_accumulated) {
-    std::vector<std::vector<Item>> result;
-
-    // find the current candidates
-    auto abs_lod = framework::ToAbsOffset(scores->lod());
-
+  void SelectTopBeamSizeItems(const platform::CPUDeviceContext &context,
+                              const framework::LoDTensor *pre_ids,
+                              const framework::LoDTensor *pre_scores,
+                              const framework::LoDTensor *ids,
+                              const framework::LoDTensor *scores,
+                              const std::vector<size_t> &high_level,
+                              size_t beam_size, int end_id,
+                              bool is_accumulated, Workspace *workspace) {
     auto *pre_ids_data = pre_ids->data<int64_t>();
     auto *pre_scores_data = pre_scores->data<float>();
 
     auto *ids_data = ids ? ids->data<int64_t>() : nullptr;
     auto *scores_data = scores->data<float>();
 
-    size_t num_seqs = scores->NumElements(lod_level);
+    const size_t num_seqs = high_level.size() - 1;
     size_t seq_width = 1;
     for (int i = 1; i < scores->dims().size(); i++) {
       seq_width *= scores->dims()[i];
     }
-
-    for (size_t seq_id = 0; seq_id < num_seqs; ++seq_id) {
-      size_t seq_offset_start = abs_lod[lod_level][seq_id];
-      size_t seq_offset_end = abs_lod[lod_level][seq_id + 1];
-
-      std::vector<Item> top_beam;
-      top_beam.reserve(beam_size);
-
-      for (size_t offset = seq_offset_start; offset < seq_offset_end;
-           ++offset) {
-        auto pre_id = pre_ids_data[offset];
-        auto pre_score = pre_scores_data[offset];
-        if (pre_id == end_id) {
-          // Allocate all probability mass to end_id for finished branchs and
-          // the other candidate ids can be ignored.
-          Item item(offset, end_id, pre_score);
-          Insert(&top_beam, item, beam_size);
-        } else {
+    const size_t seq_candidates = std::max<size_t>(
+        high_level.back() * seq_width / std::max<size_t>(num_seqs, 1), 1);
+    Item *all_items = workspace->items.data();
+    size_t *all_num_items = workspace->num_items.data();
+
+    auto select = [&](int64_t begin, int64_t end) {
+      for (int64_t seq_id = begin; seq_id < end; ++seq_id) {
+        size_t seq_offset_start = high_level[seq_id];
+        size_t seq_offset_end = high_level[seq_id + 1];
+        Item *top_beam = all_items + seq_id * beam_size;
+        size_t num_beams = 0;
+
+        for (size_t offset = seq_offset_start; offset < seq_offset_end;
+             ++offset) {
+          auto pre_id = pre_ids_data[offset];
+          auto pre_score = pre_scores_data[offset];
+          if (pre_id == end_id) {
+            // Allocate all probability mass to end_id for finished branchs
+            // and the other candidate ids can be ignored.
+            Item item(offset, end_id, pre_score);
+            Insert(top_beam, &num_beams, item, beam_size);
+            continue;
+          }
+          // A later candidate is kept only if its score is not less than
+          // that of the last kept one, since its offset is not less. The
+          // probabilities are compared before their logs are taken, with a
+          // margin for the rounding of the logs.
+          float min_score = 0.f;
+          float min_prob = 0.f;
+          auto update_bound = [&]() {
+            if (num_beams < beam_size) return;
+            min_score = top_beam[beam_size - 1].score;
+            if (!is_accumulated) {
+              min_prob = std::exp(min_score - pre_score) * 0.999f;
+            }
+          };
+          update_bound();
           size_t index = offset * seq_width;
           for (size_t d = 0; d < seq_width; d++, index++) {
+            if (num_beams == beam_size &&
+                (is_accumulated ? scores_data[index] < min_score
+                                : scores_data[index] < min_prob)) {
+              continue;
+            }
             int64_t id = ids_data ? ids_data[index] : static_cast<int64_t>(d);
             float score = is_accumulated
                               ? scores_data[index]
                               : pre_score + std::log(scores_data[index]);
             Item item(offset, id, score);
-            Insert(&top_beam, item, beam_size);
+            Insert(top_beam, &num_beams, item, beam_size);
+            update_bound();
           }
         }
-      }
-
-      result.emplace_back(top_beam);
-    }
 
-    if (FLAGS_v == 3) {
-      VLOG(3) << "SelectTopBeamSizeItems result size " << result.size();
-      for (auto &items : result) {
-        VLOG(3) << "item set:";
-        for (auto &item : items) {
-          VLOG(3) << item.ToString();
+        // Sort the items by their offsets, the items of an offset are kept in
+        // the descending order of the scores.
+        for (size_t i = 1; i < num_beams; ++i) {
+          Item item = top_beam[i];
+          size_t j = i;
+          for (; j > 0 && top_beam[j - 1].offset > item.offset; --j) {
+            top_beam[j] = top_beam[j - 1];
+          }
+          top_beam[j] = item;
         }
+        all_num_items[seq_id] = num_beams;
       }
-    }
-
-    return result;
+    };
+    context.ParallelFor(
+        num_seqs, std::max<size_t>(kBeamSearchGrainSize / seq_candidates, 1),
+        select);
   }
 };
 
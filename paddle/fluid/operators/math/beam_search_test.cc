@@ -14,7 +14,11 @@ limitations under the License. */
 
 #include "paddle/fluid/operators/math/beam_search.h"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <random>
 #include <vector>
+#include "paddle/fluid/platform/timer.h"
 
 void PrepareCPUTensors(paddle::framework::LoDTensor* ids,
                        paddle::framework::LoDTensor* scores,
@@ -134,6 +138,135 @@ TEST(BeamSearch, CPU) {
                  paddle::platform::CPUPlace>();
 }
 
+// Prepares a step of num_seqs sources with beam_size prefixes each, whose
+// scores are the probabilities of a vocabulary of num_ids.
+void PrepareProbTensors(int num_seqs, int beam_size, int num_ids,
+                        std::mt19937* engine,
+                        paddle::framework::LoDTensor* scores,
+                        paddle::framework::LoDTensor* pre_ids,
+                        paddle::framework::LoDTensor* pre_scores) {
+  std::vector<size_t> level0, level1;
+  for (int i = 0; i <= num_seqs; ++i) {
+    level0.push_back(i * beam_size);
+  }
+  for (int i = 0; i <= num_seqs * beam_size; ++i) {
+    level1.push_back(i);
+  }
+  scores->set_lod({level0, level1});
+
+  const int num_prefixes = num_seqs * beam_size;
+  paddle::platform::CPUPlace place;
+  float* scores_data = scores->mutable_data<float>(
+      paddle::framework::make_ddim({num_prefixes, num_ids}), place);
+  // Few distinct values to have equal scores.
+  std::uniform_int_distribution<int> dist(1, 64);
+  for (int i = 0; i < num_prefixes; ++i) {
+    float sum = 0.f;
+    for (int j = 0; j < num_ids; ++j) {
+      scores_data[i * num_ids + j] = dist(*engine);
+      sum += scores_data[i * num_ids + j];
+    }
+    for (int j = 0; j < num_ids; ++j) {
+      scores_data[i * num_ids + j] /= sum;
+    }
+  }
+  int64_t* pre_ids_data = pre_ids->mutable_data<int64_t>(
+      paddle::framework::make_ddim({num_prefixes, 1}), place);
+  float* pre_scores_data = pre_scores->mutable_data<float>(
+      paddle::framework::make_ddim({num_prefixes, 1}), place);
+  for (int i = 0; i < num_prefixes; ++i) {
+    pre_ids_data[i] = 1 + i % 3;
+    pre_scores_data[i] = -0.5f * (i % beam_size);
+  }
+}
+
+TEST(BeamSearch, CPUCompareSort) {
+  paddle::platform::CPUDeviceContext context;
+  std::mt19937 engine(0);
+  const int num_seqs = 6, beam_size = 4, num_ids = 500;
+  paddle::framework::LoDTensor scores, pre_ids, pre_scores;
+  PrepareProbTensors(num_seqs, beam_size, num_ids, &engine, &scores, &pre_ids,
+                     &pre_scores);
+  paddle::framework::LoDTensor selected_ids, selected_scores, parent_idx;
+  paddle::operators::math::BeamSearchFunctor<
+      paddle::platform::CPUDeviceContext, float>
+      beamsearch;
+  beamsearch(context, &pre_ids, &pre_scores, nullptr, &scores, &selected_ids,
+             &selected_scores, &parent_idx, 0, beam_size, 0, false);
+
+  // The top beam_size (score, prefix) of each source by a full sort, the
+  // outputs are grouped by the prefixes.
+  const float* scores_data = scores.data<float>();
+  const float* pre_scores_data = pre_scores.data<float>();
+  std::vector<float> expected_scores;
+  std::vector<int> expected_prefixes;
+  for (int seq = 0; seq < num_seqs; ++seq) {
+    std::vector<std::pair<float, int>> candidates;
+    for (int prefix = seq * beam_size; prefix < (seq + 1) * beam_size;
+         ++prefix) {
+      for (int id = 0; id < num_ids; ++id) {
+        candidates.emplace_back(
+            pre_scores_data[prefix] +
+                std::log(scores_data[prefix * num_ids + id]),
+            prefix);
+      }
+    }
+    // The equal scores prefer the later prefix, as BeamSearchFunctor::Item.
+    std::stable_sort(
+        candidates.begin(), candidates.end(),
+        [](const std::pair<float, int>& a, const std::pair<float, int>& b) {
+          return a.first > b.first ||
+                 (a.first == b.first && a.second > b.second);
+        });
+    candidates.resize(beam_size);
+    std::stable_sort(
+        candidates.begin(), candidates.end(),
+        [](const std::pair<float, int>& a, const std::pair<float, int>& b) {
+          return a.second < b.second;
+        });
+    for (auto& candidate : candidates) {
+      expected_scores.push_back(candidate.first);
+      expected_prefixes.push_back(candidate.second);
+    }
+  }
+  ASSERT_EQ(static_cast<size_t>(selected_scores.numel()),
+            expected_scores.size());
+  for (size_t i = 0; i < expected_scores.size(); ++i) {
+    ASSERT_EQ(selected_scores.data<float>()[i], expected_scores[i]);
+    int prefix = parent_idx.data<int>()[i];
+    ASSERT_EQ(prefix, expected_prefixes[i]);
+    int64_t id = selected_ids.data<int64_t>()[i];
+    float prob = scores_data[prefix * num_ids + id];
+    ASSERT_EQ(pre_scores_data[prefix] + std::log(prob), expected_scores[i]);
+  }
+}
+
+// The timing of 20 steps of a vocabulary of 30000 ids, which is run with
+// --gtest_also_run_disabled_tests.
+TEST(BeamSearch, DISABLED_CPUBenchmark) {
+  paddle::platform::CPUDeviceContext context;
+  std::mt19937 engine(0);
+  const int num_seqs = 32, beam_size = 4, num_ids = 30000;
+  const int steps = 20;
+  paddle::framework::LoDTensor scores, pre_ids, pre_scores;
+  PrepareProbTensors(num_seqs, beam_size, num_ids, &engine, &scores, &pre_ids,
+                     &pre_scores);
+  paddle::framework::LoDTensor selected_ids, selected_scores, parent_idx;
+  paddle::operators::math::BeamSearchFunctor<
+      paddle::platform::CPUDeviceContext, float>
+      beamsearch;
+  paddle::platform::Timer timer;
+  timer.Start();
+  for (int step = 0; step < steps; ++step) {
+    beamsearch(context, &pre_ids, &pre_scores, nullptr, &scores, &selected_ids,
+               &selected_scores, &parent_idx, 0, beam_size, 0, false);
+  }
+  timer.Pause();
+  LOG(INFO) << "beam search of " << num_seqs << " sources, beam size "
+            << beam_size << ", " << num_ids << " ids: "
+            << steps / timer.ElapsedSec() << " steps/s";
+}
+
 #ifdef PADDLE_WITH_CUDA
 TEST(BeamSearch, GPU) {
   TestBeamSearch<paddle::platform::CUDADeviceContext,
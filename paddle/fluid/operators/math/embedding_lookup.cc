@@ -0,0 +1,207 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/embedding_lookup.h"
+#include <algorithm>
+#include <cstring>
+#include "paddle/fluid/platform/cpu_helper.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The rows of the ids this far ahead are prefetched.
+constexpr int64_t kPrefetchDistance = 8;
+constexpr size_t kCacheLineSize = 64;
+// The bytes of the rows copied by a thread at least.
+constexpr int64_t kMinBytesPerThread = 1 << 15;
+
+static inline void PrefetchRow(const void* row, size_t bytes) {
+#ifdef __GNUC__
+  const char* p = static_cast<const char*>(row);
+  for (size_t offset = 0; offset < bytes; offset += kCacheLineSize) {
+    __builtin_prefetch(p + offset);
+  }
+#endif
+}
+
+UniqueIds::UniqueIds(const int64_t* ids, int64_t n) : index_(n) {
+  // An open addressing hash table of the unique ids and their indices, which
+  // is at most half full. The empty slots have the index -1.
+  int bits = 4;
+  while ((int64_t{1} << bits) < 2 * n) ++bits;
+  const uint64_t mask = (uint64_t{1} << bits) - 1;
+  std::vector<int64_t> slot_ids(mask + 1);
+  std::vector<int64_t> slot_indices(mask + 1, -1);
+  for (int64_t i = 0; i < n; ++i) {
+    uint64_t slot =
+        (static_cast<uint64_t>(ids[i]) * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
+    while (slot_indices[slot] >= 0 && slot_ids[slot] != ids[i]) {
+      slot = (slot + 1) & mask;
+    }
+    if (slot_indices[slot] < 0) {
+      slot_ids[slot] = ids[i];
+      slot_indices[slot] = size();
+      values_.push_back(ids[i]);
+    }
+    index_[i] = slot_indices[slot];
+  }
+  // Counting sort of the positions by the indices of their ids.
+  offsets_.assign(size() + 1, 0);
+  for (int64_t i = 0; i < n; ++i) {
+    ++offsets_[index_[i] + 1];
+  }
+  for (int64_t u = 0; u < size(); ++u) {
+    offsets_[u + 1] += offsets_[u];
+  }
+  positions_.resize(n);
+  std::vector<int64_t> next(offsets_.begin(), offsets_.end() - 1);
+  for (int64_t i = 0; i < n; ++i) {
+    positions_[next[index_[i]]++] = i;
+  }
+}
+
+static int64_t GrainOf(int64_t width, size_t size_of_t) {
+  const int64_t row_bytes = std::max<int64_t>(width * size_of_t, 1);
+  return std::max<int64_t>(kMinBytesPerThread / row_bytes, 1);
+}
+
+template <typename T>
+void GatherRows(const platform::CPUDeviceContext& context, const T* table,
+                int64_t width, const int64_t* rows, int64_t n, T* out) {
+  const size_t row_bytes = sizeof(T) * width;
+  context.ParallelFor(
+      n, GrainOf(width, sizeof(T)), [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          if (i + kPrefetchDistance < end && rows[i + kPrefetchDistance] >= 0) {
+            PrefetchRow(table + rows[i + kPrefetchDistance] * width,
+                        row_bytes);
+          }
+          if (rows[i] < 0) {
+            std::memset(out + i * width, 0, row_bytes);
+          } else {
+            std::memcpy(out + i * width, table + rows[i] * width, row_bytes);
+          }
+        }
+      });
+}
+
+// Calls fn(u_begin, u_end) on the ranges of the unique ids for the intra-op
+// threads. The ranges are split by the numbers of the positions, since a few
+// ids of a skewed batch have most of them.
+template <typename Fn>
+static void ParallelForUnique(const platform::CPUDeviceContext& context,
+                              const UniqueIds& ids, int64_t width,
+                              size_t size_of_t, const Fn& fn) {
+  if (ids.size() == 0) return;
+  const int64_t* first = ids.positions_begin(0);
+  const int64_t n = ids.positions_end(ids.size() - 1) - first;
+  const int64_t num_shards =
+      std::min<int64_t>(platform::GetIntraOpNumThreads(),
+                        std::max<int64_t>(n / GrainOf(width, size_of_t), 1));
+  // The first unique id of a shard is the one at its first position.
+  auto unique_at = [&](int64_t shard) {
+    const int64_t pos = n * shard / num_shards;
+    int64_t lo = 0, hi = ids.size();
+    while (lo < hi) {
+      const int64_t mid = lo + (hi - lo) / 2;
+      if (ids.positions_end(mid) - first <= pos) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo;
+  };
+  context.ParallelFor(num_shards, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t shard = begin; shard < end; ++shard) {
+      const int64_t u_begin = unique_at(shard);
+      const int64_t u_end =
+          shard + 1 == num_shards ? ids.size() : unique_at(shard + 1);
+      if (u_begin < u_end) fn(u_begin, u_end);
+    }
+  });
+}
+
+// Sums the rows of value at the positions of each unique id in [u_begin,
+// u_end) into the row dst_of(u), which is skipped if it is nullptr. The first
+// row is copied instead of added if copy_first.
+template <typename T, typename DstFn>
+static void SumRows(const UniqueIds& ids, int64_t u_begin, int64_t u_end,
+                    const T* value, int64_t width, bool copy_first,
+                    const DstFn& dst_of) {
+  const size_t row_bytes = sizeof(T) * width;
+  const int64_t* last = ids.positions_end(u_end - 1);
+  for (int64_t u = u_begin; u < u_end; ++u) {
+    T* dst = dst_of(u);
+    if (dst == nullptr) continue;
+    const int64_t* pos = ids.positions_begin(u);
+    const int64_t* end = ids.positions_end(u);
+    for (bool first_row = true; pos != end; ++pos, first_row = false) {
+      if (last - pos > kPrefetchDistance) {
+        PrefetchRow(value + pos[kPrefetchDistance] * width, row_bytes);
+      }
+      const T* src = value + *pos * width;
+      if (first_row && copy_first) {
+        std::memcpy(dst, src, row_bytes);
+      } else {
+        for (int64_t j = 0; j < width; ++j) {
+          dst[j] += src[j];
+        }
+      }
+    }
+  }
+}
+
+template <typename T>
+void MergeRows(const platform::CPUDeviceContext& context, const UniqueIds& ids,
+               const T* value, int64_t width, T* out) {
+  ParallelForUnique(
+      context, ids, width, sizeof(T), [&](int64_t u_begin, int64_t u_end) {
+        SumRows(ids, u_begin, u_end, value, width, true,
+                [&](int64_t u) { return out + u * width; });
+      });
+}
+
+template <typename T>
+void ScatterAddRows(const platform::CPUDeviceContext& context,
+                    const UniqueIds& ids, const T* value, int64_t width,
+                    int64_t skip_id, T* out) {
+  const auto& values = ids.values();
+  ParallelForUnique(
+      context, ids, width, sizeof(T), [&](int64_t u_begin, int64_t u_end) {
+        SumRows(ids, u_begin, u_end, value, width, false, [&](int64_t u) {
+          return values[u] == skip_id ? nullptr : out + values[u] * width;
+        });
+      });
+}
+
+#define INSTANTIATE_EMBEDDING_LOOKUP(T)                                      \
+  template void GatherRows<T>(const platform::CPUDeviceContext&, const T*,   \
+                              int64_t, const int64_t*, int64_t, T*);         \
+  template void MergeRows<T>(const platform::CPUDeviceContext&,              \
+                             const UniqueIds&, const T*, int64_t, T*);       \
+  template void ScatterAddRows<T>(const platform::CPUDeviceContext&,         \
+                                  const UniqueIds&, const T*, int64_t,       \
+                                  int64_t, T*)
+
+INSTANTIATE_EMBEDDING_LOOKUP(float);
+INSTANTIATE_EMBEDDING_LOOKUP(double);
+INSTANTIATE_EMBEDDING_LOOKUP(int8_t);
+
+#undef INSTANTIATE_EMBEDDING_LOOKUP
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
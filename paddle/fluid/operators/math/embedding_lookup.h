@@ -0,0 +1,76 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <vector>
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The unique values of n ids in the order of their first occurrences, and
+// the positions of the ids equal to each of them.
+class UniqueIds {
+ public:
+  UniqueIds(const int64_t* ids, int64_t n);
+
+  int64_t size() const { return static_cast<int64_t>(values_.size()); }
+  const std::vector<int64_t>& values() const { return values_; }
+  // The index of the i-th id in values().
+  int64_t index(int64_t i) const { return index_[i]; }
+  // The positions of the ids equal to the u-th unique value, ascending.
+  const int64_t* positions_begin(int64_t u) const {
+    return positions_.data() + offsets_[u];
+  }
+  const int64_t* positions_end(int64_t u) const {
+    return positions_.data() + offsets_[u + 1];
+  }
+
+ private:
+  std::vector<int64_t> values_;
+  std::vector<int64_t> index_;
+  std::vector<int64_t> offsets_;
+  std::vector<int64_t> positions_;
+};
+
+// Copies the rows of table (? x width) at rows (n) to out (n x width), and
+// fills the row of a negative index with zeros.
+//
+// The ids of a batch are mostly cache misses in a large table, so the rows of
+// a few ids ahead are prefetched while a row is copied, and the ids are split
+// into ranges for the intra-op threads.
+template <typename T>
+void GatherRows(const platform::CPUDeviceContext& context, const T* table,
+                int64_t width, const int64_t* rows, int64_t n, T* out);
+
+// Writes the sum of the rows of value (n x width) at the positions of the
+// u-th unique id to the row u of out (ids.size() x width). The rows are added
+// in the order of their positions.
+template <typename T>
+void MergeRows(const platform::CPUDeviceContext& context, const UniqueIds& ids,
+               const T* value, int64_t width, T* out);
+
+// Adds the rows of value (n x width) to the rows of out (? x width) at their
+// ids, skipping the ids equal to skip_id. Each row of out is written by one
+// thread.
+template <typename T>
+void ScatterAddRows(const platform::CPUDeviceContext& context,
+                    const UniqueIds& ids, const T* value, int64_t width,
+                    int64_t skip_id, T* out);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
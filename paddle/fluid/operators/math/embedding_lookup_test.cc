@@ -0,0 +1,212 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/embedding_lookup.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <random>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/operators/math/selected_rows_functor.h"
+#include "paddle/fluid/platform/cpu_helper.h"
+#include "paddle/fluid/platform/timer.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// n ids in [0, height) of a Zipfian distribution with the exponent s, where
+// the id k is drawn with a probability in proportion to 1 / (k + 1)^s. The
+// ids are shuffled, so the frequent ones are not the first rows of a table.
+static std::vector<int64_t> ZipfIds(int64_t n, int64_t height, double s,
+                                    std::mt19937* engine) {
+  std::vector<double> cdf(height);
+  double sum = 0;
+  for (int64_t k = 0; k < height; ++k) {
+    sum += 1.0 / std::pow(k + 1, s);
+    cdf[k] = sum;
+  }
+  std::vector<int64_t> shuffled(height);
+  for (int64_t k = 0; k < height; ++k) shuffled[k] = k;
+  std::shuffle(shuffled.begin(), shuffled.end(), *engine);
+  std::uniform_real_distribution<double> dist(0, sum);
+  std::vector<int64_t> ids(n);
+  for (auto& id : ids) {
+    auto k = std::lower_bound(cdf.begin(), cdf.end(), dist(*engine)) -
+             cdf.begin();
+    id = shuffled[std::min<int64_t>(k, height - 1)];
+  }
+  return ids;
+}
+
+static std::vector<float> RandomRows(int64_t rows, int64_t width,
+                                     std::mt19937* engine) {
+  std::uniform_real_distribution<float> dist(-1.f, 1.f);
+  std::vector<float> data(rows * width);
+  for (auto& v : data) v = dist(*engine);
+  return data;
+}
+
+TEST(UniqueIds, positions) {
+  std::vector<int64_t> ids = {5, 3, 5, 0, 3, 5, 7};
+  UniqueIds unique_ids(ids.data(), ids.size());
+  EXPECT_EQ(unique_ids.values(), std::vector<int64_t>({5, 3, 0, 7}));
+  for (size_t i = 0; i < ids.size(); ++i) {
+    EXPECT_EQ(unique_ids.values()[unique_ids.index(i)], ids[i]);
+  }
+  EXPECT_EQ(std::vector<int64_t>(unique_ids.positions_begin(0),
+                                 unique_ids.positions_end(0)),
+            std::vector<int64_t>({0, 2, 5}));
+  EXPECT_EQ(std::vector<int64_t>(unique_ids.positions_begin(1),
+                                 unique_ids.positions_end(1)),
+            std::vector<int64_t>({1, 4}));
+}
+
+static void CheckEmbeddingLookup(int64_t n, int64_t height, int64_t width) {
+  std::mt19937 engine(n);
+  platform::CPUDeviceContext context;
+  auto table = RandomRows(height, width, &engine);
+  auto value = RandomRows(n, width, &engine);
+  auto ids = ZipfIds(n, height, 1.0, &engine);
+  const int64_t padding_id = ids[n / 2];
+
+  std::vector<int64_t> rows(ids);
+  for (auto& row : rows) {
+    if (row == padding_id) row = -1;
+  }
+  std::vector<float> out(n * width);
+  GatherRows(context, table.data(), width, rows.data(), n, out.data());
+  for (int64_t i = 0; i < n; ++i) {
+    for (int64_t j = 0; j < width; ++j) {
+      ASSERT_EQ(out[i * width + j],
+                rows[i] < 0 ? 0.f : table[rows[i] * width + j]);
+    }
+  }
+
+  std::map<int64_t, std::vector<float>> sums;
+  for (int64_t i = 0; i < n; ++i) {
+    auto& sum = sums[ids[i]];
+    sum.resize(width, 0.f);
+    for (int64_t j = 0; j < width; ++j) {
+      sum[j] += value[i * width + j];
+    }
+  }
+  UniqueIds unique_ids(ids.data(), n);
+  ASSERT_EQ(unique_ids.size(), static_cast<int64_t>(sums.size()));
+  std::vector<float> merged(unique_ids.size() * width);
+  MergeRows(context, unique_ids, value.data(), width, merged.data());
+  for (int64_t u = 0; u < unique_ids.size(); ++u) {
+    auto& sum = sums[unique_ids.values()[u]];
+    for (int64_t j = 0; j < width; ++j) {
+      ASSERT_FLOAT_EQ(merged[u * width + j], sum[j]);
+    }
+  }
+
+  std::vector<float> d_table(height * width, 1.f);
+  ScatterAddRows(context, unique_ids, value.data(), width, padding_id,
+                 d_table.data());
+  for (int64_t k = 0; k < height; ++k) {
+    auto it = sums.find(k);
+    for (int64_t j = 0; j < width; ++j) {
+      float expected = 1.f;
+      if (it != sums.end() && k != padding_id) expected += it->second[j];
+      ASSERT_FLOAT_EQ(d_table[k * width + j], expected);
+    }
+  }
+}
+
+TEST(EmbeddingLookup, compare_naive) {
+  CheckEmbeddingLookup(1, 10, 8);
+  CheckEmbeddingLookup(100, 50, 13);
+  CheckEmbeddingLookup(5000, 100000, 32);
+  // The ids are split for the intra-op threads.
+  platform::SetIntraOpNumThreads(4);
+  CheckEmbeddingLookup(100, 50, 13);
+  CheckEmbeddingLookup(20000, 100000, 64);
+  platform::SetIntraOpNumThreads(1);
+}
+
+// Compares the lookup and the sparse gradient of the kernels before, which
+// copy the rows one by one and leave the merging to the optimizer, on the ids
+// of Zipfian distributions. The gap of the prefetching grows with the tables
+// out of the cache. It is run with --gtest_also_run_disabled_tests.
+TEST(EmbeddingLookup, DISABLED_benchmark) {
+  std::mt19937 engine(0);
+  platform::CPUDeviceContext context;
+  const int64_t height = 1 << 16, width = 64, n = 20000;
+  const int repeat = 3;
+  auto table = RandomRows(height, width, &engine);
+  auto value = RandomRows(n, width, &engine);
+  std::vector<float> out(n * width);
+  platform::Timer timer;
+  auto time_ms = [&](const std::function<void()>& fn) {
+    fn();
+    timer.Reset();
+    timer.Start();
+    for (int i = 0; i < repeat; ++i) fn();
+    timer.Pause();
+    return timer.ElapsedMS() / repeat;
+  };
+
+  for (double s : {0.8, 1.1}) {
+    auto ids = ZipfIds(n, height, s, &engine);
+    double copy_ms = time_ms([&] {
+      for (int64_t i = 0; i < n; ++i) {
+        std::memcpy(out.data() + i * width, table.data() + ids[i] * width,
+                    sizeof(float) * width);
+      }
+    });
+    auto gather = [&] {
+      GatherRows(context, table.data(), width, ids.data(), n, out.data());
+    };
+    double gather_ms = time_ms(gather);
+    platform::SetIntraOpNumThreads(4);
+    double gather_4_threads_ms = time_ms(gather);
+    platform::SetIntraOpNumThreads(1);
+
+    double merge_add_ms = time_ms([&] {
+      framework::SelectedRows grad(ids, height);
+      grad.mutable_value()->Resize({n, width});
+      std::memcpy(grad.mutable_value()->mutable_data<float>(context.GetPlace()),
+                  value.data(), sizeof(float) * n * width);
+      framework::SelectedRows merged;
+      scatter::MergeAdd<platform::CPUDeviceContext, float> merge_add;
+      merge_add(context, grad, &merged);
+    });
+    std::vector<float> merged;
+    auto merge = [&] {
+      UniqueIds unique_ids(ids.data(), n);
+      merged.resize(unique_ids.size() * width);
+      MergeRows(context, unique_ids, value.data(), width, merged.data());
+    };
+    double merge_ms = time_ms(merge);
+    platform::SetIntraOpNumThreads(4);
+    double merge_4_threads_ms = time_ms(merge);
+    platform::SetIntraOpNumThreads(1);
+
+    LOG(INFO) << n << " ids of Zipf(" << s << ") in " << height << "x"
+              << width << ", " << merged.size() / width << " unique: copy "
+              << copy_ms << " ms, GatherRows " << gather_ms << " ms, 4 threads "
+              << gather_4_threads_ms << " ms; copy + MergeAdd " << merge_add_ms
+              << " ms, MergeRows " << merge_ms << " ms, 4 threads "
+              << merge_4_threads_ms << " ms";
+  }
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,178 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/int8_gemm.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/cpu_info.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+// The AVX2 kernel is compiled for AVX2 by the target attribute and used only
+// if the CPU supports it, so it does not need the whole build to be AVX2.
+#define PADDLE_INT8_GEMM_AVX2
+#endif
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The multiply-adds of the rows computed by one intra-op thread.
+static constexpr int64_t kInt8GemmGrainOps = 1 << 16;
+
+void QuantizeInt8(const platform::CPUDeviceContext& context, int64_t n,
+                  const float* x, float scale, int8_t* q) {
+  context.ParallelFor(n, 1 << 15, [=](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      float v = std::round(x[i] * scale);
+      v = std::min(std::max(v, static_cast<float>(-kInt8MaxRange)),
+                   static_cast<float>(kInt8MaxRange));
+      q[i] = static_cast<int8_t>(v);
+    }
+  });
+}
+
+// Computes the rows [begin, end) of C, the zeros of A are skipped, e.g. the
+// activations after relu.
+static void Int8GemmRowsRefer(int N, int K, const int8_t* A, const int8_t* B,
+                              int32_t* C, int begin, int end) {
+  for (int i = begin; i < end; ++i) {
+    int32_t* c = C + static_cast<int64_t>(i) * N;
+    std::memset(c, 0, sizeof(int32_t) * N);
+    const int8_t* a = A + static_cast<int64_t>(i) * K;
+    for (int k = 0; k < K; ++k) {
+      int32_t a_k = a[k];
+      if (a_k == 0) continue;
+      const int8_t* b = B + static_cast<int64_t>(k) * N;
+      for (int j = 0; j < N; ++j) {
+        c[j] += a_k * b[j];
+      }
+    }
+  }
+}
+
+#ifdef PADDLE_INT8_GEMM_AVX2
+// VPMADDUBSW multiplies uint8 by int8 but saturates the sum of two products
+// to int16, which overflows for the full int8 range. So the pairs of B rows
+// are interleaved, sign extended to int16 and multiplied with VPMADDWD,
+// which gives the exact int32 sums of a[k] * b[k][j] + a[k+1] * b[k+1][j].
+__attribute__((target("avx2"))) static void Int8GemmRowsAVX2(
+    int N, int K, const int8_t* A, const int8_t* B, int32_t* C, int begin,
+    int end) {
+  const int block = 16;
+  const int n_blocks = N / block * block;
+  for (int i = begin; i < end; ++i) {
+    int32_t* c = C + static_cast<int64_t>(i) * N;
+    std::memset(c, 0, sizeof(int32_t) * N);
+    const int8_t* a = A + static_cast<int64_t>(i) * K;
+    int k = 0;
+    for (; k + 1 < K; k += 2) {
+      if (a[k] == 0 && a[k + 1] == 0) continue;
+      const int8_t* b0 = B + static_cast<int64_t>(k) * N;
+      const int8_t* b1 = b0 + N;
+      uint32_t a_pair = static_cast<uint16_t>(static_cast<int16_t>(a[k])) |
+                        (static_cast<uint32_t>(static_cast<uint16_t>(
+                             static_cast<int16_t>(a[k + 1])))
+                         << 16);
+      __m256i a_vec = _mm256_set1_epi32(static_cast<int32_t>(a_pair));
+      int j = 0;
+      for (; j < n_blocks; j += block) {
+        __m128i row0 =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(b0 + j));
+        __m128i row1 =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(b1 + j));
+        __m256i lo = _mm256_cvtepi8_epi16(_mm_unpacklo_epi8(row0, row1));
+        __m256i hi = _mm256_cvtepi8_epi16(_mm_unpackhi_epi8(row0, row1));
+        __m256i* c_lo = reinterpret_cast<__m256i*>(c + j);
+        __m256i* c_hi = reinterpret_cast<__m256i*>(c + j + 8);
+        _mm256_storeu_si256(
+            c_lo, _mm256_add_epi32(_mm256_loadu_si256(c_lo),
+                                   _mm256_madd_epi16(lo, a_vec)));
+        _mm256_storeu_si256(
+            c_hi, _mm256_add_epi32(_mm256_loadu_si256(c_hi),
+                                   _mm256_madd_epi16(hi, a_vec)));
+      }
+      for (; j < N; ++j) {
+        c[j] += a[k] * b0[j] + a[k + 1] * b1[j];
+      }
+    }
+    if (k < K && a[k] != 0) {
+      const int8_t* b = B + static_cast<int64_t>(k) * N;
+      for (int j = 0; j < N; ++j) {
+        c[j] += a[k] * b[j];
+      }
+    }
+  }
+}
+#endif
+
+void Int8Gemm(const platform::CPUDeviceContext& context, int M, int N, int K,
+              const int8_t* A, const int8_t* B, int32_t* C) {
+  auto gemm_rows = Int8GemmRowsRefer;
+#ifdef PADDLE_INT8_GEMM_AVX2
+  static const bool use_avx2 = platform::MayIUse(platform::avx2);
+  if (use_avx2) {
+    gemm_rows = Int8GemmRowsAVX2;
+  }
+#endif
+  int64_t row_ops = std::max<int64_t>(static_cast<int64_t>(N) * K, 1);
+  context.ParallelFor(M, std::max<int64_t>(kInt8GemmGrainOps / row_ops, 1),
+                      [=](int64_t begin, int64_t end) {
+                        gemm_rows(N, K, A, B, C, static_cast<int>(begin),
+                                  static_cast<int>(end));
+                      });
+}
+
+void Int8FCFunctor<platform::CPUDeviceContext, float>::operator()(
+    const platform::CPUDeviceContext& context, const int M, const int N,
+    const int K, const float* X, float scale_x, const int8_t* W,
+    const std::vector<float>& scale_w, float* Y, const float* B, bool relu) {
+  PADDLE_ENFORCE_EQ(
+      scale_w.size() == 1UL || scale_w.size() == static_cast<size_t>(N), true,
+      platform::errors::InvalidArgument(
+          "The number of the weight scales should be 1 or %d, but got %d.", N,
+          scale_w.size()));
+  framework::Tensor x_int8;
+  framework::Tensor y_int32;
+  int8_t* x_data = x_int8.mutable_data<int8_t>(framework::make_ddim({M, K}),
+                                               platform::CPUPlace());
+  int32_t* y_data = y_int32.mutable_data<int32_t>(
+      framework::make_ddim({M, N}), platform::CPUPlace());
+  QuantizeInt8(context, static_cast<int64_t>(M) * K, X, scale_x, x_data);
+  Int8Gemm(context, M, N, K, x_data, W, y_data);
+
+  std::vector<float> dequant_scale(N);
+  for (int j = 0; j < N; ++j) {
+    dequant_scale[j] = 1.f / (scale_x * scale_w[scale_w.size() > 1 ? j : 0]);
+  }
+  const float* dequant = dequant_scale.data();
+  int64_t grain = std::max<int64_t>(kInt8GemmGrainOps / std::max(N, 1), 1);
+  context.ParallelFor(M, grain, [=](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; ++i) {
+      const int32_t* src = y_data + i * N;
+      float* dst = Y + i * N;
+      for (int j = 0; j < N; ++j) {
+        float v = src[j] * dequant[j];
+        if (B) v += B[j];
+        dst[j] = relu && v < 0.f ? 0.f : v;
+      }
+    }
+  });
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
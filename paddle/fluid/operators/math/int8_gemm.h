@@ -0,0 +1,64 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include <vector>
+#include "paddle/fluid/platform/device_context.h"
+#include "paddle/fluid/platform/enforce.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The native int8 kernels quantize a float x by q = round(x * scale),
+// saturated to [-127, 127], the same as the int8 kernels of MKL-DNN.
+constexpr int kInt8MaxRange = 127;
+
+// Quantizes the n values of x into q.
+void QuantizeInt8(const platform::CPUDeviceContext& context, int64_t n,
+                  const float* x, float scale, int8_t* q);
+
+// Computes C = A * B of the row-major int8 A (M x K) and B (K x N) with the
+// int32 accumulation. It uses AVX2 if the CPU supports it.
+void Int8Gemm(const platform::CPUDeviceContext& context, int M, int N, int K,
+              const int8_t* A, const int8_t* B, int32_t* C);
+
+// The same as FCFunctor with the int8 weights: X is quantized by scale_x and
+// the column j of the product is dequantized by 1 / (scale_x * scale_w[j]),
+// or by scale_w[0] for all the columns if scale_w has one value.
+template <typename DeviceContext, typename T>
+class Int8FCFunctor {
+ public:
+  void operator()(const DeviceContext& context, const int M, const int N,
+                  const int K, const T* X, float scale_x, const int8_t* W,
+                  const std::vector<float>& scale_w, T* Y,
+                  const T* B = nullptr, bool relu = false) {
+    PADDLE_THROW(platform::errors::Unimplemented(
+        "The int8 weights are only supported by the float CPU kernels."));
+  }
+};
+
+template <>
+class Int8FCFunctor<platform::CPUDeviceContext, float> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context, const int M,
+                  const int N, const int K, const float* X, float scale_x,
+                  const int8_t* W, const std::vector<float>& scale_w, float* Y,
+                  const float* B = nullptr, bool relu = false);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
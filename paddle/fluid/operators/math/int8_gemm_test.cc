@@ -0,0 +1,123 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/int8_gemm.h"
+#include <cmath>
+#include <random>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/operators/math/fc.h"
+#include "paddle/fluid/platform/timer.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+template <typename T>
+static std::vector<T> RandomVector(size_t n, int low, int high,
+                                   std::mt19937* engine) {
+  std::uniform_int_distribution<int> dist(low, high);
+  std::vector<T> vec(n);
+  for (auto& v : vec) {
+    v = static_cast<T>(dist(*engine));
+  }
+  return vec;
+}
+
+TEST(Int8Gemm, full_range) {
+  platform::CPUDeviceContext context;
+  std::mt19937 engine(0);
+  // The odd K and the N not a multiple of 16 test the tails of the kernel.
+  for (int M : {1, 3, 8}) {
+    for (int N : {1, 15, 16, 35}) {
+      for (int K : {1, 2, 17, 64}) {
+        auto A = RandomVector<int8_t>(M * K, -127, 127, &engine);
+        auto B = RandomVector<int8_t>(K * N, -127, 127, &engine);
+        std::vector<int32_t> C(M * N);
+        Int8Gemm(context, M, N, K, A.data(), B.data(), C.data());
+        for (int i = 0; i < M; ++i) {
+          for (int j = 0; j < N; ++j) {
+            int32_t sum = 0;
+            for (int k = 0; k < K; ++k) {
+              sum += A[i * K + k] * B[k * N + j];
+            }
+            ASSERT_EQ(C[i * N + j], sum) << M << " " << N << " " << K;
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(Int8FCFunctor, compare_fp32) {
+  platform::CPUDeviceContext context;
+  std::mt19937 engine(0);
+  const int M = 64, N = 512, K = 512;
+  auto X = RandomVector<float>(M * K, -100, 100, &engine);
+  for (auto& x : X) {
+    x /= 100.f;
+  }
+  // The weights are quantized per column with the scales 127 / abs_max.
+  auto W_int8 = RandomVector<int8_t>(K * N, -127, 127, &engine);
+  std::vector<float> scale_w(N);
+  std::vector<float> W(K * N);
+  for (int j = 0; j < N; ++j) {
+    scale_w[j] = kInt8MaxRange / (0.5f + j % 7);
+  }
+  for (int k = 0; k < K; ++k) {
+    for (int j = 0; j < N; ++j) {
+      W[k * N + j] = W_int8[k * N + j] / scale_w[j];
+    }
+  }
+  auto bias = RandomVector<float>(N, -5, 5, &engine);
+  const float scale_x = kInt8MaxRange / 1.f;
+
+  std::vector<float> out_fp32(M * N);
+  std::vector<float> out_int8(M * N);
+  FCFunctor<platform::CPUDeviceContext, float> fc;
+  Int8FCFunctor<platform::CPUDeviceContext, float> int8_fc;
+  fc(context, M, N, K, X.data(), W.data(), out_fp32.data(), bias.data(), true);
+  int8_fc(context, M, N, K, X.data(), scale_x, W_int8.data(), scale_w,
+          out_int8.data(), bias.data(), true);
+  for (int i = 0; i < M * N; ++i) {
+    ASSERT_GE(out_int8[i], 0.f);
+    // The error of quantizing X is at most 0.5 / scale_x for each item.
+    float tolerance = 0.5f / scale_x * K * (0.5f + 6) + 1e-3f;
+    ASSERT_NEAR(out_int8[i], out_fp32[i], tolerance);
+  }
+
+  const int repeat = 20;
+  platform::Timer timer;
+  timer.Start();
+  for (int i = 0; i < repeat; ++i) {
+    fc(context, M, N, K, X.data(), W.data(), out_fp32.data(), bias.data(),
+       true);
+  }
+  timer.Pause();
+  double fp32_ms = timer.ElapsedMS() / repeat;
+  timer.Reset();
+  timer.Start();
+  for (int i = 0; i < repeat; ++i) {
+    int8_fc(context, M, N, K, X.data(), scale_x, W_int8.data(), scale_w,
+            out_int8.data(), bias.data(), true);
+  }
+  timer.Pause();
+  double int8_ms = timer.ElapsedMS() / repeat;
+  LOG(INFO) << "fc of " << M << "x" << K << "x" << N << ": fp32 " << fp32_ms
+            << " ms, int8 " << int8_ms << " ms";
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
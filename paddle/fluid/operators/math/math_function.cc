@@ -22,6 +22,7 @@ limitations under the License. */
 #include <cblas.h>
 #endif
 
+#include <algorithm>
 #include <vector>
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/operators/math/math_function_impl.h"
@@ -33,6 +34,50 @@ namespace math {
 
 using float16 = paddle::platform::float16;
 
+// The elements of a chunk filled or transposed by one intra-op thread.
+static constexpr int64_t kCPUGrainSize = 32768;
+
+template <typename T>
+void SetConstant<platform::CPUDeviceContext, T>::operator()(
+    const platform::CPUDeviceContext& context, framework::Tensor* tensor,
+    T num) {
+  T* data = tensor->data<T>();
+  context.ParallelFor(tensor->numel(), kCPUGrainSize,
+                      [data, num](int64_t begin, int64_t end) {
+                        std::fill(data + begin, data + end, num);
+                      });
+}
+
+template <typename T, int Rank>
+void Transpose<platform::CPUDeviceContext, T, Rank>::operator()(
+    const platform::CPUDeviceContext& context, const framework::Tensor& in,
+    framework::Tensor* out, const std::vector<int>& axis) {
+  Eigen::array<int, Rank> permute;
+  for (int i = 0; i < Rank; i++) {
+    permute[i] = axis[i];
+  }
+  auto eigen_in = framework::EigenTensor<T, Rank>::From(in);
+  auto eigen_out = framework::EigenTensor<T, Rank>::From(*out);
+  auto* dev = context.eigen_device();
+  // Each thread gives the rows [begin, end) of the first dimension of out.
+  int64_t rows = out->dims()[0];
+  int64_t row_size = rows > 0 ? out->numel() / rows : 0;
+  int64_t grain =
+      std::max<int64_t>(kCPUGrainSize / std::max<int64_t>(row_size, 1), 1);
+  context.ParallelFor(rows, grain, [&](int64_t begin, int64_t end) {
+    Eigen::DSizes<int64_t, Rank> offsets;
+    Eigen::DSizes<int64_t, Rank> extents;
+    for (int i = 0; i < Rank; ++i) {
+      offsets[i] = 0;
+      extents[i] = eigen_out.dimension(i);
+    }
+    offsets[0] = begin;
+    extents[0] = end - begin;
+    eigen_out.slice(offsets, extents).device(*dev) =
+        eigen_in.shuffle(permute).slice(offsets, extents);
+  });
+}
+
 template struct SetConstant<platform::CPUDeviceContext, platform::float16>;
 template struct SetConstant<platform::CPUDeviceContext, float>;
 template struct SetConstant<platform::CPUDeviceContext, double>;
@@ -38,6 +38,21 @@ struct SetConstant {
                   T num);
 };
 
+// The CPU versions split the large tensors by the intra-op threads of the
+// context, see CPUDeviceContext::ParallelFor.
+template <typename T, int Rank>
+struct Transpose<platform::CPUDeviceContext, T, Rank> {
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor& in, framework::Tensor* out,
+                  const std::vector<int>& axis);
+};
+
+template <typename T>
+struct SetConstant<platform::CPUDeviceContext, T> {
+  void operator()(const platform::CPUDeviceContext& context,
+                  framework::Tensor* tensor, T num);
+};
+
 template <typename Place>
 void set_constant_with_place(const platform::DeviceContext& context,
                              framework::Tensor* tensor, float value);
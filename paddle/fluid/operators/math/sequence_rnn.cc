@@ -0,0 +1,290 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/sequence_rnn.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <vector>
+#include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/platform/cpu_helper.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The sequences stepped together by one thread. They are ordered by their
+// lengths in descending order, so the ones running at a step are a prefix.
+class SequenceGroup {
+ public:
+  SequenceGroup(const framework::Vector<size_t>& lod, bool is_reverse)
+      : lod_(lod), is_reverse_(is_reverse) {}
+
+  void Add(int64_t seq) { seqs_.push_back(seq); }
+
+  int64_t size() const { return seqs_.size(); }
+  int64_t seq(int64_t i) const { return seqs_[i]; }
+  int64_t length(int64_t i) const {
+    return lod_[seqs_[i] + 1] - lod_[seqs_[i]];
+  }
+  // The number of the sequences running at the step, which decreases.
+  int64_t Running(int64_t step, int64_t running) const {
+    while (running > 0 && length(running - 1) <= step) --running;
+    return running;
+  }
+  // The row of the step of the i-th sequence in the LoDTensor.
+  int64_t Row(int64_t i, int64_t step) const {
+    return is_reverse_ ? lod_[seqs_[i] + 1] - 1 - step : lod_[seqs_[i]] + step;
+  }
+
+ private:
+  const framework::Vector<size_t>& lod_;
+  const bool is_reverse_;
+  std::vector<int64_t> seqs_;
+};
+
+// Splits the sequences into at most num_groups groups. The sorted sequences
+// are dealt to the groups in turn, so that the groups take about the same
+// time.
+static std::vector<SequenceGroup> SplitSequences(
+    const framework::Vector<size_t>& lod, bool is_reverse,
+    int64_t num_groups) {
+  const int64_t num_seqs = static_cast<int64_t>(lod.size()) - 1;
+  std::vector<int64_t> order(num_seqs);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) {
+    return lod[a + 1] - lod[a] > lod[b + 1] - lod[b];
+  });
+  num_groups = std::max<int64_t>(std::min(num_groups, num_seqs), 1);
+  std::vector<SequenceGroup> groups(num_groups,
+                                    SequenceGroup(lod, is_reverse));
+  for (int64_t i = 0; i < num_seqs; ++i) {
+    groups[i % num_groups].Add(order[i]);
+  }
+  return groups;
+}
+
+// Copies the gates of a step of the running sequences to the packed rows of
+// step_gates and adds the bias.
+template <typename T>
+static void PackStepGates(const SequenceGroup& group, int64_t step,
+                          int64_t running, const T* gates, const T* bias,
+                          int width, T* step_gates) {
+  for (int64_t i = 0; i < running; ++i) {
+    const T* src = gates + group.Row(i, step) * width;
+    T* dst = step_gates + i * width;
+    if (bias) {
+      for (int j = 0; j < width; ++j) {
+        dst[j] = src[j] + bias[j];
+      }
+    } else {
+      std::memcpy(dst, src, sizeof(T) * width);
+    }
+  }
+}
+
+template <typename T>
+void SequenceLSTM(const platform::CPUDeviceContext& context,
+                  const framework::LoDTensor& gates,
+                  const framework::Tensor& weight, const T* bias, const T* h0,
+                  const T* c0, const bool is_reverse,
+                  const jit::lstm_attr_t& attr, framework::LoDTensor* hidden,
+                  framework::LoDTensor* cell) {
+  const int d = attr.d;
+  const int d4 = d * 4;
+  const int64_t total_t = gates.dims()[0];
+  const auto& lod = gates.lod()[0];
+  const T* gates_data = gates.data<T>();
+  const T* weight_data = weight.data<T>();
+  T* hidden_data =
+      hidden->mutable_data<T>({total_t, d}, context.GetPlace());
+  T* cell_data = cell->mutable_data<T>({total_t, d}, context.GetPlace());
+  const T* wp_data = attr.use_peephole ? bias + d4 : nullptr;
+
+  // The jit kernels are got by the calling thread since their cache is
+  // thread local.
+  auto compute_c1h1 =
+      jit::KernelFuncs<jit::LSTMC1H1Tuple<T>, platform::CPUPlace>::Cache().At(
+          attr);
+  auto compute_ctht =
+      jit::KernelFuncs<jit::LSTMCtHtTuple<T>, platform::CPUPlace>::Cache().At(
+          attr);
+  auto groups = SplitSequences(lod, is_reverse,
+                               platform::GetIntraOpNumThreads());
+
+  context.ParallelFor(groups.size(), 1, [&](int64_t begin, int64_t end) {
+    auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+    for (int64_t g = begin; g < end; ++g) {
+      const SequenceGroup& group = groups[g];
+      const int64_t size = group.size();
+      std::vector<T> step_gates(size * d4);
+      std::vector<T> prev_hidden(size * d, static_cast<T>(0));
+      std::vector<T> prev_cell(size * d, static_cast<T>(0));
+      std::vector<T> checked(attr.use_peephole ? 2 * d : 0);
+      for (int64_t i = 0; i < size; ++i) {
+        if (h0) {
+          std::memcpy(&prev_hidden[i * d], h0 + group.seq(i) * d,
+                      sizeof(T) * d);
+        }
+        if (c0) {
+          std::memcpy(&prev_cell[i * d], c0 + group.seq(i) * d,
+                      sizeof(T) * d);
+        }
+      }
+
+      jit::lstm_t one_step;
+      one_step.wp = wp_data;
+      one_step.checked = checked.data();
+      int64_t running = size;
+      const int64_t max_len = size > 0 ? group.length(0) : 0;
+      for (int64_t step = 0; step < max_len; ++step) {
+        running = group.Running(step, running);
+        PackStepGates(group, step, running, gates_data, bias, d4,
+                      step_gates.data());
+        // The recurrent projection is skipped for a zero H0.
+        if (step > 0 || h0) {
+          blas.GEMM(CblasNoTrans, CblasNoTrans, running, d4, d,
+                    static_cast<T>(1), prev_hidden.data(), d, weight_data, d4,
+                    static_cast<T>(1), step_gates.data(), d4);
+        }
+        for (int64_t i = 0; i < running; ++i) {
+          const int64_t row = group.Row(i, step);
+          one_step.gates = &step_gates[i * d4];
+          one_step.ct_1 = &prev_cell[i * d];
+          one_step.ct = cell_data + row * d;
+          one_step.ht = hidden_data + row * d;
+          if (step == 0 && !c0) {
+            compute_c1h1(&one_step, &attr);
+          } else {
+            compute_ctht(&one_step, &attr);
+          }
+          std::memcpy(&prev_hidden[i * d], hidden_data + row * d,
+                      sizeof(T) * d);
+          std::memcpy(&prev_cell[i * d], cell_data + row * d, sizeof(T) * d);
+        }
+      }
+    }
+  });
+}
+
+template <typename T>
+void SequenceGRU(const platform::CPUDeviceContext& context,
+                 const framework::LoDTensor& gates,
+                 const framework::Tensor& weight, const T* bias, const T* h0,
+                 const bool is_reverse, const jit::gru_attr_t& attr,
+                 framework::LoDTensor* hidden) {
+  const int d = attr.d;
+  const int d2 = d * 2;
+  const int d3 = d * 3;
+  const int64_t total_t = gates.dims()[0];
+  const auto& lod = gates.lod()[0];
+  const T* gates_data = gates.data<T>();
+  // W: {W_update, W_reset; W_state}
+  const T* weight_data = weight.data<T>();
+  const T* state_weight_data = weight_data + d * d2;
+  T* hidden_data =
+      hidden->mutable_data<T>({total_t, d}, context.GetPlace());
+
+  auto compute_h1 =
+      jit::KernelFuncs<jit::GRUH1Tuple<T>, platform::CPUPlace>::Cache().At(
+          attr);
+  auto compute_ht_part1 =
+      jit::KernelFuncs<jit::GRUHtPart1Tuple<T>, platform::CPUPlace>::Cache()
+          .At(attr);
+  auto compute_ht_part2 =
+      jit::KernelFuncs<jit::GRUHtPart2Tuple<T>, platform::CPUPlace>::Cache()
+          .At(attr);
+  auto groups = SplitSequences(lod, is_reverse,
+                               platform::GetIntraOpNumThreads());
+
+  context.ParallelFor(groups.size(), 1, [&](int64_t begin, int64_t end) {
+    auto blas = GetBlas<platform::CPUDeviceContext, T>(context);
+    for (int64_t g = begin; g < end; ++g) {
+      const SequenceGroup& group = groups[g];
+      const int64_t size = group.size();
+      std::vector<T> step_gates(size * d3);
+      std::vector<T> prev_hidden(size * d, static_cast<T>(0));
+      std::vector<T> reset_hidden(size * d);
+      if (h0) {
+        for (int64_t i = 0; i < size; ++i) {
+          std::memcpy(&prev_hidden[i * d], h0 + group.seq(i) * d,
+                      sizeof(T) * d);
+        }
+      }
+
+      jit::gru_t one_step;
+      int64_t running = size;
+      const int64_t max_len = size > 0 ? group.length(0) : 0;
+      for (int64_t step = 0; step < max_len; ++step) {
+        running = group.Running(step, running);
+        PackStepGates(group, step, running, gates_data, bias, d3,
+                      step_gates.data());
+        if (step == 0 && !h0) {
+          for (int64_t i = 0; i < running; ++i) {
+            const int64_t row = group.Row(i, step);
+            one_step.gates = &step_gates[i * d3];
+            one_step.ht = hidden_data + row * d;
+            compute_h1(&one_step, &attr);
+            std::memcpy(&prev_hidden[i * d], hidden_data + row * d,
+                        sizeof(T) * d);
+          }
+          continue;
+        }
+        // gemm prev * (Wu + Wr)
+        blas.GEMM(CblasNoTrans, CblasNoTrans, running, d2, d,
+                  static_cast<T>(1), prev_hidden.data(), d, weight_data, d2,
+                  static_cast<T>(1), step_gates.data(), d3);
+        for (int64_t i = 0; i < running; ++i) {
+          one_step.gates = &step_gates[i * d3];
+          one_step.ht_1 = &prev_hidden[i * d];
+          one_step.ht = &reset_hidden[i * d];
+          compute_ht_part1(&one_step, &attr);
+        }
+        // gemm rt * Ws
+        blas.GEMM(CblasNoTrans, CblasNoTrans, running, d, d,
+                  static_cast<T>(1), reset_hidden.data(), d, state_weight_data,
+                  d, static_cast<T>(1), step_gates.data() + d2, d3);
+        for (int64_t i = 0; i < running; ++i) {
+          const int64_t row = group.Row(i, step);
+          one_step.gates = &step_gates[i * d3];
+          one_step.ht_1 = &prev_hidden[i * d];
+          one_step.ht = hidden_data + row * d;
+          compute_ht_part2(&one_step, &attr);
+          std::memcpy(&prev_hidden[i * d], hidden_data + row * d,
+                      sizeof(T) * d);
+        }
+      }
+    }
+  });
+}
+
+#define INSTANTIATE_SEQUENCE_RNN(T)                                           \
+  template void SequenceLSTM<T>(                                              \
+      const platform::CPUDeviceContext&, const framework::LoDTensor&,         \
+      const framework::Tensor&, const T*, const T*, const T*, const bool,     \
+      const jit::lstm_attr_t&, framework::LoDTensor*, framework::LoDTensor*); \
+  template void SequenceGRU<T>(                                               \
+      const platform::CPUDeviceContext&, const framework::LoDTensor&,         \
+      const framework::Tensor&, const T*, const T*, const bool,               \
+      const jit::gru_attr_t&, framework::LoDTensor*)
+
+INSTANTIATE_SEQUENCE_RNN(float);
+INSTANTIATE_SEQUENCE_RNN(double);
+
+#undef INSTANTIATE_SEQUENCE_RNN
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
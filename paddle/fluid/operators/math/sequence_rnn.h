@@ -0,0 +1,55 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include "paddle/fluid/framework/lod_tensor.h"
+#include "paddle/fluid/operators/jit/kernel_base.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The forward LSTM of each sequence of gates (T x 4D), the input projections
+// {x_c, x_i, x_f, x_o} in the layout of the lstm op. weight is D x 4D, and
+// bias has the 4D gate biases followed by the 3D peephole weights if
+// attr.use_peephole, or is nullptr. h0 and c0 (N x D) are optional. hidden
+// and cell (T x D) are written in the order of gates, without reordering
+// them into batches.
+//
+// The sequences are split into groups for the intra-op threads. The states
+// of a group are packed, and one GEMM per step computes the recurrent
+// projections of the sequences of the group still running at the step.
+template <typename T>
+void SequenceLSTM(const platform::CPUDeviceContext& context,
+                  const framework::LoDTensor& gates,
+                  const framework::Tensor& weight, const T* bias, const T* h0,
+                  const T* c0, const bool is_reverse,
+                  const jit::lstm_attr_t& attr, framework::LoDTensor* hidden,
+                  framework::LoDTensor* cell);
+
+// The forward GRU of each sequence of gates (T x 3D), the input projections
+// {x_u, x_r, x_c} in the layout of the gru op with origin_mode false. weight
+// is D x 3D, the D x 2D weights of the update and reset gates followed by the
+// D x D weights of the candidate. bias (3D) and h0 (N x D) are optional.
+template <typename T>
+void SequenceGRU(const platform::CPUDeviceContext& context,
+                 const framework::LoDTensor& gates,
+                 const framework::Tensor& weight, const T* bias, const T* h0,
+                 const bool is_reverse, const jit::gru_attr_t& attr,
+                 framework::LoDTensor* hidden);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,235 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/softmax_cross_entropy.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "paddle/fluid/operators/jit/kernels.h"
+#include "paddle/fluid/operators/math/softmax.h"
+#include "paddle/fluid/operators/math/softmax_impl.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// A row is processed in the blocks of kBlockSize classes, so that a block is
+// still in the cache when the second pass normalizes it.
+static constexpr int kBlockSize = 1024;
+// The same threshold of the shifted logits as ValueClip of SoftmaxFunctor.
+static constexpr int kClipThreshold = 64;
+
+// The jit kernels of a block of n classes. They are got by the calling thread
+// since the cache of the jit kernels is thread local.
+template <typename T>
+struct SoftmaxBlockKernels {
+  explicit SoftmaxBlockKernels(int n)
+      : hmax(jit::KernelFuncs<jit::HMaxTuple<T>, platform::CPUPlace>::Cache()
+                 .At(n)),
+        hsum(jit::KernelFuncs<jit::HSumTuple<T>, platform::CPUPlace>::Cache()
+                 .At(n)),
+        add_bias(jit::KernelFuncs<jit::VAddBiasTuple<T>,
+                                  platform::CPUPlace>::Cache()
+                     .At(n)),
+        scal(jit::KernelFuncs<jit::VScalTuple<T>, platform::CPUPlace>::Cache()
+                 .At(n)),
+        exp(jit::KernelFuncs<jit::VExpTuple<T>, platform::CPUPlace>::Cache()
+                .At(n)) {}
+
+  typename jit::HMaxTuple<T>::func_type hmax;
+  typename jit::HSumTuple<T>::func_type hsum;
+  typename jit::VAddBiasTuple<T>::func_type add_bias;
+  typename jit::VScalTuple<T>::func_type scal;
+  typename jit::VExpTuple<T>::func_type exp;
+};
+
+// Computes y = softmax(x) of a row of d classes and returns the log of the
+// normalizer, log(sum(e^(x - max))), in log_sum and max(x) in max.
+//
+// The first pass writes e^(x - m_b) of each block with its own maximum m_b
+// and keeps the running sum of them rescaled to the running maximum, so x is
+// read only once. The second pass rescales each block by e^(m_b - max) / sum.
+template <typename T>
+static void OnlineSoftmaxRow(const SoftmaxBlockKernels<T>& block,
+                             const SoftmaxBlockKernels<T>& tail, const T* x,
+                             T* y, int d, T* block_max, T* max, T* log_sum) {
+  T row_max = -std::numeric_limits<T>::infinity();
+  T sum = static_cast<T>(0);
+  int num_blocks = (d + kBlockSize - 1) / kBlockSize;
+  for (int b = 0; b < num_blocks; ++b) {
+    int offset = b * kBlockSize;
+    int n = std::min(kBlockSize, d - offset);
+    const SoftmaxBlockKernels<T>& kernels = n == kBlockSize ? block : tail;
+    T m;
+    kernels.hmax(x + offset, &m, n);
+    T bias = -m;
+    kernels.add_bias(&bias, x + offset, y + offset, n);
+    kernels.exp(y + offset, y + offset, n);
+    T block_sum;
+    kernels.hsum(y + offset, &block_sum, n);
+    if (m > row_max) {
+      sum = sum * std::exp(row_max - m) + block_sum;
+      row_max = m;
+    } else {
+      sum += block_sum * std::exp(m - row_max);
+    }
+    block_max[b] = m;
+  }
+
+  const T min_value = std::exp(static_cast<T>(-kClipThreshold)) / sum;
+  for (int b = 0; b < num_blocks; ++b) {
+    int offset = b * kBlockSize;
+    int n = std::min(kBlockSize, d - offset);
+    const SoftmaxBlockKernels<T>& kernels = n == kBlockSize ? block : tail;
+    T scale = std::exp(block_max[b] - row_max) / sum;
+    kernels.scal(&scale, y + offset, y + offset, n);
+    T* y_block = y + offset;
+    for (int i = 0; i < n; ++i) {
+      y_block[i] = y_block[i] < min_value ? min_value : y_block[i];
+    }
+  }
+  *max = row_max;
+  *log_sum = std::log(sum);
+}
+
+template <typename T>
+class SoftmaxWithCrossEntropyFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor* logits,
+                  const framework::Tensor* labels, const bool soft_label,
+                  const int ignore_index, framework::Tensor* softmax,
+                  framework::Tensor* loss) {
+    const int batch_size = logits->dims()[0];
+    const int num_classes = logits->dims()[1];
+    const T* logits_data = logits->data<T>();
+    T* softmax_data = softmax->data<T>();
+    T* loss_data = loss->data<T>();
+    const T* soft_label_data = soft_label ? labels->data<T>() : nullptr;
+    const int64_t* label_data =
+        soft_label ? nullptr : labels->data<int64_t>();
+
+    SoftmaxBlockKernels<T> block(kBlockSize);
+    SoftmaxBlockKernels<T> tail(std::max(num_classes % kBlockSize, 1));
+    const int num_blocks = (num_classes + kBlockSize - 1) / kBlockSize;
+    const T threshold = static_cast<T>(kClipThreshold);
+    const int64_t grain = SoftmaxRowGrain(num_classes);
+
+    context.ParallelFor(batch_size, grain, [&](int64_t begin, int64_t end) {
+      std::vector<T> block_max(num_blocks);
+      for (int64_t i = begin; i < end; ++i) {
+        const T* x = logits_data + i * num_classes;
+        T* y = softmax_data + i * num_classes;
+        T max, log_sum;
+        OnlineSoftmaxRow<T>(block, tail, x, y, num_classes,
+                            block_max.data(), &max, &log_sum);
+        // -log(softmax) = log_sum + min(max - x, threshold)
+        if (soft_label) {
+          const T* lbl = soft_label_data + i * num_classes;
+          T lbl_sum = static_cast<T>(0);
+          T dot = static_cast<T>(0);
+          for (int j = 0; j < num_classes; ++j) {
+            lbl_sum += lbl[j];
+            dot += lbl[j] * std::min(max - x[j], threshold);
+          }
+          loss_data[i] = lbl_sum * log_sum + dot;
+        } else {
+          int64_t lbl = label_data[i];
+          if (lbl == ignore_index) {
+            loss_data[i] = static_cast<T>(0);
+            continue;
+          }
+          PADDLE_ENFORCE_GE(lbl, 0,
+                            platform::errors::OutOfRange(
+                                "label value should >= 0 when label "
+                                "value(%ld) not equal to ignore_index(%d)",
+                                lbl, ignore_index));
+          PADDLE_ENFORCE_LT(
+              lbl, num_classes,
+              platform::errors::OutOfRange(
+                  "label value should less than the number of classes "
+                  "when label value(%ld) not equal to ignore_index(%d), "
+                  "but the number of classes is %d",
+                  lbl, ignore_index, num_classes));
+          loss_data[i] = log_sum + std::min(max - x[lbl], threshold);
+        }
+      }
+    });
+  }
+};
+
+template <typename T>
+class SoftmaxWithCrossEntropyGradFunctor<platform::CPUDeviceContext, T> {
+ public:
+  void operator()(const platform::CPUDeviceContext& context,
+                  const framework::Tensor* softmax,
+                  const framework::Tensor* labels,
+                  const framework::Tensor* loss_grad, const bool soft_label,
+                  const int ignore_index, framework::Tensor* logits_grad) {
+    const int batch_size = softmax->dims()[0];
+    const int num_classes = softmax->dims()[1];
+    const T* softmax_data = softmax->data<T>();
+    const T* loss_grad_data = loss_grad->data<T>();
+    T* logits_grad_data = logits_grad->data<T>();
+
+    auto scal =
+        jit::KernelFuncs<jit::VScalTuple<T>, platform::CPUPlace>::Cache().At(
+            num_classes);
+    auto sub = jit::KernelFuncs<jit::VSubTuple<T>, platform::CPUPlace>::Cache()
+                   .At(num_classes);
+    const int64_t grain = SoftmaxRowGrain(num_classes);
+
+    if (soft_label) {
+      // logits_grad = loss_grad * (softmax - label)
+      const T* label_data = labels->data<T>();
+      context.ParallelFor(batch_size, grain, [=](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          T* dx = logits_grad_data + i * num_classes;
+          sub(softmax_data + i * num_classes, label_data + i * num_classes,
+              dx, num_classes);
+          scal(loss_grad_data + i, dx, dx, num_classes);
+        }
+      });
+    } else {
+      // logits_grad = loss_grad * (softmax - onehot(label)), the rows of
+      // ignore_index keep loss_grad * softmax as the CUDA kernel does.
+      const int64_t* label_data = labels->data<int64_t>();
+      context.ParallelFor(batch_size, grain, [=](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          T* dx = logits_grad_data + i * num_classes;
+          scal(loss_grad_data + i, softmax_data + i * num_classes, dx,
+               num_classes);
+          int64_t lbl = label_data[i];
+          if (lbl != ignore_index && lbl >= 0 && lbl < num_classes) {
+            dx[lbl] -= loss_grad_data[i];
+          }
+        }
+      });
+    }
+  }
+};
+
+template class SoftmaxWithCrossEntropyFunctor<platform::CPUDeviceContext,
+                                              float>;
+template class SoftmaxWithCrossEntropyFunctor<platform::CPUDeviceContext,
+                                              double>;
+template class SoftmaxWithCrossEntropyGradFunctor<platform::CPUDeviceContext,
+                                                  float>;
+template class SoftmaxWithCrossEntropyGradFunctor<platform::CPUDeviceContext,
+                                                  double>;
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
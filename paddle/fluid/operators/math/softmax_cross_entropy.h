@@ -0,0 +1,51 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+#include "paddle/fluid/framework/tensor.h"
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// Computes the softmax of each row of logits (N x D) and the cross entropy
+// loss (N x 1) of it in one kernel, the same as SoftmaxFunctor followed by
+// CrossEntropyFunctor along the last axis. The labels are N x 1 int64 class
+// indices, or N x D probabilities if soft_label is true.
+template <typename DeviceContext, typename T>
+class SoftmaxWithCrossEntropyFunctor {
+ public:
+  void operator()(const DeviceContext& context,
+                  const framework::Tensor* logits,
+                  const framework::Tensor* labels, const bool soft_label,
+                  const int ignore_index, framework::Tensor* softmax,
+                  framework::Tensor* loss);
+};
+
+// Computes the gradient of logits (N x D) from the softmax of them and the
+// gradient of the loss (N x 1). logits_grad may share the data of softmax.
+template <typename DeviceContext, typename T>
+class SoftmaxWithCrossEntropyGradFunctor {
+ public:
+  void operator()(const DeviceContext& context,
+                  const framework::Tensor* softmax,
+                  const framework::Tensor* labels,
+                  const framework::Tensor* loss_grad, const bool soft_label,
+                  const int ignore_index, framework::Tensor* logits_grad);
+};
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
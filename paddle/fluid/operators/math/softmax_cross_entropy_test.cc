@@ -0,0 +1,178 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/softmax_cross_entropy.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "gtest/gtest.h"
+#include "paddle/fluid/operators/math/cross_entropy.h"
+#include "paddle/fluid/operators/math/softmax.h"
+#include "paddle/fluid/platform/timer.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+using framework::Tensor;
+
+static void RandomLogits(int batch_size, int num_classes,
+                         std::mt19937* engine, Tensor* logits) {
+  std::uniform_real_distribution<float> dist(-20.f, 20.f);
+  float* data = logits->mutable_data<float>({batch_size, num_classes},
+                                            platform::CPUPlace());
+  for (int64_t i = 0; i < logits->numel(); ++i) {
+    data[i] = dist(*engine);
+  }
+}
+
+// Checks the fused kernel against SoftmaxFunctor and CrossEntropyFunctor.
+static void CompareUnfused(int batch_size, int num_classes, bool soft_label) {
+  platform::CPUDeviceContext context;
+  std::mt19937 engine(num_classes);
+  const int ignore_index = -100;
+  Tensor logits, labels;
+  RandomLogits(batch_size, num_classes, &engine, &logits);
+  if (soft_label) {
+    float* data = labels.mutable_data<float>({batch_size, num_classes},
+                                             platform::CPUPlace());
+    std::uniform_real_distribution<float> dist(0.f, 1.f);
+    for (int i = 0; i < batch_size; ++i) {
+      float sum = 0.f;
+      for (int j = 0; j < num_classes; ++j) {
+        data[i * num_classes + j] = dist(engine);
+        sum += data[i * num_classes + j];
+      }
+      for (int j = 0; j < num_classes; ++j) {
+        data[i * num_classes + j] /= sum;
+      }
+    }
+  } else {
+    int64_t* data =
+        labels.mutable_data<int64_t>({batch_size, 1}, platform::CPUPlace());
+    std::uniform_int_distribution<int64_t> dist(0, num_classes - 1);
+    for (int i = 0; i < batch_size; ++i) {
+      data[i] = i == 1 ? ignore_index : dist(engine);
+    }
+  }
+
+  Tensor softmax, loss, ref_softmax, ref_loss;
+  softmax.mutable_data<float>({batch_size, num_classes}, platform::CPUPlace());
+  loss.mutable_data<float>({batch_size, 1}, platform::CPUPlace());
+  ref_softmax.mutable_data<float>({batch_size, num_classes},
+                                  platform::CPUPlace());
+  ref_loss.mutable_data<float>({batch_size, 1}, platform::CPUPlace());
+
+  SoftmaxWithCrossEntropyFunctor<platform::CPUDeviceContext, float>()(
+      context, &logits, &labels, soft_label, ignore_index, &softmax, &loss);
+  SoftmaxFunctor<platform::CPUDeviceContext, float, false>()(
+      context, num_classes, &logits, &ref_softmax);
+  CrossEntropyFunctor<platform::CPUDeviceContext, float>()(
+      context, &ref_loss, &ref_softmax, &labels, soft_label, ignore_index,
+      num_classes);
+
+  for (int64_t i = 0; i < softmax.numel(); ++i) {
+    ASSERT_NEAR(softmax.data<float>()[i], ref_softmax.data<float>()[i], 1e-6f);
+  }
+  for (int i = 0; i < batch_size; ++i) {
+    float expected = ref_loss.data<float>()[i];
+    ASSERT_NEAR(loss.data<float>()[i], expected,
+                1e-4f * std::max(1.f, std::abs(expected)));
+  }
+
+  // The gradient of the loss is softmax - label scaled by loss_grad.
+  Tensor loss_grad, logits_grad;
+  float* loss_grad_data =
+      loss_grad.mutable_data<float>({batch_size, 1}, platform::CPUPlace());
+  for (int i = 0; i < batch_size; ++i) {
+    loss_grad_data[i] = 0.5f + i;
+  }
+  logits_grad.mutable_data<float>({batch_size, num_classes},
+                                  platform::CPUPlace());
+  SoftmaxWithCrossEntropyGradFunctor<platform::CPUDeviceContext, float>()(
+      context, &softmax, &labels, &loss_grad, soft_label, ignore_index,
+      &logits_grad);
+  for (int i = 0; i < batch_size; ++i) {
+    for (int j = 0; j < num_classes; ++j) {
+      int idx = i * num_classes + j;
+      float label = 0.f;
+      if (soft_label) {
+        label = labels.data<float>()[idx];
+      } else if (labels.data<int64_t>()[i] == j) {
+        label = 1.f;
+      }
+      float expected = loss_grad_data[i] * (softmax.data<float>()[idx] - label);
+      ASSERT_NEAR(logits_grad.data<float>()[idx], expected, 1e-5f);
+    }
+  }
+}
+
+TEST(SoftmaxWithCrossEntropyFunctor, hard_label) {
+  for (int num_classes : {1, 10, 1024, 1500, 10000}) {
+    CompareUnfused(4, num_classes, false);
+  }
+}
+
+TEST(SoftmaxWithCrossEntropyFunctor, soft_label) {
+  for (int num_classes : {1, 10, 1024, 1500, 10000}) {
+    CompareUnfused(4, num_classes, true);
+  }
+}
+
+// The timings of the fused and the unfused functors up to 500k classes, which
+// are run with --gtest_also_run_disabled_tests.
+TEST(SoftmaxWithCrossEntropyFunctor, DISABLED_benchmark) {
+  platform::CPUDeviceContext context;
+  std::mt19937 engine(0);
+  const int batch_size = 8;
+  const int repeat = 5;
+  for (int num_classes : {10000, 100000, 500000}) {
+    Tensor logits, labels, softmax, loss;
+    RandomLogits(batch_size, num_classes, &engine, &logits);
+    int64_t* label_data =
+        labels.mutable_data<int64_t>({batch_size, 1}, platform::CPUPlace());
+    for (int i = 0; i < batch_size; ++i) {
+      label_data[i] = i * (num_classes / batch_size);
+    }
+    softmax.mutable_data<float>({batch_size, num_classes},
+                                platform::CPUPlace());
+    loss.mutable_data<float>({batch_size, 1}, platform::CPUPlace());
+
+    platform::Timer timer;
+    timer.Start();
+    for (int i = 0; i < repeat; ++i) {
+      SoftmaxFunctor<platform::CPUDeviceContext, float, false>()(
+          context, num_classes, &logits, &softmax);
+      CrossEntropyFunctor<platform::CPUDeviceContext, float>()(
+          context, &loss, &softmax, &labels, false, -100, num_classes);
+    }
+    timer.Pause();
+    double unfused_ms = timer.ElapsedMS() / repeat;
+    timer.Reset();
+    timer.Start();
+    for (int i = 0; i < repeat; ++i) {
+      SoftmaxWithCrossEntropyFunctor<platform::CPUDeviceContext, float>()(
+          context, &logits, &labels, false, -100, &softmax, &loss);
+    }
+    timer.Pause();
+    double fused_ms = timer.ElapsedMS() / repeat;
+    LOG(INFO) << "softmax_with_cross_entropy of " << batch_size << "x"
+              << num_classes << ": unfused " << unfused_ms << " ms, fused "
+              << fused_ms << " ms";
+  }
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #pragma once
+#include <algorithm>
 #include <vector>
 #include "paddle/fluid/framework/eigen.h"
 #include "paddle/fluid/framework/tensor.h"
@@ -36,6 +37,15 @@ struct ValueClip {
   }
 };
 
+// The rows of a softmax are independent, so the CPU functors give each
+// intra-op thread about kSoftmaxGrainSize elements of whole rows.
+static constexpr int64_t kSoftmaxGrainSize = 32768;
+
+inline int64_t SoftmaxRowGrain(int64_t num_classes) {
+  return std::max<int64_t>(
+      kSoftmaxGrainSize / std::max<int64_t>(num_classes, 1), 1);
+}
+
 template <typename DeviceContext, typename T, bool is_test>
 void SoftmaxEigen(const DeviceContext& context, const int axis_dim,
                   const framework::Tensor* X, framework::Tensor* Y) {
@@ -118,24 +128,32 @@ class SoftmaxFunctor<DeviceContext, T, is_test, enable_if_CPU<DeviceContext>> {
     const int num_remain = num_classes / axis_dim;
 
     if (num_remain == 1 && platform::MayIUse(platform::avx)) {
-      const T* in_data = X->data<T>();
-      T* out_data = Y->data<T>();
-      for (int bs = 0; bs < batch_size; ++bs) {
-        T max_val = *std::max_element(in_data, in_data + num_classes);
-        max_val *= static_cast<T>(-1);
-        vec_add_bias<T, platform::avx>(num_classes, max_val, in_data, out_data);
-        vec_clip<T, platform::avx>(num_classes, static_cast<T>(-64), out_data,
-                                   out_data);
-        vec_exp<T>(num_classes, out_data, out_data);
-
-        T sum = 0;
-        vec_sum<T, platform::avx>(num_classes, out_data, &sum);
-        sum = static_cast<T>(1) / sum;
-        vec_scal<T, platform::avx>(num_classes, sum, out_data, out_data);
-
-        in_data += num_classes;
-        out_data += num_classes;
-      }
+      const T* x = X->data<T>();
+      T* y = Y->data<T>();
+      context.ParallelFor(
+          batch_size, SoftmaxRowGrain(num_classes),
+          [=](int64_t begin, int64_t end) {
+            const T* in_data = x + begin * num_classes;
+            T* out_data = y + begin * num_classes;
+            for (int64_t bs = begin; bs < end; ++bs) {
+              T max_val = *std::max_element(in_data, in_data + num_classes);
+              max_val *= static_cast<T>(-1);
+              vec_add_bias<T, platform::avx>(num_classes, max_val, in_data,
+                                             out_data);
+              vec_clip<T, platform::avx>(num_classes, static_cast<T>(-64),
+                                         out_data, out_data);
+              vec_exp<T>(num_classes, out_data, out_data);
+
+              T sum = 0;
+              vec_sum<T, platform::avx>(num_classes, out_data, &sum);
+              sum = static_cast<T>(1) / sum;
+              vec_scal<T, platform::avx>(num_classes, sum, out_data,
+                                         out_data);
+
+              in_data += num_classes;
+              out_data += num_classes;
+            }
+          });
     } else {
       SoftmaxEigen<DeviceContext, T, is_test>(context, axis_dim, X, Y);
     }
@@ -152,12 +170,19 @@ class SoftmaxFunctor<DeviceContext, float, true, enable_if_CPU<DeviceContext>> {
     float* out_data = Y->data<float>();
     const int kBatchDim = 0;
     const int kClassDim = 1;
+    const int num_classes = in_dims[kClassDim];
+    const int num_remain = num_classes / axis_dim;
     // 2D data. Batch x C
     auto compute_softmax =
         jit::KernelFuncs<jit::SoftmaxTuple<float>, platform::CPUPlace>::Cache()
-            .At(in_dims[kClassDim]);
-    compute_softmax(in_data, out_data, in_dims[kClassDim], in_dims[kBatchDim],
-                    in_dims[kClassDim] / axis_dim);
+            .At(num_classes);
+    context.ParallelFor(in_dims[kBatchDim], SoftmaxRowGrain(num_classes),
+                        [=](int64_t begin, int64_t end) {
+                          compute_softmax(in_data + begin * num_classes,
+                                          out_data + begin * num_classes,
+                                          num_classes, end - begin,
+                                          num_remain);
+                        });
   }
 };
 
@@ -213,20 +238,29 @@ class SoftmaxGradFunctor<DeviceContext, T, enable_if_CPU<DeviceContext>> {
     const int num_remain = num_classes / axis_dim;
 
     if (num_remain == 1 && platform::MayIUse(platform::avx)) {
-      const T* out_data = y->data<T>();
-      const T* out_grad = y_grad->data<T>();
-      T* in_grad = x_grad->data<T>();
-      for (int bs = 0; bs < batch_size; ++bs) {
-        T scalar;
-        vec_mul_reduce<T, platform::avx>(num_classes, out_grad, out_data,
-                                         &scalar);
-        scalar *= static_cast<T>(-1);
-        vec_add_bias<T, platform::avx>(num_classes, scalar, out_grad, in_grad);
-        vec_mul<T, platform::avx>(num_classes, out_data, in_grad, in_grad);
-        out_data += num_classes;
-        out_grad += num_classes;
-        in_grad += num_classes;
-      }
+      const T* y_data = y->data<T>();
+      const T* y_grad_data = y_grad->data<T>();
+      T* x_grad_data = x_grad->data<T>();
+      context.ParallelFor(
+          batch_size, SoftmaxRowGrain(num_classes),
+          [=](int64_t begin, int64_t end) {
+            const T* out_data = y_data + begin * num_classes;
+            const T* out_grad = y_grad_data + begin * num_classes;
+            T* in_grad = x_grad_data + begin * num_classes;
+            for (int64_t bs = begin; bs < end; ++bs) {
+              T scalar;
+              vec_mul_reduce<T, platform::avx>(num_classes, out_grad,
+                                               out_data, &scalar);
+              scalar *= static_cast<T>(-1);
+              vec_add_bias<T, platform::avx>(num_classes, scalar, out_grad,
+                                             in_grad);
+              vec_mul<T, platform::avx>(num_classes, out_data, in_grad,
+                                        in_grad);
+              out_data += num_classes;
+              out_grad += num_classes;
+              in_grad += num_classes;
+            }
+          });
     } else {
       SoftmaxGradEigen<DeviceContext, T>(context, axis_dim, y, y_grad, x_grad);
     }
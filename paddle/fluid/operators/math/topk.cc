@@ -0,0 +1,239 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/topk.h"
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "paddle/fluid/platform/cpu_helper.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The elements of the rows given to one intra-op thread.
+static constexpr int64_t kTopkGrainSize = 32768;
+// The values compared with the threshold before any of them is looked at,
+// the loop over a block is vectorized by the compiler.
+static constexpr int kTopkFilterBlock = 16;
+// Up to kSmallTopk values are kept in a sorted array instead of a heap.
+static constexpr int kSmallTopk = 16;
+// The least columns of a chunk when a row is split across threads.
+static constexpr int64_t kTopkMinChunkCols = 1 << 14;
+
+template <typename T>
+using TopkItem = std::pair<T, int64_t>;
+
+// Whether a goes before b in the top-k: the larger value, or the smaller
+// index of the equal values.
+template <typename T>
+struct TopkBefore {
+  bool operator()(const TopkItem<T>& a, const TopkItem<T>& b) const {
+    return a.first > b.first || (a.first == b.first && a.second < b.second);
+  }
+};
+
+template <typename T>
+struct TopkAfter {
+  bool operator()(const TopkItem<T>& a, const TopkItem<T>& b) const {
+    return a.first < b.first || (a.first == b.first && a.second < b.second);
+  }
+};
+
+static inline int64_t TopkRowGrain(int64_t cols) {
+  return std::max<int64_t>(kTopkGrainSize / std::max<int64_t>(cols, 1), 1);
+}
+
+// Calls keep(j) for each j in [begin, end) with x[j] > *threshold. keep may
+// raise the threshold. A block of the values is tested at once, since most
+// of them are below the threshold for a long row.
+template <typename T, typename Keep>
+static inline void ScanAbove(const T* x, int64_t begin, int64_t end,
+                             const T* threshold, Keep keep) {
+  int64_t j = begin;
+  for (; j + kTopkFilterBlock <= end; j += kTopkFilterBlock) {
+    const T thr = *threshold;
+    bool above = false;
+    for (int t = 0; t < kTopkFilterBlock; ++t) {
+      above |= x[j + t] > thr;
+    }
+    if (!above) continue;
+    for (int t = 0; t < kTopkFilterBlock; ++t) {
+      if (x[j + t] > *threshold) keep(j + t);
+    }
+  }
+  for (; j < end; ++j) {
+    if (x[j] > *threshold) keep(j);
+  }
+}
+
+// Selects the top k of x[begin, end) into out in order, and returns the
+// number of them, which is less than k only if the range is shorter.
+template <typename T>
+static int64_t SelectTopk(const T* x, int64_t begin, int64_t end, int k,
+                          TopkItem<T>* out) {
+  const int64_t n = std::min<int64_t>(k, end - begin);
+  if (n <= 0) return 0;
+  if (k == 1) {
+    int64_t arg = begin;
+    T max = x[begin];
+    ScanAbove(x, begin + 1, end, &max, [&](int64_t j) {
+      arg = j;
+      max = x[j];
+    });
+    out[0] = TopkItem<T>(max, arg);
+    return 1;
+  }
+
+  for (int64_t j = 0; j < n; ++j) {
+    out[j] = TopkItem<T>(x[begin + j], begin + j);
+  }
+  if (n < k) {
+    std::sort(out, out + n, TopkBefore<T>());
+    return n;
+  }
+
+  // A later value equal to the threshold goes after all the kept ones, so
+  // only the larger values are kept.
+  if (k <= kSmallTopk) {
+    std::sort(out, out + k, TopkBefore<T>());
+    T threshold = out[k - 1].first;
+    ScanAbove(x, begin + k, end, &threshold, [&](int64_t j) {
+      int p = k - 1;
+      while (p > 0 && x[j] > out[p - 1].first) {
+        out[p] = out[p - 1];
+        --p;
+      }
+      out[p] = TopkItem<T>(x[j], j);
+      threshold = out[k - 1].first;
+    });
+  } else {
+    // The heap keeps the last of the top k at its root.
+    std::make_heap(out, out + k, TopkBefore<T>());
+    T threshold = out[0].first;
+    ScanAbove(x, begin + k, end, &threshold, [&](int64_t j) {
+      std::pop_heap(out, out + k, TopkBefore<T>());
+      out[k - 1] = TopkItem<T>(x[j], j);
+      std::push_heap(out, out + k, TopkBefore<T>());
+      threshold = out[0].first;
+    });
+    std::sort_heap(out, out + k, TopkBefore<T>());
+  }
+  return k;
+}
+
+template <typename T>
+void TopkRows(const platform::CPUDeviceContext& context, const T* x,
+              int64_t rows, int64_t cols, int k, T* values, int64_t* indices) {
+  PADDLE_ENFORCE_LE(k, cols, platform::errors::InvalidArgument(
+                                 "k(%d) of top_k should not be larger than "
+                                 "the size(%ld) of the last dimension.",
+                                 k, cols));
+  if (rows <= 0 || k <= 0) return;
+
+  // Each of a few long rows is split into chunks, the top k of the chunks
+  // are merged afterwards.
+  int64_t chunks = 1;
+  const int64_t threads = platform::GetIntraOpNumThreads();
+  if (rows < threads && cols >= 2 * kTopkMinChunkCols) {
+    chunks = std::min<int64_t>((threads + rows - 1) / rows,
+                               cols / kTopkMinChunkCols);
+  }
+
+  if (chunks <= 1) {
+    context.ParallelFor(rows, TopkRowGrain(cols), [&](int64_t begin,
+                                                      int64_t end) {
+      std::vector<TopkItem<T>> top(k);
+      for (int64_t i = begin; i < end; ++i) {
+        SelectTopk(x + i * cols, 0, cols, k, top.data());
+        for (int j = 0; j < k; ++j) {
+          values[i * k + j] = top[j].first;
+          indices[i * k + j] = top[j].second;
+        }
+      }
+    });
+    return;
+  }
+
+  const int64_t chunk_cols = (cols + chunks - 1) / chunks;
+  std::vector<TopkItem<T>> candidates(rows * chunks * k);
+  std::vector<int64_t> counts(rows * chunks);
+  context.ParallelFor(rows * chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t t = begin; t < end; ++t) {
+      const int64_t i = t / chunks;
+      const int64_t col_begin = (t % chunks) * chunk_cols;
+      const int64_t col_end = std::min(cols, col_begin + chunk_cols);
+      counts[t] = SelectTopk(x + i * cols, col_begin, col_end, k,
+                             candidates.data() + t * k);
+    }
+  });
+  context.ParallelFor(rows, 1, [&](int64_t begin, int64_t end) {
+    std::vector<TopkItem<T>> merged;
+    merged.reserve(chunks * k);
+    for (int64_t i = begin; i < end; ++i) {
+      merged.clear();
+      for (int64_t c = 0; c < chunks; ++c) {
+        const TopkItem<T>* top = candidates.data() + (i * chunks + c) * k;
+        merged.insert(merged.end(), top, top + counts[i * chunks + c]);
+      }
+      std::partial_sort(merged.begin(), merged.begin() + k, merged.end(),
+                        TopkBefore<T>());
+      for (int j = 0; j < k; ++j) {
+        values[i * k + j] = merged[j].first;
+        indices[i * k + j] = merged[j].second;
+      }
+    }
+  });
+}
+
+template <typename T>
+void ArgsortRows(const platform::CPUDeviceContext& context, const T* x,
+                 int64_t rows, int64_t cols, bool descending, T* values,
+                 int64_t* indices) {
+  context.ParallelFor(rows, TopkRowGrain(cols), [&](int64_t begin,
+                                                    int64_t end) {
+    std::vector<TopkItem<T>> row(cols);
+    for (int64_t i = begin; i < end; ++i) {
+      for (int64_t j = 0; j < cols; ++j) {
+        row[j] = TopkItem<T>(x[i * cols + j], j);
+      }
+      if (descending) {
+        std::sort(row.begin(), row.end(), TopkBefore<T>());
+      } else {
+        std::sort(row.begin(), row.end(), TopkAfter<T>());
+      }
+      for (int64_t j = 0; j < cols; ++j) {
+        values[i * cols + j] = row[j].first;
+        indices[i * cols + j] = row[j].second;
+      }
+    }
+  });
+}
+
+#define INSTANTIATE_TOPK(T)                                                   \
+  template void TopkRows<T>(const platform::CPUDeviceContext&, const T*,      \
+                            int64_t, int64_t, int, T*, int64_t*);             \
+  template void ArgsortRows<T>(const platform::CPUDeviceContext&, const T*,   \
+                               int64_t, int64_t, bool, T*, int64_t*)
+
+INSTANTIATE_TOPK(float);
+INSTANTIATE_TOPK(double);
+INSTANTIATE_TOPK(int);
+INSTANTIATE_TOPK(int64_t);
+
+#undef INSTANTIATE_TOPK
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
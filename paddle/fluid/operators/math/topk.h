@@ -0,0 +1,45 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#pragma once
+
+#include "paddle/fluid/platform/device_context.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// Writes the k largest values of each row of x (rows x cols) to values
+// (rows x k) in descending order, and their column indices to indices. The
+// equal values are ordered by their indices. k should not be larger than
+// cols.
+//
+// A row is scanned once against the smallest value kept so far, so most of
+// the values of a long row are skipped by a comparison. A few long rows are
+// also split into chunks for the intra-op threads.
+template <typename T>
+void TopkRows(const platform::CPUDeviceContext& context, const T* x,
+              int64_t rows, int64_t cols, int k, T* values, int64_t* indices);
+
+// Sorts each row of x (rows x cols) and writes the sorted values to values
+// and their column indices to indices. The equal values are ordered by their
+// indices.
+template <typename T>
+void ArgsortRows(const platform::CPUDeviceContext& context, const T* x,
+                 int64_t rows, int64_t cols, bool descending, T* values,
+                 int64_t* indices);
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,174 @@
+/* Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License. */
+
+#include "paddle/fluid/operators/math/topk.h"
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+#include "gtest/gtest.h"
+#include "paddle/fluid/platform/cpu_helper.h"
+#include "paddle/fluid/platform/timer.h"
+
+namespace paddle {
+namespace operators {
+namespace math {
+
+// The top k by a stable sort of the whole row, as the expected result.
+static void SortTopk(const std::vector<float>& x, int64_t rows, int64_t cols,
+                     int k, std::vector<float>* values,
+                     std::vector<int64_t>* indices) {
+  values->resize(rows * k);
+  indices->resize(rows * k);
+  std::vector<std::pair<float, int64_t>> row(cols);
+  for (int64_t i = 0; i < rows; ++i) {
+    for (int64_t j = 0; j < cols; ++j) {
+      row[j] = std::make_pair(x[i * cols + j], j);
+    }
+    std::stable_sort(row.begin(), row.end(),
+                     [](const std::pair<float, int64_t>& a,
+                        const std::pair<float, int64_t>& b) {
+                       return a.first > b.first;
+                     });
+    for (int j = 0; j < k; ++j) {
+      (*values)[i * k + j] = row[j].first;
+      (*indices)[i * k + j] = row[j].second;
+    }
+  }
+}
+
+static std::vector<float> RandomRows(int64_t rows, int64_t cols, int range,
+                                     std::mt19937* engine) {
+  // A small range gives many equal values.
+  std::uniform_int_distribution<int> dist(-range, range);
+  std::vector<float> x(rows * cols);
+  for (auto& v : x) {
+    v = static_cast<float>(dist(*engine)) / 4;
+  }
+  return x;
+}
+
+static void CheckTopk(int64_t rows, int64_t cols, int k, int range) {
+  platform::CPUDeviceContext context;
+  std::mt19937 engine(cols + k);
+  auto x = RandomRows(rows, cols, range, &engine);
+  std::vector<float> values(rows * k), expected_values;
+  std::vector<int64_t> indices(rows * k), expected_indices;
+  TopkRows<float>(context, x.data(), rows, cols, k, values.data(),
+                  indices.data());
+  SortTopk(x, rows, cols, k, &expected_values, &expected_indices);
+  EXPECT_EQ(values, expected_values);
+  EXPECT_EQ(indices, expected_indices);
+}
+
+TEST(TopkRows, compare_sort) {
+  for (int k : {1, 2, 5, 16, 17, 100}) {
+    CheckTopk(7, 1000, k, 1000000);
+    CheckTopk(7, 1000, k, 8);
+    CheckTopk(3, k, k, 8);
+  }
+}
+
+TEST(TopkRows, split_rows) {
+  // A few long rows are split into chunks for the intra-op threads.
+  platform::SetIntraOpNumThreads(4);
+  for (int k : {1, 10, 50}) {
+    CheckTopk(1, 100000, k, 1000000);
+    CheckTopk(2, 100000, k, 16);
+  }
+  platform::SetIntraOpNumThreads(1);
+}
+
+TEST(ArgsortRows, compare_sort) {
+  platform::CPUDeviceContext context;
+  std::mt19937 engine(0);
+  const int64_t rows = 5, cols = 999;
+  auto x = RandomRows(rows, cols, 8, &engine);
+  std::vector<float> values(rows * cols), expected_values;
+  std::vector<int64_t> indices(rows * cols), expected_indices;
+  ArgsortRows<float>(context, x.data(), rows, cols, true, values.data(),
+                     indices.data());
+  SortTopk(x, rows, cols, cols, &expected_values, &expected_indices);
+  EXPECT_EQ(values, expected_values);
+  EXPECT_EQ(indices, expected_indices);
+
+  ArgsortRows<float>(context, x.data(), rows, cols, false, values.data(),
+                     indices.data());
+  for (int64_t i = 0; i < rows; ++i) {
+    for (int64_t j = 0; j < cols; ++j) {
+      int64_t idx = i * cols + j;
+      EXPECT_EQ(values[idx], x[i * cols + indices[idx]]);
+      if (j > 0) {
+        ASSERT_LE(values[idx - 1], values[idx]);
+        if (values[idx - 1] == values[idx]) {
+          ASSERT_LT(indices[idx - 1], indices[idx]);
+        }
+      }
+    }
+  }
+}
+
+// The timings of the threshold scan and the sort, which are run with
+// --gtest_also_run_disabled_tests.
+TEST(TopkRows, DISABLED_benchmark) {
+  platform::CPUDeviceContext context;
+  std::mt19937 engine(0);
+  const int64_t rows = 16;
+  const int repeat = 5;
+  for (int64_t cols : {100000, 500000}) {
+    auto x = RandomRows(rows, cols, 1000000, &engine);
+    for (int k : {1, 10, 100}) {
+      std::vector<float> values(rows * k);
+      std::vector<int64_t> indices(rows * k);
+      platform::Timer timer;
+      // The kernel of top_k before: a partial sort of all the pairs.
+      timer.Start();
+      for (int r = 0; r < repeat; ++r) {
+        for (int64_t i = 0; i < rows; ++i) {
+          std::vector<std::pair<float, size_t>> vec;
+          vec.reserve(cols);
+          for (int64_t j = 0; j < cols; ++j) {
+            vec.push_back(std::pair<float, size_t>(x[i * cols + j], j));
+          }
+          std::partial_sort(vec.begin(), vec.begin() + k, vec.end(),
+                            [](const std::pair<float, size_t>& l,
+                               const std::pair<float, size_t>& r) {
+                              return l.first > r.first;
+                            });
+          for (int j = 0; j < k; ++j) {
+            values[i * k + j] = vec[j].first;
+            indices[i * k + j] = vec[j].second;
+          }
+        }
+      }
+      timer.Pause();
+      double sort_ms = timer.ElapsedMS() / repeat;
+      timer.Reset();
+      timer.Start();
+      for (int r = 0; r < repeat; ++r) {
+        TopkRows<float>(context, x.data(), rows, cols, k, values.data(),
+                        indices.data());
+      }
+      timer.Pause();
+      double topk_ms = timer.ElapsedMS() / repeat;
+      LOG(INFO) << "top_k of " << rows << "x" << cols << " k=" << k
+                << ": partial_sort " << sort_ms << " ms, TopkRows " << topk_ms
+                << " ms";
+    }
+  }
+}
+
+}  // namespace math
+}  // namespace operators
+}  // namespace paddle
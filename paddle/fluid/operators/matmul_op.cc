@@ -18,6 +18,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/detail/safe_ref.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/int8_gemm.h"
 
 namespace paddle {
 namespace operators {
@@ -65,6 +66,11 @@ class MatMulKernel : public framework::OpKernel<T> {
     auto *out = context.Output<framework::Tensor>("Out");
     out->mutable_data<T>(context.GetPlace());
 
+    if (y.type() == framework::proto::VarType::INT8) {
+      ComputeInt8(context, x, y, out);
+      return;
+    }
+
     auto blas = math::GetBlas<DeviceContext, T>(context);
     auto mat_dim_a = math::CreateMatrixDescriptor(
         RowMatrixFromVector(x.dims()), 0, context.Attr<bool>("transpose_X"));
@@ -86,6 +92,32 @@ class MatMulKernel : public framework::OpKernel<T> {
     blas.MatMul(x, mat_dim_a, y, mat_dim_b, scale, out, T(0));
 #endif
   }
+
+ private:
+  // Y is the 2-D weight quantized by the native_int8_quantize_pass, so all
+  // the rows of X are multiplied by the same Y.
+  void ComputeInt8(const framework::ExecutionContext &context,
+                   const framework::Tensor &x, const framework::Tensor &y,
+                   framework::Tensor *out) const {
+    PADDLE_ENFORCE_EQ(
+        !context.Attr<bool>("transpose_X") &&
+            !context.Attr<bool>("transpose_Y") && y.dims().size() == 2,
+        true, platform::errors::Unimplemented(
+                  "The int8 Y of matmul should be 2-D and not transposed."));
+    int K = static_cast<int>(y.dims()[0]);
+    int N = static_cast<int>(y.dims()[1]);
+    int M = static_cast<int>(x.numel() / K);
+    // Out is scaled by alpha through the dequantize scales.
+    auto alpha = context.Attr<float>("alpha");
+    auto scale_y = context.Attr<std::vector<float>>("scale_y");
+    for (auto &scale : scale_y) {
+      scale /= alpha;
+    }
+    math::Int8FCFunctor<DeviceContext, T> int8_fc;
+    int8_fc(context.template device_context<DeviceContext>(), M, N, K,
+            x.data<T>(), context.Attr<float>("scale_x"), y.data<int8_t>(),
+            scale_y, out->data<T>());
+  }
 };
 
 // Reshape a rank-3 tensor from P x M x N to (P * M) x N.
@@ -384,6 +416,14 @@ class MatMulOp : public framework::OperatorWithKernel {
     context->SetOutputDim("Out", framework::make_ddim(dim_out));
     context->ShareLoD("X", /*->*/ "Out");
   }
+
+  framework::OpKernelType GetExpectedKernelType(
+      const framework::ExecutionContext &ctx) const override {
+    // Y is INT8 after native_int8_quantize_pass, the kernel of X's type
+    // runs the int8 path then.
+    return framework::OpKernelType(
+        OperatorWithKernel::IndicateVarDataType(ctx, "X"), ctx.GetPlace());
+  }
 };
 
 class MatMulOpMaker : public framework::OpProtoAndCheckerMaker {
@@ -401,6 +441,15 @@ class MatMulOpMaker : public framework::OpProtoAndCheckerMaker {
         )DOC")
         .SetDefault(false);
     AddAttr<float>("alpha", "The scale of Out").SetDefault(1.0f);
+    AddAttr<float>("scale_x",
+                   "(float, default 1.0f) The quantize scale of X, only used "
+                   "when Y is int8.")
+        .SetDefault(1.0f);
+    AddAttr<std::vector<float>>(
+        "scale_y",
+        "(std::vector<float>, default {1.0f}) The quantize scales of the "
+        "columns of Y, only used when Y is int8.")
+        .SetDefault({1.0f});
 #if defined(PADDLE_WITH_MKLML) && !defined(PADDLE_WITH_CUDA)
     AddAttr<int>("head_number", "The number of heads of the matrix")
         .SetDefault(1);
@@ -14,9 +14,11 @@ limitations under the License. */
 
 #pragma once
 
+#include <vector>
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/framework/operator.h"
 #include "paddle/fluid/operators/math/blas.h"
+#include "paddle/fluid/operators/math/int8_gemm.h"
 #include "paddle/fluid/operators/math/math_function.h"
 
 namespace paddle {
@@ -50,9 +52,18 @@ class MulKernel : public framework::OpKernel<T> {
       z->Resize({x_matrix.dims()[0], y_matrix.dims()[1]});
     }
 
-    auto blas = math::GetBlas<DeviceContext, T>(context);
-
-    blas.MatMul(x_matrix, y_matrix, z);
+    if (y->type() == framework::proto::VarType::INT8) {
+      // Y is quantized by the native_int8_quantize_pass.
+      math::Int8FCFunctor<DeviceContext, T> int8_fc;
+      int8_fc(context.template device_context<DeviceContext>(),
+              x_matrix.dims()[0], y_matrix.dims()[1], x_matrix.dims()[1],
+              x_matrix.data<T>(), context.Attr<float>("scale_x"),
+              y_matrix.data<int8_t>(),
+              context.Attr<std::vector<float>>("scale_y"), z->data<T>());
+    } else {
+      auto blas = math::GetBlas<DeviceContext, T>(context);
+      blas.MatMul(x_matrix, y_matrix, z);
+    }
     if (z_dim.size() != 2) {
       z->Resize(z_dim);
     }
@@ -0,0 +1,71 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/reader_op_registry.h"
+#include "paddle/fluid/operators/reader/shuffle_reader.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+class CreateShuffleReaderOp : public framework::OperatorBase {
+ public:
+  using framework::OperatorBase::OperatorBase;
+
+ private:
+  void RunImpl(const framework::Scope& scope,
+               const platform::Place& dev_place) const override {
+    auto* out = scope.FindVar(Output("Out"))
+                    ->template GetMutable<framework::ReaderHolder>();
+    if (out->Get() != nullptr) {
+      return;
+    }
+    const auto& underlying_reader = scope.FindVar(Input("UnderlyingReader"))
+                                        ->Get<framework::ReaderHolder>();
+    out->Reset(framework::MakeDecoratedReader<ShuffleReader>(
+        underlying_reader, static_cast<size_t>(Attr<int>("buffer_size")),
+        static_cast<uint64_t>(Attr<int>("seed")),
+        static_cast<size_t>(Attr<int>("num_shards")),
+        static_cast<size_t>(Attr<int>("shard_id"))));
+  }
+};
+
+class CreateShuffleReaderOpMaker : public DecoratedReaderMakerBase {
+ protected:
+  void Apply() override {
+    AddComment(R"DOC(
+      CreateShuffleReader Operator
+
+      A shuffle reader takes another reader as its 'underlying reader' and
+      shuffles its outputs by a buffer of buffer_size items. With num_shards
+      greater than 1, only the items i with i % num_shards == shard_id are
+      read, e.g. by the trainer of shard_id.
+    )DOC");
+    AddAttr<int>("buffer_size", "The size of the shuffle buffer.")
+        .GreaterThan(0);
+    AddAttr<int>("seed", "The random seed of shuffling.").SetDefault(0);
+    AddAttr<int>("num_shards", "The number of shards of the data.")
+        .SetDefault(1)
+        .GreaterThan(0);
+    AddAttr<int>("shard_id", "The shard to read.").SetDefault(0);
+  }
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
+
+namespace ops = paddle::operators::reader;
+REGISTER_DECORATED_READER_OPERATOR(create_shuffle_reader,
+                                   ops::CreateShuffleReaderOp,
+                                   ops::CreateShuffleReaderOpMaker);
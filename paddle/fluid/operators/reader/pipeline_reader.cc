@@ -0,0 +1,428 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/pipeline_reader.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include "paddle/fluid/framework/data_type.h"
+#include "paddle/fluid/platform/profiler.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+framework::LoDTensor BatchBufferPool::Get(size_t slot) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (slot < buffers_.size()) {
+    auto &buffers = buffers_[slot];
+    for (auto it = buffers.begin(); it != buffers.end(); ++it) {
+      if (it->Holder().use_count() == 1) {
+        // Synchronizes with the release of the last other holder.
+        std::atomic_thread_fence(std::memory_order_acquire);
+        framework::LoDTensor tensor(*it);
+        buffers.erase(it);
+        return tensor;
+      }
+    }
+  }
+  return framework::LoDTensor();
+}
+
+void BatchBufferPool::Recycle(const std::vector<framework::LoDTensor> &batch) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (buffers_.size() < batch.size()) {
+    buffers_.resize(batch.size());
+  }
+  for (size_t slot = 0; slot < batch.size(); ++slot) {
+    if (batch[slot].Holder() == nullptr) continue;
+    auto &buffers = buffers_[slot];
+    buffers.emplace_back(batch[slot]);
+    // The oldest buffers are dropped, they are the most likely to be released
+    // but they are not waited for.
+    while (buffers.size() > max_buffers_per_slot_) {
+      buffers.pop_front();
+    }
+  }
+}
+
+void BatchBufferPool::Clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  buffers_.clear();
+}
+
+PipelineReader::PipelineReader(
+    const std::shared_ptr<framework::ReaderBase> &reader,
+    const BatchConfig &batch_config,
+    const std::vector<TransformConfig> &transforms, size_t queue_capacity)
+    : framework::DecoratedReader(reader),
+      batch_config_(batch_config),
+      // The batches in the queues and the ones given out before.
+      buffer_pool_(2 * queue_capacity + 2) {
+  AddStage("read", 1, nullptr, queue_capacity);
+  if (batch_config_.batch_size > 0) {
+    PADDLE_ENFORCE_EQ(batch_config_.lod_levels.size(), Shapes().size(),
+                      platform::errors::InvalidArgument(
+                          "The lod levels of PipelineReader should be given "
+                          "for each of the %d slots, but got %d",
+                          Shapes().size(), batch_config_.lod_levels.size()));
+    for (auto lod_level : batch_config_.lod_levels) {
+      PADDLE_ENFORCE_EQ(lod_level == 0 || lod_level == 1, true,
+                        platform::errors::Unimplemented(
+                            "PipelineReader only batches slots of lod level 0 "
+                            "or 1, but got %d",
+                            lod_level));
+    }
+    AddStage("batch", batch_config_.num_threads,
+             [this](Item *item) { MakeBatch(item); }, queue_capacity);
+  }
+  for (auto &config : transforms) {
+    auto transform = config.transform;
+    AddStage(config.name, config.num_threads,
+             [transform](Item *item) { transform(&item->batch); },
+             queue_capacity);
+  }
+  StartThreads();
+}
+
+PipelineReader::~PipelineReader() {
+  VLOG(1) << "~PipelineReader";
+  StopThreads();
+}
+
+void PipelineReader::AddStage(const std::string &name, size_t num_threads,
+                              std::function<void(Item *)> run,
+                              size_t queue_capacity) {
+  PADDLE_ENFORCE_GT(num_threads, 0,
+                    platform::errors::InvalidArgument(
+                        "Stage %s of PipelineReader should have threads",
+                        name));
+  std::unique_ptr<Stage> stage(new Stage());
+  stage->name = name;
+  stage->num_threads = num_threads;
+  stage->run = std::move(run);
+  stage->queue.reset(new BlockingQueue<Item>(queue_capacity));
+  stages_.emplace_back(std::move(stage));
+}
+
+void PipelineReader::StartThreads() {
+  reorder_buffer_.clear();
+  next_seq_ = 0;
+  exception_ = nullptr;
+  for (auto &stage : stages_) {
+    stage->queue->ReOpen();
+    stage->live_threads = stage->num_threads;
+  }
+  running_ = true;
+
+  threads_.emplace_back([this] { ReadLoop(); });
+  for (size_t i = 1; i < stages_.size(); ++i) {
+    for (size_t j = 0; j < stages_[i]->num_threads; ++j) {
+      threads_.emplace_back([this, i] { StageLoop(i); });
+    }
+  }
+}
+
+void PipelineReader::StopThreads() {
+  running_ = false;
+  for (auto &stage : stages_) {
+    stage->queue->Close();
+  }
+  reader_->Shutdown();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+  threads_.clear();
+  for (auto &stat : Stats()) {
+    VLOG(1) << "PipelineReader stage " << stat.name << ", threads "
+            << stat.num_threads << ", items " << stat.num_items
+            << ", mean queue depth " << stat.mean_depth << "/"
+            << stat.capacity << ", starved " << stat.num_starved;
+  }
+}
+
+void PipelineReader::ShutdownImpl() {
+  VLOG(1) << "ShutdownImpl";
+  StopThreads();
+  reorder_buffer_.clear();
+  buffer_pool_.Clear();
+}
+
+void PipelineReader::StartImpl() {
+  reader_->Start();
+  StartThreads();
+}
+
+void PipelineReader::ReadLoop() {
+  const size_t batch_size = batch_config_.batch_size;
+  const size_t max_tokens = batch_config_.max_batch_tokens;
+  try {
+    // The samples read but not batched yet.
+    std::deque<Batch> pending;
+    bool eof = false;
+    for (size_t seq = 0; !eof && running_; ++seq) {
+      Item item;
+      item.seq = seq;
+      if (batch_size == 0) {
+        reader_->ReadNext(&item.batch);
+        if (item.batch.empty()) break;
+      } else {
+        item.samples.reserve(batch_size);
+        size_t tokens = 0;
+        while (item.samples.size() < batch_size && running_) {
+          if (pending.empty() && !ReadBucket(&pending)) {
+            eof = true;
+            break;
+          }
+          size_t sample_tokens = SampleTokens(pending.front());
+          // A sample of more tokens than the budget makes a batch alone.
+          if (max_tokens > 0 && !item.samples.empty() &&
+              tokens + sample_tokens > max_tokens) {
+            break;
+          }
+          tokens += sample_tokens;
+          item.samples.emplace_back(std::move(pending.front()));
+          pending.pop_front();
+        }
+        if (!running_ || item.samples.empty()) break;
+        // The last batch may be smaller.
+        if (eof && batch_config_.drop_last) break;
+      }
+      if (!stages_[0]->queue->Send(std::move(item))) break;
+    }
+  } catch (...) {
+    SetException(std::current_exception());
+  }
+  CloseQueue(0);
+}
+
+bool PipelineReader::ReadBucket(std::deque<Batch> *pending) {
+  const size_t bucket_size = std::max<size_t>(batch_config_.bucket_size, 1);
+  std::vector<std::pair<size_t, Batch>> bucket;
+  while (bucket.size() < bucket_size && running_) {
+    Batch sample;
+    reader_->ReadNext(&sample);
+    if (sample.empty()) break;
+    size_t tokens = SampleTokens(sample);
+    bucket.emplace_back(tokens, std::move(sample));
+  }
+  if (bucket.size() > 1) {
+    // Stable so that the order of the samples of the same length is kept.
+    std::stable_sort(bucket.begin(), bucket.end(),
+                     [](const std::pair<size_t, Batch> &a,
+                        const std::pair<size_t, Batch> &b) {
+                       return a.first < b.first;
+                     });
+  }
+  for (auto &sample : bucket) {
+    pending->emplace_back(std::move(sample.second));
+  }
+  return !bucket.empty();
+}
+
+size_t PipelineReader::SampleTokens(const Batch &sample) const {
+  size_t tokens = 0;
+  bool has_lod = false;
+  for (size_t slot = 0;
+       slot < sample.size() && slot < batch_config_.lod_levels.size();
+       ++slot) {
+    if (batch_config_.lod_levels[slot] == 1 && sample[slot].dims().size() > 0) {
+      has_lod = true;
+      tokens += static_cast<size_t>(sample[slot].dims()[0]);
+    }
+  }
+  // A sample without sequences counts as one token.
+  return has_lod ? tokens : 1;
+}
+
+void PipelineReader::StageLoop(size_t stage_idx) {
+  auto &stage = *stages_[stage_idx];
+  try {
+    Item item;
+    while (Receive(stage_idx - 1, &item)) {
+      stage.run(&item);
+      if (!stage.queue->Send(std::move(item))) break;
+    }
+  } catch (...) {
+    SetException(std::current_exception());
+  }
+  if (--stage.live_threads == 0) {
+    CloseQueue(stage_idx);
+  }
+}
+
+bool PipelineReader::Receive(size_t stage_idx, Item *item) {
+  auto &stage = *stages_[stage_idx];
+  size_t depth = stage.queue->Size();
+  if (depth == 0) {
+    ++stage.num_starved;
+  }
+  if (!stage.queue->Receive(item)) {
+    return false;
+  }
+  stage.depth_sum += depth;
+  ++stage.num_items;
+  return true;
+}
+
+void PipelineReader::CloseQueue(size_t stage_idx) {
+  stages_[stage_idx]->queue->Close();
+}
+
+void PipelineReader::SetException(std::exception_ptr exception) {
+  {
+    std::lock_guard<std::mutex> guard(exception_mutex_);
+    if (!exception_) {
+      exception_ = exception;
+    }
+  }
+  // Stops all the stages, the error is raised by ReadNextImpl.
+  for (auto &stage : stages_) {
+    stage->queue->Close();
+  }
+}
+
+void PipelineReader::MakeBatch(Item *item) {
+  platform::RecordEvent record_event("PipelineReader:MakeBatch");
+  auto &samples = item->samples;
+  const size_t num_slots = samples[0].size();
+  PADDLE_ENFORCE_EQ(num_slots, batch_config_.lod_levels.size(),
+                    platform::errors::InvalidArgument(
+                        "The sample has %d slots, but the reader has %d",
+                        num_slots, batch_config_.lod_levels.size()));
+
+  item->batch.resize(num_slots);
+  for (size_t slot = 0; slot < num_slots; ++slot) {
+    const auto &first = samples[0][slot];
+    const int lod_level = batch_config_.lod_levels[slot];
+    const auto &sample_dims = first.dims();
+    int64_t rows = 0;
+    framework::LoD lod;
+    if (lod_level == 1) {
+      lod.emplace_back(1, 0UL);
+    }
+    for (auto &sample : samples) {
+      PADDLE_ENFORCE_EQ(sample.size(), num_slots,
+                        platform::errors::InvalidArgument(
+                            "The samples of a batch have different slots"));
+      const auto &tensor = sample[slot];
+      PADDLE_ENFORCE_EQ(tensor.type(), first.type(),
+                        platform::errors::InvalidArgument(
+                            "Slot %d of the samples have different data types",
+                            slot));
+      PADDLE_ENFORCE_EQ(platform::is_cpu_place(tensor.place()), true,
+                        platform::errors::InvalidArgument(
+                            "The samples to batch should be on CPU"));
+      if (lod_level == 0) {
+        PADDLE_ENFORCE_EQ(tensor.dims(), sample_dims,
+                          platform::errors::InvalidArgument(
+                              "Slot %d of the samples have different shapes "
+                              "%s and %s",
+                              slot, tensor.dims(), sample_dims));
+        ++rows;
+      } else {
+        bool same_rank = tensor.dims().size() > 0 &&
+                         tensor.dims().size() == sample_dims.size();
+        PADDLE_ENFORCE_EQ(same_rank, true,
+                          platform::errors::InvalidArgument(
+                              "Slot %d of the samples should have the same "
+                              "rank and cannot be scalars",
+                              slot));
+        PADDLE_ENFORCE_EQ(
+            framework::slice_ddim(tensor.dims(), 1, tensor.dims().size()),
+            framework::slice_ddim(sample_dims, 1, sample_dims.size()),
+            platform::errors::InvalidArgument(
+                "Slot %d of the samples have different shapes %s and %s", slot,
+                tensor.dims(), sample_dims));
+        rows += tensor.dims()[0];
+        lod[0].push_back(static_cast<size_t>(rows));
+      }
+    }
+
+    framework::DDim dims;
+    if (lod_level == 0) {
+      auto shape = framework::vectorize<int64_t>(sample_dims);
+      shape.insert(shape.begin(), rows);
+      dims = framework::make_ddim(shape);
+    } else {
+      dims = sample_dims;
+      dims[0] = rows;
+    }
+
+    auto out = buffer_pool_.Get(slot);
+    out.Resize(dims);
+    auto *dst = reinterpret_cast<uint8_t *>(
+        out.mutable_data(platform::CPUPlace(), first.type()));
+    for (auto &sample : samples) {
+      const auto &tensor = sample[slot];
+      size_t bytes = tensor.numel() * framework::SizeOfType(tensor.type());
+      if (bytes == 0) continue;
+      std::memcpy(dst, tensor.data<void>(), bytes);
+      dst += bytes;
+    }
+    out.set_lod(lod);
+    item->batch[slot] = std::move(out);
+  }
+  item->samples.clear();
+}
+
+void PipelineReader::ReadNextImpl(Batch *out) {
+  const size_t last = stages_.size() - 1;
+  while (reorder_buffer_.count(next_seq_) == 0) {
+    Item item;
+    if (!Receive(last, &item)) {
+      std::lock_guard<std::mutex> guard(exception_mutex_);
+      if (exception_) {
+        auto exception = exception_;
+        exception_ = nullptr;
+        std::rethrow_exception(exception);
+      }
+      out->clear();
+      return;
+    }
+    reorder_buffer_.emplace(item.seq, std::move(item));
+  }
+
+  auto it = reorder_buffer_.find(next_seq_);
+  *out = std::move(it->second.batch);
+  reorder_buffer_.erase(it);
+  ++next_seq_;
+  if (batch_config_.batch_size > 0) {
+    buffer_pool_.Recycle(*out);
+  }
+}
+
+std::vector<PipelineStageStat> PipelineReader::Stats() const {
+  std::vector<PipelineStageStat> stats;
+  stats.reserve(stages_.size());
+  for (auto &stage : stages_) {
+    PipelineStageStat stat;
+    stat.name = stage->name;
+    stat.num_threads = stage->num_threads;
+    stat.capacity = stage->queue->Cap();
+    stat.depth = stage->queue->Size();
+    stat.num_items = stage->num_items;
+    stat.num_starved = stage->num_starved;
+    stat.mean_depth = stat.num_items == 0
+                          ? 0
+                          : static_cast<double>(stage->depth_sum) /
+                                static_cast<double>(stat.num_items);
+    stats.emplace_back(std::move(stat));
+  }
+  return stats;
+}
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,187 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "paddle/fluid/framework/reader.h"
+#include "paddle/fluid/operators/reader/blocking_queue.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+// The metrics of a stage of PipelineReader, taken on its output queue.
+struct PipelineStageStat {
+  std::string name;
+  size_t num_threads{0};
+  size_t capacity{0};
+  // The number of items in the output queue now.
+  size_t depth{0};
+  // The mean number of items in the output queue when the next stage takes
+  // one. A stage whose mean depth is near 0 starves the stages after it.
+  double mean_depth{0};
+  size_t num_items{0};
+  // How many times the next stage found the output queue empty and waited.
+  size_t num_starved{0};
+};
+
+// BatchBufferPool keeps the memory of the batches given out by a reader, so
+// that the later batches are written into it instead of new allocations.
+// The memory of a batch is reused only after all the other holders of it,
+// e.g. the variables of the executor, have released it.
+class BatchBufferPool {
+ public:
+  explicit BatchBufferPool(size_t max_buffers_per_slot)
+      : max_buffers_per_slot_(max_buffers_per_slot) {}
+
+  // Returns a released buffer of the slot, or an empty tensor if there is
+  // none.
+  framework::LoDTensor Get(size_t slot);
+
+  void Recycle(const std::vector<framework::LoDTensor> &batch);
+
+  void Clear();
+
+ private:
+  size_t max_buffers_per_slot_;
+  std::mutex mutex_;
+  std::vector<std::deque<framework::LoDTensor>> buffers_;
+};
+
+// PipelineReader reads the underlying reader by a pipeline of stages running
+// at the same time: read -> batch -> transforms. Each stage has its own
+// threads and a bounded queue of its outputs, and the batches are given out
+// in the order they are read whatever the number of threads is.
+//
+// When batch_size is not 0, the underlying reader gives samples, which are
+// batched on CPU by the batch stage into the buffers of a BatchBufferPool. A
+// slot of lod level 0 stacks the samples into a new outermost dimension, a
+// slot of lod level 1 concatenates them and gets the lod of the batch.
+//
+// With max_batch_tokens, a batch is closed before batch_size samples if the
+// next sample would make its tokens, i.e. the rows of its slots of lod level
+// 1, exceed max_batch_tokens, so that the batches of long sequences do not
+// exhaust the memory. With bucket_size, the samples are read bucket_size at
+// a time and sorted by their tokens, so that a batch has sequences of close
+// lengths and little padding.
+class PipelineReader : public framework::DecoratedReader {
+ public:
+  using Batch = std::vector<framework::LoDTensor>;
+  // A transform may be run by several threads on different batches.
+  using BatchTransform = std::function<void(Batch *)>;
+
+  struct BatchConfig {
+    size_t batch_size{0};
+    std::vector<int> lod_levels;
+    bool drop_last{true};
+    size_t num_threads{1};
+    size_t max_batch_tokens{0};
+    size_t bucket_size{0};
+  };
+
+  struct TransformConfig {
+    std::string name;
+    BatchTransform transform;
+    size_t num_threads{1};
+  };
+
+  PipelineReader(const std::shared_ptr<framework::ReaderBase> &reader,
+                 const BatchConfig &batch_config,
+                 const std::vector<TransformConfig> &transforms,
+                 size_t queue_capacity);
+
+  ~PipelineReader() override;
+
+  std::vector<PipelineStageStat> Stats() const;
+
+ protected:
+  void ShutdownImpl() override;
+  void StartImpl() override;
+  void ReadNextImpl(Batch *out) override;
+
+ private:
+  struct Item {
+    size_t seq{0};
+    std::vector<Batch> samples;
+    Batch batch;
+  };
+
+  struct Stage {
+    std::string name;
+    size_t num_threads{1};
+    // Runs on an item received from the queue of the previous stage.
+    std::function<void(Item *)> run;
+    std::unique_ptr<BlockingQueue<Item>> queue;
+    std::atomic<size_t> live_threads{0};
+    std::atomic<size_t> num_items{0};
+    std::atomic<size_t> num_starved{0};
+    std::atomic<size_t> depth_sum{0};
+  };
+
+  void AddStage(const std::string &name, size_t num_threads,
+                std::function<void(Item *)> run, size_t queue_capacity);
+
+  void StartThreads();
+
+  void StopThreads();
+
+  void ReadLoop();
+
+  // Reads a bucket of samples into pending, returns false at the end of the
+  // underlying reader.
+  bool ReadBucket(std::deque<Batch> *pending);
+
+  size_t SampleTokens(const Batch &sample) const;
+
+  void StageLoop(size_t stage_idx);
+
+  // Receives an item from the queue of stage stage_idx and records the
+  // metrics of the queue.
+  bool Receive(size_t stage_idx, Item *item);
+
+  void CloseQueue(size_t stage_idx);
+
+  void SetException(std::exception_ptr exception);
+
+  void MakeBatch(Item *item);
+
+ private:
+  BatchConfig batch_config_;
+  BatchBufferPool buffer_pool_;
+
+  std::vector<std::unique_ptr<Stage>> stages_;
+  std::vector<std::thread> threads_;
+  std::atomic<bool> running_{false};
+
+  // The items received by ReadNextImpl before the ones read earlier.
+  std::map<size_t, Item> reorder_buffer_;
+  size_t next_seq_{0};
+
+  std::mutex exception_mutex_;
+  std::exception_ptr exception_;
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,197 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/pipeline_reader.h"
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+using framework::LoDTensor;
+
+// Gives num samples, sample i has a float of i and a sequence of i % 3 + 1
+// int64 of i.
+class SampleReader : public framework::FileReader {
+ public:
+  explicit SampleReader(int64_t num)
+      : framework::FileReader(
+            {framework::make_ddim({-1}), framework::make_ddim({-1, 1})},
+            {framework::proto::VarType::FP32,
+             framework::proto::VarType::INT64},
+            {false, false}),
+        num_(num) {}
+
+ protected:
+  void ReadNextImpl(std::vector<LoDTensor> *out) override {
+    out->clear();
+    if (next_ >= num_) return;
+    int64_t i = next_++;
+    out->resize(2);
+    (*out)[0].Resize({1});
+    (*out)[0].mutable_data<float>(platform::CPUPlace())[0] = i;
+    int64_t len = i % 3 + 1;
+    (*out)[1].Resize({len, 1});
+    auto *data = (*out)[1].mutable_data<int64_t>(platform::CPUPlace());
+    for (int64_t j = 0; j < len; ++j) {
+      data[j] = i;
+    }
+  }
+
+  void StartImpl() override { next_ = 0; }
+
+ private:
+  int64_t num_;
+  int64_t next_{0};
+};
+
+static std::shared_ptr<PipelineReader> CreatePipelineReader(
+    int64_t num_samples, size_t batch_size, bool drop_last) {
+  std::shared_ptr<framework::ReaderBase> samples(
+      new SampleReader(num_samples));
+  PipelineReader::BatchConfig batch_config;
+  batch_config.batch_size = batch_size;
+  batch_config.lod_levels = {0, 1};
+  batch_config.drop_last = drop_last;
+  batch_config.num_threads = 3;
+  // Doubles the floats.
+  PipelineReader::TransformConfig transform;
+  transform.name = "double";
+  transform.num_threads = 2;
+  transform.transform = [](PipelineReader::Batch *batch) {
+    auto &tensor = (*batch)[0];
+    auto *data = tensor.data<float>();
+    for (int64_t i = 0; i < tensor.numel(); ++i) {
+      data[i] *= 2;
+    }
+  };
+  auto reader = framework::MakeDecoratedReader<PipelineReader>(
+      samples, batch_config,
+      std::vector<PipelineReader::TransformConfig>{transform}, 4);
+  return std::static_pointer_cast<PipelineReader>(reader);
+}
+
+TEST(PipelineReader, batch_in_order) {
+  const int64_t num_samples = 103;
+  const size_t batch_size = 4;
+  auto reader = CreatePipelineReader(num_samples, batch_size, false);
+
+  for (int pass = 0; pass < 2; ++pass) {
+    int64_t sample = 0;
+    std::vector<LoDTensor> batch;
+    while (true) {
+      reader->ReadNext(&batch);
+      if (batch.empty()) break;
+      ASSERT_EQ(batch.size(), 2UL);
+      int64_t rows = batch[0].dims()[0];
+      ASSERT_EQ(rows, std::min<int64_t>(batch_size, num_samples - sample));
+      ASSERT_EQ(batch[0].dims().size(), 2);
+
+      const auto &lod = batch[1].lod();
+      ASSERT_EQ(lod.size(), 1UL);
+      ASSERT_EQ(lod[0].size(), static_cast<size_t>(rows + 1));
+      const auto *floats = batch[0].data<float>();
+      const auto *ints = batch[1].data<int64_t>();
+      for (int64_t i = 0; i < rows; ++i, ++sample) {
+        ASSERT_EQ(floats[i], 2 * sample);
+        ASSERT_EQ(lod[0][i + 1] - lod[0][i],
+                  static_cast<size_t>(sample % 3 + 1));
+        for (size_t j = lod[0][i]; j < lod[0][i + 1]; ++j) {
+          ASSERT_EQ(ints[j], sample);
+        }
+      }
+    }
+    ASSERT_EQ(sample, num_samples);
+
+    auto stats = reader->Stats();
+    ASSERT_EQ(stats.size(), 3UL);
+    EXPECT_EQ(stats[0].name, "read");
+    EXPECT_EQ(stats[1].name, "batch");
+    EXPECT_EQ(stats[2].name, "double");
+
+    reader->Shutdown();
+    reader->Start();
+  }
+}
+
+TEST(PipelineReader, recycle_buffers) {
+  auto reader = CreatePipelineReader(1000, 8, true);
+  std::set<const void *> buffers;
+  std::vector<LoDTensor> batch;
+  size_t num_batches = 0;
+  while (true) {
+    // The previous batch is released by the assignment.
+    reader->ReadNext(&batch);
+    if (batch.empty()) break;
+    buffers.insert(batch[0].data<void>());
+    ++num_batches;
+  }
+  ASSERT_EQ(num_batches, 125UL);
+  // The batches are written into the memory of the released ones.
+  ASSERT_LT(buffers.size(), num_batches / 2);
+}
+
+// Returns the padding of each batch to the longest sequence in it.
+static size_t ReadWithTokenBudget(size_t max_batch_tokens, size_t bucket_size,
+                                  int64_t num_samples) {
+  std::shared_ptr<framework::ReaderBase> samples(
+      new SampleReader(num_samples));
+  PipelineReader::BatchConfig batch_config;
+  batch_config.batch_size = 64;
+  batch_config.lod_levels = {0, 1};
+  batch_config.drop_last = false;
+  batch_config.max_batch_tokens = max_batch_tokens;
+  batch_config.bucket_size = bucket_size;
+  auto reader = framework::MakeDecoratedReader<PipelineReader>(
+      samples, batch_config, std::vector<PipelineReader::TransformConfig>(),
+      4);
+
+  std::set<int64_t> seen;
+  size_t padding = 0;
+  std::vector<LoDTensor> batch;
+  while (true) {
+    reader->ReadNext(&batch);
+    if (batch.empty()) break;
+    const auto &lod = batch[1].lod()[0];
+    size_t rows = lod.size() - 1;
+    size_t max_len = 0;
+    for (size_t i = 0; i < rows; ++i) {
+      max_len = std::max(max_len, lod[i + 1] - lod[i]);
+    }
+    // Only a batch of one sample may exceed the budget.
+    EXPECT_TRUE(rows == 1 || lod.back() <= max_batch_tokens);
+    padding += max_len * rows - lod.back();
+    const auto *floats = batch[0].data<float>();
+    for (size_t i = 0; i < rows; ++i) {
+      EXPECT_TRUE(seen.insert(static_cast<int64_t>(floats[i])).second);
+    }
+  }
+  EXPECT_EQ(seen.size(), static_cast<size_t>(num_samples));
+  return padding;
+}
+
+TEST(PipelineReader, token_budget) {
+  size_t padding = ReadWithTokenBudget(16, 0, 301);
+  size_t bucketed_padding = ReadWithTokenBudget(16, 60, 301);
+  LOG(INFO) << "padding " << padding << ", with buckets " << bucketed_padding;
+  EXPECT_LT(bucketed_padding, padding);
+}
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
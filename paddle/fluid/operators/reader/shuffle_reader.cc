@@ -0,0 +1,101 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/shuffle_reader.h"
+#include <utility>
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+ShuffleReader::ShuffleReader(
+    const std::shared_ptr<framework::ReaderBase>& reader, size_t buffer_size,
+    uint64_t seed, size_t num_shards, size_t shard_id)
+    : framework::DecoratedReader(reader),
+      buffer_size_(buffer_size),
+      seed_(seed),
+      num_shards_(num_shards),
+      shard_id_(shard_id) {
+  PADDLE_ENFORCE_GT(buffer_size_, 0,
+                    platform::errors::InvalidArgument(
+                        "The buffer size of ShuffleReader should be greater "
+                        "than 0, but got %d",
+                        buffer_size_));
+  PADDLE_ENFORCE_GT(num_shards_, 0,
+                    platform::errors::InvalidArgument(
+                        "The number of shards should be greater than 0"));
+  PADDLE_ENFORCE_LT(shard_id_, num_shards_,
+                    platform::errors::InvalidArgument(
+                        "The shard id %d should be less than the number of "
+                        "shards %d",
+                        shard_id_, num_shards_));
+  buffer_.reserve(buffer_size_);
+  Reset();
+}
+
+void ShuffleReader::Reset() {
+  buffer_.clear();
+  eof_ = false;
+  num_read_ = 0;
+  engine_.seed(seed_ + num_passes_);
+}
+
+void ShuffleReader::ShutdownImpl() {
+  VLOG(1) << "ShutdownImpl";
+  reader_->Shutdown();
+  buffer_.clear();
+}
+
+void ShuffleReader::StartImpl() {
+  reader_->Start();
+  ++num_passes_;
+  Reset();
+}
+
+bool ShuffleReader::ReadShardItem(std::vector<framework::LoDTensor>* out) {
+  while (true) {
+    reader_->ReadNext(out);
+    if (out->empty()) return false;
+    if (num_read_++ % num_shards_ == shard_id_) return true;
+  }
+}
+
+void ShuffleReader::ReadNextImpl(std::vector<framework::LoDTensor>* out) {
+  while (!eof_ && buffer_.size() < buffer_size_) {
+    std::vector<framework::LoDTensor> item;
+    if (!ReadShardItem(&item)) {
+      eof_ = true;
+      break;
+    }
+    buffer_.emplace_back(std::move(item));
+  }
+  if (buffer_.empty()) {
+    out->clear();
+    return;
+  }
+
+  // The engine is used directly rather than by a distribution, whose results
+  // differ between standard libraries. The bias of the modulo is negligible
+  // for the 64 bit engine.
+  size_t idx = engine_() % buffer_.size();
+  *out = std::move(buffer_[idx]);
+  if (idx + 1 != buffer_.size()) {
+    buffer_[idx] = std::move(buffer_.back());
+  }
+  buffer_.pop_back();
+}
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
@@ -0,0 +1,69 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <memory>
+#include <random>
+#include <vector>
+#include "paddle/fluid/framework/reader.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+// ShuffleReader shuffles the items of the underlying reader by a buffer of
+// buffer_size items: an item is given out at random from the buffer, which
+// is then refilled by the next item read.
+//
+// The items are sharded before shuffling: the item i of a pass belongs to
+// shard i % num_shards, and only the items of shard_id are given out. So
+// trainers reading the same data with the same seed get disjoint items.
+//
+// The order is decided by seed and the number of passes started, so every
+// pass is shuffled differently but reproducibly.
+class ShuffleReader : public framework::DecoratedReader {
+ public:
+  ShuffleReader(const std::shared_ptr<framework::ReaderBase>& reader,
+                size_t buffer_size, uint64_t seed, size_t num_shards = 1,
+                size_t shard_id = 0);
+
+ protected:
+  void ShutdownImpl() override;
+  void StartImpl() override;
+  void ReadNextImpl(std::vector<framework::LoDTensor>* out) override;
+
+ private:
+  // Reads the next item of shard_id_, returns false at the end of the
+  // underlying reader.
+  bool ReadShardItem(std::vector<framework::LoDTensor>* out);
+
+  void Reset();
+
+ private:
+  const size_t buffer_size_;
+  const uint64_t seed_;
+  const size_t num_shards_;
+  const size_t shard_id_;
+
+  std::vector<std::vector<framework::LoDTensor>> buffer_;
+  bool eof_{false};
+  size_t num_read_{0};
+  size_t num_passes_{0};
+  std::mt19937_64 engine_;
+};
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
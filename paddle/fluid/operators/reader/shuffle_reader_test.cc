@@ -0,0 +1,129 @@
+// Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "paddle/fluid/operators/reader/shuffle_reader.h"
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace paddle {
+namespace operators {
+namespace reader {
+
+using framework::LoDTensor;
+
+// Gives the int64 0, 1, ..., num - 1.
+class RangeReader : public framework::FileReader {
+ public:
+  explicit RangeReader(int64_t num)
+      : framework::FileReader({framework::make_ddim({1})},
+                              {framework::proto::VarType::INT64}, {false}),
+        num_(num) {}
+
+ protected:
+  void ReadNextImpl(std::vector<LoDTensor>* out) override {
+    out->clear();
+    if (next_ >= num_) return;
+    out->resize(1);
+    (*out)[0].Resize({1});
+    (*out)[0].mutable_data<int64_t>(platform::CPUPlace())[0] = next_++;
+  }
+
+  void StartImpl() override { next_ = 0; }
+
+ private:
+  int64_t num_;
+  int64_t next_{0};
+};
+
+static std::vector<int64_t> ReadAll(framework::ReaderBase* reader) {
+  std::vector<int64_t> values;
+  std::vector<LoDTensor> item;
+  while (true) {
+    reader->ReadNext(&item);
+    if (item.empty()) break;
+    values.emplace_back(item[0].data<int64_t>()[0]);
+  }
+  return values;
+}
+
+static std::shared_ptr<framework::ReaderBase> CreateShuffleReader(
+    int64_t num, size_t buffer_size, uint64_t seed, size_t num_shards = 1,
+    size_t shard_id = 0) {
+  std::shared_ptr<framework::ReaderBase> range(new RangeReader(num));
+  return framework::MakeDecoratedReader<ShuffleReader>(
+      range, buffer_size, seed, num_shards, shard_id);
+}
+
+TEST(ShuffleReader, deterministic_shuffle) {
+  const int64_t num = 1000;
+  auto reader = CreateShuffleReader(num, 100, 10);
+  auto first = ReadAll(reader.get());
+  ASSERT_EQ(first.size(), static_cast<size_t>(num));
+  auto sorted = first;
+  std::sort(sorted.begin(), sorted.end());
+  for (int64_t i = 0; i < num; ++i) {
+    ASSERT_EQ(sorted[i], i);
+  }
+  ASSERT_FALSE(std::is_sorted(first.begin(), first.end()));
+
+  // The same seed gives the same order.
+  auto same_seed = CreateShuffleReader(num, 100, 10);
+  ASSERT_EQ(ReadAll(same_seed.get()), first);
+
+  // The next pass is shuffled differently.
+  reader->Shutdown();
+  reader->Start();
+  auto second = ReadAll(reader.get());
+  ASSERT_EQ(second.size(), first.size());
+  ASSERT_NE(second, first);
+}
+
+TEST(ShuffleReader, shard) {
+  const int64_t num = 1001;
+  const size_t num_shards = 4;
+  std::vector<int64_t> all;
+  for (size_t shard_id = 0; shard_id < num_shards; ++shard_id) {
+    auto reader = CreateShuffleReader(num, 16, 0, num_shards, shard_id);
+    auto values = ReadAll(reader.get());
+    for (auto value : values) {
+      ASSERT_EQ(static_cast<size_t>(value) % num_shards, shard_id);
+    }
+    all.insert(all.end(), values.begin(), values.end());
+  }
+  std::sort(all.begin(), all.end());
+  ASSERT_EQ(all.size(), static_cast<size_t>(num));
+  for (int64_t i = 0; i < num; ++i) {
+    ASSERT_EQ(all[i], i);
+  }
+}
+
+// The throughput of a buffer of 10000 items, which is run with
+// --gtest_also_run_disabled_tests.
+TEST(ShuffleReader, DISABLED_throughput) {
+  const int64_t num = 200000;
+  auto reader = CreateShuffleReader(num, 10000, 0);
+  auto start = std::chrono::steady_clock::now();
+  auto values = ReadAll(reader.get());
+  auto end = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(end - start).count();
+  ASSERT_EQ(values.size(), static_cast<size_t>(num));
+  LOG(INFO) << "ShuffleReader gives " << num / seconds << " items/s";
+}
+
+}  // namespace reader
+}  // namespace operators
+}  // namespace paddle
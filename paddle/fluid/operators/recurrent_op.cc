@@ -17,6 +17,8 @@ limitations under the License. */
 #include <algorithm>
 #include "paddle/fluid/string/string_helper.h"
 
+DECLARE_bool(cache_sub_block_context);
+
 namespace paddle {
 namespace operators {
 
@@ -68,6 +70,16 @@ StepScopes::StepScopes(const platform::DeviceContext &dev_ctx,
                     platform::errors::PreconditionNotMet(
                         "Cannot backward when is not training"));
   if (!is_backward_) {
+    // The two scopes of inference alternate between the steps, so they can be
+    // kept for the next run as well.
+    if (!is_train && FLAGS_cache_sub_block_context &&
+        scopes->size() == num_step_scopes &&
+        std::all_of(scopes->begin(), scopes->end(),
+                    [&parent](framework::Scope *s) {
+                      return parent.HasKid(s);
+                    })) {
+      return;
+    }
     ClearStepScopes(dev_ctx, const_cast<framework::Scope *>(&parent), scopes);
     scopes->reserve(static_cast<size_t>(num_step_scopes));
     for (size_t i = 0; i < num_step_scopes; ++i) {
@@ -204,7 +216,7 @@ void RecurrentOp::RunImpl(const framework::Scope &scope,
   auto *block = Attr<framework::BlockDesc *>(kStepBlock);
 
   auto *program = block->Program();
-  auto ctx = executor.Prepare(
+  auto ctx = ctx_cache_.Get(
       *program, block->ID(), Attr<std::vector<std::string>>(
                                  kSkipEagerDeletionVars) /*skip_ref_cnt_vars*/);
 
@@ -308,7 +320,7 @@ void RecurrentGradOp::RunImpl(const framework::Scope &scope,
   framework::Executor executor(place);
   auto *block = Attr<framework::BlockDesc *>(kStepBlock);
   auto *program = block->Program();
-  auto ctx = executor.Prepare(
+  auto ctx = ctx_cache_.Get(
       *program, block->ID(), Attr<std::vector<std::string>>(
                                  kSkipEagerDeletionVars) /*skip_ref_cnt_vars*/);
 
@@ -200,6 +200,8 @@ class RecurrentOp : public RecurrentBase {
   StepScopes CreateStepScopes(const platform::DeviceContext &dev_ctx,
                               const framework::Scope &scope,
                               size_t seq_len) const;
+
+  mutable framework::ExecutorPrepareContextCache ctx_cache_;
 };
 
 class RecurrentGradOp : public RecurrentBase {
@@ -225,6 +227,8 @@ class RecurrentGradOp : public RecurrentBase {
 
   static std::vector<std::string> GradVarLists(
       const std::vector<std::string> &var_names);
+
+  mutable framework::ExecutorPrepareContextCache ctx_cache_;
 };
 
 }  // namespace operators
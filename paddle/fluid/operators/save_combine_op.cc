@@ -65,6 +65,13 @@ to a file on disk.
                   "type and then saved. Otherwise, the tensor will be "
                   "directly saved without data type conversion.")
         .SetDefault(false);
+    AddAttr<bool>("save_as_aligned",
+                  "(boolean, default false)"
+                  "If true, the tensors will be saved in the aligned combined "
+                  "format, in which the data of every tensor starts at a page "
+                  "aligned offset, so the file can be memory mapped by "
+                  "load_combine_op.")
+        .SetDefault(false);
     AddAttr<std::string>(
         "file_path",
         "(string)"
@@ -19,7 +19,9 @@ limitations under the License. */
 #include <numeric>
 #include <sstream>
 #include <string>
+#include <vector>
 
+#include "paddle/fluid/framework/aligned_combine.h"
 #include "paddle/fluid/framework/data_type.h"
 #include "paddle/fluid/framework/data_type_transform.h"
 #include "paddle/fluid/framework/framework.pb.h"
@@ -38,6 +40,7 @@ class SaveCombineOpKernel : public framework::OpKernel<T> {
     auto filename = ctx.Attr<std::string>("file_path");
     auto overwrite = ctx.Attr<bool>("overwrite");
     auto save_as_fp16 = ctx.Attr<bool>("save_as_fp16");
+    auto save_as_aligned = ctx.Attr<bool>("save_as_aligned");
 
     bool is_present = FileExists(filename);
     if (is_present && !overwrite) {
@@ -59,6 +62,10 @@ class SaveCombineOpKernel : public framework::OpKernel<T> {
     platform::DeviceContextPool &pool = platform::DeviceContextPool::Instance();
     auto &dev_ctx = *pool.Get(place);
 
+    // tensors converted to fp16 are kept alive until they are written
+    std::vector<framework::LoDTensor> converted(inp_var_names.size());
+    std::vector<const framework::LoDTensor *> tensors;
+    tensors.reserve(inp_var_names.size());
     for (size_t i = 0; i < inp_var_names.size(); i++) {
       PADDLE_ENFORCE(inp_vars[i] != nullptr,
                      "Cannot find variable %s for save_combine_op",
@@ -68,7 +75,6 @@ class SaveCombineOpKernel : public framework::OpKernel<T> {
                      inp_var_names[i]);
 
       auto &tensor = inp_vars[i]->Get<framework::LoDTensor>();
-      // Serialize tensors one by one
 
       // Check types to see if a fp16 transformation is required
       auto in_dtype = tensor.type();
@@ -78,14 +84,23 @@ class SaveCombineOpKernel : public framework::OpKernel<T> {
       if (in_dtype != out_dtype) {
         auto in_kernel_type = framework::OpKernelType(in_dtype, place);
         auto out_kernel_type = framework::OpKernelType(out_dtype, place);
-        framework::LoDTensor out;
+        auto &out = converted[i];
         // copy LoD info to the new tensor
         out.set_lod(tensor.lod());
         framework::TransDataType(in_kernel_type, out_kernel_type, tensor, &out);
-        framework::SerializeToStream(fout, out, dev_ctx);
+        tensors.push_back(&out);
       } else {
-        framework::SerializeToStream(fout, tensor, dev_ctx);
+        tensors.push_back(&tensor);
       }
+
+      if (!save_as_aligned) {
+        // Serialize tensors one by one
+        framework::SerializeToStream(fout, *tensors.back(), dev_ctx);
+        converted[i].clear();
+      }
+    }
+    if (save_as_aligned) {
+      framework::SerializeToAlignedCombineStream(fout, tensors, dev_ctx);
     }
     fout.close();
   }
@@ -344,3 +344,50 @@ TEST(SaveLoadTestWithCombineOp, CPU) {
     }
   }
 }
+
+// Save in the aligned combined format, then load it by copy and by mmap
+TEST(SaveLoadCombineOpAligned, CPU) {
+  paddle::framework::Scope scope;
+  paddle::platform::CPUPlace place;
+
+  std::vector<int> lod1 = {0, 1, 2, 3, 10};
+  int numel1 = 100;
+  paddle::framework::LoD expect_lod1;
+  float* expect1 = CreateForSaveCombineOp<float, float>(
+      10, 10, lod1, "test_var1", place, &scope, &expect_lod1);
+
+  std::vector<int> lod2 = {0, 2, 5, 10};
+  int numel2 = 200;
+  paddle::framework::LoD expect_lod2;
+  float* expect2 = CreateForSaveCombineOp<float, float>(
+      10, 20, lod2, "test_var2", place, &scope, &expect_lod2);
+
+  paddle::framework::AttributeMap save_attrs;
+  save_attrs.insert({"file_path", std::string("check_tensor_aligned.ls")});
+  save_attrs.insert({"save_as_aligned", true});
+  auto save_combine_op = paddle::framework::OpRegistry::CreateOp(
+      "save_combine", {{"X", {"test_var1", "test_var2"}}}, {}, save_attrs);
+  save_combine_op->Run(scope, place);
+
+  for (bool use_mmap : {false, true}) {
+    auto target1 = GeneratePlaceholderBeforeLoad("out_var1", &scope);
+    auto target2 = GeneratePlaceholderBeforeLoad("out_var2", &scope);
+
+    paddle::framework::AttributeMap load_attrs;
+    load_attrs.insert({"file_path", std::string("check_tensor_aligned.ls")});
+    load_attrs.insert({"use_mmap", use_mmap});
+    auto load_combine_op = paddle::framework::OpRegistry::CreateOp(
+        "load_combine", {}, {{"Out", {"out_var1", "out_var2"}}}, load_attrs);
+    load_combine_op->Run(scope, place);
+
+    paddle::framework::LoD actual_lod1, actual_lod2;
+    float* actual1 =
+        GetValuesAfterLoadCombineOp<float>(target1, scope, &actual_lod1);
+    float* actual2 =
+        GetValuesAfterLoadCombineOp<float>(target2, scope, &actual_lod2);
+    CheckValues<float, float>(expect1, actual1, expect_lod1, actual_lod1,
+                              numel1);
+    CheckValues<float, float>(expect2, actual2, expect_lod2, actual_lod2,
+                              numel2);
+  }
+}
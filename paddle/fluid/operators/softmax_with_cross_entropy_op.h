@@ -17,6 +17,7 @@ limitations under the License. */
 #include "paddle/fluid/framework/op_registry.h"
 #include "paddle/fluid/operators/math/cross_entropy.h"
 #include "paddle/fluid/operators/math/softmax.h"
+#include "paddle/fluid/operators/math/softmax_cross_entropy.h"
 #include "paddle/fluid/operators/softmax_op.h"
 
 namespace paddle {
@@ -56,6 +57,14 @@ class SoftmaxWithCrossEntropyKernel : public framework::OpKernel<T> {
 
     auto& dev_ctx =
         context.template device_context<platform::CPUDeviceContext>();
+    if (d == axis_dim) {
+      // The softmax is along the last axis, the fused kernel computes the
+      // softmax and the loss of a row together.
+      math::SoftmaxWithCrossEntropyFunctor<platform::CPUDeviceContext, T>()(
+          dev_ctx, &logits_2d, &labels_2d, soft_label,
+          context.Attr<int>("ignore_index"), &softmax_2d, &loss_2d);
+      return;
+    }
     math::SoftmaxFunctor<platform::CPUDeviceContext, T, false>()(
         dev_ctx, axis_dim, &logits_2d, &softmax_2d);
     math::CrossEntropyFunctor<platform::CPUDeviceContext, T>()(
@@ -75,19 +84,32 @@ class SoftmaxWithCrossEntropyGradKernel : public framework::OpKernel<T> {
         context.Output<Tensor>(framework::GradVarName("Logits"));
 
     const Tensor* softmax = context.Input<Tensor>("Softmax");
-    if (logit_grad != softmax) {
-      framework::TensorCopy(*softmax, context.GetPlace(),
-                            context.device_context(), logit_grad);
-    }
-
     const bool soft_label = context.Attr<bool>("soft_label");
 
-    const int rank = logit_grad->dims().size();
+    const int rank = softmax->dims().size();
     const int axis = CanonicalAxis(context.Attr<int>("axis"), rank);
-    int axis_dim = logit_grad->dims()[axis];
+    int axis_dim = softmax->dims()[axis];
+
+    const int n = SizeToAxis(axis, softmax->dims());
+    const int d = SizeFromAxis(axis, softmax->dims());
+    if (d == axis_dim) {
+      logit_grad->mutable_data<T>(context.GetPlace());
+      Tensor softmax_2d, logit_grad_2d, labels_2d, out_grad_2d;
+      softmax_2d.ShareDataWith(*softmax).Resize({n, d});
+      logit_grad_2d.ShareDataWith(*logit_grad).Resize({n, d});
+      labels_2d.ShareDataWith(*labels).Resize({n, labels->numel() / n});
+      out_grad_2d.ShareDataWith(*out_grad).Resize({n, 1});
+      math::SoftmaxWithCrossEntropyGradFunctor<platform::CPUDeviceContext, T>()(
+          context.template device_context<platform::CPUDeviceContext>(),
+          &softmax_2d, &labels_2d, &out_grad_2d, soft_label,
+          context.Attr<int>("ignore_index"), &logit_grad_2d);
+      return;
+    }
 
-    const int n = SizeToAxis(axis, logit_grad->dims());
-    const int d = SizeFromAxis(axis, logit_grad->dims());
+    if (logit_grad != softmax) {
+      framework::TensorCopy(*softmax, context.GetPlace(),
+                            context.device_context(), logit_grad);
+    }
     Tensor logit_grad_2d, labels_2d, out_grad_2d;
     logit_grad_2d.ShareDataWith(*logit_grad).Resize({n, d});
     labels_2d.ShareDataWith(*labels).Resize({n, labels->numel() / n});
@@ -110,10 +132,14 @@ class SoftmaxWithCrossEntropyGradKernel : public framework::OpKernel<T> {
       const int64_t* label_data = labels->data<int64_t>();
       T* logit_grad_data = logit_grad->data<T>();
       const T* out_grad_data = out_grad->data<T>();
+      const int ignore_index = context.Attr<int>("ignore_index");
       const int remain = d / axis_dim;
       for (int i = 0; i < n; ++i) {
         for (int j = 0; j < remain; j++) {
           int idx = i * remain + j;
+          // The positions of ignore_index keep out_grad * softmax, as the
+          // fused kernel does.
+          if (label_data[idx] == ignore_index) continue;
           logit_grad_data[i * d + label_data[idx] * remain + j] -=
               out_grad_data[idx];
         }
@@ -20,7 +20,16 @@ namespace paddle {
 namespace platform {
 
 //! Set the number of threads in use.
+// Sets the threads of BLAS (MKL/OpenBLAS) and the intra-op threads of the
+// calling thread.
 void SetNumThreads(int num_threads);
 
+// The intra-op threads are the threads used by CPUDeviceContext::ParallelFor
+// for one operator. The budget is per thread, so that each executor or
+// predictor thread has its own, and it is 1 (serial) by default.
+void SetIntraOpNumThreads(int num_threads);
+
+int GetIntraOpNumThreads();
+
 }  // namespace platform
 }  // namespace paddle
@@ -13,10 +13,41 @@ See the License for the specific language governing permissions and
 limitations under the License. */
 
 #include "paddle/fluid/platform/cpu_helper.h"
+#include <atomic>
+#include <vector>
 
 #include "gtest/gtest.h"
+#include "paddle/fluid/platform/device_context.h"
 
 TEST(CpuHelper, SetNumThread) {
   paddle::platform::SetNumThreads(1);
   paddle::platform::SetNumThreads(4);
 }
+
+TEST(CpuHelper, IntraOpParallelFor) {
+  paddle::platform::CPUDeviceContext ctx;
+  const int64_t n = 100003;
+  for (int num_threads : {1, 2, 4, 8}) {
+    paddle::platform::SetIntraOpNumThreads(num_threads);
+    EXPECT_EQ(paddle::platform::GetIntraOpNumThreads(), num_threads);
+    std::vector<int> visits(n, 0);
+    std::atomic<int> num_ranges(0);
+    ctx.ParallelFor(n, 1000, [&](int64_t begin, int64_t end) {
+      ++num_ranges;
+      for (int64_t i = begin; i < end; ++i) {
+        ++visits[i];
+      }
+    });
+    EXPECT_LE(num_ranges.load(), num_threads);
+    for (int64_t i = 0; i < n; ++i) {
+      ASSERT_EQ(visits[i], 1);
+    }
+  }
+  // No more ranges than n / grain.
+  std::atomic<int> num_ranges(0);
+  ctx.ParallelFor(1500, 1000, [&](int64_t begin, int64_t end) {
+    ++num_ranges;
+  });
+  EXPECT_EQ(num_ranges.load(), 2);
+  paddle::platform::SetIntraOpNumThreads(1);
+}
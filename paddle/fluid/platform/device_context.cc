@@ -10,12 +10,17 @@ WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 See the License for the specific language governing permissions and
 limitations under the License. */
 #include "paddle/fluid/platform/device_context.h"
+#include <ThreadPool.h>
+#include <algorithm>
+#include <exception>
 #include <set>
+#include <thread>  // NOLINT
 #include <string>
 #include <unordered_set>
 #include <vector>
 
 #include "paddle/fluid/memory/memory.h"
+#include "paddle/fluid/platform/cpu_helper.h"
 #ifdef PADDLE_WITH_CUDA
 #include "paddle/fluid/framework/rw_lock.h"
 #include "paddle/fluid/memory/allocation/cuda_device_context_allocator.h"
@@ -131,6 +136,52 @@ Eigen::DefaultDevice* CPUDeviceContext::eigen_device() const {
 
 Place CPUDeviceContext::GetPlace() const { return place_; }
 
+// The threads shared by the intra-op parallelism of all the CPU contexts.
+static ::ThreadPool* IntraOpThreadPool() {
+  static ::ThreadPool pool(
+      std::max(std::thread::hardware_concurrency(), 2U) - 1);
+  return &pool;
+}
+
+void CPUDeviceContext::ParallelFor(
+    int64_t n, int64_t grain,
+    const std::function<void(int64_t, int64_t)>& fn) const {
+  if (n <= 0) return;
+  grain = std::max<int64_t>(grain, 1);
+  int64_t num_tasks =
+      std::min<int64_t>(GetIntraOpNumThreads(), (n + grain - 1) / grain);
+  if (num_tasks <= 1) {
+    fn(0, n);
+    return;
+  }
+  int64_t chunk = (n + num_tasks - 1) / num_tasks;
+  std::vector<std::future<void>> futures;
+  for (int64_t begin = chunk; begin < n; begin += chunk) {
+    int64_t end = std::min(n, begin + chunk);
+    futures.emplace_back(IntraOpThreadPool()->enqueue([&fn, begin, end] {
+      // The nested ParallelFor in fn runs serially.
+      SetIntraOpNumThreads(1);
+      fn(begin, end);
+    }));
+  }
+  // fn is referenced by the tasks, so all of them are waited for before an
+  // exception is thrown.
+  std::exception_ptr error;
+  try {
+    fn(0, chunk);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  for (auto& future : futures) {
+    try {
+      future.get();
+    } catch (...) {
+      if (!error) error = std::current_exception();
+    }
+  }
+  if (error) std::rethrow_exception(error);
+}
+
 #ifdef PADDLE_WITH_CUDA
 
 class EigenCudaStreamDevice : public Eigen::StreamInterface {
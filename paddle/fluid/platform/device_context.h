@@ -11,6 +11,7 @@ limitations under the License. */
 #pragma once
 
 #include <future>  // NOLINT
+#include <functional>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <string>
@@ -62,6 +63,14 @@ class CPUDeviceContext : public DeviceContext {
 
   Place GetPlace() const override;
 
+  // Calls fn(begin, end) on the disjoint ranges covering [0, n), each of at
+  // least grain items except the last one. The ranges are run by at most
+  // GetIntraOpNumThreads() threads, the calling thread included, and it
+  // returns after all of them are done. fn is called once on [0, n) if the
+  // intra-op threads is 1 or n is not greater than grain.
+  void ParallelFor(int64_t n, int64_t grain,
+                   const std::function<void(int64_t, int64_t)>& fn) const;
+
  private:
   CPUPlace place_;
   std::unique_ptr<Eigen::DefaultDevice> eigen_device_;
@@ -34,7 +34,8 @@ namespace platform {
 // Transform applys a unary or a binary functor on each element in a
 // range defined by a pair of iterators.
 //
-// - The specialization for CPU calls std::transform.
+// - The specialization for CPU calls std::transform, on the chunks of the
+//   range by CPUDeviceContext::ParallelFor if the iterators are pointers.
 // - The specialization for CUDA calls thrust::tranform.
 //
 // NOTE: We need to define InputIter and OutputIter defined as
@@ -61,10 +62,15 @@ struct Transform {
 
 template <>
 struct Transform<platform::CPUDeviceContext> {
+  // The elements of a chunk transformed by one intra-op thread.
+  static constexpr int64_t kGrainSize = 32768;
+
   template <typename InputIter, typename OutputIter, typename UnaryOperation>
   void operator()(const platform::CPUDeviceContext& context, InputIter first,
                   InputIter last, OutputIter result, UnaryOperation op) {
-    std::transform(first, last, result, op);
+    Run(context, first, last, result, op,
+        std::integral_constant<bool, std::is_pointer<InputIter>::value &&
+                                         std::is_pointer<OutputIter>::value>());
   }
 
   template <typename InputIter1, typename InputIter2, typename OutputIter,
@@ -72,8 +78,50 @@ struct Transform<platform::CPUDeviceContext> {
   void operator()(const platform::CPUDeviceContext& context, InputIter1 first1,
                   InputIter1 last1, InputIter2 first2, OutputIter result,
                   BinaryOperation op) {
+    Run(context, first1, last1, first2, result, op,
+        std::integral_constant<bool, std::is_pointer<InputIter1>::value &&
+                                         std::is_pointer<InputIter2>::value &&
+                                         std::is_pointer<OutputIter>::value>());
+  }
+
+ private:
+  template <typename InputIter, typename OutputIter, typename UnaryOperation>
+  void Run(const platform::CPUDeviceContext& context, InputIter first,
+           InputIter last, OutputIter result, UnaryOperation op,
+           std::false_type) {
+    std::transform(first, last, result, op);
+  }
+
+  template <typename InputIter, typename OutputIter, typename UnaryOperation>
+  void Run(const platform::CPUDeviceContext& context, InputIter first,
+           InputIter last, OutputIter result, UnaryOperation op,
+           std::true_type) {
+    context.ParallelFor(last - first, kGrainSize,
+                        [&](int64_t begin, int64_t end) {
+                          std::transform(first + begin, first + end,
+                                         result + begin, op);
+                        });
+  }
+
+  template <typename InputIter1, typename InputIter2, typename OutputIter,
+            typename BinaryOperation>
+  void Run(const platform::CPUDeviceContext& context, InputIter1 first1,
+           InputIter1 last1, InputIter2 first2, OutputIter result,
+           BinaryOperation op, std::false_type) {
     std::transform(first1, last1, first2, result, op);
   }
+
+  template <typename InputIter1, typename InputIter2, typename OutputIter,
+            typename BinaryOperation>
+  void Run(const platform::CPUDeviceContext& context, InputIter1 first1,
+           InputIter1 last1, InputIter2 first2, OutputIter result,
+           BinaryOperation op, std::true_type) {
+    context.ParallelFor(last1 - first1, kGrainSize,
+                        [&](int64_t begin, int64_t end) {
+                          std::transform(first1 + begin, first1 + end,
+                                         first2 + begin, result + begin, op);
+                        });
+  }
 };
 
 #ifdef __NVCC__
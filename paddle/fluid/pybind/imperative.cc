@@ -26,9 +26,12 @@ limitations under the License. */
 #include <vector>
 #include "paddle/fluid/imperative/backward_strategy.h"
 #include "paddle/fluid/imperative/data_loader.h"
+#include "paddle/fluid/imperative/gloo_context.h"
+#include "paddle/fluid/imperative/jit/program_replayer.h"
 #include "paddle/fluid/imperative/layer.h"
 #include "paddle/fluid/imperative/nccl_context.h"
 #include "paddle/fluid/imperative/profiler.h"
+#include "paddle/fluid/imperative/reducer.h"
 #include "paddle/fluid/imperative/tracer.h"
 #include "paddle/fluid/imperative/type_defs.h"
 #include "paddle/fluid/memory/allocation/mmap_allocator.h"
@@ -585,6 +588,39 @@ void BindImperative(py::module *m_ptr) {
            &imperative::jit::ProgramDescTracer::CreateProgramDesc)
       .def("reset", &imperative::jit::ProgramDescTracer::Reset);
 
+  py::class_<imperative::jit::ProgramReplayer>(m, "ProgramReplayer", "")
+      .def(py::init<const framework::ProgramDesc &,
+                    const std::vector<std::string> &,
+                    const std::vector<std::string> &,
+                    const std::vector<std::shared_ptr<imperative::VarBase>> &,
+                    const std::vector<std::string> &,
+                    const platform::CPUPlace &>())
+      .def(py::init<const framework::ProgramDesc &,
+                    const std::vector<std::string> &,
+                    const std::vector<std::string> &,
+                    const std::vector<std::shared_ptr<imperative::VarBase>> &,
+                    const std::vector<std::string> &,
+                    const platform::CUDAPlace &>())
+      .def("run",
+           [](imperative::jit::ProgramReplayer &self,
+              const std::vector<std::shared_ptr<imperative::VarBase>> &feeds)
+               -> py::object {
+             std::vector<std::shared_ptr<imperative::VarBase>> fetches;
+             bool replayed = false;
+             {
+               py::gil_scoped_release release;
+               replayed = self.Run(feeds, &fetches);
+             }
+             if (!replayed) {
+               return py::none();
+             }
+             return py::cast(fetches);
+           })
+      .def("is_replayable", &imperative::jit::ProgramReplayer::IsReplayable)
+      .def("is_same_trace", &imperative::jit::ProgramReplayer::IsSameTrace)
+      .def("program", &imperative::jit::ProgramReplayer::Program,
+           py::return_value_policy::reference_internal);
+
   py::class_<imperative::Tracer, std::shared_ptr<imperative::Tracer>>(
       m, "Tracer",
       R"DOC()DOC")
@@ -620,6 +656,11 @@ void BindImperative(py::module *m_ptr) {
       .def("_get_program_desc_tracer",
            &imperative::Tracer::GetProgramDescTracer,
            py::return_value_policy::reference)
+      .def("_set_reducer",
+           [](imperative::Tracer &self,
+              const std::shared_ptr<imperative::Reducer> &reducer) {
+             self.GetDefaultEngine()->SetReducer(reducer);
+           })
       .def("trace",
            [](imperative::Tracer &self, const std::string &type,
               const PyNameVarBaseMap &ins, const PyNameVarBaseMap &outs,
@@ -678,6 +719,34 @@ void BindImperative(py::module *m_ptr) {
                     },
                     [](imperative::ParallelStrategy &self,
                        const std::string &ep) { self.current_endpoint_ = ep; });
+  py::class_<imperative::ParallelContext,
+             std::shared_ptr<imperative::ParallelContext>>(m,
+                                                           "ParallelContext");
+
+  py::class_<imperative::Reducer, std::shared_ptr<imperative::Reducer>>(
+      m, "Reducer", "")
+      .def(py::init<const std::vector<std::shared_ptr<imperative::VarBase>> &,
+                    const std::shared_ptr<imperative::ParallelContext> &,
+                    size_t>())
+      .def("bucket_num", &imperative::Reducer::BucketNum);
+
+#if defined(PADDLE_WITH_GLOO) && !defined(_WIN32)
+  py::class_<imperative::GlooParallelContext, imperative::ParallelContext,
+             std::shared_ptr<imperative::GlooParallelContext>>(
+      m, "GlooParallelContext")
+      .def(py::init<const imperative::ParallelStrategy &,
+                    const std::string &>())
+      .def("init", [](imperative::GlooParallelContext &self) { self.Init(); })
+      .def("broadcast",
+           [](imperative::GlooParallelContext &self, imperative::VarBase &var,
+              int root) {
+             auto *tensor =
+                 var.MutableVar()->GetMutable<framework::LoDTensor>();
+             py::gil_scoped_release release;
+             self.Broadcast(tensor, root);
+           });
+#endif
+
 #if defined(PADDLE_WITH_NCCL)
   py::class_<imperative::NCCLParallelContext> nccl_ctx(m,
                                                        "NCCLParallelContext");
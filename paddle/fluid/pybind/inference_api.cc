@@ -401,6 +401,10 @@ void BindAnalysisConfig(py::module *m) {
       .def("disable_glog_info", &AnalysisConfig::DisableGlogInfo)
       .def("glog_info_disabled", &AnalysisConfig::glog_info_disabled)
       .def("set_optim_cache_dir", &AnalysisConfig::SetOptimCacheDir)
+      .def("enable_optim_program_cache",
+           &AnalysisConfig::EnableOptimProgramCache, py::arg("x") = true)
+      .def("optim_program_cache_enabled",
+           &AnalysisConfig::optim_program_cache_enabled)
       .def("switch_use_feed_fetch_ops", &AnalysisConfig::SwitchUseFeedFetchOps,
            py::arg("x") = true)
       .def("use_feed_fetch_ops_enabled",
@@ -431,6 +435,10 @@ void BindAnalysisConfig(py::module *m) {
       .def("set_mkldnn_op", &AnalysisConfig::SetMKLDNNOp)
       .def("set_model_buffer", &AnalysisConfig::SetModelBuffer)
       .def("model_from_memory", &AnalysisConfig::model_from_memory)
+      .def("enable_memory_map_params", &AnalysisConfig::EnableMemoryMapParams,
+           py::arg("x") = true)
+      .def("memory_map_params_enabled",
+           &AnalysisConfig::memory_map_params_enabled)
       .def("delete_pass",
            [](AnalysisConfig &self, const std::string &pass) {
              self.pass_builder()->DeletePass(pass);
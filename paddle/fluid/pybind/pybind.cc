@@ -22,6 +22,8 @@ limitations under the License. */
 #include <unordered_set>
 #include <utility>
 #include <vector>
+#include "paddle/fluid/framework/aligned_combine.h"
+#include "paddle/fluid/framework/async_checkpoint.h"
 #include "paddle/fluid/framework/executor.h"
 #include "paddle/fluid/framework/feed_fetch_method.h"
 #include "paddle/fluid/framework/feed_fetch_type.h"
@@ -368,6 +370,46 @@ PYBIND11_MODULE(core_noavx, m) {
           LoadStaticNameListFromDisk(str_file_name, vec_name_list, scope);
         });
 
+  m.def("_save_static_dict_sharded",
+        [](const std::string &str_dir_name, const py::handle &vec_var_list,
+           const Scope &scope, size_t shard_size, int num_threads,
+           bool incremental) {
+          std::vector<std::string> vec_name_list = GetNameList(vec_var_list);
+          SaveStaticNameListToShardedDir(str_dir_name, vec_name_list, scope,
+                                         shard_size, num_threads, incremental);
+        });
+
+  m.def("_load_static_dict_sharded",
+        [](const std::string &str_dir_name, const py::handle &vec_var_list,
+           const Scope &scope, const Executor *executor, int num_threads) {
+          std::vector<std::string> vec_name_list = GetNameList(vec_var_list);
+          CreateVariableIfNotExit(vec_var_list, scope, executor);
+          LoadStaticNameListFromShardedDir(str_dir_name, vec_name_list, scope,
+                                           num_threads);
+        });
+
+  py::class_<AsyncCheckpointHandle>(m, "AsyncCheckpointHandle")
+      .def("done", &AsyncCheckpointHandle::Done)
+      .def("wait", &AsyncCheckpointHandle::Wait,
+           py::call_guard<py::gil_scoped_release>());
+
+  m.def("_save_async_checkpoint",
+        [](const std::string &str_file_name, const py::handle &vec_var_list,
+           const Scope &scope) {
+          std::vector<std::string> vec_name_list = GetNameList(vec_var_list);
+          return AsyncCheckpointer::GetInstance()->Save(scope, vec_name_list,
+                                                        str_file_name);
+        });
+
+  m.def("_wait_async_checkpoints",
+        [] { AsyncCheckpointer::GetInstance()->WaitAll(); },
+        py::call_guard<py::gil_scoped_release>());
+
+  m.def("_convert_to_aligned_combine",
+        [](const std::string &src_path, const std::string &dst_path) {
+          return ConvertToAlignedCombineFile(src_path, dst_path);
+        });
+
   m.def("_create_loaded_parameter",
         [](const py::handle &vec_var_list, const Scope &scope,
            const Executor *executor) {
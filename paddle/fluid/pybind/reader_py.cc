@@ -13,6 +13,7 @@
 // limitations under the License.
 
 #include "paddle/fluid/pybind/reader_py.h"
+#include <algorithm>
 #include <exception>
 #include <memory>
 #include <string>
@@ -25,7 +26,9 @@
 #include "paddle/fluid/imperative/layer.h"
 #include "paddle/fluid/imperative/tracer.h"
 #include "paddle/fluid/operators/reader/buffered_reader.h"
+#include "paddle/fluid/operators/reader/pipeline_reader.h"
 #include "paddle/fluid/operators/reader/py_reader.h"
+#include "paddle/fluid/operators/reader/shuffle_reader.h"
 #include "paddle/fluid/platform/place.h"
 #include "pybind11/stl.h"
 
@@ -46,7 +49,11 @@ class MultiDeviceFeedReader {
       const std::vector<std::vector<int>> &shapes,
       const std::vector<framework::proto::VarType::Type> &dtypes,
       const std::vector<bool> &need_check_feed,
-      const std::vector<platform::Place> &dst_places, bool use_double_buffer)
+      const std::vector<platform::Place> &dst_places, bool use_double_buffer,
+      size_t batch_size, const std::vector<int> &lod_levels, bool drop_last,
+      size_t batch_threads, size_t max_batch_tokens, size_t bucket_size,
+      size_t shuffle_buffer_size, uint64_t shuffle_seed, size_t num_shards,
+      size_t shard_id)
       : queue_(queue),
         names_(names),
         pool_(new ::ThreadPool(dst_places.size())) {
@@ -56,6 +63,28 @@ class MultiDeviceFeedReader {
     }
     std::shared_ptr<framework::ReaderBase> reader(
         new operators::reader::PyReader(queue, dims, dtypes, need_check_feed));
+    if (shuffle_buffer_size > 0 || num_shards > 1) {
+      reader = framework::MakeDecoratedReader<operators::reader::ShuffleReader>(
+          reader, std::max<size_t>(shuffle_buffer_size, 1), shuffle_seed,
+          num_shards, shard_id);
+    }
+    if (batch_size > 0) {
+      // The queue gives samples, which are batched by the pipeline.
+      operators::reader::PipelineReader::BatchConfig batch_config;
+      batch_config.batch_size = batch_size;
+      batch_config.lod_levels = lod_levels;
+      batch_config.drop_last = drop_last;
+      batch_config.num_threads = batch_threads;
+      batch_config.max_batch_tokens = max_batch_tokens;
+      batch_config.bucket_size = bucket_size;
+      pipeline_ = std::static_pointer_cast<operators::reader::PipelineReader>(
+          framework::MakeDecoratedReader<operators::reader::PipelineReader>(
+              reader, batch_config,
+              std::vector<
+                  operators::reader::PipelineReader::TransformConfig>(),
+              2 * dst_places.size() + 2));
+      reader = pipeline_;
+    }
 
     readers_.reserve(dst_places.size());
     for (auto &p : dst_places) {
@@ -109,6 +138,11 @@ class MultiDeviceFeedReader {
     ReadAsync();
   }
 
+  std::vector<operators::reader::PipelineStageStat> PipelineStats() const {
+    if (pipeline_ == nullptr) return {};
+    return pipeline_->Stats();
+  }
+
   ~MultiDeviceFeedReader() {
     queue_->Close();
     pool_.reset();
@@ -187,6 +221,7 @@ class MultiDeviceFeedReader {
   std::vector<std::string> names_;
   std::unique_ptr<::ThreadPool> pool_;
 
+  std::shared_ptr<operators::reader::PipelineReader> pipeline_;
   std::vector<std::unique_ptr<framework::ReaderHolder>> readers_;
 
   std::vector<std::future<Status>> futures_;
@@ -235,7 +270,17 @@ void BindReader(py::module *module) {
            },
            py::call_guard<py::gil_scoped_release>())
       .def("reset", &MultiDeviceFeedReader::Reset,
-           py::call_guard<py::gil_scoped_release>());
+           py::call_guard<py::gil_scoped_release>())
+      .def("pipeline_stats", &MultiDeviceFeedReader::PipelineStats);
+
+  py::class_<reader::PipelineStageStat>(m, "ReaderPipelineStageStat", "")
+      .def_readonly("name", &reader::PipelineStageStat::name)
+      .def_readonly("num_threads", &reader::PipelineStageStat::num_threads)
+      .def_readonly("capacity", &reader::PipelineStageStat::capacity)
+      .def_readonly("depth", &reader::PipelineStageStat::depth)
+      .def_readonly("mean_depth", &reader::PipelineStageStat::mean_depth)
+      .def_readonly("num_items", &reader::PipelineStageStat::num_items)
+      .def_readonly("num_starved", &reader::PipelineStageStat::num_starved);
 
   m.def("create_py_reader",
         [](const std::shared_ptr<operators::reader::LoDTensorBlockingQueue>
@@ -245,11 +290,25 @@ void BindReader(py::module *module) {
            const std::vector<framework::proto::VarType::Type> &dtypes,
            const std::vector<bool> &need_check_feed,
            const std::vector<platform::Place> &dst_places,
-           bool use_double_buffer) {
-          return new MultiDeviceFeedReader(queue, names, shapes, dtypes,
-                                           need_check_feed, dst_places,
-                                           use_double_buffer);
+           bool use_double_buffer, size_t batch_size,
+           const std::vector<int> &lod_levels, bool drop_last,
+           size_t batch_threads, size_t max_batch_tokens,
+           size_t bucket_size, size_t shuffle_buffer_size,
+           uint64_t shuffle_seed, size_t num_shards, size_t shard_id) {
+          return new MultiDeviceFeedReader(
+              queue, names, shapes, dtypes, need_check_feed, dst_places,
+              use_double_buffer, batch_size, lod_levels, drop_last,
+              batch_threads, max_batch_tokens, bucket_size,
+              shuffle_buffer_size, shuffle_seed, num_shards, shard_id);
         },
+        py::arg("queue"), py::arg("names"), py::arg("shapes"),
+        py::arg("dtypes"), py::arg("need_check_feed"), py::arg("dst_places"),
+        py::arg("use_double_buffer"), py::arg("batch_size") = 0,
+        py::arg("lod_levels") = std::vector<int>(), py::arg("drop_last") = true,
+        py::arg("batch_threads") = 1, py::arg("max_batch_tokens") = 0,
+        py::arg("bucket_size") = 0, py::arg("shuffle_buffer_size") = 0,
+        py::arg("shuffle_seed") = 0, py::arg("num_shards") = 1,
+        py::arg("shard_id") = 0,
         py::return_value_policy::take_ownership);
 }
 
@@ -174,7 +174,10 @@ def __bootstrap__():
         'enable_parallel_graph', 'fuse_parameter_groups_size',
         'multiple_of_cupti_buffer_size', 'fuse_parameter_memory_size',
         'tracer_profile_fname', 'dygraph_debug', 'use_system_allocator',
-        'enable_unused_var_check', 'free_idle_chunk', 'free_when_no_cache_hit'
+        'enable_unused_var_check', 'free_idle_chunk', 'free_when_no_cache_hit',
+        'tensor_stream_compression', 'tensor_stream_compression_min_bytes',
+        'cache_sub_block_context', 'dygraph_dispatch_cache',
+        'dygraph_backward_threads', 'cpu_reduce_threads'
     ]
     if 'Darwin' not in sysstr:
         read_env_flags.append('use_pinned_memory')
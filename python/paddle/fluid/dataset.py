@@ -154,6 +154,32 @@ class DatasetBase(object):
         """
         self.proto_desc.batch_size = batch_size
 
+    def set_max_batch_feasigns(self, max_batch_feasigns, length_bucket_size=0):
+        """
+        Set the feasign budget of a batch, only for InMemoryDataset. A batch
+        is closed before batch_size instances if the next instance would
+        make its feasigns exceed max_batch_feasigns. With length_bucket_size
+        greater than 1, the instances are taken length_bucket_size at a time
+        and sorted by their feasigns before batching, which reduces the
+        padding of sequence_pad.
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              dataset.set_batch_size(1024)
+              dataset.set_max_batch_feasigns(20000, length_bucket_size=4096)
+
+        Args:
+            max_batch_feasigns(int): max feasigns of a batch, 0 for no limit
+            length_bucket_size(int): num of instances sorted by their
+                                     feasigns before batching. Default is 0.
+
+        """
+        self.proto_desc.max_batch_feasigns = max_batch_feasigns
+        self.proto_desc.length_bucket_size = length_bucket_size
+
     def set_thread(self, thread_num):
         """
         Set thread num, it is the num of readers.
@@ -310,6 +336,9 @@ class InMemoryDataset(DatasetBase):
         self.parse_content = False
         self.merge_by_lineid = False
         self.fleet_send_sleep_seconds = None
+        self.streaming_global_shuffle = False
+        self.streaming_fleet = None
+        self.streaming_thread_num = None
 
     def _prepare_to_run(self):
         """
@@ -424,6 +453,54 @@ class InMemoryDataset(DatasetBase):
         """
         self.fleet_send_sleep_seconds = fleet_send_sleep_seconds
 
+    def set_streaming_global_shuffle(self, fleet=None, thread_num=12):
+        """
+        Send the data to other trainers while loading it into memory,
+        instead of after loading in global_shuffle, so that the loading and
+        the shuffling overlap. The sending is throttled by the receivers
+        instead of fleet_send_sleep_seconds. global_shuffle should still be
+        called after loading to wait for the data from other trainers.
+
+        Args:
+            fleet(Fleet): fleet singleton. Default None.
+            thread_num(int): shuffle thread num. Default is 12.
+
+        Examples:
+            .. code-block:: python
+
+              import paddle.fluid as fluid
+              from paddle.fluid.incubate.fleet.parameter_server.pslib import fleet
+              dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+              filelist = ["a.txt", "b.txt"]
+              dataset.set_filelist(filelist)
+              dataset.set_streaming_global_shuffle(fleet)
+              dataset.load_into_memory()
+              dataset.global_shuffle(fleet)
+
+        """
+        self.streaming_global_shuffle = True
+        self.streaming_fleet = fleet
+        self.streaming_thread_num = thread_num
+
+    def _prepare_streaming_global_shuffle(self):
+        """
+        Register the message handler of every trainer before any of them
+        starts sending, user no need to call this function.
+        """
+        fleet = self.streaming_fleet
+        trainer_num = 1
+        if fleet is not None:
+            trainer_num = fleet.worker_num()
+        if self.fleet_send_batch_size is None:
+            self.fleet_send_batch_size = 1024
+        self.dataset.set_trainer_num(trainer_num)
+        self.dataset.set_fleet_send_batch_size(self.fleet_send_batch_size)
+        self.dataset.set_streaming_global_shuffle(True,
+                                                  self.streaming_thread_num)
+        self.dataset.register_client2client_msg_handler()
+        if fleet is not None:
+            fleet._role_maker.barrier_worker()
+
     def set_merge_by_lineid(self, merge_size=2):
         """
         Set merge by line id, instances of same line id will be merged after
@@ -468,6 +545,8 @@ class InMemoryDataset(DatasetBase):
               dataset.load_into_memory()
         """
         self._prepare_to_run()
+        if self.streaming_global_shuffle:
+            self._prepare_streaming_global_shuffle()
         self.dataset.load_into_memory()
 
     def preload_into_memory(self, thread_num=None):
@@ -488,6 +567,8 @@ class InMemoryDataset(DatasetBase):
               dataset.wait_preload_done()
         """
         self._prepare_to_run()
+        if self.streaming_global_shuffle:
+            self._prepare_streaming_global_shuffle()
         if thread_num is None:
             thread_num = self.thread_num
         self.dataset.set_preload_thread_num(thread_num)
@@ -550,6 +631,19 @@ class InMemoryDataset(DatasetBase):
             thread_num(int): shuffle thread num. Default is 12.
 
         """
+        if self.streaming_global_shuffle:
+            # the data has been sent while loading, waits for all trainers
+            # to finish sending, then for the data received
+            if fleet is not None:
+                fleet._role_maker.barrier_worker()
+            self.dataset.global_shuffle(thread_num)
+            if fleet is not None:
+                fleet._role_maker.barrier_worker()
+            if self.merge_by_lineid:
+                self.dataset.merge_by_lineid()
+            if fleet is not None:
+                fleet._role_maker.barrier_worker()
+            return
         trainer_num = 1
         if fleet is not None:
             fleet._role_maker.barrier_worker()
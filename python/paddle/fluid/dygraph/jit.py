@@ -14,7 +14,10 @@
 
 from __future__ import print_function
 
-__all__ = ['TracedLayer', 'dygraph_to_static_output', 'dygraph_to_static_graph']
+__all__ = [
+    'TracedLayer', 'TracedStep', 'dygraph_to_static_output',
+    'dygraph_to_static_graph'
+]
 
 import warnings
 
@@ -385,3 +388,94 @@ class TracedLayer(object):
                 target_vars=target_vars,
                 executor=self._exe,
                 main_program=self._program.clone())
+
+
+class TracedStep(object):
+    """
+    TracedStep runs a dygraph step, e.g. the forward, backward and
+    optimization of a training iteration, by tracing it once and replaying
+    the traced program with the static graph executor in the later calls.
+    The replay skips the tracing and the kernel dispatching of dygraph and
+    runs the IR passes given by :code:`passes` on the traced program.
+
+    The step is run by dygraph when the shapes or data types of the inputs
+    differ from the traced ones. Since the control flow of Python cannot be
+    seen by the replay, the step is traced again every :code:`check_interval`
+    calls, and the new trace is replayed from then on when it differs from
+    the old one. Only the outputs and the parameters are
+    updated by a replay, the gradients of the parameters are not.
+
+    Args:
+        step_func (callable): the dygraph step to run, whose inputs and
+            outputs are Variables.
+        passes (list(str), optional): the IR passes applied to the traced
+            program. Default None.
+        check_interval (int, optional): the number of calls after which the
+            step is traced again. No check is done if it is 0. Default 100.
+
+    Examples:
+        .. code-block:: python:
+
+            import paddle.fluid as fluid
+            from paddle.fluid.dygraph import Linear, to_variable, TracedStep
+            import numpy as np
+
+            with fluid.dygraph.guard():
+                fc = Linear(3, 10)
+                sgd = fluid.optimizer.SGD(learning_rate=0.01,
+                                          parameter_list=fc.parameters())
+
+                def train_step(x):
+                    loss = fluid.layers.reduce_mean(fc(x))
+                    loss.backward()
+                    sgd.minimize(loss)
+                    fc.clear_gradients()
+                    return loss
+
+                step = TracedStep(train_step)
+                for i in range(10):
+                    x = to_variable(np.random.random([2, 3]).astype('float32'))
+                    loss = step(x)
+    """
+
+    def __init__(self, step_func, passes=None, check_interval=100):
+        assert callable(step_func), "step_func should be callable"
+        self._step_func = step_func
+        self._passes = list(passes) if passes is not None else []
+        self._check_interval = check_interval
+        self._replayer = None
+        self._num_calls = 0
+        self._single_output = False
+
+    def _trace_and_run(self, inputs, feed_vars):
+        tracer = _dygraph_tracer()._get_program_desc_tracer()
+        with program_desc_tracing_guard(True):
+            outputs = self._step_func(*inputs)
+            self._single_output = not isinstance(outputs, (list, tuple))
+            fetch_vars = [outputs] if self._single_output else list(outputs)
+            program_desc, feed_names, fetch_names, persistables = \
+                tracer.create_program_desc(feed_vars, 'feed_', fetch_vars,
+                                           'fetch_', 't_')
+            tracer.reset()
+
+        if self._replayer is None or \
+                not self._replayer.is_same_trace(program_desc):
+            self._replayer = core.ProgramReplayer(
+                program_desc, feed_names, fetch_names, persistables,
+                self._passes, _current_expected_place())
+        self._num_calls = 0
+        return outputs
+
+    @dygraph_only
+    def __call__(self, *inputs):
+        feed_vars = extract_vars(inputs)
+        if self._replayer is None or (self._check_interval > 0 and
+                                      self._num_calls >= self._check_interval):
+            return self._trace_and_run(inputs, feed_vars)
+
+        self._num_calls += 1
+        outputs = self._replayer.run(feed_vars)
+        if outputs is None:
+            # The inputs differ from the traced ones.
+            return self._step_func(*inputs)
+        return outputs[0] if self._single_output else outputs
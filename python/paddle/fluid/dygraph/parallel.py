@@ -44,6 +44,14 @@ def prepare_context(strategy=None):
     if isinstance(place, core.CUDAPlace):
         parallel_helper._set_parallel_ctx(
             core.NCCLParallelContext(strategy, place))
+    elif isinstance(place, core.CPUPlace) and hasattr(core,
+                                                      'GlooParallelContext'):
+        store_path = os.getenv("PADDLE_GLOO_STORE_PATH", "")
+        assert store_path, \
+            "PADDLE_GLOO_STORE_PATH should be set to a directory shared by " \
+            "all the trainers to run data parallel on CPU."
+        parallel_helper._set_parallel_ctx(
+            core.GlooParallelContext(strategy, store_path))
     else:
         # TODO(Yancey1989): add Gloo Parallel Context to support CPU parallel computation
         assert ("Only support CUDAPlace for now.")
@@ -129,23 +137,63 @@ class DataParallel(layers.Layer):
                adam.minimize(avg_loss)
                linear.clear_gradients()
 
+    On CPU, the context is prepared by gloo, whose trainers meet by the files
+    in the directory given by the environment variable PADDLE_GLOO_STORE_PATH.
+    The gradients are coalesced into buckets of about :code:`comm_buffer_size`
+    MB and all-reduced during the backward, as soon as a bucket is computed,
+    so :code:`apply_collective_grads` only ends the step there, which detaches
+    the gradient buckets of this module from the backward.
+
     Args:
         layers(Layer): The module that should be executed by data parallel.
         strategy(ParallelStrategy): The strategy of data parallelism.
+        comm_buffer_size(float, optional): The size in MB of the gradient
+            buckets all-reduced during the backward on CPU. Default 25.
 
     Returns:
         Layer: The data paralleled module.
     """
 
-    def __init__(self, layers, strategy):
+    def __init__(self, layers, strategy, comm_buffer_size=25):
         super(DataParallel,
               self).__init__(layers.full_name() + "_data_parallel")
 
         self._layers = layers
         self._strategy = strategy
+        self._comm_buffer_size = comm_buffer_size
+        self._reducer = None
+        self._reducer_attached = False
+
+    def __del__(self):
+        self._detach_reducer()
 
     def forward(self, *inputs, **kwargs):
-        return self._layers(*inputs, **kwargs)
+        outputs = self._layers(*inputs, **kwargs)
+        # The parameters of some layers are created by their first run.
+        if self._reducer is None and self._is_data_parallel_mode() and \
+                parallel_helper._is_gloo_parallel_ctx():
+            self._init_reducer()
+        # The reducer only serves the backward of this step, and is detached
+        # by apply_collective_grads.
+        if self._reducer is not None:
+            framework._dygraph_tracer()._set_reducer(self._reducer)
+            self._reducer_attached = True
+        return outputs
+
+    def _init_reducer(self):
+        params = [p for p in self._layers.parameters() if p.trainable]
+        self._reducer = core.Reducer(
+            params,
+            parallel_helper._get_parallel_ctx(),
+            int(self._comm_buffer_size * 1024 * 1024))
+
+    def _detach_reducer(self):
+        if not self.__dict__.get("_reducer_attached", False):
+            return
+        tracer = framework._dygraph_tracer()
+        if tracer is not None:
+            tracer._set_reducer(None)
+        self._reducer_attached = False
 
     def scale_loss(self, loss):
         """
@@ -214,6 +262,10 @@ class DataParallel(layers.Layer):
         """
         if not self._is_data_parallel_mode():
             return
+        # The gradients are all-reduced by the reducer during backward.
+        if self._reducer is not None:
+            self._detach_reducer()
+            return
 
         grad_var_set = set()
         grad_vars = []
@@ -12,6 +12,7 @@
 # See the License for the specific language governing permissions and
 # limitations under the License.
 import os
+from .. import core
 from ..layers import collective
 from ..framework import Parameter
 __parallel_ctx__clz__ = None
@@ -30,6 +31,17 @@ def _set_parallel_ctx(nccl_parallel_context):
     __parallel_ctx__clz__ = nccl_parallel_context
 
 
+def _get_parallel_ctx():
+    global __parallel_ctx__clz__
+    return __parallel_ctx__clz__
+
+
+def _is_gloo_parallel_ctx():
+    global __parallel_ctx__clz__
+    return hasattr(core, 'GlooParallelContext') and isinstance(
+        __parallel_ctx__clz__, core.GlooParallelContext)
+
+
 def _init_parallel_ctx():
     global __parallel_ctx__clz__
     assert __parallel_ctx__clz__ is not None, \
@@ -38,6 +50,12 @@ def _init_parallel_ctx():
 
 
 def _broadcast_parameters(parameters):
+    if _is_gloo_parallel_ctx():
+        for param in parameters:
+            if isinstance(param, Parameter) and param.trainable:
+                __parallel_ctx__clz__.broadcast(param, 0)
+        return
+
     for param in parameters:
         if isinstance(param, Parameter) and param.trainable:
             collective._broadcast(param, 0, sync_mode=True)
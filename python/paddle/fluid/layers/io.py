@@ -33,7 +33,7 @@ from ..transpiler.distribute_transpiler import DistributedMode
 import logging
 
 __all__ = [
-    'data', 'read_file', 'double_buffer', 'py_reader',
+    'data', 'read_file', 'double_buffer', 'shuffle', 'py_reader',
     'create_py_reader_by_data', 'load'
 ]
 
@@ -855,6 +855,53 @@ def double_buffer(reader, place=None, name=None):
         'create_double_buffer_reader', reader, attrs, name=name)
 
 
+def shuffle(reader, buffer_size, seed=0, num_shards=1, shard_id=0, name=None):
+    """
+    Wrap a shuffle reader, which shuffles the data of the underlying reader
+    in C++ by a buffer of :attr:`buffer_size` items. An item is read out at
+    random from the buffer, which is then refilled by the next item of the
+    underlying reader. The order only depends on :attr:`seed` and on how many
+    times the reader has been started, so it is reproducible, and every pass
+    is shuffled differently.
+
+    With :attr:`num_shards` greater than 1, the i-th item of the underlying
+    reader is read only if :code:`i % num_shards == shard_id`, so trainers
+    reading the same data with their trainer id as :attr:`shard_id` get
+    disjoint items.
+
+    Args:
+        reader (Variable): The Reader Variable need to be wrapped.
+        buffer_size (int): The number of items in the shuffle buffer.
+        seed (int, optional): The random seed. Default is 0.
+        num_shards (int, optional): The number of shards. Default is 1.
+        shard_id (int, optional): The shard to read. Default is 0.
+        name (str, optional): Variable name. Normally there is no need for user to set this property. For more information, please refer to :ref:`api_guide_Name`. Default is None.
+
+    Returns:
+        Variable(Reader): wrapped reader with a shuffle buffer.
+
+    Examples:
+        ..  code-block:: python
+
+            import paddle.fluid as fluid
+            reader = fluid.layers.py_reader(capacity=64,
+                                            shapes=[(-1, 1, 28, 28), (-1, 1)],
+                                            dtypes=['float32', 'int64'],
+                                            use_double_buffer=False)
+            reader = fluid.layers.shuffle(reader, buffer_size=16, seed=1)
+            reader = fluid.layers.double_buffer(reader)
+            image, label = fluid.layers.read_file(reader)
+    """
+    attrs = {
+        'buffer_size': int(buffer_size),
+        'seed': int(seed),
+        'num_shards': int(num_shards),
+        'shard_id': int(shard_id)
+    }
+    return __create_unshared_decorated_reader__(
+        'create_shuffle_reader', reader, attrs, name=name)
+
+
 def read_file(reader):
     """
     Execute the given reader and get data via it.
@@ -20,7 +20,7 @@ import threading
 import paddle
 from .framework import Program, Variable, program_guard, default_main_program, default_startup_program, in_dygraph_mode, cpu_places
 from .executor import global_scope
-from .data_feeder import DataFeeder, BatchedTensorProvider
+from .data_feeder import DataFeeder, BatchedTensorProvider, convert_dtype
 from .layers.io import monkey_patch_reader_methods, _copy_reader_var_, double_buffer
 from .unique_name import UniqueNameGenerator
 import logging
@@ -735,6 +735,17 @@ class GeneratorLoader(DataLoaderBase):
             raise Exception("Feed list must be given under static mode.")
         self._use_double_buffer = use_double_buffer
         self._capacity = capacity
+        # The samples are batched by the C++ reader when _batch_size > 0
+        self._batch_size = 0
+        self._drop_last = True
+        self._max_batch_tokens = 0
+        self._bucket_size = 0
+        # The data is shuffled and sharded by the C++ reader when
+        # _shuffle_buffer_size > 0 or _num_shards > 1
+        self._shuffle_buffer_size = 0
+        self._shuffle_seed = 0
+        self._num_shards = 1
+        self._shard_id = 0
         if not self._iterable:
             self._init_non_iterable()
 
@@ -754,11 +765,28 @@ class GeneratorLoader(DataLoaderBase):
         self._need_check_feed = [
             v.desc.need_check_feed() for v in self._feed_list
         ]
+        # The queue holds samples instead of batches when batching in C++
+        capacity = self._capacity * max(self._batch_size, 1)
         self._queue = core.init_lod_tensor_blocking_queue(core.Variable(),
-                                                          self._capacity)
+                                                          capacity)
         self._reader = core.create_py_reader(
-            self.queue, self._var_names, self._shapes, self._dtypes,
-            self._need_check_feed, self._places, self._use_double_buffer)
+            self.queue,
+            self._var_names,
+            self._shapes,
+            self._dtypes,
+            self._need_check_feed,
+            self._places,
+            self._use_double_buffer,
+            batch_size=self._batch_size,
+            lod_levels=[v.lod_level for v in self._feed_list],
+            drop_last=self._drop_last,
+            batch_threads=len(self._places),
+            max_batch_tokens=self._max_batch_tokens,
+            bucket_size=self._bucket_size,
+            shuffle_buffer_size=self._shuffle_buffer_size,
+            shuffle_seed=self._shuffle_seed,
+            num_shards=self._num_shards,
+            shard_id=self._shard_id)
 
     def _init_non_iterable(self):
         lod_levels = []
@@ -921,7 +949,14 @@ class GeneratorLoader(DataLoaderBase):
                 has_lod = True
                 break
 
-        if has_lod:
+        if has_lod and self._can_batch_in_cpp():
+            # The lod of the batches is built by the C++ reader, which is much
+            # faster than DataFeeder.
+            self.set_batch_generator(
+                self._sample_tensor_reader(reader), places=places)
+            self._batch_size = batch_size
+            self._drop_last = drop_last
+        elif has_lod:
             self.set_sample_list_generator(
                 paddle.batch(
                     reader, batch_size=batch_size, drop_last=drop_last),
@@ -936,6 +971,33 @@ class GeneratorLoader(DataLoaderBase):
             self.set_batch_generator(reader, places=places)
         return self
 
+    def _can_batch_in_cpp(self):
+        if not self._iterable:
+            return False
+        for f in self._feed_list:
+            unknown_dims = len([s for s in f.shape[1:] if s is None or s < 0])
+            if f.lod_level > 1 or unknown_dims > 1 - f.lod_level:
+                return False
+        return True
+
+    def _sample_tensor_reader(self, reader):
+        shapes = []
+        for f in self._feed_list:
+            shape = [-1 if s is None else s for s in f.shape[1:]]
+            # The sequence of a sample is the rows of its tensor
+            shapes.append([-1] + shape if f.lod_level == 1 else shape)
+        dtypes = [convert_dtype(f.dtype) for f in self._feed_list]
+
+        def __impl__():
+            for sample in reader():
+                yield [
+                    np.array(
+                        field, dtype=dtype).reshape(shape)
+                    for field, dtype, shape in zip(sample, dtypes, shapes)
+                ]
+
+        return __impl__
+
     def set_sample_list_generator(self, reader, places=None):
         with program_guard(Program(), Program()):
             feeder = DataFeeder(
@@ -951,6 +1013,7 @@ class GeneratorLoader(DataLoaderBase):
 
     def set_batch_generator(self, reader, places=None):
         self._tensor_reader = reader
+        self._batch_size = 0
         if self._iterable:
             assert places is not None, "Places cannot be None when DataLoader is iterable"
             self._places = _convert_places(places)
@@ -960,6 +1023,54 @@ class GeneratorLoader(DataLoaderBase):
                     'places would be ommited when DataLoader is not iterable')
         return self
 
+    def set_token_budget(self, max_batch_tokens, bucket_size=0):
+        """
+        Batch the samples by their tokens, i.e. the lengths of the sequences
+        of the lod_level 1 feed variables. A batch is closed before
+        batch_size samples if the next sample would make its tokens exceed
+        max_batch_tokens. With bucket_size > 1, bucket_size samples are read
+        at a time and sorted by their tokens before batching, so that a batch
+        has sequences of close lengths and less padding.
+
+        It takes effect only when the samples are batched in C++, i.e. for
+        the iterable DataLoader set by set_sample_generator with lod_level 1
+        feed variables.
+        """
+        assert max_batch_tokens >= 0, "max_batch_tokens should not be negative"
+        assert bucket_size >= 0, "bucket_size should not be negative"
+        self._max_batch_tokens = int(max_batch_tokens)
+        self._bucket_size = int(bucket_size)
+        return self
+
+    def set_shuffle_buffer(self,
+                           buffer_size,
+                           seed=0,
+                           num_shards=1,
+                           shard_id=0):
+        """
+        Shuffle the data in C++ by a buffer of buffer_size items, which are
+        samples when the samples are batched in C++ by set_sample_generator,
+        or batches otherwise. The order only depends on seed and the number
+        of passes, so it is reproducible.
+
+        With num_shards > 1, only the i-th items with
+        i % num_shards == shard_id are read, so trainers reading the same
+        data with their trainer id as shard_id read disjoint items.
+
+        Only the iterable DataLoader is supported, use
+        fluid.layers.shuffle for the non-iterable one.
+        """
+        assert self._iterable, \
+            "set_shuffle_buffer only supports iterable DataLoader"
+        assert buffer_size >= 0, "buffer_size should not be negative"
+        assert 0 <= shard_id < num_shards, \
+            "shard_id should be in [0, num_shards)"
+        self._shuffle_buffer_size = int(buffer_size)
+        self._shuffle_seed = int(seed)
+        self._num_shards = int(num_shards)
+        self._shard_id = int(shard_id)
+        return self
+
 
 class PyReader(DataLoaderBase):
     """
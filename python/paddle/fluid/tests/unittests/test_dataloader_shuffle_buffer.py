@@ -0,0 +1,102 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import paddle
+import paddle.fluid as fluid
+import numpy as np
+import os
+import unittest
+
+os.environ['CPU_NUM'] = '1'
+
+
+def id_reader(sample_num):
+    def __impl__():
+        for i in range(sample_num):
+            yield np.array([[i]]).astype('int64'),
+
+    return __impl__
+
+
+class TestDataLoaderShuffleBuffer(unittest.TestCase):
+    def setUp(self):
+        self.sample_num = 20000
+        self.batch_size = 100
+        self.buffer_size = 1000
+
+    def create_loader(self, reader):
+        # The samples with lod are batched by the C++ reader, so the C++
+        # shuffle buffer shuffles the samples instead of the batches.
+        x = fluid.data(name='x', shape=[None, 1], dtype='int64', lod_level=1)
+        loader = fluid.io.DataLoader.from_generator(
+            feed_list=[x], capacity=16, iterable=True)
+        loader.set_sample_generator(
+            reader, self.batch_size, drop_last=False, places=fluid.cpu_places())
+        return loader
+
+    def read_ids(self, loader):
+        ids = []
+        for data in loader():
+            ids.extend(np.array(data[0]['x']).flatten().tolist())
+        return ids
+
+    def test_shuffle(self):
+        with fluid.program_guard(fluid.Program(), fluid.Program()):
+            loader = self.create_loader(id_reader(self.sample_num))
+            loader.set_shuffle_buffer(self.buffer_size, seed=10)
+            first = self.read_ids(loader)
+            second = self.read_ids(loader)
+            self.assertEqual(sorted(first), list(range(self.sample_num)))
+            self.assertNotEqual(first, sorted(first))
+            self.assertEqual(sorted(second), sorted(first))
+            self.assertNotEqual(second, first)
+
+            same_seed = self.create_loader(id_reader(self.sample_num))
+            same_seed.set_shuffle_buffer(self.buffer_size, seed=10)
+            self.assertEqual(self.read_ids(same_seed), first)
+
+    def test_shard(self):
+        num_shards = 3
+        all_ids = []
+        with fluid.program_guard(fluid.Program(), fluid.Program()):
+            for shard_id in range(num_shards):
+                loader = self.create_loader(id_reader(self.sample_num))
+                loader.set_shuffle_buffer(
+                    self.buffer_size,
+                    num_shards=num_shards,
+                    shard_id=shard_id)
+                ids = self.read_ids(loader)
+                for i in ids:
+                    self.assertEqual(i % num_shards, shard_id)
+                all_ids.extend(ids)
+        self.assertEqual(sorted(all_ids), list(range(self.sample_num)))
+
+    def test_same_samples_as_python_shuffle(self):
+        # The C++ shuffle buffer gives the same samples as paddle.reader.shuffle
+        # in the Python generator, both batched by the C++ reader.
+        with fluid.program_guard(fluid.Program(), fluid.Program()):
+            native = self.create_loader(id_reader(self.sample_num))
+            native.set_shuffle_buffer(self.buffer_size)
+            python = self.create_loader(
+                paddle.reader.shuffle(
+                    id_reader(self.sample_num), self.buffer_size))
+            native_ids = self.read_ids(native)
+            python_ids = self.read_ids(python)
+            self.assertEqual(len(native_ids), self.sample_num)
+            self.assertEqual(sorted(native_ids), sorted(python_ids))
+
+if __name__ == '__main__':
+    unittest.main()
@@ -256,6 +256,44 @@ class TestDataset(unittest.TestCase):
         os.remove("./test_in_memory_dataset_run_a.txt")
         os.remove("./test_in_memory_dataset_run_b.txt")
 
+    def test_in_memory_dataset_streaming_global_shuffle(self):
+        """
+        Testcase for InMemoryDataset with streaming global shuffle.
+        """
+        with open("test_streaming_global_shuffle_a.txt", "w") as f:
+            data = "1 1 2 3 3 4 5 5 5 5 1 1\n"
+            data += "1 2 2 3 4 4 6 6 6 6 1 2\n"
+            data += "1 3 2 3 5 4 7 7 7 7 1 3\n"
+            f.write(data)
+        with open("test_streaming_global_shuffle_b.txt", "w") as f:
+            data = "1 4 2 3 3 4 5 5 5 5 1 4\n"
+            data += "1 5 2 3 4 4 6 6 6 6 1 5\n"
+            f.write(data)
+
+        slots = ["slot1", "slot2", "slot3", "slot4"]
+        slots_vars = []
+        for slot in slots:
+            var = fluid.layers.data(
+                name=slot, shape=[1], dtype="int64", lod_level=1)
+            slots_vars.append(var)
+
+        dataset = fluid.DatasetFactory().create_dataset("InMemoryDataset")
+        dataset.set_batch_size(32)
+        dataset.set_thread(2)
+        dataset.set_filelist([
+            "test_streaming_global_shuffle_a.txt",
+            "test_streaming_global_shuffle_b.txt"
+        ])
+        dataset.set_pipe_command("cat")
+        dataset.set_use_var(slots_vars)
+        dataset.set_streaming_global_shuffle(thread_num=2)
+        dataset.load_into_memory()
+        dataset.global_shuffle()
+        self.assertEqual(dataset.get_shuffle_data_size(), 5)
+
+        os.remove("./test_streaming_global_shuffle_a.txt")
+        os.remove("./test_streaming_global_shuffle_b.txt")
+
     def test_in_memory_dataset_masterpatch(self):
         """
         Testcase for InMemoryDataset from create to run.
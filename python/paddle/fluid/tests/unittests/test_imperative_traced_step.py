@@ -0,0 +1,100 @@
+# Copyright (c) 2020 PaddlePaddle Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+from __future__ import print_function
+
+import unittest
+import paddle.fluid as fluid
+from paddle.fluid.dygraph import Linear, TracedStep, to_variable
+import numpy as np
+import six
+
+
+class MLP(fluid.dygraph.Layer):
+    def __init__(self, input_size, hidden_size):
+        super(MLP, self).__init__()
+        self._fc1 = Linear(input_size, hidden_size, act='relu')
+        self._fc2 = Linear(hidden_size, 1)
+
+    def forward(self, x):
+        return self._fc2(self._fc1(x))
+
+
+class TestTracedStep(unittest.TestCase):
+    def setUp(self):
+        self.input_size = 4
+        self.hidden_size = 8
+        self.learning_rate = 0.1
+        self.num_steps = 8
+
+    def create_step(self, model):
+        sgd = fluid.optimizer.SGD(learning_rate=self.learning_rate,
+                                  parameter_list=model.parameters())
+
+        def train_step(x):
+            loss = fluid.layers.reduce_mean(model(x))
+            loss.backward()
+            sgd.minimize(loss)
+            model.clear_gradients()
+            return loss
+
+        return train_step
+
+    def params(self, model):
+        return [p.numpy() for p in model.parameters()]
+
+    def check_step(self, eager_model, eager_step, traced_model, traced_step,
+                   batch_size):
+        x = np.random.random([batch_size, self.input_size]).astype('float32')
+        eager_before = self.params(eager_model)
+        traced_before = self.params(traced_model)
+        eager_loss = eager_step(to_variable(x)).numpy()
+        traced_loss = traced_step(to_variable(x)).numpy()
+        self.assertTrue(np.allclose(eager_loss, traced_loss, rtol=1e-5))
+
+        # The gradients of SGD are the changes of the parameters.
+        for e0, e1, t0, t1 in zip(eager_before,
+                                  self.params(eager_model), traced_before,
+                                  self.params(traced_model)):
+            self.assertTrue(np.allclose(e1, t1, rtol=1e-5, atol=1e-6))
+            self.assertTrue(
+                np.allclose(
+                    (e0 - e1) / self.learning_rate,
+                    (t0 - t1) / self.learning_rate,
+                    rtol=1e-4,
+                    atol=1e-5))
+
+    def test_replay(self):
+        np.random.seed(1)
+        with fluid.dygraph.guard():
+            eager_model = MLP(self.input_size, self.hidden_size)
+            traced_model = MLP(self.input_size, self.hidden_size)
+            traced_model.set_dict(eager_model.state_dict())
+            eager_step = self.create_step(eager_model)
+            # The step is traced again on the 4th and 7th calls.
+            traced_step = TracedStep(
+                self.create_step(traced_model), check_interval=2)
+
+            for _ in six.moves.range(self.num_steps):
+                self.check_step(eager_model, eager_step, traced_model,
+                                traced_step, 16)
+            # Another batch size is not replayed but run by dygraph.
+            self.check_step(eager_model, eager_step, traced_model,
+                            traced_step, 5)
+            self.check_step(eager_model, eager_step, traced_model,
+                            traced_step, 16)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -131,6 +131,13 @@ class TrainerDesc(object):
         self.proto_desc.adjust_ins_weight_config.ins_weight_slot = \
                 config_dict.get("ins_weight_slot", "")
 
+    def _set_async_checkpoint(self, config_dict):
+        config = self.proto_desc.async_checkpoint_config
+        config.path = config_dict.get("path", "")
+        config.interval_seconds = config_dict.get("interval_seconds", 0)
+        for var_name in config_dict.get("var_names", []):
+            config.var_names.append(var_name)
+
     def _set_copy_table_config(self, config_dict):
         config = self.proto_desc.copy_table_config
         config.need_copy = config_dict.get("need_copy", False)